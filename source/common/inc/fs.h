@@ -34,6 +34,7 @@
 *  History:
 *
 *  31.05.2019  mifi  First Version.
+*  17.10.2026  mifi  The upload functions use the handle of fs_UploadStart.
 **************************************************************************/
 #if !defined(__FS_H__)
 #define __FS_H__
@@ -57,6 +58,9 @@
 **************************************************************************/
 
 void     fs_Init (void);
+int      fs_UploadStart (uint32_t dMaxSize, void **ppHandle);
+int      fs_UploadWrite (void *pHandle, const uint8_t *pData, uint32_t dSize);
+void     fs_UploadAbort (void *pHandle);
 int      fs_Upload (web_upload_t *pUpload);
 int      fs_UpgradeWeb (uint8_t bIndex);
 int      fs_UpgradeFw  (uint8_t bIndex);
@@ -216,6 +216,13 @@ extern void  lwip_free(void *ptr);
  */
 #define LWIP_NETIF_HOSTNAME         1
 
+/*
+ * LWIP_NETIF_LOOPBACK==1: Support sending packets with a destination IP
+ * address equal to the netif IP address, and the loop interface (127.0.0.1).
+ * Used by the wakeup socket of the web server connection multiplexer.
+ */
+#define LWIP_NETIF_LOOPBACK         1
+
 
 /*-----------------------------------------------------------------------*/
 /*    TCP options                                                        */
@@ -34,6 +34,8 @@
 *  History:
 *
 *  08.04.2017  mifi  First Version.
+*  16.10.2026  mifi  Read and Write use size_t like the file systems.
+*  17.10.2026  mifi  The file system handles are intptr_t.
 **************************************************************************/
 #if !defined(__FSAPI_H__)
 #define __FSAPI_H__
@@ -42,6 +44,7 @@
 *  Includes
 **************************************************************************/
 #include <stdint.h>
+#include <stddef.h>
 #include <time.h>
 #include "fcntl.h"
 
@@ -61,14 +64,16 @@ struct _fs_fs_
 {
    char DriveName[9];
    
-   int  (*Open)  (const char *name, int mode);
-   int  (*Close) (int fd);
-   int  (*Read)  (int fd, void *buffer, uint32_t count);
-   int  (*Write) (int fd, const void *buffer, uint32_t count);
-   int  (*Seek)  (int fd, long offset, int origin);
-   int  (*Stat)  (int fd, struct _stat *pStat);
-   long (*Filelength)(int fd);
-   int  (*Ioctl) (int fd, int cmd, void *data);
+   /* The handle of a file system can be a pointer, -1 = error */
+   intptr_t (*Open)  (const char *name, int mode);
+   int      (*Close) (intptr_t fd);
+   int      (*Read)  (intptr_t fd, void *buffer, size_t count);
+   int      (*Write) (intptr_t fd, const void *buffer, size_t count);
+   int      (*Seek)  (intptr_t fd, long offset, int origin);
+   int      (*Stat)  (intptr_t fd, struct _stat *pStat);
+   long     (*Filelength)(intptr_t fd);
+   int      (*Ioctl) (intptr_t fd, int cmd, void *data);
+   int      (*Etag)  (const char *name, uint32_t *pEtag);
    
    FS_FS  *pNext;
 };
@@ -92,6 +97,7 @@ int  _seek (int fd, long offset, int origin);
 int  _fstat (int fh, struct _stat *s);
 long _filelength (int fd);
 int  _ioctl (int fd, int cmd, void *buffer);
+int  _etag (const char *name, uint32_t *pEtag);
 
 #endif /* !__FSAPI_H__ */
 
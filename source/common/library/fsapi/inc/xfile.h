@@ -35,6 +35,7 @@
 *
 *  17.10.2015  mifi  First Version.
 *  15.08.2020  mifi  Added ZLIB support
+*  16.10.2026  mifi  Added version 4 with a hashed directory index.
 **************************************************************************/
 #if !defined(__XFILE_H__)
 #define __XFILE_H__
@@ -59,7 +60,9 @@ typedef BYTE   uint8_t;
 
 #define XFILE_HEADER_MAGIC_1     0x4C494658
 #define XFILE_HEADER_MAGIC_2     0x49465845
-#define XFILE_HEADER_SIZEVER     ((((uint32_t)sizeof(XFILE_HEADER)) << 16) | 0x0003)
+#define XFILE_HEADER_SIZEVER_V3  ((((uint32_t)sizeof(XFILE_HEADER)) << 16) | 0x0003)
+#define XFILE_HEADER_SIZEVER_V4  ((((uint32_t)sizeof(XFILE_HEADER)) << 16) | 0x0004)
+#define XFILE_HEADER_SIZEVER     XFILE_HEADER_SIZEVER_V4
 #define XFILE_SIZE_OF_CRC32      sizeof(uint32_t)   
 #define XFILE_HEADER_NAME_SIZE   20
 
@@ -78,7 +81,9 @@ typedef struct _xfile_header_
    uint32_t dDataVersion;
    uint32_t dDataCompSize;
    uint32_t dDataCompCRC32;
-   uint32_t dReserve[3];   
+   uint32_t dHashTable;       /* V4: Offset of the hash table in the data, 0 = none */
+   uint32_t dHashSize;        /* V4: Number of hash entries, power of 2 */
+   uint32_t dReserve[1];   
    uint32_t dHeaderCRC32;
 } XFILE_HEADER;
 
@@ -90,10 +95,27 @@ typedef struct _xfile_fat_entry_
    uint32_t dData;
 } XFILE_FAT_ENTRY;
 
+/*
+ * Version 4 hash table, open addressing with linear probing.
+ * The hash is the FNV-1a of the filename, dIndex is the index
+ * of the FAT entry + 1, an empty slot has a dIndex of 0.
+ */
+typedef struct _xfile_hash_entry_
+{
+   uint32_t dHash;
+   uint32_t dIndex;
+} XFILE_HASH_ENTRY;
+
+#define XFILE_HASH_FNV_OFFSET    0x811C9DC5
+#define XFILE_HASH_FNV_PRIME     0x01000193
+
 /**************************************************************************
 *  Macro Definitions
 **************************************************************************/
 
+#define XFILE_HEADER_SIZEVER_VALID(_v)    \
+   (((_v) == XFILE_HEADER_SIZEVER_V3) || ((_v) == XFILE_HEADER_SIZEVER_V4))
+
 /**************************************************************************
 *  Funtions Definitions
 **************************************************************************/
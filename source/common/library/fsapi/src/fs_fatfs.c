@@ -35,6 +35,8 @@
 *
 *  04.01.2015  mifi  First Version.
 *  13.03.2016  mifi  Renamed to fs_fatfs.c
+*  16.10.2026  mifi  Added SEEK_SET to the seek function.
+*  17.10.2026  mifi  The file handle is intptr_t.
 **************************************************************************/
 #define __FS_FATFS_C__
 
@@ -103,11 +105,11 @@ static int nInitDone = 0;
 /*  Out   : none                                                         */
 /*  Return: file handle                                                  */
 /*************************************************************************/
-static int fatfs_open (const char *name, int mode)
+static intptr_t fatfs_open (const char *name, int mode)
 {
    FRESULT     Result;
    FIL        *FileDesc;
-   int         FileHandle = -1;
+   intptr_t    FileHandle = -1;
    FILINFO     Info;
    struct tm   TM;
    WORD        Value;
@@ -131,7 +133,7 @@ static int fatfs_open (const char *name, int mode)
       Result = f_open(FileDesc, name, ffmode);
       if(FR_OK == Result)
       {
-         FileHandle = (int)FileDesc;
+         FileHandle = (intptr_t)FileDesc;
 
          /* Get file info */
          memset(&Info, 0x00, sizeof(Info));
@@ -185,7 +187,7 @@ static int fatfs_open (const char *name, int mode)
 /*  Out   : none                                                         */
 /*  Return: Result                                                       */
 /*************************************************************************/
-static int fatfs_close (int fd)
+static int fatfs_close (intptr_t fd)
 {
    FIL *FileDesc = (FIL*)fd;
 
@@ -207,7 +209,7 @@ static int fatfs_close (int fd)
 /*  Out   : none                                                         */
 /*  Return: Number of bytes read                                         */
 /*************************************************************************/
-static int fatfs_read (int fd, void *buffer, size_t size)
+static int fatfs_read (intptr_t fd, void *buffer, size_t size)
 {
    FRESULT  Result;
    FIL     *FileDesc = (FIL*)fd;
@@ -242,7 +244,7 @@ static int fatfs_read (int fd, void *buffer, size_t size)
 /*  Out   : none                                                         */
 /*  Return: Number of bytes written                                      */
 /*************************************************************************/
-static int fatfs_write (int fd, const void *buffer, size_t size)
+static int fatfs_write (intptr_t fd, const void *buffer, size_t size)
 {
    FRESULT  Result;
    FIL     *FileDesc = (FIL*)fd;
@@ -277,19 +279,44 @@ static int fatfs_write (int fd, const void *buffer, size_t size)
 /*  Out   : none                                                         */
 /*  Return: New position from the start of file.                         */
 /*************************************************************************/
-static int fatfs_seek (int fd, long offset, int origin)
+static int fatfs_seek (intptr_t fd, long offset, int origin)
 {
    long  pos = -1;
    FIL  *FileDesc = (FIL*)fd;
 
    if (FileDesc != NULL)
    {
-      if (SEEK_CUR == origin)
+      switch (origin) 
       {
-         pos  = (long)f_tell(FileDesc);
-         pos += offset;
-         f_lseek(FileDesc, (DWORD)pos); 
-      }         
+         case SEEK_SET:
+         {
+            pos = offset;
+            break;
+         }
+         
+         case SEEK_CUR:
+         {
+            pos = (long)f_tell(FileDesc) + offset;
+            break;
+         }   
+           
+         case SEEK_END:
+         {
+            pos = (long)f_size(FileDesc) + offset;
+            break;
+         }   
+         
+         default:
+         {
+            /* Invalid origin */
+            break;
+         }
+      }
+      
+      if ((pos < 0) || (f_lseek(FileDesc, (DWORD)pos) != FR_OK))
+      {
+         pos = -1;
+      }
    }
    
    return(pos);
@@ -304,7 +331,7 @@ static int fatfs_seek (int fd, long offset, int origin)
 /*  Out   : none                                                         */
 /*  Return: File size                                                    */
 /*************************************************************************/
-static long fatfs_filelength (int fd)
+static long fatfs_filelength (intptr_t fd)
 {
    long  size = 0;
    FIL  *FileDesc = (FIL*)fd;
@@ -326,7 +353,7 @@ static long fatfs_filelength (int fd)
 /*  Out   : none                                                         */
 /*  Return: 0 = OK / -1 = Error                                          */
 /*************************************************************************/
-static int fatfs_fstat (int fd, struct _stat *stat)
+static int fatfs_fstat (intptr_t fd, struct _stat *stat)
 {
    int   Res = -1;
    FIL  *FileDesc = (FIL*)fd;
@@ -357,6 +384,7 @@ static FS_FS FileSystem =
    fatfs_fstat,
    fatfs_filelength,
    NULL,          /* Ioctl */
+   NULL,          /* Etag */
    
    NULL           /* pNext */
 };
@@ -34,6 +34,10 @@
 *  History:
 *
 *  30.10.2016  mifi  First Version, ROMFS is based on XFILE.
+*  16.10.2026  mifi  Added entity tag support.
+*  16.10.2026  mifi  Use the hashed directory index of version 4 images.
+*  16.10.2026  mifi  Added SEEK_SET to the seek function.
+*  17.10.2026  mifi  The file handle is intptr_t.
 **************************************************************************/
 #define __FS_ROMFS_C__
 
@@ -74,11 +78,166 @@ typedef struct _FCB_
 static time_t             FileTime    = 0;
 static XFILE_FAT_ENTRY  *pDir         = NULL;
 static uint8_t          *pImageBuffer = NULL;
+static uint32_t         *pEtagList    = NULL;
+static XFILE_HASH_ENTRY *pHash        = NULL;
+static uint32_t          dHashMask    = 0;
 
 /*=======================================================================*/
 /*  Definition of all local Procedures                                   */
 /*=======================================================================*/
 
+/*************************************************************************/
+/*  HashName                                                             */
+/*                                                                       */
+/*  Calculate the FNV-1a hash of a filename.                             */
+/*                                                                       */
+/*  In    : name                                                         */
+/*  Out   : none                                                         */
+/*  Return: Hash value                                                   */
+/*************************************************************************/
+static uint32_t HashName (const char *name)
+{
+   uint32_t dHash = XFILE_HASH_FNV_OFFSET;
+   
+   while (*name != 0)
+   {
+      dHash ^= (uint8_t)*name++;
+      dHash *= XFILE_HASH_FNV_PRIME;
+   }
+   
+   return(dHash);
+} /* HashName */
+
+/*************************************************************************/
+/*  SetupHashTable                                                       */
+/*                                                                       */
+/*  Use the hash table of a version 4 image if it is available and       */
+/*  located inside the data. Otherwise the linear search is used.        */
+/*                                                                       */
+/*  In    : pHeader                                                      */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void SetupHashTable (XFILE_HEADER *pHeader)
+{
+   uint32_t dSize = pHeader->dHashSize;
+   
+   pHash     = NULL;
+   dHashMask = 0;
+   
+   if ( (XFILE_HEADER_SIZEVER_V4 == pHeader->dSizeVersion) &&
+        (pHeader->dHashTable != 0)                          &&
+        (0 == (pHeader->dHashTable & 3))                    &&
+        (dSize != 0) && (0 == (dSize & (dSize - 1)))        &&
+        (pHeader->dHashTable < pHeader->dDataTotalSize)     &&
+        (dSize <= ((pHeader->dDataTotalSize - pHeader->dHashTable) / sizeof(XFILE_HASH_ENTRY))) )
+   {
+      pHash     = (XFILE_HASH_ENTRY*)(pImageBuffer + pHeader->dHashTable); /*lint !e826*/
+      dHashMask = dSize - 1;
+   }
+   
+} /* SetupHashTable */
+
+/*************************************************************************/
+/*  FindEntry                                                            */
+/*                                                                       */
+/*  Find the directory entry of a file. Version 4 images are searched    */
+/*  with the hash table (linear probing), older ones linear.             */
+/*                                                                       */
+/*  In    : name                                                         */
+/*  Out   : none                                                         */
+/*  Return: Index of the entry / -1 = not found                          */
+/*************************************************************************/
+static int FindEntry (const char *name)
+{
+   int       Index = -1;
+   char    *pName;
+   int       i;
+   uint32_t dHash;
+   uint32_t dSlot;
+   uint32_t dCount;
+   
+   if (*name == '/') 
+   {
+      name++;
+   }
+
+   if (pHash != NULL)
+   {
+      dHash = HashName(name);
+      dSlot = dHash & dHashMask;
+      
+      for (dCount = 0; dCount <= dHashMask; dCount++)
+      {
+         if (0 == pHash[dSlot].dIndex)
+         {
+            /* Empty slot, the file is not available */
+            break;
+         }
+         
+         if (pHash[dSlot].dHash == dHash)
+         {
+            i     = (int)pHash[dSlot].dIndex - 1;
+            pName = (char*)(pImageBuffer + pDir[i].dFilename);
+            if (0 == strcmp(pName, name))
+            {
+               Index = i;
+               break;
+            }
+         }
+         
+         dSlot = (dSlot + 1) & dHashMask;
+      }
+   }
+   else
+   {
+      i = 0;
+      while(pDir[i].dFilename != 0)
+      {
+         pName = (char*)(pImageBuffer + pDir[i].dFilename);
+         if (0 == strcmp(pName, name))
+         {
+            Index = i;
+            break;
+         }
+      
+         i++;
+      }
+   }
+   
+   return(Index);
+} /* FindEntry */
+
+/*************************************************************************/
+/*  CreateEtagList                                                       */
+/*                                                                       */
+/*  Calculate the entity tag of all files, the adler32 of the content.   */
+/*                                                                       */
+/*  In    : none                                                         */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void CreateEtagList (void)
+{
+   int i;
+   int Count = 0;
+   
+   while(pDir[Count].dFilename != 0)
+   {
+      Count++;
+   }
+   
+   pEtagList = (uint32_t*)xmalloc(XM_ID_HEAP, ((size_t)Count + 1) * sizeof(uint32_t));
+   if (pEtagList != NULL)
+   {
+      for (i = 0; i < Count; i++)
+      {
+         pEtagList[i] = adler32(ADLER_START_VALUE, pImageBuffer + pDir[i].dData, pDir[i].dFilelength);
+      }
+   }
+   
+} /* CreateEtagList */
+
 /*************************************************************************/
 /*  xfile_open                                                           */
 /*                                                                       */
@@ -88,22 +247,16 @@ static uint8_t          *pImageBuffer = NULL;
 /*  Out   : none                                                         */
 /*  Return: file handle                                                  */
 /*************************************************************************/
-static int xfile_open (const char *name, int mode)
+static intptr_t xfile_open (const char *name, int mode)
 {
-   int     FileHandle = -1;
-   FCB   *pFCB = NULL;
-   char  *pName;
-   int     i;
+   intptr_t  FileHandle = -1;
+   FCB      *pFCB = NULL;
+   int       i;
    
    (void)mode;
    
    if ((pImageBuffer != NULL) && (name != NULL))
    {
-      if (*name == '/') 
-      {
-         name++;
-      }
-   
       /*
        * In general a file will be opened who is available too.
        * Therefore the descriptors can be allocated before.
@@ -113,22 +266,15 @@ static int xfile_open (const char *name, int mode)
       /* Check for valid descriptors */
       if (pFCB != NULL)
       {
-         i = 0;
-         while(pDir[i].dFilename != 0)
+         i = FindEntry(name);
+         if (i != -1)
          {
-            pName = (char*)(pImageBuffer + pDir[i].dFilename);
-            if (0 == strcmp(pName, name))
-            {
-               pFCB->pData = (uint8_t*)(pImageBuffer + pDir[i].dData);    
-               pFCB->Size  = pDir[i].dFilelength;
-               pFCB->Pos   = 0;
-            
-               /* File is available, "create" descriptors */
-               FileHandle = (int)pFCB;
-               break;
-            }
+            pFCB->pData = (uint8_t*)(pImageBuffer + pDir[i].dData);    
+            pFCB->Size  = pDir[i].dFilelength;
+            pFCB->Pos   = 0;
          
-            i++;
+            /* File is available, "create" descriptors */
+            FileHandle = (intptr_t)pFCB;
          }
 
          if (-1 == FileHandle)
@@ -151,7 +297,7 @@ static int xfile_open (const char *name, int mode)
 /*  Out   : none                                                         */
 /*  Return: Result                                                       */
 /*************************************************************************/
-static int xfile_close (int fd)
+static int xfile_close (intptr_t fd)
 {
    FCB *pFCB = (FCB*)fd;
 
@@ -172,7 +318,7 @@ static int xfile_close (int fd)
 /*  Out   : none                                                         */
 /*  Return: Number of bytes read                                         */
 /*************************************************************************/
-static int xfile_read (int fd, void *buffer, size_t size)
+static int xfile_read (intptr_t fd, void *buffer, size_t size)
 {
    FCB *pFCB = (FCB*)fd;
    
@@ -206,7 +352,7 @@ static int xfile_read (int fd, void *buffer, size_t size)
 /*  Out   : none                                                         */
 /*  Return: New position from the start of file.                         */
 /*************************************************************************/
-static int xfile_seek (int fd, long offset, int origin)
+static int xfile_seek (intptr_t fd, long offset, int origin)
 {
    long   pos = -1;
    FCB  *pFCB = (FCB*)fd;
@@ -215,6 +361,12 @@ static int xfile_seek (int fd, long offset, int origin)
    {
       switch (origin) 
       {
+         case SEEK_SET:
+         {
+            pos = offset;
+            break;
+         }
+         
          case SEEK_CUR:
          {
             pos = (long)pFCB->Pos + offset;
@@ -229,8 +381,7 @@ static int xfile_seek (int fd, long offset, int origin)
          
          default:
          {
-            pos = (long)pFCB->Pos;
-            /* Do nothing */
+            /* Invalid origin */
             break;
          }
       }
@@ -258,7 +409,7 @@ static int xfile_seek (int fd, long offset, int origin)
 /*  Out   : none                                                         */
 /*  Return: File size                                                    */
 /*************************************************************************/
-static long xfile_filelength (int fd)
+static long xfile_filelength (intptr_t fd)
 {
    long   size = 0;
    FCB  *pFCB = (FCB*)fd;
@@ -280,7 +431,7 @@ static long xfile_filelength (int fd)
 /*  Out   : none                                                         */
 /*  Return: 0 = OK / -1 = Error                                          */
 /*************************************************************************/
-static int xfile_fstat (int fd, struct _stat *stat)
+static int xfile_fstat (intptr_t fd, struct _stat *stat)
 {
    int    rc = -1;
    FCB  *pFCB = (FCB*)fd;
@@ -303,7 +454,7 @@ static int xfile_fstat (int fd, struct _stat *stat)
 /*  Out   : none                                                         */
 /*  Return: 0 = OK / -1 = Error                                          */
 /*************************************************************************/
-static int xfile_ioctl (int fd, int cmd, void *data)
+static int xfile_ioctl (intptr_t fd, int cmd, void *data)
 {
    int rc = -1;
    
@@ -315,6 +466,33 @@ static int xfile_ioctl (int fd, int cmd, void *data)
 } /* _ioctl */
 
 
+/*************************************************************************/
+/*  xfile_etag                                                           */
+/*                                                                       */
+/*  Return the entity tag of a file.                                     */
+/*                                                                       */
+/*  In    : name                                                         */
+/*  Out   : pEtag                                                        */
+/*  Return: 0 = OK / -1 = Error                                          */
+/*************************************************************************/
+static int xfile_etag (const char *name, uint32_t *pEtag)
+{
+   int rc = -1;
+   int i;
+   
+   if ((pImageBuffer != NULL) && (pEtagList != NULL) && (name != NULL))
+   {
+      i = FindEntry(name);
+      if (i != -1)
+      {
+         *pEtag = pEtagList[i];
+         rc     = 0;
+      }
+   }
+   
+   return(rc);
+} /* xfile_etag */
+
 static FS_FS FileSystem = 
 {
    "ROMFS",
@@ -326,6 +504,7 @@ static FS_FS FileSystem =
    xfile_fstat,
    xfile_filelength,
    xfile_ioctl,
+   xfile_etag,
    
    NULL           /* pNext */
 };
@@ -358,7 +537,7 @@ void romfs_Init (void)
    
    if ( (XFILE_HEADER_MAGIC_1 == pHeader->dMagic1)      &&
         (XFILE_HEADER_MAGIC_2 == pHeader->dMagic2)      &&
-        (XFILE_HEADER_SIZEVER == pHeader->dSizeVersion) )
+        XFILE_HEADER_SIZEVER_VALID(pHeader->dSizeVersion) )
    {
       /* Check CRC32 of the header */
       CRC32 = adler32(ADLER_START_VALUE, (uint8_t*)pHeader, sizeof(XFILE_HEADER) - XFILE_SIZE_OF_CRC32);
@@ -375,6 +554,11 @@ void romfs_Init (void)
             /* Error */
             pImageBuffer = NULL;
          }
+         else
+         {
+            SetupHashTable(pHeader);
+            CreateEtagList();
+         }
       }
    }       
    
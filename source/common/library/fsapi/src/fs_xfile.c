@@ -35,6 +35,11 @@
 *
 *  29.10.2016  mifi  First Version.
 *  15.08.2020  mifi  Added ZLIB support
+*  16.10.2026  mifi  Added entity tag support.
+*  16.10.2026  mifi  Use the hashed directory index of version 4 images.
+*  16.10.2026  mifi  Added SEEK_SET to the seek function.
+*  17.10.2026  mifi  The file handle is intptr_t.
+*  17.10.2026  mifi  Take the FCB from a pool.
 **************************************************************************/
 #define __FS_XFILE_C__
 
@@ -56,12 +61,20 @@
 /*  All Structures and Common Constants                                  */
 /*=======================================================================*/
 
+/* Number of FCBs in the pool, further open files use the heap */
+#if !defined(XFILE_FCB_POOL_CNT)
+#define _FCB_POOL_CNT   16
+#else
+#define _FCB_POOL_CNT   XFILE_FCB_POOL_CNT
+#endif
+
 /* File Control Block */
 typedef struct _FCB_ 
 {
-   uint8_t  *pData;
-   uint32_t   Size;
-   uint32_t   Pos;
+   uint8_t      *pData;
+   uint32_t       Size;
+   uint32_t       Pos;
+   struct _FCB_ *pNext;    /* Free list of the pool */
 } FCB;
 
 /*=======================================================================*/
@@ -75,71 +88,259 @@ typedef struct _FCB_
 static time_t             FileTime = 0;
 static XFILE_FAT_ENTRY  *pDir         = NULL;
 static uint8_t          *pImageBuffer = NULL;
+static uint32_t         *pEtagList    = NULL;
+static XFILE_HASH_ENTRY *pHash        = NULL;
+static uint32_t          dHashMask    = 0;
 
 static char             *pDataName    = NULL;
 static uint32_t          dDataVersion = 0;
 
+static FCB               FCBPool[_FCB_POOL_CNT];
+static FCB              *pFreeFCB     = NULL;
+
 /*=======================================================================*/
 /*  Definition of all local Procedures                                   */
 /*=======================================================================*/
 
 /*************************************************************************/
-/*  xfile_open                                                           */
+/*  HashName                                                             */
 /*                                                                       */
-/*  Open a file and return the "file handle".                            */
+/*  Calculate the FNV-1a hash of a filename.                             */
 /*                                                                       */
-/*  In    : fs, name, mode                                               */
+/*  In    : name                                                         */
 /*  Out   : none                                                         */
-/*  Return: file handle                                                  */
+/*  Return: Hash value                                                   */
 /*************************************************************************/
-static int xfile_open (const char *name, int mode)
+static uint32_t HashName (const char *name)
 {
-   int     FileHandle = -1;
-   FCB   *pFCB;
-   char  *pName;
-   int     i;
+   uint32_t dHash = XFILE_HASH_FNV_OFFSET;
    
-   (void)mode;
+   while (*name != 0)
+   {
+      dHash ^= (uint8_t)*name++;
+      dHash *= XFILE_HASH_FNV_PRIME;
+   }
    
-   if ((pImageBuffer != NULL) && (name != NULL))
+   return(dHash);
+} /* HashName */
+
+/*************************************************************************/
+/*  SetupHashTable                                                       */
+/*                                                                       */
+/*  Use the hash table of a version 4 image if it is available and       */
+/*  located inside the data. Otherwise the linear search is used.        */
+/*                                                                       */
+/*  In    : pHeader                                                      */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void SetupHashTable (XFILE_HEADER *pHeader)
+{
+   uint32_t dSize = pHeader->dHashSize;
+   
+   pHash     = NULL;
+   dHashMask = 0;
+   
+   if ( (XFILE_HEADER_SIZEVER_V4 == pHeader->dSizeVersion) &&
+        (pHeader->dHashTable != 0)                          &&
+        (0 == (pHeader->dHashTable & 3))                    &&
+        (dSize != 0) && (0 == (dSize & (dSize - 1)))        &&
+        (pHeader->dHashTable < pHeader->dDataTotalSize)     &&
+        (dSize <= ((pHeader->dDataTotalSize - pHeader->dHashTable) / sizeof(XFILE_HASH_ENTRY))) )
    {
-      if (*name == '/') 
-      {
-         name++;
-      }
+      pHash     = (XFILE_HASH_ENTRY*)(pImageBuffer + pHeader->dHashTable); /*lint !e826*/
+      dHashMask = dSize - 1;
+   }
    
-      /*
-       * In general a file will be opened who is available too.
-       * Therefore the descriptors can be allocated before.
-       */
-      pFCB = xmalloc(XM_ID_FS, sizeof(FCB));
+} /* SetupHashTable */
+
+/*************************************************************************/
+/*  FindEntry                                                            */
+/*                                                                       */
+/*  Find the directory entry of a file. Version 4 images are searched    */
+/*  with the hash table (linear probing), older ones linear.             */
+/*                                                                       */
+/*  In    : name                                                         */
+/*  Out   : none                                                         */
+/*  Return: Index of the entry / -1 = not found                          */
+/*************************************************************************/
+static int FindEntry (const char *name)
+{
+   int       Index = -1;
+   char    *pName;
+   int       i;
+   uint32_t dHash;
+   uint32_t dSlot;
+   uint32_t dCount;
+   
+   if (*name == '/') 
+   {
+      name++;
+   }
+
+   if (pHash != NULL)
+   {
+      dHash = HashName(name);
+      dSlot = dHash & dHashMask;
       
-      /* Check for valid descriptors */
-      if (pFCB != NULL)
+      for (dCount = 0; dCount <= dHashMask; dCount++)
       {
-         i = 0;
-         while(pDir[i].dFilename != 0)
+         if (0 == pHash[dSlot].dIndex)
          {
+            /* Empty slot, the file is not available */
+            break;
+         }
+         
+         if (pHash[dSlot].dHash == dHash)
+         {
+            i     = (int)pHash[dSlot].dIndex - 1;
             pName = (char*)(pImageBuffer + pDir[i].dFilename);
             if (0 == strcmp(pName, name))
             {
-               pFCB->pData = (uint8_t*)(pImageBuffer + pDir[i].dData);    
-               pFCB->Size  = pDir[i].dFilelength;
-               pFCB->Pos   = 0;
-            
-               /* File is available, "create" descriptors */
-               FileHandle = (int)pFCB;
+               Index = i;
                break;
             }
-         
-            i++;
          }
          
-         if (-1 == FileHandle)
+         dSlot = (dSlot + 1) & dHashMask;
+      }
+   }
+   else
+   {
+      i = 0;
+      while(pDir[i].dFilename != 0)
+      {
+         pName = (char*)(pImageBuffer + pDir[i].dFilename);
+         if (0 == strcmp(pName, name))
          {
-            /* File not found */
-            xfree(pFCB);
-         } 
+            Index = i;
+            break;
+         }
+      
+         i++;
+      }
+   }
+   
+   return(Index);
+} /* FindEntry */
+
+/*************************************************************************/
+/*  CreateEtagList                                                       */
+/*                                                                       */
+/*  Calculate the entity tag of all files, the adler32 of the content.   */
+/*                                                                       */
+/*  In    : none                                                         */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void CreateEtagList (void)
+{
+   int i;
+   int Count = 0;
+   
+   while(pDir[Count].dFilename != 0)
+   {
+      Count++;
+   }
+   
+   pEtagList = (uint32_t*)xmalloc(XM_ID_HEAP, ((size_t)Count + 1) * sizeof(uint32_t));
+   if (pEtagList != NULL)
+   {
+      for (i = 0; i < Count; i++)
+      {
+         pEtagList[i] = adler32(ADLER_START_VALUE, pImageBuffer + pDir[i].dData, pDir[i].dFilelength);
+      }
+   }
+   
+} /* CreateEtagList */
+
+/*************************************************************************/
+/*  AllocFCB                                                             */
+/*                                                                       */
+/*  Take a FCB from the pool, from the heap if the pool is empty.        */
+/*                                                                       */
+/*  In    : none                                                         */
+/*  Out   : none                                                         */
+/*  Return: FCB / NULL = ERROR                                           */
+/*************************************************************************/
+static FCB *AllocFCB (void)
+{
+   FCB *pFCB;
+   
+   TAL_CPU_DISABLE_ALL_INTS();
+   pFCB = pFreeFCB;
+   if (pFCB != NULL)
+   {
+      pFreeFCB = pFCB->pNext;
+   }
+   TAL_CPU_ENABLE_ALL_INTS();
+   
+   if (NULL == pFCB)
+   {
+      pFCB = xmalloc(XM_ID_FS, sizeof(FCB));
+   }
+   
+   return(pFCB);
+} /* AllocFCB */
+
+/*************************************************************************/
+/*  FreeFCB                                                              */
+/*                                                                       */
+/*  Give the FCB back to the pool, or to the heap.                       */
+/*                                                                       */
+/*  In    : pFCB                                                         */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void FreeFCB (FCB *pFCB)
+{
+   if ((pFCB >= &FCBPool[0]) && (pFCB < &FCBPool[_FCB_POOL_CNT]))
+   {
+      TAL_CPU_DISABLE_ALL_INTS();
+      pFCB->pNext = pFreeFCB;
+      pFreeFCB    = pFCB;
+      TAL_CPU_ENABLE_ALL_INTS();
+   }
+   else
+   {
+      xfree(pFCB);
+   }
+   
+} /* FreeFCB */
+
+/*************************************************************************/
+/*  xfile_open                                                           */
+/*                                                                       */
+/*  Open a file and return the "file handle".                            */
+/*                                                                       */
+/*  In    : fs, name, mode                                               */
+/*  Out   : none                                                         */
+/*  Return: file handle                                                  */
+/*************************************************************************/
+static intptr_t xfile_open (const char *name, int mode)
+{
+   intptr_t  FileHandle = -1;
+   FCB      *pFCB;
+   int       i;
+   
+   (void)mode;
+   
+   if ((pImageBuffer != NULL) && (name != NULL))
+   {
+      /* The FCB is only needed if the file is available */
+      i = FindEntry(name);
+      if (i != -1)
+      {
+         pFCB = AllocFCB();
+         if (pFCB != NULL)
+         {
+            pFCB->pData = (uint8_t*)(pImageBuffer + pDir[i].dData);    
+            pFCB->Size  = pDir[i].dFilelength;
+            pFCB->Pos   = 0;
+         
+            /* File is available, "create" descriptors */
+            FileHandle = (intptr_t)pFCB;
+         }
       }
    }
       
@@ -155,13 +356,13 @@ static int xfile_open (const char *name, int mode)
 /*  Out   : none                                                         */
 /*  Return: Result                                                       */
 /*************************************************************************/
-static int xfile_close (int fd)
+static int xfile_close (intptr_t fd)
 {
    FCB *pFCB = (FCB*)fd;
 
    if (pFCB != NULL)
    {
-      xfree(pFCB);
+      FreeFCB(pFCB);
    }      
    
    return(0);
@@ -176,7 +377,7 @@ static int xfile_close (int fd)
 /*  Out   : none                                                         */
 /*  Return: Number of bytes read                                         */
 /*************************************************************************/
-static int xfile_read (int fd, void *buffer, size_t size)
+static int xfile_read (intptr_t fd, void *buffer, size_t size)
 {
    FCB *pFCB = (FCB*)fd;
 
@@ -210,7 +411,7 @@ static int xfile_read (int fd, void *buffer, size_t size)
 /*  Out   : none                                                         */
 /*  Return: New position from the start of file.                         */
 /*************************************************************************/
-static int xfile_seek (int fd, long offset, int origin)
+static int xfile_seek (intptr_t fd, long offset, int origin)
 {
    long   pos = -1;
    FCB  *pFCB = (FCB*)fd;
@@ -219,6 +420,12 @@ static int xfile_seek (int fd, long offset, int origin)
    {
       switch (origin) 
       {
+         case SEEK_SET:
+         {
+            pos = offset;
+            break;
+         }
+         
          case SEEK_CUR:
          {
             pos = (long)pFCB->Pos + offset;
@@ -233,8 +440,7 @@ static int xfile_seek (int fd, long offset, int origin)
          
          default:
          {
-            pos = (long)pFCB->Pos;
-            /* Do nothing */
+            /* Invalid origin */
             break;
          }
       }
@@ -262,7 +468,7 @@ static int xfile_seek (int fd, long offset, int origin)
 /*  Out   : none                                                         */
 /*  Return: File size                                                    */
 /*************************************************************************/
-static long xfile_filelength (int fd)
+static long xfile_filelength (intptr_t fd)
 {
    long  size = 0;
    FCB  *pFCB = (FCB*)fd;
@@ -284,7 +490,7 @@ static long xfile_filelength (int fd)
 /*  Out   : none                                                         */
 /*  Return: 0 = OK / -1 = Error                                          */
 /*************************************************************************/
-static int xfile_fstat (int fd, struct _stat *stat)
+static int xfile_fstat (intptr_t fd, struct _stat *stat)
 {
    int         rc = -1;
    FCB  *pFCB = (FCB*)fd;
@@ -307,7 +513,7 @@ static int xfile_fstat (int fd, struct _stat *stat)
 /*  Out   : none                                                         */
 /*  Return: 0 = OK / -1 = Error                                          */
 /*************************************************************************/
-static int xfile_ioctl (int fd, int cmd, void *data)
+static int xfile_ioctl (intptr_t fd, int cmd, void *data)
 {
    int rc = -1;
    
@@ -319,6 +525,33 @@ static int xfile_ioctl (int fd, int cmd, void *data)
 } /* _ioctl */
 
 
+/*************************************************************************/
+/*  xfile_etag                                                           */
+/*                                                                       */
+/*  Return the entity tag of a file.                                     */
+/*                                                                       */
+/*  In    : name                                                         */
+/*  Out   : pEtag                                                        */
+/*  Return: 0 = OK / -1 = Error                                          */
+/*************************************************************************/
+static int xfile_etag (const char *name, uint32_t *pEtag)
+{
+   int rc = -1;
+   int i;
+   
+   if ((pImageBuffer != NULL) && (pEtagList != NULL) && (name != NULL))
+   {
+      i = FindEntry(name);
+      if (i != -1)
+      {
+         *pEtag = pEtagList[i];
+         rc     = 0;
+      }
+   }
+   
+   return(rc);
+} /* xfile_etag */
+
 static FS_FS FileSystem = 
 {
    "XFILE",
@@ -330,6 +563,7 @@ static FS_FS FileSystem =
    xfile_fstat,
    xfile_filelength,
    xfile_ioctl,
+   xfile_etag,
    
    NULL           /* pNext */
 };
@@ -348,6 +582,16 @@ static FS_FS FileSystem =
 /*************************************************************************/
 void xfile_Init (void)
 {
+   int i;
+   
+   /* Setup the free list of the FCB pool */
+   pFreeFCB = NULL;
+   for (i = (_FCB_POOL_CNT - 1); i >= 0; i--)
+   {
+      FCBPool[i].pNext = pFreeFCB;
+      pFreeFCB         = &FCBPool[i];
+   }
+   
    /* Register the file system. */
    FSRegister(&FileSystem);
    
@@ -374,7 +618,7 @@ int xfile_Check (uint8_t *pImage, uint32_t ImageSize)
 
    if ( (XFILE_HEADER_MAGIC_1 == pHeader->dMagic1)      &&
         (XFILE_HEADER_MAGIC_2 == pHeader->dMagic2)      &&
-        (XFILE_HEADER_SIZEVER == pHeader->dSizeVersion) )
+        XFILE_HEADER_SIZEVER_VALID(pHeader->dSizeVersion) )
    {
       /* Check CRC32 of the header */
       CRC32 = adler32(ADLER_START_VALUE, (uint8_t*)pHeader, sizeof(XFILE_HEADER) - XFILE_SIZE_OF_CRC32);
@@ -445,9 +689,14 @@ uint8_t *xfile_Mount (uint8_t *pImage, uint32_t ImageSize)
    pDir         = NULL;
    pImageBuffer = NULL;
    
+   pHash        = NULL;
+   
+   xfree(pEtagList);
+   pEtagList    = NULL;
+   
    if ( (XFILE_HEADER_MAGIC_1 == pHeader->dMagic1)      &&
         (XFILE_HEADER_MAGIC_2 == pHeader->dMagic2)      &&
-        (XFILE_HEADER_SIZEVER == pHeader->dSizeVersion) )
+        XFILE_HEADER_SIZEVER_VALID(pHeader->dSizeVersion) )
    {
       /* Check CRC32 of the header */
       CRC32 = adler32(ADLER_START_VALUE, (uint8_t*)pHeader, sizeof(XFILE_HEADER) - XFILE_SIZE_OF_CRC32);
@@ -510,6 +759,12 @@ uint8_t *xfile_Mount (uint8_t *pImage, uint32_t ImageSize)
       }
    }       
    
+   if (pBuffer != NULL)
+   {
+      SetupHashTable(pHeader);
+      CreateEtagList();
+   }
+   
    return(pBuffer);
 } /* xfile_Mount */
 
@@ -525,9 +780,13 @@ uint8_t *xfile_Mount (uint8_t *pImage, uint32_t ImageSize)
 void xfile_UnMount (void)
 {
    pImageBuffer = NULL;
+   pHash        = NULL;
    pDataName    = NULL;
    dDataVersion = 0;
    
+   xfree(pEtagList);
+   pEtagList    = NULL;
+   
 } /* xfile_UnMount */
 
 /*************************************************************************/
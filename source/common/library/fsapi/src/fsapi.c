@@ -34,6 +34,9 @@
 *  History:
 *
 *  08.04.2017  mifi  First Version.
+*  16.10.2026  mifi  Added _etag.
+*  16.10.2026  mifi  _read uses size_t like the prototype.
+*  17.10.2026  mifi  The file system handles are intptr_t.
 **************************************************************************/
 #define __FSAPI_C__
 
@@ -58,8 +61,8 @@
 
 typedef struct _fs_file_desc_
 {
-   FS_FS *pFS;      /* File System */
-   void  *pHandle;  /* File handle */ 
+   FS_FS    *pFS;    /* File System */
+   intptr_t  Handle; /* File handle */
 } FS_FILE_DESC;
 
 /*=======================================================================*/
@@ -101,6 +104,50 @@ static FS_FS *FindFSByDriveName (const char *pName)
    return(pFS);
 } /* FindFSByDriveName */
 
+/*************************************************************************/
+/*  FindFSByPath                                                         */
+/*                                                                       */
+/*  Find file system by the drive name part of a path.                   */
+/*                                                                       */
+/*  In    : name                                                         */
+/*  Out   : ppFilename                                                   */
+/*  Return: NULL / pDev                                                  */
+/*************************************************************************/
+static FS_FS *FindFSByPath (const char *name, char **ppFilename)
+{
+   char    Drive[9];
+   int     DriveLen = 0;
+   FS_FS *pFS = NULL;
+   
+   *ppFilename = NULL;
+   
+   /* Find drive */
+   while (DriveLen < (int)sizeof(Drive) -1)
+   {
+      if (*name != ':')
+      {
+         Drive[DriveLen] = *name;
+         DriveLen++;
+         name++;
+      }
+      else
+      {
+         Drive[DriveLen] = 0;
+         name++;
+         *ppFilename = (char*)name;
+         break;
+      }
+   }
+
+   /* Check if a filename is available too */ 
+   if (*ppFilename != NULL)
+   {
+      pFS = FindFSByDriveName(Drive);
+   }
+   
+   return(pFS);
+} /* FindFSByPath */
+
 /*=======================================================================*/
 /*  All code exported                                                    */
 /*=======================================================================*/
@@ -156,71 +203,47 @@ int FSRegister (FS_FS *pFS)
 /*************************************************************************/
 int _open (const char *name, int mode)
 {
-   int     Result = -1;
-   int     Handle;
-   int     FileDesc;   
-   char    Drive[9];
-   int     DriveLen = 0;
-   char  *pFilename = NULL;
-   FS_FS *pFS = NULL;
+   int       Result = -1;
+   intptr_t  Handle;
+   int       FileDesc;   
+   char     *pFilename;
+   FS_FS    *pFS;
    
    OS_RES_LOCK(&Sema);
    
-   /* Find drive */
-   while (DriveLen < (int)sizeof(Drive) -1)
-   {
-      if (*name != ':')
-      {
-         Drive[DriveLen] = *name;
-         DriveLen++;
-         name++;
-      }
-      else
-      {
-         Drive[DriveLen] = 0;
-         name++;
-         pFilename = (char*)name;
-         break;
-      }
-   }
-
-   /* Check if a filename is available too */ 
-   if (pFilename != NULL)
+   /* Get device */
+   pFS = FindFSByPath(name, &pFilename);
+   if (pFS != NULL)
    {
-      /* Get device */
-      pFS = FindFSByDriveName(Drive);
-      if (pFS != NULL)
+      /* Open file */
+      if (pFS->Open != NULL)
       {
-         /* Open file */
-         if (pFS->Open != NULL)
+         Handle = pFS->Open(pFilename, mode);
+         if (Handle != -1)
          {
-            Handle = pFS->Open(pFilename, mode);
-            if (Handle != -1)
+            /* Search a free file descriptor */
+            for (FileDesc = 0; FileDesc < MAX_OPEN_FILES; FileDesc++)
             {
-               /* Search a free file descriptor */
-               for (FileDesc = 0; FileDesc < MAX_OPEN_FILES; FileDesc++)
+               if (NULL == FileDescList[FileDesc].pFS)
                {
-                  if (NULL == FileDescList[FileDesc].pFS)
-                  {
-                     break;
-                  }
+                  break;
                }
+            }
+            
+            /* Check if entry is available */
+            if (FileDesc < MAX_OPEN_FILES)
+            {
+               FileDescList[FileDesc].pFS     = pFS;
+               FileDescList[FileDesc].Handle  = Handle;
                
-               /* Check if entry is available */
-               if (FileDesc < MAX_OPEN_FILES)
-               {
-                  FileDescList[FileDesc].pFS     = pFS;
-                  FileDescList[FileDesc].pHandle = (void*)Handle;
-                  
-                  Result = FileDesc;
-               }
-               else
+               Result = FileDesc;
+            }
+            else
+            {
+               /* Ups, no descriptor available, file must be closed */
+               if (pFS->Close != NULL)
                {
-                  /* Ups, no descriptor available, file must be closed */
-                  if (pFS->Close != NULL)
-                  {
-                     pFS->Close(Handle);   
-                  }
+                  pFS->Close(Handle);   
                }
             }
          }
@@ -243,21 +266,21 @@ int _open (const char *name, int mode)
 /*************************************************************************/
 int _close (int fd)
 {
-   int     Result = -1;
-   int     Handle;
-   FS_FS *pFS;
+   int       Result = -1;
+   intptr_t  Handle;
+   FS_FS    *pFS;
    
    OS_RES_LOCK(&Sema);
 
    if (fd < MAX_OPEN_FILES)
    {
       pFS    = FileDescList[fd].pFS;
-      Handle = (int)(FileDescList[fd].pHandle);
+      Handle = FileDescList[fd].Handle;
       if ((pFS->Close != NULL) && (Handle != 0))
       {
          Result = pFS->Close(Handle);
          FileDescList[fd].pFS     = NULL;
-         FileDescList[fd].pHandle = NULL;
+         FileDescList[fd].Handle  = 0;
       }
    }
 
@@ -275,18 +298,18 @@ int _close (int fd)
 /*  Out   : none                                                         */
 /*  Return: Number of bytes read                                         */
 /*************************************************************************/
-int _read (int fd, void *buffer, uint32_t count)
+int _read (int fd, void *buffer, size_t count)
 {
-   int     BytesRead = -1;
-   int     Handle;
-   FS_FS *pFS;
+   int       BytesRead = -1;
+   intptr_t  Handle;
+   FS_FS    *pFS;
    
    OS_RES_LOCK(&Sema);
 
    if (fd < MAX_OPEN_FILES)
    {
       pFS    = FileDescList[fd].pFS;
-      Handle = (int)(FileDescList[fd].pHandle);
+      Handle = FileDescList[fd].Handle;
       if ((pFS->Read != NULL) && (Handle != 0))
       {
          BytesRead = pFS->Read(Handle, buffer, count);
@@ -309,16 +332,16 @@ int _read (int fd, void *buffer, uint32_t count)
 /*************************************************************************/
 int _write (int fd, const void *buffer, size_t count)
 {
-   int     BytesWritten = -1;
-   int     Handle;
-   FS_FS *pFS;
+   int       BytesWritten = -1;
+   intptr_t  Handle;
+   FS_FS    *pFS;
    
    OS_RES_LOCK(&Sema);
 
    if (fd < MAX_OPEN_FILES)
    {
       pFS    = FileDescList[fd].pFS;
-      Handle = (int)(FileDescList[fd].pHandle);
+      Handle = FileDescList[fd].Handle;
       if ((pFS->Write != NULL) && (Handle != 0))
       {
          BytesWritten = pFS->Write(Handle, buffer, count);
@@ -341,16 +364,16 @@ int _write (int fd, const void *buffer, size_t count)
 /*************************************************************************/
 int _seek (int fd, long offset, int origin)
 {
-   int     Result = -1;
-   int     Handle;
-   FS_FS *pFS;
+   int       Result = -1;
+   intptr_t  Handle;
+   FS_FS    *pFS;
 
    OS_RES_LOCK(&Sema);
 
    if (fd < MAX_OPEN_FILES)
    {
       pFS    = FileDescList[fd].pFS;
-      Handle = (int)(FileDescList[fd].pHandle);
+      Handle = FileDescList[fd].Handle;
       if ((pFS->Seek != NULL) && (Handle != 0))
       {
          Result = pFS->Seek(Handle, offset, origin);
@@ -373,16 +396,16 @@ int _seek (int fd, long offset, int origin)
 /*************************************************************************/
 int _fstat (int fd, struct _stat *stat)
 {
-   int     Result = -1;
-   int     Handle;
-   FS_FS *pFS;
+   int       Result = -1;
+   intptr_t  Handle;
+   FS_FS    *pFS;
 
    OS_RES_LOCK(&Sema);
 
    if (fd < MAX_OPEN_FILES)
    {
       pFS    = FileDescList[fd].pFS;
-      Handle = (int)(FileDescList[fd].pHandle);
+      Handle = FileDescList[fd].Handle;
       if ((pFS->Stat != NULL) && (Handle != 0))
       {
          Result = pFS->Stat(Handle, stat);
@@ -405,16 +428,16 @@ int _fstat (int fd, struct _stat *stat)
 /*************************************************************************/
 long _filelength (int fd)
 {
-   long    Size = 0;
-   int     Handle;
-   FS_FS *pFS;
+   long      Size = 0;
+   intptr_t  Handle;
+   FS_FS    *pFS;
 
    OS_RES_LOCK(&Sema);
 
    if (fd < MAX_OPEN_FILES)
    {
       pFS    = FileDescList[fd].pFS;
-      Handle = (int)(FileDescList[fd].pHandle);
+      Handle = FileDescList[fd].Handle;
       if ((pFS->Filelength != NULL) && (Handle != 0))
       {
          Size = pFS->Filelength(Handle);
@@ -426,4 +449,33 @@ long _filelength (int fd)
    return(Size);
 } /* _filelength */
 
+/*************************************************************************/
+/*  _etag                                                                */
+/*                                                                       */
+/*  Return the entity tag of a file without opening it. The tag          */
+/*  changes with the content of the file.                                */
+/*                                                                       */
+/*  In    : name                                                         */
+/*  Out   : pEtag                                                        */
+/*  Return: 0 = OK / -1 = Error or not supported                         */
+/*************************************************************************/
+int _etag (const char *name, uint32_t *pEtag)
+{
+   int     Result = -1;
+   char  *pFilename;
+   FS_FS *pFS;
+
+   OS_RES_LOCK(&Sema);
+
+   pFS = FindFSByPath(name, &pFilename);
+   if ((pFS != NULL) && (pFS->Etag != NULL))
+   {
+      Result = pFS->Etag(pFilename, pEtag);
+   }
+
+   OS_RES_FREE(&Sema);
+
+   return(Result);
+} /* _etag */
+
 /*** EOF ***/
@@ -35,6 +35,8 @@
 *
 *  27.06.2015  mifi  First Version.
 *  13.03.2016  mifi  Renamed to web.h.
+*  16.10.2026  mifi  Added accept statistics.
+*  17.10.2026  mifi  Added the upload handle to web_upload_t.
 **************************************************************************/
 #if !defined(__IPWEB_H__)
 #define __IPWEB_H__
@@ -60,24 +62,31 @@
 *  Global Definitions
 **************************************************************************/
 
-#define WEB_UPLOAD_BUFFER_SIZE   (2*1024*1024)
-
 typedef struct _web_upload_
 {
    uint8_t   Error;
    
    char    *pFileName;
    long     lFileSize;
-   uint8_t *pBuffer;
    
-   long     lBufferSize;
    uint8_t  bBufferIndex;
    
    char    *pType;
    char    *pRedirOK;
    char    *pRedirERR;
+   
+   void    *pHandle;    /* Upload of this session, see fs_UploadStart */
 } web_upload_t;
 
+typedef struct _ipweb_accept_stats_
+{
+   uint32_t dAccepted;  /* Connections handed over to a client task */
+   uint32_t dQueued;    /* Connections which waited for a client task */
+   uint32_t dShed;      /* Connections answered with 503 */
+   uint32_t dQueueMax;  /* Maximum number of waiting connections */
+   uint32_t dTimedOut;  /* Connections aborted by a timeout */
+} ipweb_accept_stats_t;
+
 /**************************************************************************
 *  Macro Definitions
 **************************************************************************/
@@ -92,6 +101,7 @@ int IPWebsStart (uint16_t wPort);
 int IPWebsStartSsl (uint16_t wPort);
 
 int IPWebsIsRunnung (void);
+void IPWebsGetAcceptStats (ipweb_accept_stats_t *pStats);
 int IPWebsSslIsRunnung (void);
 
 #endif /* !__IPWEB_H__ */
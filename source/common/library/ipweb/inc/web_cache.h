@@ -0,0 +1,80 @@
+/**************************************************************************
+*  Copyright (c) 2026 by Michael Fischer (www.emb4fun.de).
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*  1. Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*
+*  2. Redistributions in binary form must reproduce the above copyright
+*     notice, this list of conditions and the following disclaimer in the
+*     documentation and/or other materials provided with the distribution.
+*
+*  3. Neither the name of the author nor the names of its contributors may
+*     be used to endorse or promote products derived from this software
+*     without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+*  THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+*  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+*  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+*  SUCH DAMAGE.
+*
+***************************************************************************
+*  History:
+*
+*  16.10.2026  mifi  First Version.
+*  17.10.2026  mifi  Added web_CacheInit.
+**************************************************************************/
+#if !defined(__WEB_CACHE_H__)
+#define __WEB_CACHE_H__
+
+/**************************************************************************
+*  Includes
+**************************************************************************/
+#include <stdint.h>
+#include "pro/uhttp/uhttpd.h"
+#include "pro/uhttp/mediatypes.h"
+
+/**************************************************************************
+*  Global Definitions
+**************************************************************************/
+
+typedef struct _web_cache_stats_
+{
+   uint32_t dEntries;
+   uint32_t dBytes;
+   uint32_t dHits;
+   uint32_t dMisses;
+   uint32_t dInserts;
+   uint32_t dEvicts;
+   uint32_t dFlushes;
+} web_cache_stats_t;
+
+/**************************************************************************
+*  Macro Definitions
+**************************************************************************/
+
+/**************************************************************************
+*  Functions Definitions
+**************************************************************************/
+
+void web_CacheInit (void);
+const MEDIA_TYPE_ENTRY *web_CacheSend (HTTPD_SESSION *hs);
+int  web_CacheAdd (HTTPD_SESSION *hs, const MEDIA_TYPE_ENTRY *mt, int fd, long lSize, const char *pEtag);
+void web_CacheFlush (void);
+void web_CacheGetStats (web_cache_stats_t *pStats);
+
+#endif /* !__WEB_CACHE_H__ */
+
+/*** EOF ***/
@@ -0,0 +1,105 @@
+/**************************************************************************
+*  Copyright (c) 2026 by Michael Fischer (www.emb4fun.de).
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without 
+*  modification, are permitted provided that the following conditions 
+*  are met:
+*  
+*  1. Redistributions of source code must retain the above copyright 
+*     notice, this list of conditions and the following disclaimer.
+*
+*  2. Redistributions in binary form must reproduce the above copyright
+*     notice, this list of conditions and the following disclaimer in the 
+*     documentation and/or other materials provided with the distribution.
+*
+*  3. Neither the name of the author nor the names of its contributors may 
+*     be used to endorse or promote products derived from this software 
+*     without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS 
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL 
+*  THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, 
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS 
+*  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF 
+*  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+*  SUCH DAMAGE.
+*
+***************************************************************************
+*  History:
+*
+*  16.10.2026  mifi  First Version.
+*  17.10.2026  mifi  Raw HiRes time and URL in the record.
+**************************************************************************/
+#if !defined(__WEB_LOG_H__)
+#define __WEB_LOG_H__
+
+/**************************************************************************
+*  Includes
+**************************************************************************/
+#include <stdint.h>
+#include "pro/uhttp/uhttpd.h"
+#include "pro/uhttp/mediatypes.h"
+
+/**************************************************************************
+*  Global Definitions
+**************************************************************************/
+
+/*
+ * Route families of the latency histograms
+ */
+#define WEB_LOG_STATIC     0
+#define WEB_LOG_CGI        1
+#define WEB_LOG_SSI        2
+#define WEB_LOG_OTHER      3
+#define WEB_LOG_FAMILY_MAX 4
+
+/*
+ * Number of histogram buckets. Bucket 0 counts 0us, bucket n
+ * counts 2^(n-1)..2^n-1 us, the last one all longer requests.
+ */
+#define WEB_LOG_BUCKETS    24
+
+/*
+ * Size of the URL in the record, longer URLs are cut
+ */
+#define WEB_LOG_URL_SIZE   24
+
+/*
+ * Access record, 48 bytes. The service time is kept like it was
+ * measured, the conversion to us and the URL hash are done when
+ * the record is output.
+ */
+typedef struct _web_log_rec_
+{
+   uint32_t dTime;      /* Start of the request, ms since boot */
+   uint32_t dClient;    /* IPv4 address of the client, network order */
+   uint32_t dBytes;     /* Bytes sent */
+   uint32_t dHiRes;     /* Service time, HiRes count difference */
+   uint32_t dMs;        /* Service time in ms */
+   uint16_t wStatus;    /* HTTP status code */
+   uint8_t  bMethod;    /* HTTP_METHOD_ */
+   uint8_t  bFamily;    /* WEB_LOG_ */
+   char     Url[WEB_LOG_URL_SIZE];
+} web_log_rec_t;
+
+/**************************************************************************
+*  Macro Definitions
+**************************************************************************/
+
+/**************************************************************************
+*  Functions Definitions
+**************************************************************************/
+
+void web_LogBegin (HTTPD_SESSION *hs);
+void web_LogEnd (HTTPD_SESSION *hs, const MEDIA_TYPE_ENTRY *mt);
+int  web_LogSendJson (HTTPD_SESSION *hs);
+
+#endif /* !__WEB_LOG_H__ */
+
+/*** EOF ***/
@@ -34,6 +34,8 @@
 *  History:
 *
 *  09.03.2019  mifi  First Version.
+*  16.10.2026  mifi  Added session list configuration.
+*  17.10.2026  mifi  Nonce is copied to a caller buffer.
 **************************************************************************/
 #if !defined(__WEB_SID_H__)
 #define __WEB_SID_H__
@@ -54,10 +56,34 @@
 #define _IP_WEB_SID_SUPPORT   IP_WEB_SID_SUPPORT
 #endif  
 
+/* Max number of sessions, the least recently used one will be evicted */
+#if !defined(IP_WEB_SID_LIST_CNT) 
+#define _IP_WEB_SID_LIST_CNT     8
+#else
+#define _IP_WEB_SID_LIST_CNT     IP_WEB_SID_LIST_CNT
+#endif  
+
+/* Idle timeout of a session */
+#if !defined(IP_WEB_SID_TIMEOUT_SEC) 
+#define _IP_WEB_SID_TIMEOUT_SEC  (1*60)
+#else
+#define _IP_WEB_SID_TIMEOUT_SEC  IP_WEB_SID_TIMEOUT_SEC
+#endif  
+
+/* Bind the session to the IP address of the client */
+#if !defined(IP_WEB_SID_BIND_IP) 
+#define _IP_WEB_SID_BIND_IP      1
+#else
+#define _IP_WEB_SID_BIND_IP      IP_WEB_SID_BIND_IP
+#endif  
+
 
 #define WEB_SID_HTTP    1
 #define WEB_SID_CGI     0
 
+/* Buffer size for WebSidCreateNonce, 16 hex digits and the terminator */
+#define WEB_SID_NONCE_SIZE    17
+
 /**************************************************************************
 *  Macro Definitions
 **************************************************************************/
@@ -69,13 +95,11 @@
 void     WebSidInit (void);
 char    *WebSidParseCookie (char *pCookie);
 char    *WebSidCreateCookie (HTTPD_SESSION *hs);
-char    *WebSidCreateNonce (HTTPD_SESSION *hs);
+int      WebSidCreateNonce (HTTPD_SESSION *hs, char *pNonce, int nSize);
 int      WebSidCheck (HTTPD_SESSION *hs, char *pSessionID, int nIsHttp);
 int      WebSidCheckAccessGranted (HTTPD_SESSION *hs, char *pSessionID, int nIsHttp);
 int      WebSidCheckUserPass (HTTPD_SESSION *hs, char *pUser, char *pPass);
 void     WebSidInvalidate (HTTPD_SESSION *hs);
-uint32_t WebSidGetPermission (int nSIDEntry);
-char    *WebSidGetUser (int nSIDEntry);
 int      WebSidSetNewPass (HTTPD_SESSION *hs, char *pOldPass, char *pNewPass);
 
 int      WebSidLoginBlocked (void);
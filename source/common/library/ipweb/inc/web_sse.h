@@ -0,0 +1,101 @@
+/**************************************************************************
+*  Copyright (c) 2026 by Michael Fischer (www.emb4fun.de).
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without 
+*  modification, are permitted provided that the following conditions 
+*  are met:
+*  
+*  1. Redistributions of source code must retain the above copyright 
+*     notice, this list of conditions and the following disclaimer.
+*
+*  2. Redistributions in binary form must reproduce the above copyright
+*     notice, this list of conditions and the following disclaimer in the 
+*     documentation and/or other materials provided with the distribution.
+*
+*  3. Neither the name of the author nor the names of its contributors may 
+*     be used to endorse or promote products derived from this software 
+*     without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS 
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL 
+*  THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, 
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS 
+*  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF 
+*  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+*  SUCH DAMAGE.
+*
+***************************************************************************
+*  History:
+*
+*  16.10.2026  mifi  First Version.
+*  17.10.2026  mifi  Each event has its own budget, truncation is reported.
+**************************************************************************/
+#if !defined(__WEB_SSE_H__)
+#define __WEB_SSE_H__
+
+/**************************************************************************
+*  Includes
+**************************************************************************/
+#include <stdint.h>
+#include "pro/uhttp/uhttpd.h"
+
+/**************************************************************************
+*  Global Definitions
+**************************************************************************/
+
+/*
+ * Frame buffer, filled by the sample function. While an event
+ * is open, the room for the "\n\n" which ends it and for its
+ * truncation text is reserved. bFull applies to the open event
+ * only, the next event gets the remaining room.
+ */
+typedef struct _web_sse_buf_
+{
+   char       *pData;
+   const char *pTrunc;     /* Text of the open event in case of truncation */
+   uint16_t    wSize;
+   uint16_t    wLen;
+   uint8_t     bFull;
+   uint8_t     bOpen;
+   uint8_t     bTrunc;     /* At least one event was truncated or skipped */
+} web_sse_buf_t;
+
+typedef void web_sse_sample_t (web_sse_buf_t *pBuf);
+
+typedef struct _web_sse_stats_
+{
+   uint32_t dSubscribers;  /* Actual number of subscribers */
+   uint32_t dSamples;      /* Frames created by the sample function */
+   uint32_t dSent;         /* Frames sent to the subscribers */
+   uint32_t dDropped;      /* Stale frames a slow subscriber has skipped */
+   uint32_t dSkipped;      /* Samples skipped, all frame buffers were busy */
+   uint32_t dTruncated;    /* Samples with an event which did not fit */
+   uint32_t dRejected;     /* Subscribers answered with 503 */
+} web_sse_stats_t;
+
+/**************************************************************************
+*  Macro Definitions
+**************************************************************************/
+
+/**************************************************************************
+*  Functions Definitions
+**************************************************************************/
+
+void web_SSEInit (web_sse_sample_t *pSample, uint32_t dIntervalMs);
+int  web_SSERun (HTTPD_SESSION *hs);
+void web_SSEGetStats (web_sse_stats_t *pStats);
+
+void web_SSEBufInit (web_sse_buf_t *pBuf, char *pData, uint16_t wSize);
+int  web_SSEPrintf (web_sse_buf_t *pBuf, const char *fmt, ...);
+void web_SSEEventBegin (web_sse_buf_t *pBuf, const char *pName, const char *pTrunc);
+void web_SSEEventEnd (web_sse_buf_t *pBuf);
+
+#endif /* !__WEB_SSE_H__ */
+
+/*** EOF ***/
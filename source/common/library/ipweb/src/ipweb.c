@@ -35,6 +35,16 @@
 *
 *  27.06.2015  mifi  First Version.
 *  13.03.2016  mifi  Renamed to web.c.
+*  16.10.2026  mifi  Added optional connection multiplexer.
+*  16.10.2026  mifi  Added admission control with accept queue and 503.
+*  16.10.2026  mifi  Added connection timeouts with a timer wheel.
+*  16.10.2026  mifi  Removed the WebClient timing code, see web_log.c.
+*  16.10.2026  mifi  Freeze the route table at start.
+*  17.10.2026  mifi  Wake the mux dispatcher by a loopback socket.
+*  17.10.2026  mifi  Lock the connection counters.
+*  17.10.2026  mifi  Initialize the file cache and the SSI templates.
+*  17.10.2026  mifi  The timer wheel is independent of the server mode.
+*  17.10.2026  mifi  Removed the mux receive timeout, reuse idle slots.
 **************************************************************************/
 #define __IPWEB_C__
 
@@ -47,9 +57,16 @@
 
 #include "tal.h"
 #include "ipstack.h"
+
+#include "lwip\api.h"
+#include "lwip\tcp.h"
+#include "lwip\tcpip.h"
+#include "lwip\priv\sockets_priv.h"
 #include "ipweb.h"
 #include "web_cgi.h"
 #include "web_sid.h"
+#include "web_cache.h"
+#include "pro/uhttp/routes.h"
 
 #if !defined(IP_WEB_MAX_HTTP_TASKS) 
 #define _MAX_WEB_CLIENT_TASKS   4
@@ -57,6 +74,64 @@
 #define _MAX_WEB_CLIENT_TASKS   IP_WEB_MAX_HTTP_TASKS
 #endif
 
+#if !defined(IP_WEB_MUX_SUPPORT)
+#define _IP_WEB_MUX_SUPPORT     0
+#else
+#define _IP_WEB_MUX_SUPPORT     IP_WEB_MUX_SUPPORT
+#endif
+
+#if !defined(IP_WEB_MUX_WORKERS)
+#define _MUX_WORKERS            4
+#else
+#define _MUX_WORKERS            IP_WEB_MUX_WORKERS
+#endif
+
+/* Connections which wait for a free client task */
+#if !defined(IP_WEB_ACCEPT_QUEUE_SIZE)
+#define _ACCEPT_QUEUE_SIZE      8
+#else
+#define _ACCEPT_QUEUE_SIZE      IP_WEB_ACCEPT_QUEUE_SIZE
+#endif
+
+/* A waiting connection is answered with 503 after this time */
+#if !defined(IP_WEB_ACCEPT_QUEUE_TIMEOUT_MS)
+#define _ACCEPT_QUEUE_TIMEOUT_MS 2000
+#else
+#define _ACCEPT_QUEUE_TIMEOUT_MS IP_WEB_ACCEPT_QUEUE_TIMEOUT_MS
+#endif
+
+#if !defined(IP_WEB_RETRY_AFTER_SEC)
+#define _RETRY_AFTER_SEC        1
+#else
+#define _RETRY_AFTER_SEC        IP_WEB_RETRY_AFTER_SEC
+#endif
+
+/* Connection timeouts, see S_TMO_HEADER, S_TMO_BODY and S_TMO_IDLE */
+#if !defined(IP_WEB_HEADER_TIMEOUT_MS)
+#define _HEADER_TIMEOUT_MS      10000
+#else
+#define _HEADER_TIMEOUT_MS      IP_WEB_HEADER_TIMEOUT_MS
+#endif
+
+#if !defined(IP_WEB_BODY_TIMEOUT_MS)
+#define _BODY_TIMEOUT_MS        30000
+#else
+#define _BODY_TIMEOUT_MS        IP_WEB_BODY_TIMEOUT_MS
+#endif
+
+#if !defined(IP_WEB_IDLE_TIMEOUT_MS)
+#define _IDLE_TIMEOUT_MS        15000
+#else
+#define _IDLE_TIMEOUT_MS        IP_WEB_IDLE_TIMEOUT_MS
+#endif
+
+/* The connections are limited by the number of lwIP sockets */
+#if !defined(IP_WEB_MUX_MAX_CONN)
+#define _MUX_MAX_CONN           MEMP_NUM_NETCONN
+#else
+#define _MUX_MAX_CONN           IP_WEB_MUX_MAX_CONN
+#endif
+
 /*=======================================================================*/
 /*  Global                                                               */
 /*=======================================================================*/
@@ -112,20 +187,84 @@ static MEDIA_TYPE_ENTRY mt_defaults[] = {
 #define ROMFS_HTTP_ROOT_PATH  "ROMFS:/htdocs/"
 
 
+#define _STR(_x)              #_x
+#define STR(_x)               _STR(_x)
+
+/*
+ * Response for a connection which can not be served, it is sent
+ * by the server task without a client task.
+ */
+static const char BusyResponse[] = 
+   "HTTP/1.1 503 Service Unavailable\r\n"
+   "Server: uHTTP 0.0\r\n"
+   "Retry-After: " STR(_RETRY_AFTER_SEC) "\r\n"
+   "Content-Length: 0\r\n"
+   "Connection: close\r\n"
+   "\r\n";
+
+
 typedef struct _CLIENT_THREAD_PARAM 
 {
    HTTP_STREAM        *ctp_stream;
    HTTP_CLIENT_HANDLER ctp_handler;
 } CLIENT_THREAD_PARAM;
 
+/*
+ * Timer wheel of the connection timeouts, a deadline is
+ * wRounds turns of the wheel plus the slot position.
+ */
+#define TMO_WHEEL_SLOTS       64
+#define TMO_TICK_MS           250
+
+typedef struct _tmo_conn_
+{
+   struct _tmo_conn_ *pNext;
+   struct _tmo_conn_ *pPrev;
+   HTTP_STREAM       *pStream;
+   uint16_t           wRounds;
+   uint8_t            bSlot;
+   uint8_t            bArmed;
+} tmo_conn_t;
+
 typedef struct _client_info_
 {
    OS_TCB               TCB;
    uint8_t             *Stack;
    uint16_t             StackSize;
    CLIENT_THREAD_PARAM *ctp;
+   tmo_conn_t           Tmo;
 } client_info_t;
 
+typedef struct _pending_conn_
+{
+   SOCKET               csock;
+   struct sockaddr_in   caddr;
+   uint32_t             dTime;
+} pending_conn_t;
+
+#if (_IP_WEB_MUX_SUPPORT >= 1)
+
+typedef int (*CLIENT_REQUEST_HANDLER) (HTTP_STREAM *);
+
+typedef enum _mux_state_
+{
+   MUX_CONN_FREE = 0,
+   MUX_CONN_IDLE,       /* Watched by the dispatcher */
+   MUX_CONN_QUEUED,     /* Waiting for a worker */
+   MUX_CONN_BUSY        /* A worker process a request */
+} mux_state_t;
+
+typedef struct _mux_conn_
+{
+   HTTP_STREAM            *pStream;
+   CLIENT_REQUEST_HANDLER  Handler;
+   volatile uint8_t        bState;
+   uint32_t                dIdleTime;  /* Start of the keep-alive wait */
+   tmo_conn_t              Tmo;
+} mux_conn_t;
+
+#endif /* (_IP_WEB_MUX_SUPPORT >= 1) */
+
 /*=======================================================================*/
 /*  Definition of all global Data                                        */
 /*=======================================================================*/
@@ -140,14 +279,34 @@ typedef struct _client_info_
 static OS_STACK (ServerStack, TASK_IP_WEB_SERVER_STK_SIZE); 
 static OS_TCB TCBServerTask;
 
+#if (_IP_WEB_MUX_SUPPORT == 0)
 static client_info_t       ClientArray[_MAX_WEB_CLIENT_TASKS];
 static uint64_t            ClientStack[_MAX_WEB_CLIENT_TASKS][TASK_IP_WEB_CLIENT_STK_SIZE/8];
+static pending_conn_t      PendingQueue[_ACCEPT_QUEUE_SIZE];
+static int                 nPendingHead  = 0;
+static int                 nPendingCount = 0;
+#else
+static OS_TCB              MuxTCB[_MUX_WORKERS];
+static uint64_t            MuxStack[_MUX_WORKERS][TASK_IP_WEB_CLIENT_STK_SIZE/8];
+static mux_conn_t          MuxConn[_MUX_MAX_CONN];
+static OS_MBOX             MuxMbox;
+static void               *MuxMboxBuffer[_MUX_MAX_CONN];
+static SOCKET              MuxWakeSock = INVALID_SOCKET;
+#endif
 
+static OS_SEMA             TmoSema;
+static tmo_conn_t         *TmoWheel[TMO_WHEEL_SLOTS];
+static uint8_t             bTmoPos = 0;
+static uint32_t            dTmoLastTick;
+
+static OS_SEMA   CountSema;
 static int       nNumThreads = 0;
 static int       nWebsInit    = 0;
 static int       nWebsRunning = 0;
 static uint16_t  wServerPort;
 
+static ipweb_accept_stats_t AcceptStats;
+
 int nNumThreadsMax = 0;
 
 /*=======================================================================*/
@@ -175,6 +334,258 @@ static void InitDefaults (void)
    
 } /* InitDefaults */
 
+/*************************************************************************/
+/*  SendBusy                                                             */
+/*                                                                       */
+/*  Answer a connection which can not be served with 503 and close it.   */
+/*                                                                       */
+/*  In    : csock                                                        */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void SendBusy (SOCKET csock)
+{
+   char Buffer[64];
+   
+   send(csock, BusyResponse, sizeof(BusyResponse) - 1, 0);
+   
+   /* 
+    * Read the request data which is already available, a close 
+    * with unread data would reset the connection.
+    */
+   while (recv(csock, Buffer, sizeof(Buffer), MSG_DONTWAIT) > 0)
+   {
+      /* Do nothing */
+   }
+   
+   closesocket(csock);
+   
+   AcceptStats.dShed++;
+   
+} /* SendBusy */
+
+/*************************************************************************/
+/*  CountOpen                                                            */
+/*                                                                       */
+/*  Count a new connection. The counters are changed by the server and   */
+/*  by the client tasks, therefore they are protected by CountSema.      */
+/*                                                                       */
+/*  In    : none                                                         */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void CountOpen (void)
+{
+   OS_RES_LOCK(&CountSema);
+   
+   nNumThreads++;
+   gWebIdleStartTime = 0;
+
+   if (nNumThreads > nNumThreadsMax)
+   {
+      nNumThreadsMax = nNumThreads;
+   }
+   
+   AcceptStats.dAccepted++;
+   
+   OS_RES_FREE(&CountSema);
+   
+} /* CountOpen */
+
+/*************************************************************************/
+/*  CountClose                                                           */
+/*                                                                       */
+/*  Count a closed connection, see CountOpen.                            */
+/*                                                                       */
+/*  In    : none                                                         */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void CountClose (void)
+{
+   OS_RES_LOCK(&CountSema);
+   
+   nNumThreads--;
+   
+   /* Handle web server idle */   
+   if (nNumThreads <= 0)
+   {
+      /* No more connections available, set time */
+      gWebIdleStartTime = OS_TimeGet();
+   }      
+   
+   OS_RES_FREE(&CountSema);
+   
+} /* CountClose */
+
+/*************************************************************************/
+/*  TmoUnlink                                                            */
+/*                                                                       */
+/*  Remove a connection from the timer wheel, TmoSema must be locked.    */
+/*                                                                       */
+/*  In    : pTmo                                                         */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void TmoUnlink (tmo_conn_t *pTmo)
+{
+   if (pTmo->bArmed)
+   {
+      if (pTmo->pPrev != NULL)
+      {
+         pTmo->pPrev->pNext = pTmo->pNext;
+      }
+      else
+      {
+         TmoWheel[pTmo->bSlot] = pTmo->pNext;
+      }
+      
+      if (pTmo->pNext != NULL)
+      {
+         pTmo->pNext->pPrev = pTmo->pPrev;
+      }
+      
+      pTmo->bArmed = 0;
+   }
+   
+} /* TmoUnlink */
+
+/*************************************************************************/
+/*  TmoHandler                                                           */
+/*                                                                       */
+/*  Stream timeout handler, (re)arm or stop the timeout of a connection. */
+/*                                                                       */
+/*  In    : sp, phase                                                    */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void TmoHandler (HTTP_STREAM *sp, int phase)
+{
+   tmo_conn_t *pTmo = (tmo_conn_t*)sp->strm_tmo_ctx;
+   uint32_t    dTicks;
+   
+   /* Only connections of this server are monitored */
+   if (NULL == pTmo)
+   {
+      return;
+   }
+   
+   switch (phase)
+   {
+      case S_TMO_IDLE:   dTicks = _IDLE_TIMEOUT_MS;   break;
+      case S_TMO_HEADER: dTicks = _HEADER_TIMEOUT_MS; break;
+      case S_TMO_BODY:   dTicks = _BODY_TIMEOUT_MS;   break;
+      default:           dTicks = 0;                  break;
+   }
+   
+   /* The current tick is already running, therefore one more */
+   if (dTicks != 0)
+   {
+      dTicks = (dTicks / TMO_TICK_MS) + 1;
+   }
+
+   OS_RES_LOCK(&TmoSema);
+   
+   TmoUnlink(pTmo);
+   
+   if (dTicks != 0)
+   {
+      pTmo->wRounds = (uint16_t)((dTicks - 1) / TMO_WHEEL_SLOTS);
+      pTmo->bSlot   = (uint8_t)((bTmoPos + dTicks) % TMO_WHEEL_SLOTS);
+      pTmo->bArmed  = 1;
+      
+      pTmo->pPrev = NULL;
+      pTmo->pNext = TmoWheel[pTmo->bSlot];
+      if (pTmo->pNext != NULL)
+      {
+         pTmo->pNext->pPrev = pTmo;
+      }
+      TmoWheel[pTmo->bSlot] = pTmo;
+   }
+   
+   OS_RES_FREE(&TmoSema);
+   
+} /* TmoHandler */
+
+/*************************************************************************/
+/*  TmoAbortConn                                                         */
+/*                                                                       */
+/*  Abort the TCP connection, runs in the context of the tcpip thread.   */
+/*  A task which is blocked in recv or send returns with an error, and   */
+/*  closes the socket and frees the stream as usual.                     */
+/*                                                                       */
+/*  In    : arg                                                          */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void TmoAbortConn (void *arg)
+{
+   struct netconn *conn = (struct netconn*)arg;
+   
+   if ((NETCONN_TCP == NETCONNTYPE_GROUP(netconn_type(conn))) && (conn->pcb.tcp != NULL))
+   {
+      tcp_abort(conn->pcb.tcp);
+   }
+   
+} /* TmoAbortConn */
+
+/*************************************************************************/
+/*  TmoAdvance                                                           */
+/*                                                                       */
+/*  Turn the timer wheel and abort the connections which are expired.   */
+/*                                                                       */
+/*  A connection is removed from the wheel before its socket will be     */
+/*  closed. Therefore the abort request, which is posted                 */
+/*  with locked TmoSema, is processed by the tcpip thread before the     */
+/*  netconn can be deleted.                                              */
+/*                                                                       */
+/*  In    : none                                                         */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void TmoAdvance (void)
+{
+   tmo_conn_t       *pTmo;
+   tmo_conn_t       *pNext;
+   struct lwip_sock *sock;
+   
+   while ((OS_TimeGet() - dTmoLastTick) >= OS_MS_2_TICKS(TMO_TICK_MS))
+   {
+      dTmoLastTick += OS_MS_2_TICKS(TMO_TICK_MS);
+      
+      OS_RES_LOCK(&TmoSema);
+      
+      bTmoPos = (bTmoPos + 1) % TMO_WHEEL_SLOTS;
+      
+      for (pTmo = TmoWheel[bTmoPos]; pTmo != NULL; pTmo = pNext)
+      {
+         pNext = pTmo->pNext;
+         
+         if (pTmo->wRounds != 0)
+         {
+            pTmo->wRounds--;
+         }
+         else
+         {
+            TmoUnlink(pTmo);
+            
+            sock = lwip_socket_dbg_get_socket(pTmo->pStream->strm_csock);
+            if ((sock != NULL) && (sock->conn != NULL))
+            {
+               tcpip_callback(TmoAbortConn, sock->conn);
+            }
+            
+            AcceptStats.dTimedOut++;
+         }
+      }
+      
+      OS_RES_FREE(&TmoSema);
+   }
+   
+} /* TmoAdvance */
+
+#if (_IP_WEB_MUX_SUPPORT == 0)
+
 /*************************************************************************/
 /*  FindFreeClient                                                       */
 /*                                                                       */
@@ -210,13 +621,11 @@ static void WebClient (void *p)
    client_info_t       *Client = (client_info_t*)p;
    CLIENT_THREAD_PARAM *ctp    = (CLIENT_THREAD_PARAM *)Client->ctp;
 
-#if 1
-   (*ctp->ctp_handler)(ctp->ctp_stream);
-#else   
-   uint32_t dStart = OS_TimeGet();
+   /* The requests are timed by the access log, see web_log.c */
    (*ctp->ctp_handler)(ctp->ctp_stream);
-   term_printf("%ld\r\n", OS_TimeGet() - dStart);
-#endif   
+   
+   /* Must be stopped before the socket will be closed, see TmoAdvance */
+   s_set_timeout(ctp->ctp_stream, S_TMO_NONE);
    
    closesocket(ctp->ctp_stream->strm_csock);
    xfree(ctp->ctp_stream);
@@ -237,16 +646,480 @@ static void WebClient (void *p)
 }   
 #endif
 
-   nNumThreads--;
+   CountClose();
    
-   /* Handle web server idle */   
-   if (nNumThreads <= 0)
+} /* WebClient */
+
+/*************************************************************************/
+/*  StartClient                                                          */
+/*                                                                       */
+/*  Create the client task for a connection.                             */
+/*                                                                       */
+/*  In    : Client, sock, pAddr, csock, pCAddr                           */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void StartClient (client_info_t *Client, SOCKET sock, struct sockaddr_in *pAddr,
+                         SOCKET csock, struct sockaddr_in *pCAddr)
+{
+   CLIENT_THREAD_PARAM *ctp;
+   HTTP_STREAM         *ctp_stream;
+#if (HTTP_KEEP_ALIVE_REQ >= 1)
+   unsigned int         optval;
+#endif   
+
+   //optval = 1000;
+   //setsockopt(csock, SOL_SOCKET, SO_RCVTIMEO, (char *)&optval, sizeof(optval));
+
+#if (HTTP_KEEP_ALIVE_REQ >= 1)
+   optval = 1;
+   setsockopt(csock, SOL_SOCKET, SO_KEEPALIVE, (char *)&optval, sizeof(optval));
+#endif                  
+
+   ctp        = xmalloc(XM_ID_WEB, sizeof(CLIENT_THREAD_PARAM));
+   ctp_stream = xcalloc(XM_ID_WEB, 1, sizeof(HTTP_STREAM));
+   
+   if ((ctp != NULL) && (ctp_stream != NULL))
    {
-      /* No more threads available, set time */
-      gWebIdleStartTime = OS_TimeGet();
-   }      
+      if (0 == gRedirectHTTPtoHTTPS)
+      {
+         ctp->ctp_handler = HttpdClientHandler;
+      }
+      else
+      {
+         ctp->ctp_handler = TlsRedirHandler;
+      }   
+      ctp->ctp_stream = ctp_stream;
+      ctp->ctp_stream->strm_ssock = sock;
+      ctp->ctp_stream->strm_csock = csock;
+      memcpy(&ctp->ctp_stream->strm_saddr, pAddr, sizeof(ctp->ctp_stream->strm_saddr));
+      memcpy(&ctp->ctp_stream->strm_caddr, pCAddr, sizeof(ctp->ctp_stream->strm_caddr));
+      
+      /* The request header is expected now */
+      Client->Tmo.pStream = ctp_stream;
+      ctp->ctp_stream->strm_tmo_ctx = &Client->Tmo;
+      s_set_timeout(ctp->ctp_stream, S_TMO_HEADER);
+
+      Client->ctp = ctp;
+      CountOpen();
+
+      OS_TaskCreate(&Client->TCB, WebClient, (void*)Client, (TASK_IP_WEB_SERVER_PRIORITY + 1),
+                    Client->Stack, Client->StackSize, 
+                    "WebClient");
+   }
+   else
+   {
+      /* Memory error */
+      if (ctp != NULL)        xfree(ctp);
+      if (ctp_stream != NULL) xfree(ctp_stream);
+      
+      SendBusy(csock);
+   }                     
    
-} /* WebClient */
+} /* StartClient */
+
+/*************************************************************************/
+/*  DispatchPending                                                      */
+/*                                                                       */
+/*  Start the waiting connections in order of arrival as long as client  */
+/*  tasks are free. Connections which waited too long get a 503.         */
+/*                                                                       */
+/*  In    : sock, pAddr                                                  */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void DispatchPending (SOCKET sock, struct sockaddr_in *pAddr)
+{
+   pending_conn_t *pConn;
+   client_info_t  *Client;
+   
+   while (nPendingCount != 0)
+   {
+      pConn = &PendingQueue[nPendingHead];
+      
+      if ((OS_TimeGet() - pConn->dTime) >= OS_MS_2_TICKS(_ACCEPT_QUEUE_TIMEOUT_MS))
+      {
+         SendBusy(pConn->csock);
+      }
+      else
+      {
+         Client = FindFreeClient();
+         if (NULL == Client)
+         {
+            break;
+         }
+         
+         StartClient(Client, sock, pAddr, pConn->csock, &pConn->caddr);
+      }
+      
+      nPendingHead = (nPendingHead + 1) % _ACCEPT_QUEUE_SIZE;
+      nPendingCount--;
+   }
+   
+} /* DispatchPending */
+
+#else
+
+/*************************************************************************/
+/*  MuxClose                                                             */
+/*                                                                       */
+/*  Close the connection and release the connection slot.                */
+/*                                                                       */
+/*  In    : pConn                                                        */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void MuxClose (mux_conn_t *pConn)
+{
+   /* Must be stopped before the socket will be closed, see TmoAdvance */
+   s_set_timeout(pConn->pStream, S_TMO_NONE);
+   
+   closesocket(pConn->pStream->strm_csock);
+   xfree(pConn->pStream);
+   
+   pConn->pStream = NULL;
+   pConn->bState  = MUX_CONN_FREE;
+
+   CountClose();
+   
+} /* MuxClose */
+
+/*************************************************************************/
+/*  MuxQueue                                                             */
+/*                                                                       */
+/*  Hand over a connection with pending data to the workers.             */
+/*                                                                       */
+/*  In    : pConn                                                        */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void MuxQueue (mux_conn_t *pConn)
+{
+   pConn->bState = MUX_CONN_QUEUED;
+   
+   /* 
+    * The mailbox can hold all connections, and a connection 
+    * is queued only once. Therefore the post can not fail.
+    */
+   OS_MboxPost(&MuxMbox, pConn);
+} /* MuxQueue */
+
+/*************************************************************************/
+/*  MuxFindSlot                                                          */
+/*                                                                       */
+/*  Return a free connection slot. If all are used, the connection which */
+/*  waits longest for the next keep-alive request is closed, a new       */
+/*  client is more important.                                            */
+/*                                                                       */
+/*  In    : none                                                         */
+/*  Out   : none                                                         */
+/*  Return: NULL = no slot / pConn                                       */
+/*************************************************************************/
+static mux_conn_t *MuxFindSlot (void)
+{
+   mux_conn_t *pIdle = NULL;
+   
+   for (int i=0; i<_MUX_MAX_CONN; i++)
+   {
+      if (MUX_CONN_FREE == MuxConn[i].bState)
+      {
+         return(&MuxConn[i]);
+      }
+      
+      if ((MUX_CONN_IDLE == MuxConn[i].bState) &&
+          ((NULL == pIdle) || ((int32_t)(MuxConn[i].dIdleTime - pIdle->dIdleTime) < 0)))
+      {
+         pIdle = &MuxConn[i];
+      }
+   }
+   
+   /* An idle connection is owned by the dispatcher, it can be closed here */
+   if (pIdle != NULL)
+   {
+      MuxClose(pIdle);
+      AcceptStats.dTimedOut++;
+   }
+   
+   return(pIdle);
+} /* MuxFindSlot */
+
+/*************************************************************************/
+/*  MuxAccept                                                            */
+/*                                                                       */
+/*  Accept a new connection and assign a connection slot.                */
+/*                                                                       */
+/*  In    : sock, pAddr                                                  */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void MuxAccept (SOCKET sock, struct sockaddr_in *pAddr)
+{
+   SOCKET               csock;
+   struct sockaddr_in   caddr;
+   socklen_t            len;
+   HTTP_STREAM         *pStream;
+   mux_conn_t          *pConn;
+#if (HTTP_KEEP_ALIVE_REQ >= 1)
+   unsigned int         optval;
+#endif   
+   
+   len = sizeof(caddr);
+   if ((csock = accept(sock, (struct sockaddr*)&caddr, &len)) == INVALID_SOCKET) /*lint !e740*/
+   {
+      return;  /* Error */
+   }
+   
+   pConn = MuxFindSlot();
+   
+   /* The stream buffers are the only memory needed by a connection */
+   pStream = (pConn != NULL) ? xcalloc(XM_ID_WEB, 1, sizeof(HTTP_STREAM)) : NULL;
+   if (NULL == pStream)
+   {
+      SendBusy(csock);
+      return;
+   }
+
+#if (HTTP_KEEP_ALIVE_REQ >= 1)
+   optval = 1;
+   setsockopt(csock, SOL_SOCKET, SO_KEEPALIVE, (char *)&optval, sizeof(optval));
+#endif                  
+
+   pStream->strm_ssock = sock;
+   pStream->strm_csock = csock;
+   memcpy(&pStream->strm_saddr, pAddr, sizeof(pStream->strm_saddr));
+   memcpy(&pStream->strm_caddr, &caddr, sizeof(pStream->strm_caddr));
+
+   if (0 == gRedirectHTTPtoHTTPS)
+   {
+      pConn->Handler = HttpdClientRequest;
+   }
+   else
+   {
+      pConn->Handler = TlsRedirRequest;
+   }   
+   pConn->pStream = pStream;
+   
+   /* The request header is expected now */
+   pConn->Tmo.pStream   = pStream;
+   pStream->strm_tmo_ctx = &pConn->Tmo;
+   s_set_timeout(pStream, S_TMO_HEADER);
+
+   CountOpen();
+   
+   /* The request will follow, do not wait for the next select */
+   MuxQueue(pConn);
+   
+} /* MuxAccept */
+
+/*************************************************************************/
+/*  MuxWakeCreate                                                        */
+/*                                                                       */
+/*  Create the wakeup socket of the dispatcher. This is a UDP socket     */
+/*  at the loopback interface which is connected to itself. A worker     */
+/*  send one byte to it when a connection is given back, therefore the   */
+/*  dispatcher does not wait for the next tick of the timer wheel.       */
+/*                                                                       */
+/*  In    : none                                                         */
+/*  Out   : none                                                         */
+/*  Return: 0 = OK / -1 Error                                            */
+/*************************************************************************/
+static int MuxWakeCreate (void)
+{
+   struct sockaddr_in   addr;
+   socklen_t            len;
+   
+   MuxWakeSock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+   if (INVALID_SOCKET == MuxWakeSock)
+   {
+      return(-1);
+   }
+   
+   /* Bind to an ephemeral port and use this address as destination */
+   memset((void*)&addr, 0, sizeof(addr));
+   addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+   addr.sin_port        = 0;
+   addr.sin_family      = AF_INET;
+   len                  = sizeof(addr);
+   
+   if ((bind(MuxWakeSock, (const struct sockaddr*)&addr, sizeof(addr)) != 0)     || /*lint !e740*/
+       (getsockname(MuxWakeSock, (struct sockaddr*)&addr, &len) != 0)            || /*lint !e740*/
+       (connect(MuxWakeSock, (const struct sockaddr*)&addr, sizeof(addr)) != 0))    /*lint !e740*/
+   {
+      closesocket(MuxWakeSock);
+      MuxWakeSock = INVALID_SOCKET;
+      return(-1);
+   }
+   
+   return(0);
+} /* MuxWakeCreate */
+
+/*************************************************************************/
+/*  MuxWake                                                              */
+/*                                                                       */
+/*  Wake up the dispatcher, see MuxWakeCreate.                           */
+/*                                                                       */
+/*  In    : none                                                         */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void MuxWake (void)
+{
+   uint8_t bWake = 0;
+   
+   /* 
+    * A lost datagram is not a problem as long as other ones are
+    * pending, the dispatcher checks all idle connections anyway.
+    */
+   send(MuxWakeSock, &bWake, sizeof(bWake), MSG_DONTWAIT);
+   
+} /* MuxWake */
+
+/*************************************************************************/
+/*  MuxWorker                                                            */
+/*                                                                       */
+/*  Process the requests of the connections which are ready.             */
+/*                                                                       */
+/*  In    : task parameter                                               */
+/*  Out   : none                                                         */
+/*  Return: never                                                        */
+/*************************************************************************/
+static void MuxWorker (void *p)
+{
+   mux_conn_t  *pConn;
+   HTTP_STREAM *pStream;
+   int          rc;
+   
+   (void)p;
+   
+   for (;;)
+   {
+      if (OS_RC_OK == OS_MboxWait(&MuxMbox, (void**)&pConn, OS_WAIT_INFINITE))
+      {
+         pConn->bState = MUX_CONN_BUSY;
+         pStream       = pConn->pStream;
+         
+         /* Pipelined requests are already in the input buffer */
+         do
+         {
+            rc = (*pConn->Handler)(pStream);
+         } while ((0 == rc) && (pStream->strm_ipos < pStream->strm_ilen));
+         
+         if (0 == rc)
+         {
+            /* Keep-alive, give the connection back to the dispatcher */
+            pConn->dIdleTime = OS_TimeGet();
+            pConn->bState    = MUX_CONN_IDLE;
+            MuxWake();
+         }
+         else
+         {
+            MuxClose(pConn);
+         }
+      }
+   }
+   
+} /* MuxWorker */
+
+/*************************************************************************/
+/*  MuxServer                                                            */
+/*                                                                       */
+/*  Dispatcher of the connection multiplexer. Only the listen socket,    */
+/*  the wakeup socket and the idle connections are watched by select.    */
+/*  A connection which becomes readable is handed over to one of the     */
+/*  workers. The timer wheel is turned here too, an expired connection   */
+/*  is aborted and becomes readable, the worker closes it.               */
+/*                                                                       */
+/*  In    : sock, pAddr                                                  */
+/*  Out   : none                                                         */
+/*  Return: never                                                        */
+/*************************************************************************/
+static void MuxServer (SOCKET sock, struct sockaddr_in *pAddr)
+{
+   fd_set         rset;
+   struct timeval tv;
+   int            nMaxFd;
+   SOCKET         csock;
+   uint8_t        Buffer[8];
+   
+   if (MuxWakeCreate() != 0)
+   {
+      return;  /* Error */
+   }
+   
+   memset(MuxConn, 0x00, sizeof(MuxConn));
+   OS_MboxCreate(&MuxMbox, MuxMboxBuffer, _MUX_MAX_CONN);
+   
+   for (int i=0; i<_MUX_WORKERS; i++)
+   {
+      OS_TaskCreate(&MuxTCB[i], MuxWorker, NULL, (TASK_IP_WEB_SERVER_PRIORITY + 1),
+                    (uint8_t*)&MuxStack[i][0], TASK_IP_WEB_CLIENT_STK_SIZE, 
+                    "WebWorker");
+   }
+
+   for (;;)
+   {
+      /* Abort expired connections */
+      TmoAdvance();
+      
+      FD_ZERO(&rset);
+      FD_SET(sock, &rset);
+      FD_SET(MuxWakeSock, &rset);
+      nMaxFd = (MuxWakeSock > sock) ? MuxWakeSock : sock;
+      
+      for (int i=0; i<_MUX_MAX_CONN; i++)
+      {
+         if (MUX_CONN_IDLE == MuxConn[i].bState)
+         {
+            csock = MuxConn[i].pStream->strm_csock;
+            FD_SET(csock, &rset);
+            if (csock > nMaxFd)
+            {
+               nMaxFd = csock;
+            }
+         }
+      }
+
+      /* 
+       * Wake up with the tick of the timer wheel, or earlier 
+       * if a worker gives back a connection.
+       */
+      tv.tv_sec  = 0;
+      tv.tv_usec = TMO_TICK_MS * 1000;
+      if (select(nMaxFd + 1, &rset, NULL, NULL, &tv) <= 0)
+      {
+         continue;   /* Timeout or error */
+      }
+      
+      if (FD_ISSET(MuxWakeSock, &rset))
+      {
+         while (recv(MuxWakeSock, Buffer, sizeof(Buffer), MSG_DONTWAIT) > 0)
+         {
+            /* Do nothing */
+         }
+      }
+      
+      /* 
+       * Check the idle connections first, the slot of a new 
+       * connection must not be tested with the old socket.
+       */
+      for (int i=0; i<_MUX_MAX_CONN; i++)
+      {
+         if ((MUX_CONN_IDLE == MuxConn[i].bState) &&
+             (FD_ISSET(MuxConn[i].pStream->strm_csock, &rset)))
+         {
+            MuxQueue(&MuxConn[i]);
+         }
+      }
+
+      if (FD_ISSET(sock, &rset))
+      {
+         MuxAccept(sock, pAddr);
+      }
+   }
+
+} /* MuxServer */
+
+#endif /* (_IP_WEB_MUX_SUPPORT == 0) */
 
 /*************************************************************************/
 /*  WebServer                                                            */
@@ -258,18 +1131,20 @@ static void WebClient (void *p)
 static void WebServer (void *p)
 {
    SOCKET               sock;
-   SOCKET               csock;
    struct sockaddr_in   addr;
+#if (_IP_WEB_MUX_SUPPORT == 0)
+   SOCKET               csock;
    struct sockaddr_in   caddr;
    socklen_t            len;
-   CLIENT_THREAD_PARAM *ctp;
-   HTTP_STREAM         *ctp_stream;
-   unsigned int         optval;
    client_info_t       *Client;
+   pending_conn_t      *pConn;
+   fd_set               rset;
+   struct timeval       tv;
+#endif   
    
    (void)p;
 
-   
+#if (_IP_WEB_MUX_SUPPORT == 0)   
    /* Setup client data */
    memset(ClientArray, 0x00, sizeof(ClientArray));
    for(int i=0; i<_MAX_WEB_CLIENT_TASKS; i++)
@@ -277,7 +1152,9 @@ static void WebServer (void *p)
       ClientArray[i].Stack     = (uint8_t*)&ClientStack[i][0];
       ClientArray[i].StackSize = TASK_IP_WEB_CLIENT_STK_SIZE;
    }
-   
+#endif   
+
+   dTmoLastTick = OS_TimeGet();
 
    /* Wait that the IP interface is ready for use */
    while(!IP_IF_IsReady(IFACE_ANY))
@@ -302,78 +1179,62 @@ static void WebServer (void *p)
       {
          if (listen(sock, _MAX_WEB_CLIENT_TASKS) == 0)
          {
+#if (_IP_WEB_MUX_SUPPORT >= 1)
+            MuxServer(sock, &addr);
+#else         
             for (;;) 
             {
+               /* Abort expired connections, and start the waiting ones */
+               TmoAdvance();
+               DispatchPending(sock, &addr);
+               
+               /* 
+                * Wait for a new connection. As long as connections are
+                * waiting, check for free client tasks every 10ms.
+                * Otherwise wake up with the tick of the timer wheel.
+                */
+               FD_ZERO(&rset);
+               FD_SET(sock, &rset);
+               tv.tv_sec  = 0;
+               tv.tv_usec = ((nPendingCount != 0) ? 10 : TMO_TICK_MS) * 1000;
+               if (select(sock + 1, &rset, NULL, NULL, &tv) <= 0)
+               {
+                  continue;   /* Timeout or error */
+               }
+            
                len = sizeof(caddr);
                if ((csock = accept(sock, (struct sockaddr*)&caddr, &len)) == INVALID_SOCKET) /*lint !e740*/
                {
                   continue;   /* Error */
                }
 
-               Client = FindFreeClient();
+               /* Waiting connections are served first */
+               Client = (0 == nPendingCount) ? FindFreeClient() : NULL;
                if (Client != NULL)
                {
-                  /* Create the Http client task */
-                                    
-                  //optval = 1000;
-                  //setsockopt(csock, SOL_SOCKET, SO_RCVTIMEO, (char *)&optval, sizeof(optval));
-
-#if (HTTP_KEEP_ALIVE_REQ >= 1)
-                  optval = 1;
-                  setsockopt(csock, SOL_SOCKET, SO_KEEPALIVE, (char *)&optval, sizeof(optval));
-#endif                  
-
-                  ctp        = xmalloc(XM_ID_WEB, sizeof(CLIENT_THREAD_PARAM));
-                  ctp_stream = xcalloc(XM_ID_WEB, 1, sizeof(HTTP_STREAM));
+                  StartClient(Client, sock, &addr, csock, &caddr);
+               }
+               else if (nPendingCount < _ACCEPT_QUEUE_SIZE)
+               {
+                  pConn = &PendingQueue[(nPendingHead + nPendingCount) % _ACCEPT_QUEUE_SIZE];
+                  pConn->csock = csock;
+                  pConn->dTime = OS_TimeGet();
+                  memcpy(&pConn->caddr, &caddr, sizeof(pConn->caddr));
+                  nPendingCount++;
                   
-                  if ((ctp != NULL) && (ctp_stream != NULL))
+                  AcceptStats.dQueued++;
+                  if ((uint32_t)nPendingCount > AcceptStats.dQueueMax)
                   {
-                     if (0 == gRedirectHTTPtoHTTPS)
-                     {
-                        ctp->ctp_handler = HttpdClientHandler;
-                     }
-                     else
-                     {
-                        ctp->ctp_handler = TlsRedirHandler;
-                     }   
-                     ctp->ctp_stream = ctp_stream;
-                     ctp->ctp_stream->strm_ssock = sock;
-                     ctp->ctp_stream->strm_csock = csock;
-                     memcpy(&ctp->ctp_stream->strm_saddr, &addr, sizeof(ctp->ctp_stream->strm_saddr));
-                     memcpy(&ctp->ctp_stream->strm_caddr, &caddr, sizeof(ctp->ctp_stream->strm_caddr));
-
-                     nNumThreads++;
-                     Client->ctp = ctp;
-                     gWebIdleStartTime = 0;
-
-                     if (nNumThreads > nNumThreadsMax)
-                     {
-                        nNumThreadsMax = nNumThreads;
-                     }
-
-                     OS_TaskCreate(&Client->TCB, WebClient, (void*)Client, (TASK_IP_WEB_SERVER_PRIORITY + 1),
-                                   Client->Stack, Client->StackSize, 
-                                   "WebClient");
-                               
-                     while (nNumThreads >= _MAX_WEB_CLIENT_TASKS)
-                     {
-                        OS_TimeDly(10);
-                     }
+                     AcceptStats.dQueueMax = (uint32_t)nPendingCount;
                   }
-                  else
-                  {
-                     /* Memory error */
-                     if (ctp != NULL)        xfree(ctp);
-                     if (ctp_stream != NULL) xfree(ctp_stream);
-                     
-                     closesocket(csock);
-                  }                     
                }
                else
                {
-                  closesocket(csock);
-               } /* end if (Client != NULL) */
+                  /* Saturated, answer without a client task */
+                  SendBusy(csock);
+               }
             }
+#endif /* (_IP_WEB_MUX_SUPPORT >= 1) */            
          } /* end if "listen" */
       } /* end if "bind" */
       
@@ -408,6 +1269,9 @@ int IPWebsInit (void)
        */
       StreamInit();
       StreamInitSsl(NULL, NULL);
+      OS_RES_CREATE(&CountSema);
+      OS_RES_CREATE(&TmoSema);
+      StreamInitTimeout(TmoHandler);
    
       /* 
        * Register media type defaults. These are configurable
@@ -420,6 +1284,8 @@ int IPWebsInit (void)
 
       web_CGIInit();
       web_SSIInit();
+      web_CacheInit();
+      HttpSsiInit();
    
       rc = 0;                   
    }
@@ -449,6 +1315,9 @@ int IPWebsStart (uint16_t wPort)
       
       web_CGIStart();
       web_SSIStart();
+      
+      /* All routes are registered now, use the hashed lookup */
+      HttpRoutesFreeze();
 
       /* Create the HTTP server tasks */
       OS_TaskCreate(&TCBServerTask, WebServer, NULL, TASK_IP_WEB_SERVER_PRIORITY,
@@ -474,4 +1343,18 @@ int IPWebsIsRunnung (void)
    return(nWebsRunning);
 } /* IPWebsIsRunnung */
 
+/*************************************************************************/
+/*  IPWebsGetAcceptStats                                                 */
+/*                                                                       */
+/*  Return the admission control counters of the web server.             */
+/*                                                                       */
+/*  In    : pStats                                                       */
+/*  Out   : pStats                                                       */
+/*  Return: none                                                         */
+/*************************************************************************/
+void IPWebsGetAcceptStats (ipweb_accept_stats_t *pStats)
+{
+   memcpy(pStats, &AcceptStats, sizeof(ipweb_accept_stats_t));
+} /* IPWebsGetAcceptStats */
+
 /*** EOF ***/
@@ -0,0 +1,573 @@
+/**************************************************************************
+*  Copyright (c) 2026 by Michael Fischer (www.emb4fun.de).
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*  1. Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*
+*  2. Redistributions in binary form must reproduce the above copyright
+*     notice, this list of conditions and the following disclaimer in the
+*     documentation and/or other materials provided with the distribution.
+*
+*  3. Neither the name of the author nor the names of its contributors may
+*     be used to endorse or promote products derived from this software
+*     without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+*  THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+*  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+*  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+*  SUCH DAMAGE.
+*
+***************************************************************************
+*  History:
+*
+*  16.10.2026  mifi  First Version.
+*  17.10.2026  mifi  Use the shared FNV-1a hash, see HttpHashStr.
+*  17.10.2026  mifi  Lock the list by CacheSema, not by interrupts.
+**************************************************************************/
+#define __WEB_CACHE_C__
+
+/*=======================================================================*/
+/*  Includes                                                             */
+/*=======================================================================*/
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "tcts.h"
+#include "tal.h"
+#include "fsapi.h"
+#include "ipweb.h"
+#include "web_cache.h"
+
+#include <cfg/http.h>
+#include <pro/uhttp/utils.h>
+
+/*=======================================================================*/
+/*  All Structures and Common Constants                                  */
+/*=======================================================================*/
+
+/* Size of all cached files together, 0 = cache not used */
+#if !defined(IP_WEB_CACHE_SIZE)
+#define _CACHE_SIZE           0
+#else
+#define _CACHE_SIZE           IP_WEB_CACHE_SIZE
+#endif
+
+/* Maximum number of cached files */
+#if !defined(IP_WEB_CACHE_ENTRIES)
+#define _CACHE_ENTRIES        16
+#else
+#define _CACHE_ENTRIES        IP_WEB_CACHE_ENTRIES
+#endif
+
+/* Larger files are not cached */
+#if !defined(IP_WEB_CACHE_FILE_MAX)
+#define _CACHE_FILE_MAX       16384
+#else
+#define _CACHE_FILE_MAX       IP_WEB_CACHE_FILE_MAX
+#endif
+
+/*
+ * A file is cached at the second miss, the URL hash of
+ * the first one is remembered in the ghost list.
+ */
+#define _CACHE_GHOSTS         (2 * _CACHE_ENTRIES)
+
+/*
+ * The Last-Modified header depends on the request,
+ * such a response is not cached.
+ */
+#if !defined(HTTPD_EXCLUDE_DATE)
+#undef  _CACHE_SIZE
+#define _CACHE_SIZE           0
+#endif
+
+typedef struct _cache_entry_
+{
+   uint32_t                dHash;
+   uint32_t                dHits;
+   uint32_t                dSize;      /* Size of the body */
+   uint16_t                wRefs;      /* Tasks which send the body */
+   uint8_t                 bGzip;
+   uint8_t                 bStale;     /* Removed, the last sender frees it */
+   const MEDIA_TYPE_ENTRY *mt;
+   char                    Etag[12];   /* Quoted entity tag, or empty */
+   char                   *pUrl;
+   uint8_t                *pData;
+} cache_entry_t;
+
+/*=======================================================================*/
+/*  Definition of all local Data                                         */
+/*=======================================================================*/
+
+#if (_CACHE_SIZE > 0)
+static cache_entry_t *CacheList[_CACHE_ENTRIES];
+static uint32_t       GhostList[_CACHE_GHOSTS];
+static uint8_t        bGhostPos = 0;
+#endif
+
+static OS_SEMA           CacheSema;
+static uint8_t           bCacheInit = 0;
+static web_cache_stats_t Stats;
+
+/*=======================================================================*/
+/*  Definition of all local Procedures                                   */
+/*=======================================================================*/
+
+#if (_CACHE_SIZE > 0)
+/*************************************************************************/
+/*  Find                                                                 */
+/*                                                                       */
+/*  Find the entry of an URL, CacheSema must be locked.                  */
+/*                                                                       */
+/*  In    : dHash, pUrl                                                  */
+/*  Out   : none                                                         */
+/*  Return: Index of the entry / -1 = not found                          */
+/*************************************************************************/
+static int Find (uint32_t dHash, const char *pUrl)
+{
+   int i;
+   
+   for (i = 0; i < _CACHE_ENTRIES; i++)
+   {
+      if ((CacheList[i] != NULL) && (CacheList[i]->dHash == dHash) &&
+          (0 == strcmp(CacheList[i]->pUrl, pUrl)))
+      {
+         return(i);
+      }
+   }
+   
+   return(-1);
+} /* Find */
+
+/*************************************************************************/
+/*  Remove                                                               */
+/*                                                                       */
+/*  Remove an entry from the list, CacheSema must be locked. An entry    */
+/*  which is in use is freed by the last sender.                         */
+/*                                                                       */
+/*  In    : nIndex                                                       */
+/*  Out   : none                                                         */
+/*  Return: Entry which must be freed, or NULL                           */
+/*************************************************************************/
+static cache_entry_t *Remove (int nIndex)
+{
+   cache_entry_t *pEntry = CacheList[nIndex];
+   
+   CacheList[nIndex] = NULL;
+   Stats.dEntries--;
+   Stats.dBytes -= pEntry->dSize;
+   
+   pEntry->bStale = 1;
+   
+   return((0 == pEntry->wRefs) ? pEntry : NULL);
+} /* Remove */
+
+/*************************************************************************/
+/*  Admit                                                                */
+/*                                                                       */
+/*  Check if an URL missed before, otherwise remember it. CacheSema      */
+/*  must be locked.                                                      */
+/*                                                                       */
+/*  In    : dHash                                                        */
+/*  Out   : none                                                         */
+/*  Return: 1 = cache the file / 0 = not yet                             */
+/*************************************************************************/
+static int Admit (uint32_t dHash)
+{
+   int i;
+   
+   for (i = 0; i < _CACHE_GHOSTS; i++)
+   {
+      if (GhostList[i] == dHash)
+      {
+         GhostList[i] = 0;
+         return(1);
+      }
+   }
+   
+   GhostList[bGhostPos] = dHash;
+   bGhostPos = (uint8_t)((bGhostPos + 1) % _CACHE_GHOSTS);
+   
+   return(0);
+} /* Admit */
+
+/*************************************************************************/
+/*  Insert                                                               */
+/*                                                                       */
+/*  Insert a new entry. The entries with the lowest hit count are        */
+/*  evicted until the entry fits, the hits of the others are halved.     */
+/*  CacheSema must be locked.                                            */
+/*                                                                       */
+/*  In    : pNew                                                         */
+/*  Out   : pFree, entries which must be freed                           */
+/*  Return: Number of entries in pFree                                   */
+/*************************************************************************/
+static int Insert (cache_entry_t *pNew, cache_entry_t **pFree)
+{
+   int            nFree = 0;
+   int            nSlot;
+   int            nVictim;
+   int            i;
+   cache_entry_t *pEntry;
+   
+   if (Find(pNew->dHash, pNew->pUrl) != -1)
+   {
+      /* Inserted by an other task in the meantime */
+      pNew->bStale = 1;
+      return(0);
+   }
+   
+   for (;;)
+   {
+      nSlot   = -1;
+      nVictim = -1;
+      for (i = 0; i < _CACHE_ENTRIES; i++)
+      {
+         if (NULL == CacheList[i])
+         {
+            nSlot = i;
+         }
+         else if ((-1 == nVictim) || (CacheList[i]->dHits < CacheList[nVictim]->dHits))
+         {
+            nVictim = i;
+         }
+      }
+      
+      if ((nSlot != -1) && ((Stats.dBytes + pNew->dSize) <= _CACHE_SIZE))
+      {
+         break;
+      }
+      
+      pEntry = Remove(nVictim);
+      if (pEntry != NULL)
+      {
+         pFree[nFree++] = pEntry;
+      }
+      Stats.dEvicts++;
+      
+      for (i = 0; i < _CACHE_ENTRIES; i++)
+      {
+         if (CacheList[i] != NULL)
+         {
+            CacheList[i]->dHits >>= 1;
+         }
+      }
+   }
+   
+   CacheList[nSlot] = pNew;
+   Stats.dEntries++;
+   Stats.dBytes += pNew->dSize;
+   Stats.dInserts++;
+   
+   return(nFree);
+} /* Insert */
+
+/*************************************************************************/
+/*  Release                                                              */
+/*                                                                       */
+/*  In    : pEntry                                                       */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void Release (cache_entry_t *pEntry)
+{
+   int nFree;
+   
+   OS_RES_LOCK(&CacheSema);
+   pEntry->wRefs--;
+   nFree = ((1 == pEntry->bStale) && (0 == pEntry->wRefs)) ? 1 : 0;
+   OS_RES_FREE(&CacheSema);
+   
+   if (1 == nFree)
+   {
+      xfree(pEntry);
+   }
+   
+} /* Release */
+
+/*************************************************************************/
+/*  Send                                                                 */
+/*                                                                       */
+/*  Send the response, the header like MediaTypeHandlerBinary and the    */
+/*  body directly from the entry.                                        */
+/*                                                                       */
+/*  In    : hs, pEntry                                                   */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void Send (HTTPD_SESSION *hs, cache_entry_t *pEntry)
+{
+   const MEDIA_TYPE_ENTRY *mt = pEntry->mt;
+   
+   HttpSendHeaderTop(hs, 200);
+   if (pEntry->Etag[0] != 0)
+   {
+      s_vputs(hs->s_stream, ct_ETag, ": ", pEntry->Etag, "\r\n", NULL);
+   }
+   s_vputs(hs->s_stream, ct_Accept_Ranges, ": bytes\r\n", NULL);
+   HttpSendHeaderBottom(hs, mt->media_type, mt->media_subtype ? mt->media_subtype : mt->media_ext, 
+                        (long)pEntry->dSize, pEntry->bGzip);
+   
+   s_send(hs->s_stream, pEntry->pData, pEntry->dSize);
+   s_flush(hs->s_stream);
+   
+} /* Send */
+#endif /* (_CACHE_SIZE > 0) */
+
+/*=======================================================================*/
+/*  All code exported                                                    */
+/*=======================================================================*/
+
+/*************************************************************************/
+/*  web_CacheInit                                                        */
+/*                                                                       */
+/*  In    : none                                                         */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+void web_CacheInit (void)
+{
+   if (0 == bCacheInit)
+   {
+      OS_RES_CREATE(&CacheSema);
+      bCacheInit = 1;
+   }
+   
+} /* web_CacheInit */
+
+/*************************************************************************/
+/*  web_CacheSend                                                        */
+/*                                                                       */
+/*  Send the response of a cached file. Conditional and range requests   */
+/*  are answered by the media type handler.                              */
+/*                                                                       */
+/*  In    : hs                                                           */
+/*  Out   : none                                                         */
+/*  Return: Media type of the file / NULL = not cached                   */
+/*************************************************************************/
+const MEDIA_TYPE_ENTRY *web_CacheSend (HTTPD_SESSION *hs)
+{
+#if (_CACHE_SIZE > 0)
+   HTTP_REQUEST           *req    = &hs->s_req;
+   cache_entry_t          *pEntry = NULL;
+   const MEDIA_TYPE_ENTRY *mt;
+   uint32_t                dHash;
+   int                     nIndex;
+   
+   if ((req->req_method != HTTP_METHOD_GET) || (req->req_inm != NULL) ||
+       (req->req_range != NULL) || (NULL == req->req_url))
+   {
+      return(NULL);
+   }
+   
+   dHash = HttpHashStr(HTTP_HASH_INIT, req->req_url, 0);
+   
+   OS_RES_LOCK(&CacheSema);
+   nIndex = Find(dHash, req->req_url);
+   if (nIndex != -1)
+   {
+      pEntry = CacheList[nIndex];
+      pEntry->wRefs++;
+      pEntry->dHits++;
+      Stats.dHits++;
+   }
+   OS_RES_FREE(&CacheSema);
+   
+   if (NULL == pEntry)
+   {
+      return(NULL);
+   }
+   
+   mt = pEntry->mt;
+   Send(hs, pEntry);
+   Release(pEntry);
+   
+   return(mt);
+#else
+   (void)hs;
+   
+   return(NULL);
+#endif
+} /* web_CacheSend */
+
+/*************************************************************************/
+/*  web_CacheAdd                                                         */
+/*                                                                       */
+/*  Called by the media type handler for a file which is not cached.     */
+/*  If the file should be cached, it is read completely and the          */
+/*  response is sent from the new entry. Otherwise the file position     */
+/*  is not changed and the handler must send the file.                   */
+/*                                                                       */
+/*  In    : hs, mt, fd, lSize, pEtag                                     */
+/*  Out   : none                                                         */
+/*  Return: 0 = response sent / -1 = not cached                          */
+/*************************************************************************/
+int web_CacheAdd (HTTPD_SESSION *hs, const MEDIA_TYPE_ENTRY *mt, int fd, long lSize, const char *pEtag)
+{
+#if (_CACHE_SIZE > 0)
+   HTTP_REQUEST  *req = &hs->s_req;
+   cache_entry_t *pEntry;
+   cache_entry_t *pFree[_CACHE_ENTRIES];
+   int            nFree = 0;
+   int            nAdmit;
+   uint32_t       dHash;
+   uint32_t       dRead;
+   size_t         UrlLen;
+   int            got;
+   
+   /*
+    * Only the plain GET of a static file is cached. A html file could
+    * be protected by the session ID, see HttpdClientRequest.
+    */
+   if ((req->req_method != HTTP_METHOD_GET) || (NULL == req->req_url) ||
+       (lSize <= 0) || (lSize > _CACHE_FILE_MAX) || (lSize > _CACHE_SIZE) ||
+       ((mt->media_subtype != NULL) && (0 == strcmp(mt->media_subtype, "html"))))
+   {
+      return(-1);
+   }
+   
+   dHash = HttpHashStr(HTTP_HASH_INIT, req->req_url, 0);
+   
+   OS_RES_LOCK(&CacheSema);
+   Stats.dMisses++;
+   nAdmit = Admit(dHash);
+   OS_RES_FREE(&CacheSema);
+   
+   if (0 == nAdmit)
+   {
+      return(-1);
+   }
+   
+   /* The entry, the URL and the data are one block */
+   UrlLen = strlen(req->req_url) + 1;
+   pEntry = xmalloc(XM_ID_WEB, sizeof(cache_entry_t) + UrlLen + (size_t)lSize);
+   if (NULL == pEntry)
+   {
+      return(-1);
+   }
+   memset(pEntry, 0x00, sizeof(cache_entry_t));
+   pEntry->pUrl  = (char*)&pEntry[1];
+   pEntry->pData = (uint8_t*)&pEntry->pUrl[UrlLen];
+   memcpy(pEntry->pUrl, req->req_url, UrlLen);
+   
+   for (dRead = 0; dRead < (uint32_t)lSize; dRead += (uint32_t)got)
+   {
+      got = _read(fd, &pEntry->pData[dRead], (size_t)lSize - dRead);
+      if (got <= 0)
+      {
+         _seek(fd, 0, SEEK_SET);
+         xfree(pEntry);
+         return(-1);
+      }
+   }
+   
+   pEntry->dHash = dHash;
+   pEntry->dSize = (uint32_t)lSize;
+   pEntry->wRefs = 1;
+   pEntry->mt    = mt;
+   pEntry->bGzip = ((lSize >= 2) && (0x1f == pEntry->pData[0]) && (0x8b == pEntry->pData[1])) ? 1 : 0;
+   if ((pEtag != NULL) && (strlen(pEtag) < sizeof(pEntry->Etag)))
+   {
+      strcpy(pEntry->Etag, pEtag);
+   }
+   
+   OS_RES_LOCK(&CacheSema);
+   nFree = Insert(pEntry, pFree);
+   OS_RES_FREE(&CacheSema);
+   
+   while (nFree > 0)
+   {
+      xfree(pFree[--nFree]);
+   }
+   
+   Send(hs, pEntry);
+   Release(pEntry);
+   
+   return(0);
+#else
+   (void)hs;
+   (void)mt;
+   (void)fd;
+   (void)lSize;
+   (void)pEtag;
+   
+   return(-1);
+#endif
+} /* web_CacheAdd */
+
+/*************************************************************************/
+/*  web_CacheFlush                                                       */
+/*                                                                       */
+/*  Remove all entries, must be called if the file system has changed.   */
+/*                                                                       */
+/*  In    : none                                                         */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+void web_CacheFlush (void)
+{
+#if (_CACHE_SIZE > 0)
+   cache_entry_t *pFree[_CACHE_ENTRIES];
+   cache_entry_t *pEntry;
+   int            nFree = 0;
+   int            i;
+   
+   /* Nothing is cached before web_CacheInit, e.g. at the first mount */
+   if (0 == bCacheInit)
+   {
+      return;
+   }
+   
+   OS_RES_LOCK(&CacheSema);
+   for (i = 0; i < _CACHE_ENTRIES; i++)
+   {
+      if (CacheList[i] != NULL)
+      {
+         pEntry = Remove(i);
+         if (pEntry != NULL)
+         {
+            pFree[nFree++] = pEntry;
+         }
+      }
+   }
+   memset(GhostList, 0x00, sizeof(GhostList));
+   Stats.dFlushes++;
+   OS_RES_FREE(&CacheSema);
+   
+   while (nFree > 0)
+   {
+      xfree(pFree[--nFree]);
+   }
+#endif
+} /* web_CacheFlush */
+
+/*************************************************************************/
+/*  web_CacheGetStats                                                    */
+/*                                                                       */
+/*  In    : pStats                                                       */
+/*  Out   : pStats                                                       */
+/*  Return: none                                                         */
+/*************************************************************************/
+void web_CacheGetStats (web_cache_stats_t *pStats)
+{
+   OS_RES_LOCK(&CacheSema);
+   *pStats = Stats;
+   OS_RES_FREE(&CacheSema);
+   
+} /* web_CacheGetStats */
+
+/*** EOF ***/
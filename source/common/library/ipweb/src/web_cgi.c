@@ -35,6 +35,15 @@
 *
 *  27.06.2015  mifi  First Version.
 *  13.03.2016  mifi  Renamed to web_cgi.c.
+*  16.10.2026  mifi  Stream the upload to the SD card.
+*  16.10.2026  mifi  StatStack does not flush every row.
+*  16.10.2026  mifi  Added status event stream.
+*  16.10.2026  mifi  Added JSON telemetry snapshot.
+*  16.10.2026  mifi  Added access log output.
+*  17.10.2026  mifi  The upload handle is kept by the session.
+*  17.10.2026  mifi  StatSample reports a truncated task list.
+*  17.10.2026  mifi  Adapted to the new WebSidCreateNonce.
+*  17.10.2026  mifi  stat_json.cgi outputs the web and netconn usage.
 **************************************************************************/
 #define __WEB_CGI_C__
 
@@ -53,11 +62,16 @@
 #include "ipweb.h"
 #include "web_sid.h"
 #include "mod_cgi.h"
+#include "web_sse.h"
+#include "web_log.h"
 #include "nvm.h"
 #include "fs.h"
 
 #include "terminal.h"
 
+#include "lwip\stats.h"
+#include "lwip\memp.h"
+
 #if !defined(IP_WEB_CGI_EXT_CST) 
 #define _IP_WEB_CGI_EXT_CST   0
 #else
@@ -136,6 +150,27 @@ void Time64Init (void);
 
 #define MAX_CGI_LIST_ENTRY    32
 
+/* Interval of the status event stream */
+#if !defined(IP_WEB_SSE_INTERVAL_MS)
+#define _SSE_INTERVAL_MS      2000
+#else
+#define _SSE_INTERVAL_MS      IP_WEB_SSE_INTERVAL_MS
+#endif
+
+/* Buffer of the JSON telemetry snapshot */
+#if !defined(IP_WEB_STAT_JSON_SIZE)
+#define _STAT_JSON_SIZE       4096
+#else
+#define _STAT_JSON_SIZE       IP_WEB_STAT_JSON_SIZE
+#endif
+
+typedef struct _stat_run_
+{
+   const char *pName;
+   uint8_t    *pStart;
+   uint8_t    *pEnd;
+} stat_run_t;
+
 
 /*=======================================================================*/
 /*  Definition of all global Data                                        */
@@ -147,7 +182,30 @@ void Time64Init (void);
 
 static CGI_LIST_ENTRY *ListTable[MAX_CGI_LIST_ENTRY];
 
-static uint8_t *UploadBuffer = NULL;
+static OS_SEMA         StatJsonSema;
+static char            StatJsonBuffer[_STAT_JSON_SIZE];
+
+/*
+ * Runtime stacks, used by StatRun and StatSample
+ */
+static const stat_run_t StatRunList[] =
+{
+#if defined(__ARM_ARCH_4T__) || defined(__ARM_ARCH_7A__)
+   { "User/System Stack", __stack_start__,     __stack_end__     },
+   { "IRQ Stack",         __stack_irq_start__, __stack_irq_end__ },
+   { "FIQ Stack",         __stack_fiq_start__, __stack_fiq_end__ },
+   { "Supervisior Stack", __stack_svc_start__, __stack_svc_end__ },
+   { "Abort Stack",       __stack_abt_start__, __stack_abt_end__ },
+   { "Undefined Stack",   __stack_und_start__, __stack_und_end__ },
+#endif
+
+#if defined(__ARM_ARCH_7EM__) || defined(__ARM_ARCH_7M__)
+   { "Main Stack",        __stack_start__,         __stack_end__         },
+   { "Process Stack",     __stack_process_start__, __stack_process_end__ },
+#endif
+
+   { NULL, NULL, NULL }
+};
 
 /*=======================================================================*/
 /*  Definition of all local Procedures                                   */
@@ -205,6 +263,8 @@ static int UploadFile (HTTPD_SESSION *hs, web_upload_t *Info)
    long avail;
    char *line;
    char *delim;
+   char *data_delim;
+   HTTP_BOUNDARY *bnd;
    const char *sub_ptr;
    int sub_len;
    int got = 0;
@@ -218,10 +278,30 @@ static int UploadFile (HTTPD_SESSION *hs, web_upload_t *Info)
       return(-1);
    }
 
+   /* The CRLF in front of the boundary does not belong to the data. */
+   data_delim = xmalloc(XM_ID_WEB, strlen(delim) + 3);
+   if (data_delim == NULL) {
+      xfree(delim);
+      return(-1);
+   }
+   data_delim[0] = '\r';
+   data_delim[1] = '\n';
+   strcpy(&data_delim[2], delim);
+
+   bnd = xmalloc(XM_ID_WEB, sizeof(HTTP_BOUNDARY));
+   if ((bnd == NULL) || StreamBoundaryInit(bnd, data_delim)) {
+      xfree(bnd);
+      xfree(data_delim);
+      xfree(delim);
+      return(-1);
+   }
+
    avail = req->req_length;
    line = xmalloc(XM_ID_WEB, (size_t)(MIN(avail, MAX_UPSIZE) + 1));
    if (line == NULL) {
       /* No memory. */
+      xfree(bnd);
+      xfree(data_delim);
       xfree(delim);
       return(-1);
    }
@@ -240,7 +320,7 @@ static int UploadFile (HTTPD_SESSION *hs, web_upload_t *Info)
          if (sub_ptr) {
             /* The item named 'image' contains the binary data of the file. */
             if (strncasecmp(sub_ptr, "image", (size_t)sub_len) == 0) {
-               int eol = 0;
+               int rc;
 
                /* Get the upload file name. */
                sub_ptr = HttpArgValueSub(req->req_bnd_dispo, "filename", &sub_len);
@@ -250,58 +330,51 @@ static int UploadFile (HTTPD_SESSION *hs, web_upload_t *Info)
                      memcpy(upname, sub_ptr, (size_t)sub_len);
                      upname[sub_len] = 0;
                            
+                     xfree(Info->pFileName);
                      Info->pFileName = xstrdup(XM_ID_WEB, upname);
                      xfree(upname);    
                   }
                }
                
-               /* Recieve the binary data. */
+               /* 
+                * The file can not be larger than the rest of the
+                * request, use it for the preallocation.
+                */
+               if (Info->pHandle != NULL) {
+                  /* Only one image per request. */
+                  Info->Error = 1;
+               } else {
+                  rc = fs_UploadStart((uint32_t)avail, &Info->pHandle);
+                  if (rc != 0) {
+                     Info->Error = (uint8_t)rc;
+                  }
+               }
+               
+               /* Recieve the binary data and write it in chunks. */
                filesize = 0;
                while (avail) {
                   /* Read until the next boundary line. */
-                  got = StreamReadUntilString(stream, delim, line, MIN(avail, MAX_UPSIZE));
+                  got = StreamReadUntilBoundary(stream, bnd, line, MIN(avail, MAX_UPSIZE));
                   if (got <= 0) {
                      break;
                   }
-                  avail -= got;
+                  avail    -= got;
+                  filesize += got;
                   
-                  /* Write data to the local file, if one had been opened. */
-                  //term_printf(".");
-                  if (eol) {
-                     //term_printf("eol");
-                     if ((filesize + 2) < Info->lBufferSize)
-                     {
-                       Info->pBuffer[filesize++] = '\r';
-                       Info->pBuffer[filesize++] = '\n';
+                  /* On error the data is read, but ignored. */
+                  if (0 == Info->Error) {
+                     rc = fs_UploadWrite(Info->pHandle, (uint8_t*)line, (uint32_t)got);
+                     if (rc != 0) {
+                        Info->Error = (uint8_t)rc;
                      }
-                     else
-                     {
-                       Info->Error = 1;
-                     }  
-                  }
-                  eol = 0;
-                  if (got >= 2 && line[got - 2] == '\r' && line[got - 1] == '\n') {
-                     eol = 1;
-                     got -= 2;
-                  }
-                       
-                  /* Write data is memory is available */
-                  if ((filesize + got) < Info->lBufferSize)
-                  {
-                     memcpy(&Info->pBuffer[filesize], line, (size_t)got);
                   }
-                  else
-                  {
-                     Info->Error = 1;
-                  }
-                  filesize += got;
                }
-               //term_printf("\r\n");
                    
                Info->lFileSize = filesize;
                    
                if (got < 0) {
                   /* Broken connection. */
+                  Info->Error = 1;
                   break;
                }
             }
@@ -342,6 +415,8 @@ static int UploadFile (HTTPD_SESSION *hs, web_upload_t *Info)
       Info->Error = 5;
    }
    
+   xfree(bnd);
+   xfree(data_delim);
    xfree(delim);
    xfree(line);
    
@@ -421,7 +496,7 @@ static int Login (HTTPD_SESSION *hs)
          /* Not valid */
          
          /* A new NONCE must be created for a new login */
-         WebSidCreateNonce(hs);  
+         WebSidCreateNonce(hs, NULL, 0);  
          
          HttpSendRedirection(hs, 303, "/login.htm?err=1", NULL);      
       }
@@ -433,7 +508,7 @@ static int Login (HTTPD_SESSION *hs)
    else
    {
       /* A new NONCE must be created for a new login */
-      WebSidCreateNonce(hs);  
+      WebSidCreateNonce(hs, NULL, 0);  
    
       HttpSendRedirection(hs, 303, "/login.htm?err=1", NULL);      
    }   
@@ -1169,8 +1244,6 @@ static int StatStack (HTTPD_SESSION *hs)
       /* row end */ 
       s_printf(hs->s_stream, "</td>");
       
-      s_flush(hs->s_stream);
-      
       wDimCnt++;
       pTCB = pTCB->pTaskNext;
    }   
@@ -1189,114 +1262,37 @@ static int StatStack (HTTPD_SESSION *hs)
 /*************************************************************************/
 static int StatRun (HTTPD_SESSION *hs)
 {
-   uint32_t dSize;
-   uint32_t dFree;
+   const stat_run_t *pRun = StatRunList;
+   uint32_t          dSize;
+   uint32_t          dFree;
+   uint16_t          wDimCnt = 0;   
    
    web_SendCGIHeader(hs);
 
-#if defined(__ARM_ARCH_4T__) || defined(__ARM_ARCH_7A__)
-
-   /* User/System Stack */
-   dSize = (uint32_t)(__stack_end__ - __stack_start__);
-   dFree = GetStackFreeCount(__stack_start__, __stack_end__);
-   s_printf(hs->s_stream, "<tr>\r\n");
-   s_printf(hs->s_stream, "  <td>&nbsp;</td>\r\n");
-   s_printf(hs->s_stream, "  <td>User/System Stack</td>\r\n");
-   s_printf(hs->s_stream, "  <td>%4d</td>\r\n", dSize);
-   s_printf(hs->s_stream, "  <td>%4d</td>\r\n", (dSize - dFree));
-   s_printf(hs->s_stream, "  <td>%4d</td>\r\n", dFree);
-   s_printf(hs->s_stream, "  <td>&nbsp;</td>\r\n");
-   s_printf(hs->s_stream, "</tr>\r\n");
-   
-   /* IRQ Stack */
-   dSize = (uint32_t)(__stack_irq_end__ - __stack_irq_start__);
-   dFree = GetStackFreeCount(__stack_irq_start__, __stack_irq_end__);
-   s_printf(hs->s_stream, "<tr class=\"dim\">\r\n");
-   s_printf(hs->s_stream, "  <td>&nbsp;</td>\r\n");
-   s_printf(hs->s_stream, "  <td>IRQ Stack</td>\r\n");
-   s_printf(hs->s_stream, "  <td>%4d</td>\r\n", dSize);
-   s_printf(hs->s_stream, "  <td>%4d</td>\r\n", (dSize - dFree));
-   s_printf(hs->s_stream, "  <td>%4d</td>\r\n", dFree);
-   s_printf(hs->s_stream, "  <td>&nbsp;</td>\r\n");
-   s_printf(hs->s_stream, "</tr>\r\n");
-
-   /* FIQ Stack */
-   dSize = (uint32_t)(__stack_fiq_end__ - __stack_fiq_start__);
-   dFree = GetStackFreeCount(__stack_fiq_start__, __stack_fiq_end__);
-   s_printf(hs->s_stream, "<tr>\r\n");
-   s_printf(hs->s_stream, "  <td>&nbsp;</td>\r\n");
-   s_printf(hs->s_stream, "  <td>FIQ Stack</td>\r\n");
-   s_printf(hs->s_stream, "  <td>%4d</td>\r\n", dSize);
-   s_printf(hs->s_stream, "  <td>%4d</td>\r\n", (dSize - dFree));
-   s_printf(hs->s_stream, "  <td>%4d</td>\r\n", dFree);
-   s_printf(hs->s_stream, "  <td>&nbsp;</td>\r\n");
-   s_printf(hs->s_stream, "</tr>\r\n");
-
-   /* Supervisior Stack */
-   dSize = (uint32_t)(__stack_svc_end__ - __stack_svc_start__);
-   dFree = GetStackFreeCount(__stack_svc_start__, __stack_svc_end__);
-   s_printf(hs->s_stream, "<tr class=\"dim\">\r\n");
-   s_printf(hs->s_stream, "  <td>&nbsp;</td>\r\n");
-   s_printf(hs->s_stream, "  <td>Supervisior Stack</td>\r\n");
-   s_printf(hs->s_stream, "  <td>%4d</td>\r\n", dSize);
-   s_printf(hs->s_stream, "  <td>%4d</td>\r\n", (dSize - dFree));
-   s_printf(hs->s_stream, "  <td>%4d</td>\r\n", dFree);
-   s_printf(hs->s_stream, "  <td>&nbsp;</td>\r\n");
-   s_printf(hs->s_stream, "</tr>\r\n");
-
-   /* Abort Stack */
-   dSize = (uint32_t)(__stack_abt_end__ - __stack_abt_start__);
-   dFree = GetStackFreeCount(__stack_abt_start__, __stack_abt_end__);
-   s_printf(hs->s_stream, "<tr>\r\n");
-   s_printf(hs->s_stream, "  <td>&nbsp;</td>\r\n");
-   s_printf(hs->s_stream, "  <td>Abort Stack</td>\r\n");
-   s_printf(hs->s_stream, "  <td>%4d</td>\r\n", dSize);
-   s_printf(hs->s_stream, "  <td>%4d</td>\r\n", (dSize - dFree));
-   s_printf(hs->s_stream, "  <td>%4d</td>\r\n", dFree);
-   s_printf(hs->s_stream, "  <td>&nbsp;</td>\r\n");
-   s_printf(hs->s_stream, "</tr>\r\n");
-
-   /* Undefined Stack */
-   dSize = (uint32_t)(__stack_und_end__ - __stack_und_start__);
-   dFree = GetStackFreeCount(__stack_und_start__, __stack_und_end__);
-   s_printf(hs->s_stream, "<tr class=\"dim\">\r\n");
-   s_printf(hs->s_stream, "  <td>&nbsp;</td>\r\n");
-   s_printf(hs->s_stream, "  <td>Undefined Stack</td>\r\n");
-   s_printf(hs->s_stream, "  <td>%4d</td>\r\n", dSize);
-   s_printf(hs->s_stream, "  <td>%4d</td>\r\n", (dSize - dFree));
-   s_printf(hs->s_stream, "  <td>%4d</td>\r\n", dFree);
-   s_printf(hs->s_stream, "  <td>&nbsp;</td>\r\n");
-   s_printf(hs->s_stream, "</tr>\r\n");
-   
-#endif /* defined(__ARM_ARCH_4T__) || defined(__ARM_ARCH_7A__) */
-
-#if defined(__ARM_ARCH_7EM__) || defined(__ARM_ARCH_7M__)
-
-   /* Main Stack */
-   dSize = (uint32_t)(__stack_end__ - __stack_start__);
-   dFree = GetStackFreeCount(__stack_start__, __stack_end__);
-   s_printf(hs->s_stream, "<tr>\r\n");
-   s_printf(hs->s_stream, "  <td>&nbsp;</td>\r\n");
-   s_printf(hs->s_stream, "  <td>Main Stack</td>\r\n");
-   s_printf(hs->s_stream, "  <td>%4d</td>\r\n", dSize);
-   s_printf(hs->s_stream, "  <td>%4d</td>\r\n", (dSize - dFree));
-   s_printf(hs->s_stream, "  <td>%4d</td>\r\n", dFree);
-   s_printf(hs->s_stream, "  <td>&nbsp;</td>\r\n");
-   s_printf(hs->s_stream, "</tr>\r\n");
-   
-   /* Process Stack */
-   dSize = (uint32_t)(__stack_process_end__ - __stack_process_start__);
-   dFree = GetStackFreeCount(__stack_process_start__, __stack_process_end__);
-   s_printf(hs->s_stream, "<tr class=\"dim\">\r\n");
-   s_printf(hs->s_stream, "  <td>&nbsp;</td>\r\n");
-   s_printf(hs->s_stream, "  <td>Process Stack</td>\r\n");
-   s_printf(hs->s_stream, "  <td>%4d</td>\r\n", dSize);
-   s_printf(hs->s_stream, "  <td>%4d</td>\r\n", (dSize - dFree));
-   s_printf(hs->s_stream, "  <td>%4d</td>\r\n", dFree);
-   s_printf(hs->s_stream, "  <td>&nbsp;</td>\r\n");
-   s_printf(hs->s_stream, "</tr>\r\n");
-
-#endif /* defined(__ARM_ARCH_7EM__) || defined(__ARM_ARCH_7M__) */
+   while (pRun->pName != NULL)
+   {
+      dSize = (uint32_t)(pRun->pEnd - pRun->pStart);
+      dFree = GetStackFreeCount(pRun->pStart, pRun->pEnd);
+      
+      if (0 == (wDimCnt & 0x01))
+      { 
+         s_printf(hs->s_stream, "<tr>\r\n");
+      }
+      else
+      {
+         s_printf(hs->s_stream, "<tr class=\"dim\">\r\n");
+      }   
+      s_printf(hs->s_stream, "  <td>&nbsp;</td>\r\n");
+      s_printf(hs->s_stream, "  <td>%s</td>\r\n", pRun->pName);
+      s_printf(hs->s_stream, "  <td>%4d</td>\r\n", dSize);
+      s_printf(hs->s_stream, "  <td>%4d</td>\r\n", (dSize - dFree));
+      s_printf(hs->s_stream, "  <td>%4d</td>\r\n", dFree);
+      s_printf(hs->s_stream, "  <td>&nbsp;</td>\r\n");
+      s_printf(hs->s_stream, "</tr>\r\n");
+      
+      wDimCnt++;
+      pRun++;
+   }
    
    return(0);
 } /* StatRun */
@@ -1383,6 +1379,318 @@ static int CPULoad (HTTPD_SESSION *hs)
    return(0);
 } /* CPULoad */
 
+#if LWIP_STATS
+/*************************************************************************/
+/*  StatJsonProto                                                        */
+/*                                                                       */
+/*  In    : pBuf, pName, pProto                                          */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void StatJsonProto (web_sse_buf_t *pBuf, const char *pName, struct stats_proto *pProto)
+{
+   web_SSEPrintf(pBuf, "\"%s\":{\"xmit\":%u,\"recv\":%u,\"drop\":%u,\"chkerr\":%u,\"lenerr\":%u,\"memerr\":%u,\"rterr\":%u,\"proterr\":%u,\"err\":%u},",
+                 pName, (unsigned)pProto->xmit, (unsigned)pProto->recv, (unsigned)pProto->drop,
+                 (unsigned)pProto->chkerr, (unsigned)pProto->lenerr, (unsigned)pProto->memerr,
+                 (unsigned)pProto->rterr, (unsigned)pProto->proterr, (unsigned)pProto->err);
+                 
+} /* StatJsonProto */
+#endif /* LWIP_STATS */
+
+/*************************************************************************/
+/*  StatJson                                                             */
+/*                                                                       */
+/*  Output CPU load, task and runtime stacks, memory pools, web server   */
+/*  and lwIP counters and uptime as one JSON document. It is created in  */
+/*  a static buffer and sent with a Content-Length.                      */
+/*                                                                       */
+/*  With stat_json.cgi?reset=1 the peak values of the memory pools and   */
+/*  lwIP are cleared after the output, e.g. to get the peaks of each run */
+/*  of a load test.                                                      */
+/*                                                                       */
+/*  In    : hs                                                           */
+/*  Out   : none                                                         */
+/*  Return: 0 = OK / -1 = ERROR                                          */
+/*************************************************************************/
+static int StatJson (HTTPD_SESSION *hs)
+{
+   web_sse_buf_t        Buf;
+   ipweb_accept_stats_t Accept;
+   const stat_run_t    *pRun;
+   OS_TCB              *pTCB;
+   char                *pName;
+   char                *pArg;
+   int                  nReset = 0;
+   uint8_t             *pStart;
+   uint8_t             *pEnd;
+   uint32_t             dSize;
+   uint32_t             dUsed;
+   uint32_t             dFree;
+   uint32_t             dPeak;
+   uint16_t             wNext;
+   uint16_t             wIndex;
+   int                  nFirst;
+#if LWIP_STATS && MEMP_STATS
+   int                  nPool;
+#endif
+   
+   for (pArg = HttpArgParseFirst(&hs->s_req); pArg != NULL; pArg = HttpArgParseNext(&hs->s_req))
+   {
+      if (0 == strcmp(pArg, "reset"))
+      {
+         nReset = 1;
+      }
+   }
+   
+   OS_RES_LOCK(&StatJsonSema);
+   
+   web_SSEBufInit(&Buf, StatJsonBuffer, sizeof(StatJsonBuffer));
+   
+   web_SSEPrintf(&Buf, "{\"uptime\":%d,\"cpuload\":%d,", OS_TimeGetSeconds(), OS_StatGetCPULoad());
+
+   /* Tasks */
+   web_SSEPrintf(&Buf, "\"tasks\":[");
+   nFirst = 1;
+   pTCB   = OS_TaskGetList(); 
+   while (pTCB != NULL)
+   {
+      pStart = pTCB->pStackStart;
+      pEnd   = (uint8_t*)pStart + pTCB->wStackSize;
+      dSize  = (uint32_t)pEnd - (uint32_t)pStart;
+      dFree  = GetStackFreeCount(pStart, pEnd);
+      
+      web_SSEPrintf(&Buf, "%s{\"name\":\"%s\",\"prio\":%d,\"size\":%d,\"used\":%d,\"free\":%d,\"cpu\":%d.%02d}",
+                    (nFirst) ? "" : ",", pTCB->Name, pTCB->nPrio, dSize, (dSize - dFree), dFree,
+                    (uint16_t)(pTCB->dStatUsage / 100), (uint16_t)(pTCB->dStatUsage % 100));
+      
+      nFirst = 0;
+      pTCB   = pTCB->pTaskNext;
+   }
+   web_SSEPrintf(&Buf, "],");
+   
+   /* Runtime stacks */
+   web_SSEPrintf(&Buf, "\"stacks\":[");
+   for (pRun = StatRunList; pRun->pName != NULL; pRun++)
+   {
+      dSize = (uint32_t)(pRun->pEnd - pRun->pStart);
+      dFree = GetStackFreeCount(pRun->pStart, pRun->pEnd);
+      
+      web_SSEPrintf(&Buf, "%s{\"name\":\"%s\",\"size\":%d,\"used\":%d,\"free\":%d}",
+                    (pRun == StatRunList) ? "" : ",", pRun->pName, dSize, (dSize - dFree), dFree);
+   }
+   web_SSEPrintf(&Buf, "],");
+   
+   /* Memory pools */
+   web_SSEPrintf(&Buf, "\"mem\":[");
+   nFirst = 1;
+   wIndex = 0;
+   pName  = tal_MEMInfoGet(wIndex, &dSize, &dUsed, &dFree, &dPeak, &wNext);
+   while (wNext != 0)
+   {
+      if (pName != NULL)
+      {
+         web_SSEPrintf(&Buf, "%s{\"name\":\"%s\",\"size\":%d,\"used\":%d,\"free\":%d,\"peak\":%d}",
+                       (nFirst) ? "" : ",", pName, dSize, dUsed, dFree, dPeak);
+         nFirst = 0;
+      }
+      
+      wIndex++;
+      pName = tal_MEMInfoGet(wIndex, &dSize, &dUsed, &dFree, &dPeak, &wNext);
+   }
+   web_SSEPrintf(&Buf, "],");
+   
+   /* Web server connections */
+   IPWebsGetAcceptStats(&Accept);
+   web_SSEPrintf(&Buf, "\"web\":{\"accepted\":%u,\"queued\":%u,\"shed\":%u,\"queuemax\":%u,\"timedout\":%u},",
+                 (unsigned)Accept.dAccepted, (unsigned)Accept.dQueued, (unsigned)Accept.dShed,
+                 (unsigned)Accept.dQueueMax, (unsigned)Accept.dTimedOut);
+   
+   /* lwIP counters */
+   web_SSEPrintf(&Buf, "\"lwip\":{");
+#if LWIP_STATS
+#if LINK_STATS
+   StatJsonProto(&Buf, "link", &lwip_stats.link);
+#endif
+#if ETHARP_STATS
+   StatJsonProto(&Buf, "etharp", &lwip_stats.etharp);
+#endif
+#if IP_STATS
+   StatJsonProto(&Buf, "ip", &lwip_stats.ip);
+#endif
+#if ICMP_STATS
+   StatJsonProto(&Buf, "icmp", &lwip_stats.icmp);
+#endif
+#if UDP_STATS
+   StatJsonProto(&Buf, "udp", &lwip_stats.udp);
+#endif
+#if TCP_STATS
+   StatJsonProto(&Buf, "tcp", &lwip_stats.tcp);
+#endif
+#if MEM_STATS
+   web_SSEPrintf(&Buf, "\"mem\":{\"avail\":%u,\"used\":%u,\"max\":%u,\"err\":%u},",
+                 (unsigned)lwip_stats.mem.avail, (unsigned)lwip_stats.mem.used,
+                 (unsigned)lwip_stats.mem.max, (unsigned)lwip_stats.mem.err);
+#endif
+#if MEMP_STATS
+   /* The pool names are only available with LWIP_DEBUG, use the index */
+   web_SSEPrintf(&Buf, "\"memp\":[");
+   for (nPool = 0; nPool < MEMP_MAX; nPool++)
+   {
+      web_SSEPrintf(&Buf, "%s[%u,%u,%u,%u]", (0 == nPool) ? "" : ",",
+                    (unsigned)lwip_stats.memp[nPool]->avail, (unsigned)lwip_stats.memp[nPool]->used,
+                    (unsigned)lwip_stats.memp[nPool]->max, (unsigned)lwip_stats.memp[nPool]->err);
+   }
+   web_SSEPrintf(&Buf, "],");
+#if LWIP_NETCONN || LWIP_SOCKET
+   /* One netconn for each open connection */
+   web_SSEPrintf(&Buf, "\"netconn\":{\"avail\":%u,\"used\":%u,\"max\":%u,\"err\":%u},",
+                 (unsigned)lwip_stats.memp[MEMP_NETCONN]->avail, (unsigned)lwip_stats.memp[MEMP_NETCONN]->used,
+                 (unsigned)lwip_stats.memp[MEMP_NETCONN]->max, (unsigned)lwip_stats.memp[MEMP_NETCONN]->err);
+#endif
+#endif
+#endif /* LWIP_STATS */
+   
+   /* Replace the last comma, or close an empty object */
+   if (',' == Buf.pData[Buf.wLen - 1])
+   {
+      Buf.wLen--;
+   }
+   web_SSEPrintf(&Buf, "}}");
+   
+   if (Buf.bFull)
+   {
+      OS_RES_FREE(&StatJsonSema);
+      HttpSendError(hs, 500);
+      return(-1);
+   }
+   
+   HttpSendHeaderTop(hs, 200);
+   s_puts("Cache-Control: no-cache, must-revalidate\r\n", hs->s_stream);
+   s_puts("Expires: Sat, 26 Jul 1997 05:00:00 GMT\r\n", hs->s_stream);   
+   HttpSendHeaderBottom(hs, "application", "json", Buf.wLen, 0);
+   
+   s_write(StatJsonBuffer, 1, Buf.wLen, hs->s_stream);
+   s_flush(hs->s_stream);
+   
+   if (nReset)
+   {
+      /* The peak starts again with the next allocation */
+      for (wIndex = 0; wIndex < XM_ID_MAX; wIndex++)
+      {
+         tal_MEMClrUsedRawMemoryMax((tal_mem_id)wIndex);
+      }
+#if LWIP_STATS && MEM_STATS
+      lwip_stats.mem.max = lwip_stats.mem.used;
+#endif
+#if LWIP_STATS && MEMP_STATS
+      for (nPool = 0; nPool < MEMP_MAX; nPool++)
+      {
+         lwip_stats.memp[nPool]->max = lwip_stats.memp[nPool]->used;
+      }
+#endif
+   }
+   
+   OS_RES_FREE(&StatJsonSema);
+
+   return(0);
+} /* StatJson */
+
+/*************************************************************************/
+/*  StatSample                                                           */
+/*                                                                       */
+/*  Create one frame of the status event stream. It contains the same    */
+/*  data as CPULoad, StatRun and StatStack, one row per web_SSEPrintf.   */
+/*  The task list depends on the number of tasks and comes last, rows    */
+/*  which do not fit are replaced by a note.                             */
+/*                                                                       */
+/*  In    : pBuf                                                         */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void StatSample (web_sse_buf_t *pBuf)
+{
+   const stat_run_t *pRun;
+   OS_TCB           *pTCB;
+   uint8_t          *pStart;
+   uint8_t          *pEnd;
+   uint32_t          dSize;
+   uint32_t          dFree;
+   uint16_t          wDimCnt;
+   
+   /* CPU load */
+   web_SSEEventBegin(pBuf, "cpuload", NULL);
+   web_SSEPrintf(pBuf, "{\"cpuload\":\"%d\"}", OS_StatGetCPULoad());
+   web_SSEEventEnd(pBuf);
+   
+   /* Runtime stacks */
+   web_SSEEventBegin(pBuf, "statrun", NULL);
+   wDimCnt = 0;
+   for (pRun = StatRunList; pRun->pName != NULL; pRun++)
+   {
+      dSize = (uint32_t)(pRun->pEnd - pRun->pStart);
+      dFree = GetStackFreeCount(pRun->pStart, pRun->pEnd);
+      
+      web_SSEPrintf(pBuf, "<tr%s><td>&nbsp;</td><td>%s</td><td>%4d</td><td>%4d</td><td>%4d</td><td>&nbsp;</td></tr>",
+                    (wDimCnt & 0x01) ? " class=\"dim\"" : "",
+                    pRun->pName, dSize, (dSize - dFree), dFree);
+      
+      wDimCnt++;
+   }
+   web_SSEEventEnd(pBuf);
+   
+   /* Task stacks */
+   web_SSEEventBegin(pBuf, "statstack", "<tr><td>&nbsp;</td><td colspan=\"6\">More tasks, IP_WEB_SSE_FRAME_SIZE is too small</td><td>&nbsp;</td></tr>");
+   wDimCnt = 0;
+   pTCB    = OS_TaskGetList(); 
+   while (pTCB != NULL)
+   {
+      pStart = pTCB->pStackStart;
+      pEnd   = (uint8_t*)pStart + pTCB->wStackSize;
+      dSize  = (uint32_t)pEnd - (uint32_t)pStart;
+      dFree  = GetStackFreeCount(pStart, pEnd);
+      
+      web_SSEPrintf(pBuf, "<tr%s><td>&nbsp;</td><td>%s</td><td>%d</td><td>%d</td><td>%d</td><td>%d</td><td>%2d.%02d</td><td>&nbsp;</td></tr>",
+                    (wDimCnt & 0x01) ? " class=\"dim\"" : "",
+                    (pTCB->Name[0] != 0) ? pTCB->Name : "----------------",
+                    pTCB->nPrio, dSize, (dSize - dFree), dFree,
+                    (uint16_t)(pTCB->dStatUsage / 100), (uint16_t)(pTCB->dStatUsage % 100));
+      
+      wDimCnt++;
+      pTCB = pTCB->pTaskNext;
+   }
+   web_SSEEventEnd(pBuf);
+
+} /* StatSample */
+
+/*************************************************************************/
+/*  StatSse                                                              */
+/*                                                                       */
+/*  Status event stream, replaces the polling of CPULoad, StatStack      */
+/*  and StatRun. All subscribers share one sample per interval.          */
+/*                                                                       */
+/*  In    : hs                                                           */
+/*  Out   : none                                                         */
+/*  Return: 0 = OK / -1 = ERROR                                          */
+/*************************************************************************/
+static int StatSse (HTTPD_SESSION *hs)
+{
+   return(web_SSERun(hs));
+} /* StatSse */
+
+/*************************************************************************/
+/*  StatLog                                                              */
+/*                                                                       */
+/*  Output the latency histograms and the access records.                */
+/*                                                                       */
+/*  In    : hs                                                           */
+/*  Out   : none                                                         */
+/*  Return: 0 = OK / -1 = ERROR                                          */
+/*************************************************************************/
+static int StatLog (HTTPD_SESSION *hs)
+{
+   return(web_LogSendJson(hs));
+} /* StatLog */
+
 /*************************************************************************/
 /*  Upload                                                               */
 /*                                                                       */
@@ -1395,16 +1703,7 @@ static int Upload (HTTPD_SESSION *hs)
    web_upload_t Info;
    int         nErr = -1;
    
-   if (NULL == UploadBuffer)
-   {
-      UploadBuffer = xmalloc(XM_ID_HEAP, WEB_UPLOAD_BUFFER_SIZE);   
-      if (NULL == UploadBuffer) return(-1);
-   }
-      
    memset(&Info, 0, sizeof(web_upload_t));
-   
-   Info.pBuffer     = UploadBuffer;
-   Info.lBufferSize = WEB_UPLOAD_BUFFER_SIZE;
 
    UploadFile(hs, &Info);
 
@@ -1425,6 +1724,9 @@ static int Upload (HTTPD_SESSION *hs)
    }
    else
    {
+      /* Remove the temporary file, if this session has started the upload */
+      fs_UploadAbort(Info.pHandle);
+      
       LastUpdateError = (int8_t)Info.Error;
    }
    
@@ -1447,9 +1749,6 @@ static int Upload (HTTPD_SESSION *hs)
    xfree(Info.pType);
    xfree(Info.pRedirOK);
    xfree(Info.pRedirERR);
-   
-   xfree(UploadBuffer);
-   UploadBuffer = NULL;
 
    return(0);
 } /* Upload */
@@ -1561,6 +1860,10 @@ void web_CGIInit (void)
    
    web_CGIListAdd((CGI_LIST_ENTRY*)CGIList);
    
+   OS_RES_CREATE(&StatJsonSema);
+   
+   web_SSEInit(StatSample, _SSE_INTERVAL_MS);
+   
    Time64Init();
    
 } /* web_CGIInit */
@@ -1661,6 +1964,9 @@ static const CGI_LIST_ENTRY CGIList[] =   /*lint !e31*/
    { "cgi-bin/stat_mem.cgi",        StatMem      },   
    
    { "cgi-bin/cpuload.cgi",         CPULoad      },
+   { "cgi-bin/stat_sse.cgi",        StatSse      },
+   { "cgi-bin/stat_json.cgi",       StatJson     },
+   { "cgi-bin/stat_log.cgi",        StatLog      },
    
    { "cgi-bin/upload.cgi",          Upload       },
    { "cgi-bin/upgrade.cgi",         Upgrade      },
@@ -0,0 +1,444 @@
+/**************************************************************************
+*  Copyright (c) 2026 by Michael Fischer (www.emb4fun.de).
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without 
+*  modification, are permitted provided that the following conditions 
+*  are met:
+*  
+*  1. Redistributions of source code must retain the above copyright 
+*     notice, this list of conditions and the following disclaimer.
+*
+*  2. Redistributions in binary form must reproduce the above copyright
+*     notice, this list of conditions and the following disclaimer in the 
+*     documentation and/or other materials provided with the distribution.
+*
+*  3. Neither the name of the author nor the names of its contributors may 
+*     be used to endorse or promote products derived from this software 
+*     without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS 
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL 
+*  THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, 
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS 
+*  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF 
+*  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+*  SUCH DAMAGE.
+*
+***************************************************************************
+*  History:
+*
+*  16.10.2026  mifi  First Version.
+*  17.10.2026  mifi  Fixed service time overflow, uptime in seconds.
+*  17.10.2026  mifi  Use the shared FNV-1a hash, see HttpHashStr.
+*  17.10.2026  mifi  Convert the service time and hash the URL on output.
+**************************************************************************/
+#define __WEB_LOG_C__
+
+/*=======================================================================*/
+/*  Includes                                                             */
+/*=======================================================================*/
+#include <stdint.h>
+#include <string.h>
+
+#include "tcts.h"
+#include "tal.h"
+#include "ipstack.h"
+#include "ipweb.h"
+#include "web_log.h"
+#include "pro/uhttp/modules/mod_ssi.h"
+#include "pro/uhttp/utils.h"
+
+/*=======================================================================*/
+/*  All Structures and Common Constants                                  */
+/*=======================================================================*/
+
+/* Number of access records, must be a power of 2 */
+#if !defined(IP_WEB_LOG_RING_SIZE)
+#define _LOG_RING_SIZE        64
+#else
+#define _LOG_RING_SIZE        IP_WEB_LOG_RING_SIZE
+#endif
+
+#if ((_LOG_RING_SIZE & (_LOG_RING_SIZE - 1)) != 0)
+#error IP_WEB_LOG_RING_SIZE must be a power of 2
+#endif
+
+/* Drain the records to syslog */
+#if !defined(IP_WEB_LOG_SYSLOG)
+#define _LOG_SYSLOG           0
+#else
+#define _LOG_SYSLOG           IP_WEB_LOG_SYSLOG
+#endif
+
+/* Number of records which are drained together */
+#if !defined(IP_WEB_LOG_SYSLOG_BATCH)
+#define _LOG_SYSLOG_BATCH     16
+#else
+#define _LOG_SYSLOG_BATCH     IP_WEB_LOG_SYSLOG_BATCH
+#endif
+
+/* Above this time the ms counter is used, the HiRes count wraps at 65s */
+#define _LOG_HIRES_MAX_MS     60000
+
+/*=======================================================================*/
+/*  Definition of all local Data                                         */
+/*=======================================================================*/
+
+static web_log_rec_t LogRing[_LOG_RING_SIZE];
+static uint32_t      dLogHead   = 0;  /* Number of records written */
+static uint32_t      dLogFolded = 0;  /* Number of records in the histograms */
+static uint32_t      dLogPeriod = 0;  /* HiRes count per ms */
+static uint32_t      LogHist[WEB_LOG_FAMILY_MAX][WEB_LOG_BUCKETS];
+
+static const char   *FamilyName[WEB_LOG_FAMILY_MAX] = { "static", "cgi", "ssi", "other" };
+
+#if (_LOG_SYSLOG >= 1)
+static uint32_t      dLogDrained  = 0;
+static uint8_t       bLogDraining = 0;
+#endif
+
+/*=======================================================================*/
+/*  Definition of all local Procedures                                   */
+/*=======================================================================*/
+
+/*************************************************************************/
+/*  ServiceTime                                                          */
+/*                                                                       */
+/*  Return the service time of a record. The HiRes difference has the    */
+/*  ms in the upper 16 bit, and the count below dLogPeriod in the lower  */
+/*  16 bit, see web_LogEnd.                                              */
+/*                                                                       */
+/*  In    : pRec                                                         */
+/*  Out   : none                                                         */
+/*  Return: Service time in us                                           */
+/*************************************************************************/
+static uint32_t ServiceTime (const web_log_rec_t *pRec)
+{
+   if ((pRec->dMs >= _LOG_HIRES_MAX_MS) || (0 == dLogPeriod))
+   {
+      return((pRec->dMs < (0xFFFFFFFF / 1000)) ? (pRec->dMs * 1000) : 0xFFFFFFFF);
+   }
+   
+   return(((pRec->dHiRes >> 16) * 1000) + (((pRec->dHiRes & 0xFFFF) * 1000) / dLogPeriod));
+} /* ServiceTime */
+
+/*************************************************************************/
+/*  LogFoldRecord                                                        */
+/*                                                                       */
+/*  Count the service time of the oldest record which is not in the      */
+/*  histograms yet. Must be called with the interrupts disabled.         */
+/*                                                                       */
+/*  In    : none                                                         */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void LogFoldRecord (void)
+{
+   web_log_rec_t *pRec     = &LogRing[dLogFolded & (_LOG_RING_SIZE - 1)];
+   uint32_t       dService = ServiceTime(pRec);
+   int            nBucket  = 0;
+   
+   /* Bucket is the number of significant bits, CLZ instruction */
+   if (dService != 0)
+   {
+      nBucket = 32 - __builtin_clz(dService);
+      if (nBucket >= WEB_LOG_BUCKETS)
+      {
+         nBucket = WEB_LOG_BUCKETS - 1;
+      }
+   }
+   
+   LogHist[pRec->bFamily][nBucket]++;
+   dLogFolded++;
+   
+} /* LogFoldRecord */
+
+/*************************************************************************/
+/*  LogFold                                                              */
+/*                                                                       */
+/*  Count all new records in the histograms, one record per interrupt    */
+/*  lock.                                                                */
+/*                                                                       */
+/*  In    : none                                                         */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void LogFold (void)
+{
+   uint8_t bDone = 0;
+   
+   while (0 == bDone)
+   {
+      TAL_CPU_DISABLE_ALL_INTS();
+      if (dLogFolded == dLogHead)
+      {
+         bDone = 1;
+      }
+      else
+      {
+         LogFoldRecord();
+      }
+      TAL_CPU_ENABLE_ALL_INTS();
+   }
+   
+} /* LogFold */
+
+#if (_LOG_SYSLOG >= 1)
+/*************************************************************************/
+/*  LogDrain                                                             */
+/*                                                                       */
+/*  Send the records which are not drained yet to syslog, one message    */
+/*  per record. Records overwritten in the meantime are lost.            */
+/*                                                                       */
+/*  In    : none                                                         */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void LogDrain (void)
+{
+   web_log_rec_t Rec;
+   uint32_t      dIndex = 0;
+   uint8_t       bBusy;
+   uint8_t       bDone  = 0;
+   uint8_t      *pIP;
+   
+   /* Only one task drains */
+   TAL_CPU_DISABLE_ALL_INTS();
+   bBusy        = bLogDraining;
+   bLogDraining = 1;
+   TAL_CPU_ENABLE_ALL_INTS();
+   
+   if (bBusy)
+   {
+      return;
+   }
+   
+   LogFold();
+   
+   while (0 == bDone)
+   {
+      TAL_CPU_DISABLE_ALL_INTS();
+      dIndex = dLogDrained;
+      if ((dLogHead - dIndex) > _LOG_RING_SIZE)
+      {
+         dIndex = dLogHead - _LOG_RING_SIZE;
+      }
+      
+      if (dIndex == dLogHead)
+      {
+         bDone        = 1;
+         bLogDraining = 0;
+      }
+      else
+      {
+         Rec         = LogRing[dIndex & (_LOG_RING_SIZE - 1)];
+         dLogDrained = dIndex + 1;
+      }
+      TAL_CPU_ENABLE_ALL_INTS();
+      
+      if (0 == bDone)
+      {
+         pIP = (uint8_t*)&Rec.dClient;
+         IP_SYSL_Output(0, SYSL_PRIORITY(SYSL_SEV_INFO, SYSL_FAC_LOCAL0), "httpd",
+                        "%d.%d.%d.%d %s %s %08x %d %d %dus",
+                        pIP[0], pIP[1], pIP[2], pIP[3], FamilyName[Rec.bFamily],
+                        (HTTP_METHOD_POST == Rec.bMethod) ? "POST" : (HTTP_METHOD_HEAD == Rec.bMethod) ? "HEAD" : "GET",
+                        HttpHashStr(HTTP_HASH_INIT, Rec.Url, 0), Rec.wStatus, Rec.dBytes, ServiceTime(&Rec));
+      }
+   }
+   
+} /* LogDrain */
+#endif /* (_LOG_SYSLOG >= 1) */
+
+/*=======================================================================*/
+/*  All code exported                                                    */
+/*=======================================================================*/
+
+/*************************************************************************/
+/*  web_LogBegin                                                         */
+/*                                                                       */
+/*  Start the service time of a request, the header is parsed.           */
+/*                                                                       */
+/*  In    : hs                                                           */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+void web_LogBegin (HTTPD_SESSION *hs)
+{
+   hs->s_req.req_log_start   = tal_CPUStatGetHiResCnt();
+   hs->s_req.req_log_ms      = OS_TimeGet();
+   hs->s_stream->strm_status = 0;
+   hs->s_stream->strm_bytes  = 0;
+   
+} /* web_LogBegin */
+
+/*************************************************************************/
+/*  web_LogEnd                                                           */
+/*                                                                       */
+/*  Write the access record. Only the HiRes difference and the first     */
+/*  part of the URL are stored here, the service time is converted and   */
+/*  counted in the histograms by LogFold, the URL is hashed on output.   */
+/*  The record is written with the interrupts disabled, this are a few   */
+/*  stores only.                                                         */
+/*                                                                       */
+/*  In    : hs, mt                                                       */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+void web_LogEnd (HTTPD_SESSION *hs, const MEDIA_TYPE_ENTRY *mt)
+{
+   web_log_rec_t *pRec;
+   uint32_t       dEnd    = tal_CPUStatGetHiResCnt();
+   uint32_t       dMs     = OS_TimeGet() - hs->s_req.req_log_ms;
+   uint32_t       dStart  = hs->s_req.req_log_start;
+   uint32_t       dHiRes  = dEnd - dStart;
+   const char    *pUrl    = hs->s_req.req_url;
+   uint8_t        bFamily = WEB_LOG_OTHER;
+   int            nIndex;
+   
+   if (mt != NULL)
+   {
+      if (HttpCgiFunctionHandler == mt->media_handler)
+      {
+         bFamily = WEB_LOG_CGI;
+      }
+      else if (HttpSsiHandler == mt->media_handler)
+      {
+         bFamily = WEB_LOG_SSI;
+      }
+      else
+      {
+         bFamily = WEB_LOG_STATIC;
+      }
+   }
+   
+   if (0 == dLogPeriod)
+   {
+      dLogPeriod = tal_CPUStatGetHiResPeriod();
+   }
+   
+   /* The count borrowed a whole 16 bit from the ms, but a ms has dLogPeriod only */
+   if ((dEnd & 0xFFFF) < (dStart & 0xFFFF))
+   {
+      dHiRes -= (0x10000 - dLogPeriod);
+   }
+   
+   TAL_CPU_DISABLE_ALL_INTS();
+   /* Count the oldest record before it is overwritten */
+   if ((dLogHead - dLogFolded) >= _LOG_RING_SIZE)
+   {
+      LogFoldRecord();
+   }
+   
+   pRec = &LogRing[dLogHead & (_LOG_RING_SIZE - 1)];
+   dLogHead++;
+   
+   pRec->dTime   = hs->s_req.req_log_ms;
+   pRec->dClient = hs->s_stream->strm_caddr.sin_addr.s_addr;
+   pRec->dBytes  = hs->s_stream->strm_bytes;
+   pRec->dHiRes  = dHiRes;
+   pRec->dMs     = dMs;
+   pRec->wStatus = (uint16_t)hs->s_stream->strm_status;
+   pRec->bMethod = (uint8_t)hs->s_req.req_method;
+   pRec->bFamily = bFamily;
+   
+   nIndex = 0;
+   if (pUrl != NULL)
+   {
+      for (; (nIndex < (WEB_LOG_URL_SIZE - 1)) && (pUrl[nIndex] != 0); nIndex++)
+      {
+         pRec->Url[nIndex] = pUrl[nIndex];
+      }
+   }
+   pRec->Url[nIndex] = 0;
+   TAL_CPU_ENABLE_ALL_INTS();
+   
+#if (_LOG_SYSLOG >= 1)
+   if ((dLogHead - dLogDrained) >= _LOG_SYSLOG_BATCH)
+   {
+      LogDrain();
+   }
+#endif   
+   
+} /* web_LogEnd */
+
+/*************************************************************************/
+/*  web_LogSendJson                                                      */
+/*                                                                       */
+/*  Output the histograms and the access records, oldest first. A        */
+/*  record is [time, client, method, url hash, status, bytes, us], the   */
+/*  hash is over the first WEB_LOG_URL_SIZE - 1 characters of the URL.   */
+/*  The uptime is in seconds like in stat_json, the time of a record     */
+/*  in ms since boot.                                                    */
+/*                                                                       */
+/*  In    : hs                                                           */
+/*  Out   : none                                                         */
+/*  Return: 0 = OK / -1 = ERROR                                          */
+/*************************************************************************/
+int web_LogSendJson (HTTPD_SESSION *hs)
+{
+   web_log_rec_t Rec;
+   uint32_t      Hist[WEB_LOG_BUCKETS];
+   uint32_t      dIndex;
+   uint32_t      dHead;
+   uint8_t      *pIP;
+   int           nFamily;
+   int           nBucket;
+   int           nValid;
+   int           nFirst = 1;
+   
+   web_SendCGIHeader(hs);
+   
+   LogFold();
+   
+   s_printf(hs->s_stream, "{\"uptime\":%d,\"buckets\":%d,\"hist\":{", OS_TimeGetSeconds(), WEB_LOG_BUCKETS);
+   for (nFamily = 0; nFamily < WEB_LOG_FAMILY_MAX; nFamily++)
+   {
+      TAL_CPU_DISABLE_ALL_INTS();
+      memcpy(Hist, LogHist[nFamily], sizeof(Hist));
+      TAL_CPU_ENABLE_ALL_INTS();
+      
+      s_printf(hs->s_stream, "%s\"%s\":[", (0 == nFamily) ? "" : ",", FamilyName[nFamily]);
+      for (nBucket = 0; nBucket < WEB_LOG_BUCKETS; nBucket++)
+      {
+         s_printf(hs->s_stream, "%s%d", (0 == nBucket) ? "" : ",", Hist[nBucket]);
+      }
+      s_puts("]", hs->s_stream);
+   }
+   s_puts("},\"log\":[", hs->s_stream);
+   
+   TAL_CPU_DISABLE_ALL_INTS();
+   dHead = dLogHead;
+   TAL_CPU_ENABLE_ALL_INTS();
+   
+   dIndex = (dHead > _LOG_RING_SIZE) ? (dHead - _LOG_RING_SIZE) : 0;
+   for (; dIndex != dHead; dIndex++)
+   {
+      /* Skip records which were overwritten while sending */
+      TAL_CPU_DISABLE_ALL_INTS();
+      nValid = ((dLogHead - dIndex) <= _LOG_RING_SIZE);
+      Rec    = LogRing[dIndex & (_LOG_RING_SIZE - 1)];
+      TAL_CPU_ENABLE_ALL_INTS();
+      
+      if (nValid)
+      {
+         pIP = (uint8_t*)&Rec.dClient;
+         s_printf(hs->s_stream, "%s[%d,\"%d.%d.%d.%d\",%d,\"%08x\",%d,%d,%d]",
+                  (nFirst) ? "" : ",",
+                  Rec.dTime, pIP[0], pIP[1], pIP[2], pIP[3], Rec.bMethod,
+                  HttpHashStr(HTTP_HASH_INIT, Rec.Url, 0), Rec.wStatus, Rec.dBytes, ServiceTime(&Rec));
+         nFirst = 0;
+      }
+   }
+   s_puts("]}", hs->s_stream);
+   
+   return(0);
+} /* web_LogSendJson */
+
+/*** EOF ***/
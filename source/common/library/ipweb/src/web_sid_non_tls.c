@@ -35,6 +35,10 @@
 *
 *  09.03.2019  mifi  First Version.
 *  21.08.2020  mifi  Replace SHA1 by SHA256.
+*  16.10.2026  mifi  Use a hashed session list with LRU eviction.
+*  17.10.2026  mifi  Random SID, evict sessions without login first.
+*  17.10.2026  mifi  Use the shared FNV-1a hash, see HttpHashBuf.
+*  17.10.2026  mifi  Copy the NONCE, WebSidCheck returns user and permission.
 **************************************************************************/
 #define __WEB_SID_C__
 
@@ -45,9 +49,11 @@
 #include <string.h>
 #include <stdlib.h>
 #include <ctype.h>
+#include "tal.h"
 #include "tcts.h"
 #include "ipweb.h"
 #include "xmem.h"
+#include "pro/uhttp/utils.h"
 
 #if (_IP_WEB_SID_SUPPORT >= 1)
 
@@ -72,11 +78,12 @@
 #define LOGIN_ERROR_CNT_MAX   3
 #define LOGIN_TIMEOUT_SEC     60
 
-#define SID_TIMEOUT_SEC       (1*60)
+#define SID_TIMEOUT_SEC       _IP_WEB_SID_TIMEOUT_SEC
 #define SID_START             "sid="
 #define SID_LEN               32
 #define SID_NONCE_LEN         16
 #define SID_COOKIE_SIZE       64
+#define SID_RANDOM_SIZE       16       /* 128 bit from the hardware RNG */
 
 #define USER_SIZE             16
 
@@ -84,7 +91,13 @@
 #define SHA2_HASH_SIZE        32
 
 #define USER_LIST_CNT         8
-#define SID_LIST_CNT          8
+#define SID_LIST_CNT          _IP_WEB_SID_LIST_CNT
+#define SID_HASH_CNT          (SID_LIST_CNT * 2)
+#define SID_BIND_IP           _IP_WEB_SID_BIND_IP
+
+#if (SID_LIST_CNT > 16384)
+#error "IP_WEB_SID_LIST_CNT is too large"
+#endif
 
 #define BLOWFISH_KEY_LEN      56
 
@@ -99,11 +112,15 @@ typedef struct _sid_
 {
    int      nUserIndex;
    uint32_t dIPAddr;
-   //uint32_t dLastAccessTimeSec;
+   uint32_t dLastAccessTimeSec;
    uint32_t dLastAccessHTTPTimeSec;
    uint32_t dLastAccessCGITimeSec;
    int      nAccessGranted;
    uint32_t dPermission;
+   uint32_t dHash;                        /* Hash key of StrSID */
+   int16_t  nHashNext;                    /* Next entry in hash chain or free list */
+   int16_t  nLruPrev;
+   int16_t  nLruNext;
    char      StrSID[SID_LEN+1];           /* Add 1 for zero termination */    
    char      StrNonce[SID_NONCE_LEN+1];   /* Add 1 for zero termination */
 } sid_t;
@@ -113,6 +130,8 @@ typedef struct _sid_data_
    uint32_t dIPAddr;
    uint32_t dTimeSec;
    uint32_t dTimeTick;
+   uint32_t dCounter;
+   uint8_t   Random[SID_RANDOM_SIZE];
 } sid_data_t;
 
 typedef struct _nonce_data_
@@ -134,6 +153,13 @@ typedef struct _nonce_data_
 static user_t UserList[USER_LIST_CNT];
 static sid_t  SIDList[SID_LIST_CNT];
 
+static int16_t  SIDHash[SID_HASH_CNT];
+static int16_t  nSIDFree;
+static int16_t  nSIDLruHead;            /* Most recently used  */
+static int16_t  nSIDLruTail;            /* Least recently used */
+static uint32_t dSIDCounter = 0;
+static OS_SEMA  SIDSema;
+
 static uint32_t dNonceCounter = 0;      
 
 static int      nLoginErrorCnt         = 0;
@@ -255,46 +281,325 @@ static int ConvStrHash2BinHash (uint8_t *pBin, char *pStr)
 } /* ConvStrHash2BinHash */
 
 /*************************************************************************/
-/*  FindSIDEntry                                                         */
+/*  SIDHashKey                                                           */
 /*                                                                       */
-/*  Find the session id for the given address, or a free entry.          */
+/*  Return the hash key (FNV-1a) of the given session id.                */
 /*                                                                       */
-/*  In    : dIPAddr                                                      */
+/*  In    : pSessionID                                                   */
 /*  Out   : none                                                         */
-/*  Return: pSIDEntry                                                    */
+/*  Return: dHash                                                        */
 /*************************************************************************/
-static sid_t *FindSIDEntry (uint32_t dIPAddr, int *pIndex)
+static uint32_t SIDHashKey (char *pSessionID)
 {
-   sid_t *pSIDEntry = NULL;
-   int    nIndex;
+   return(HttpHashBuf(HTTP_HASH_INIT, pSessionID, SID_LEN));
+} /* SIDHashKey */
+
+/*************************************************************************/
+/*  SIDLruUnlink                                                         */
+/*                                                                       */
+/*  Remove the entry from the LRU list.                                  */
+/*                                                                       */
+/*  In    : nIndex                                                       */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void SIDLruUnlink (int nIndex)
+{
+   sid_t *pSIDEntry = &SIDList[nIndex];
    
-   /* Check if the ip address is used */
-   for(nIndex = 0; nIndex < SID_LIST_CNT; nIndex++)
+   if (pSIDEntry->nLruPrev != -1)
+   {
+      SIDList[pSIDEntry->nLruPrev].nLruNext = pSIDEntry->nLruNext;
+   }
+   else
+   {
+      nSIDLruHead = pSIDEntry->nLruNext;
+   }
+   
+   if (pSIDEntry->nLruNext != -1)
+   {
+      SIDList[pSIDEntry->nLruNext].nLruPrev = pSIDEntry->nLruPrev;
+   }
+   else
+   {
+      nSIDLruTail = pSIDEntry->nLruPrev;
+   }
+   
+   pSIDEntry->nLruPrev = -1;
+   pSIDEntry->nLruNext = -1;
+   
+} /* SIDLruUnlink */
+
+/*************************************************************************/
+/*  SIDTouch                                                             */
+/*                                                                       */
+/*  Update the access time and move the entry to the head of the LRU     */
+/*  list. Therefore the tail of the list is the least recently used one. */
+/*                                                                       */
+/*  In    : nIndex                                                       */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void SIDTouch (int nIndex)
+{
+   sid_t *pSIDEntry = &SIDList[nIndex];
+   
+   pSIDEntry->dLastAccessTimeSec = OS_TimeGetSeconds();
+   
+   if (nSIDLruHead != nIndex)
    {
-      if (dIPAddr == SIDList[nIndex].dIPAddr)
+      if (pSIDEntry->nLruPrev != -1)
       {
-         *pIndex   = nIndex;
-         pSIDEntry = &SIDList[nIndex];
+         SIDLruUnlink(nIndex);
+      }
+      
+      pSIDEntry->nLruPrev = -1;
+      pSIDEntry->nLruNext = nSIDLruHead;
+      if (nSIDLruHead != -1)
+      {
+         SIDList[nSIDLruHead].nLruPrev = (int16_t)nIndex;
+      }
+      else
+      {
+         nSIDLruTail = (int16_t)nIndex;
+      }
+      nSIDLruHead = (int16_t)nIndex;
+   }
+   
+} /* SIDTouch */
+
+/*************************************************************************/
+/*  SIDRemove                                                            */
+/*                                                                       */
+/*  Remove the entry from the hash and LRU list and put it back to the   */
+/*  free list.                                                           */
+/*                                                                       */
+/*  In    : nIndex                                                       */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void SIDRemove (int nIndex)
+{
+   sid_t   *pSIDEntry = &SIDList[nIndex];
+   int16_t *pLink;
+   
+   /* Unlink from the hash chain */
+   pLink = &SIDHash[pSIDEntry->dHash % SID_HASH_CNT];
+   while (*pLink != -1)
+   {
+      if (*pLink == nIndex)
+      {
+         *pLink = pSIDEntry->nHashNext;
          break;
       }
+      pLink = &SIDList[*pLink].nHashNext;
    }
    
-   /* Check for a free entry search */
-   if (NULL == pSIDEntry)
+   SIDLruUnlink(nIndex);
+   
+   /* The hash link is used for the free list too */
+   memset(pSIDEntry, 0x00, sizeof(sid_t));
+   pSIDEntry->nLruPrev  = -1;
+   pSIDEntry->nLruNext  = -1;
+   pSIDEntry->nHashNext = nSIDFree;
+   nSIDFree             = (int16_t)nIndex;
+   
+} /* SIDRemove */
+
+/*************************************************************************/
+/*  SIDVictim                                                            */
+/*                                                                       */
+/*  Return the entry to evict. Sessions without login are evicted first, */
+/*  starting with the least recently used one. Otherwise a flood of new  */
+/*  clients could push out the sessions of logged in users.              */
+/*                                                                       */
+/*  In    : none                                                         */
+/*  Out   : none                                                         */
+/*  Return: nIndex                                                       */
+/*************************************************************************/
+static int SIDVictim (void)
+{
+   int nIndex = nSIDLruTail;
+   
+   while (nIndex != -1)
    {
-      for(nIndex = 0; nIndex < SID_LIST_CNT; nIndex++)
+      if (0 == SIDList[nIndex].nAccessGranted)
       {
-         if (0 == SIDList[nIndex].dIPAddr)
+         return(nIndex);
+      }
+      nIndex = SIDList[nIndex].nLruPrev;
+   }
+   
+   /* All sessions are logged in, evict the least recently used one */
+   return(nSIDLruTail);
+} /* SIDVictim */
+
+/*************************************************************************/
+/*  SIDAlloc                                                             */
+/*                                                                       */
+/*  Get a free entry. Idle sessions are released first, if the list is   */
+/*  still full a session is evicted, see SIDVictim.                      */
+/*                                                                       */
+/*  In    : none                                                         */
+/*  Out   : none                                                         */
+/*  Return: nIndex                                                       */
+/*************************************************************************/
+static int SIDAlloc (void)
+{
+   int nIndex;
+   
+   /* Release idle sessions, starting with the least recently used one */
+   while ((nSIDLruTail != -1) &&
+          OS_TEST_TIMEOUT(OS_TimeGetSeconds(), SIDList[nSIDLruTail].dLastAccessTimeSec, SID_TIMEOUT_SEC))
+   {
+      SIDRemove(nSIDLruTail);
+   }
+   
+   /* No free entry available, evict a session */
+   if (-1 == nSIDFree)
+   {
+      SIDRemove(SIDVictim());
+   }
+   
+   nIndex   = nSIDFree;
+   nSIDFree = SIDList[nIndex].nHashNext;
+   
+   SIDList[nIndex].nHashNext = -1;
+   
+   return(nIndex);
+} /* SIDAlloc */
+
+/*************************************************************************/
+/*  SIDInsert                                                            */
+/*                                                                       */
+/*  Insert the entry with its new session id in the hash and LRU list.   */
+/*                                                                       */
+/*  In    : nIndex                                                       */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void SIDInsert (int nIndex)
+{
+   sid_t    *pSIDEntry = &SIDList[nIndex];
+   uint32_t  dBucket;
+   
+   pSIDEntry->dHash = SIDHashKey(pSIDEntry->StrSID);
+   dBucket          = pSIDEntry->dHash % SID_HASH_CNT;
+   
+   pSIDEntry->nHashNext = SIDHash[dBucket];
+   SIDHash[dBucket]     = (int16_t)nIndex;
+   
+   SIDTouch(nIndex);
+   
+} /* SIDInsert */
+
+/*************************************************************************/
+/*  SIDFind                                                              */
+/*                                                                       */
+/*  Find the entry of the given session id. A session which was idle     */
+/*  longer than SID_TIMEOUT_SEC will be released here.                   */
+/*                                                                       */
+/*  In    : pSessionID, dIPAddr                                          */
+/*  Out   : none                                                         */
+/*  Return: -1 == not found / nIndex                                     */
+/*************************************************************************/
+static int SIDFind (char *pSessionID, uint32_t dIPAddr)
+{
+   int      nSIDEntry = -1;
+   int      nIndex;
+   uint32_t dHash;
+   sid_t   *pSIDEntry;
+   
+   if (pSessionID != NULL)
+   {
+      dHash  = SIDHashKey(pSessionID);
+      nIndex = SIDHash[dHash % SID_HASH_CNT];
+      
+      while (nIndex != -1)
+      {
+         pSIDEntry = &SIDList[nIndex];
+         
+         if( (dHash == pSIDEntry->dHash)                         &&
+             (0 == memcmp(pSIDEntry->StrSID, pSessionID, SID_LEN)) )
          {
-            *pIndex   = nIndex;
-            pSIDEntry = &SIDList[nIndex];
+            if (OS_TEST_TIMEOUT(OS_TimeGetSeconds(), pSIDEntry->dLastAccessTimeSec, SID_TIMEOUT_SEC))
+            {
+               /* Idle timeout => release the session */
+               SIDRemove(nIndex);
+            }
+            else if ((0 == SID_BIND_IP) || (dIPAddr == pSIDEntry->dIPAddr))
+            {
+               nSIDEntry = nIndex;
+            }
             break;
          }
+         
+         nIndex = pSIDEntry->nHashNext;
       }
    }
+   
+   return(nSIDEntry);
+} /* SIDFind */
 
-   return(pSIDEntry);
-} /* FindSIDEntry */
+/*************************************************************************/
+/*  SIDCheck                                                             */
+/*                                                                       */
+/*  Check if the SessionID is valid. The caller must hold the lock.      */
+/*                                                                       */
+/*  In    : hs, pSessionID, nIsHttp                                      */
+/*  Out   : none                                                         */
+/*  Return: -1 == invalid / nSIDEntry                                    */
+/*************************************************************************/
+static int SIDCheck (HTTPD_SESSION *hs, char *pSessionID, int nIsHttp)
+{
+   int      nSIDEntry;
+   sid_t   *pSIDEntry;
+   uint32_t dIPAddr;
+
+   /* Get source IP address */   
+   dIPAddr = hs->s_stream->strm_caddr.sin_addr.s_addr;
+   
+   nSIDEntry = SIDFind(pSessionID, dIPAddr);
+   if (nSIDEntry != -1)
+   {
+      pSIDEntry = &SIDList[nSIDEntry];
+      
+      if (WEB_SID_HTTP == nIsHttp)
+      {
+         /* Check HTTP timeout */       
+         if (OS_TEST_TIMEOUT(OS_TimeGetSeconds(), pSIDEntry->dLastAccessHTTPTimeSec, SID_TIMEOUT_SEC))
+         {
+            /* Timeout => not valid anymore */
+            nSIDEntry = -1;
+            pSIDEntry->nAccessGranted = 0;
+         }
+         else
+         {
+            /* Retrigger => valid */
+            pSIDEntry->dLastAccessHTTPTimeSec = OS_TimeGetSeconds();
+            SIDTouch(nSIDEntry);
+         }
+      }
+      else
+      {
+         /* Check CGI timeout */       
+         if (OS_TEST_TIMEOUT(OS_TimeGetSeconds(), pSIDEntry->dLastAccessCGITimeSec, SID_TIMEOUT_SEC))
+         {
+            /* Timeout => not valid anymore */
+            nSIDEntry = -1;
+            pSIDEntry->nAccessGranted = 0;
+         }
+         else
+         {
+            /* Retrigger => valid */
+            pSIDEntry->dLastAccessCGITimeSec = OS_TimeGetSeconds();
+            SIDTouch(nSIDEntry);
+         }
+      }             
+   }
+      
+   return(nSIDEntry);
+} /* SIDCheck */
 
 /*************************************************************************/
 /*  CheckUserPassword                                                    */
@@ -393,64 +698,65 @@ static int CheckUserPassword (sid_t *pSIDEntry, char *pUser, char *pPassword, ui
 /*************************************************************************/
 static char *CreateSIDAndNonce (uint32_t dIPAddr)
 {
-   char         *pSessionID = NULL;
+   char         *pSessionID;
    sid_t        *pSIDEntry;
    sid_data_t     Data;
    nonce_data_t   Nonce;   
+   int           nSIDEntry;
    int           nIndex;
    char          Hex[3];
    
    static sha2_context HASHctx;
    static uint8_t      HashValue[SHA2_HASH_SIZE];
    
-   pSIDEntry = FindSIDEntry(dIPAddr, &nIndex);
-   if (pSIDEntry != NULL)
-   {   
-      /*
-       * Create SID
-       */
-      Data.dIPAddr   = dIPAddr;
-      Data.dTimeSec  = OS_TimeGetSeconds();
-      Data.dTimeTick = OS_TimeGet();
-
-      sha2_start(&HASHctx);
-      sha2_update(&HASHctx, (uint8_t*)&Data, sizeof(Data));
-      sha2_finish(&HASHctx, HashValue);
-      
-      pSIDEntry->dIPAddr            = dIPAddr;
-      //pSIDEntry->dLastAccessTimeSec = OS_TimeGetSeconds();
-      pSIDEntry->dLastAccessHTTPTimeSec = pSIDEntry->dLastAccessCGITimeSec = OS_TimeGetSeconds();
-      pSIDEntry->nAccessGranted     = 0;
+   nSIDEntry = SIDAlloc();
+   pSIDEntry = &SIDList[nSIDEntry];
+   
+   /*
+    * Create SID
+    */
+   Data.dIPAddr   = dIPAddr;
+   Data.dTimeSec  = OS_TimeGetSeconds();
+   Data.dTimeTick = OS_TimeGet();
+   Data.dCounter  = dSIDCounter++;
+   tal_CPURngHardwarePoll(Data.Random, sizeof(Data.Random));
+
+   sha2_start(&HASHctx);
+   sha2_update(&HASHctx, (uint8_t*)&Data, sizeof(Data));
+   sha2_finish(&HASHctx, HashValue);
+   
+   pSIDEntry->dIPAddr            = dIPAddr;
+   pSIDEntry->dLastAccessHTTPTimeSec = pSIDEntry->dLastAccessCGITimeSec = OS_TimeGetSeconds();
+   pSIDEntry->nAccessGranted     = 0;
 
-      /* Save index in the first 2 digits */
-      sprintf(pSIDEntry->StrSID, "%02X", nIndex);
-      
-      /* Save the rest of the hash result */
-      for(nIndex = 0; nIndex < 15; nIndex++)
-      {
-         sprintf(Hex, "%02X", HashValue[nIndex]);
-         strcat(pSIDEntry->StrSID, Hex);
-      }
-      
-      pSessionID = pSIDEntry->StrSID;
-     
-      
-      /*
-       * Create NONCE
-       */
-      Nonce.dTimeSec  = OS_TimeGetSeconds();
-      Nonce.dTimeTick = OS_TimeGet();
-      
-      sha2_start(&HASHctx);
-      sha2_update(&HASHctx, (uint8_t*)&Nonce, sizeof(Nonce));
-      sha2_finish(&HASHctx, HashValue);
+   /* The SID is the hash result, the entry is found by the hash list */
+   pSIDEntry->StrSID[0] = 0;
+   for(nIndex = 0; nIndex < (SID_LEN/2); nIndex++)
+   {
+      sprintf(Hex, "%02X", HashValue[nIndex]);
+      strcat(pSIDEntry->StrSID, Hex);
+   }
+   
+   SIDInsert(nSIDEntry);
+   
+   pSessionID = pSIDEntry->StrSID;
+  
+   
+   /*
+    * Create NONCE
+    */
+   Nonce.dTimeSec  = OS_TimeGetSeconds();
+   Nonce.dTimeTick = OS_TimeGet();
+   
+   sha2_start(&HASHctx);
+   sha2_update(&HASHctx, (uint8_t*)&Nonce, sizeof(Nonce));
+   sha2_finish(&HASHctx, HashValue);
 
-      pSIDEntry->StrNonce[0] = 0;
-      for(nIndex = 0; nIndex < (SID_NONCE_LEN/2); nIndex++)
-      {
-         sprintf(Hex, "%02X", HashValue[nIndex]);
-         strcat(pSIDEntry->StrNonce, Hex);
-      }
+   pSIDEntry->StrNonce[0] = 0;
+   for(nIndex = 0; nIndex < (SID_NONCE_LEN/2); nIndex++)
+   {
+      sprintf(Hex, "%02X", HashValue[nIndex]);
+      strcat(pSIDEntry->StrNonce, Hex);
    }
       
    return(pSessionID);
@@ -469,8 +775,26 @@ static char *CreateSIDAndNonce (uint32_t dIPAddr)
 /*************************************************************************/
 void WebSidInit (void)
 {
+   int nIndex;
+   
    memset(UserList, 0x00, sizeof(UserList));
    memset(SIDList,  0x00, sizeof(SIDList));
+   memset(SIDHash,  0xFF, sizeof(SIDHash));
+   
+   /* All entries are free, the free list use the hash link */
+   for(nIndex = 0; nIndex < SID_LIST_CNT; nIndex++)
+   {
+      SIDList[nIndex].nHashNext = (int16_t)(nIndex + 1);
+      SIDList[nIndex].nLruPrev  = -1;
+      SIDList[nIndex].nLruNext  = -1;
+   }
+   SIDList[SID_LIST_CNT-1].nHashNext = -1;
+   
+   nSIDFree    = 0;
+   nSIDLruHead = -1;
+   nSIDLruTail = -1;
+   
+   OS_RES_CREATE(&SIDSema);
 
    /*
     * Setup admin
@@ -559,6 +883,8 @@ char *WebSidCreateCookie (HTTPD_SESSION *hs)
    pCookie = xmalloc(XM_ID_WEB, SID_COOKIE_SIZE);
    if (pCookie != NULL)
    {
+      OS_RES_LOCK(&SIDSema);
+
       pSessionID = CreateSIDAndNonce(dSrcIP);
       if (pSessionID != NULL)
       {
@@ -570,6 +896,8 @@ char *WebSidCreateCookie (HTTPD_SESSION *hs)
          xfree(pCookie);
          pCookie = NULL;
       }                      
+
+      OS_RES_FREE(&SIDSema);
    }   
 
    return(pCookie);
@@ -578,15 +906,17 @@ char *WebSidCreateCookie (HTTPD_SESSION *hs)
 /*************************************************************************/
 /*  WebSidCreateNonce                                                    */
 /*                                                                       */
-/*  Create a NONCE for the given session.                                */
+/*  Create a NONCE for the given session. The NONCE is copied to pNonce  */
+/*  while the session list is locked, the entry could be reused later.   */
+/*  pNonce can be NULL if only a new NONCE is needed.                    */
 /*                                                                       */
-/*  In    : hs                                                           */
-/*  Out   : none                                                         */
-/*  Return: pNonce                                                       */
+/*  In    : hs, pNonce, nSize                                            */
+/*  Out   : pNonce                                                       */
+/*  Return: 0 = OK / -1 = invalid session                                */
 /*************************************************************************/
-char *WebSidCreateNonce (HTTPD_SESSION *hs)
+int WebSidCreateNonce (HTTPD_SESSION *hs, char *pNonce, int nSize)
 {
-   char        *pNonce = NULL;
+   int          rc = -1;
    int          nIndex;
    int          nSIDEntry;
    sid_t       *pSIDEntry;
@@ -597,8 +927,10 @@ char *WebSidCreateNonce (HTTPD_SESSION *hs)
    static sha2_context HASHctx;
    static uint8_t      HashValue[SHA2_HASH_SIZE];
    
+   OS_RES_LOCK(&SIDSema);
+   
    /* Check first if the SID is valid */
-   nSIDEntry = WebSidCheck(hs, req->req_sid, WEB_SID_HTTP); 
+   nSIDEntry = SIDCheck(hs, req->req_sid, WEB_SID_HTTP); 
    if (nSIDEntry != -1)   
    {
       pSIDEntry = &SIDList[nSIDEntry];
@@ -617,10 +949,17 @@ char *WebSidCreateNonce (HTTPD_SESSION *hs)
          sprintf(Hex, "%02X", HashValue[nIndex]);
          strcat(pSIDEntry->StrNonce, Hex);
       }
-      pNonce = pSIDEntry->StrNonce;
+      
+      if ((pNonce != NULL) && (nSize > 0))
+      {
+         snprintf(pNonce, (size_t)nSize, "%s", pSIDEntry->StrNonce);
+      }
+      rc = 0;
    }
 
-   return(pNonce);
+   OS_RES_FREE(&SIDSema);
+
+   return(rc);
 } /* WebSidCreateNonce */
 
 /*************************************************************************/
@@ -629,74 +968,37 @@ char *WebSidCreateNonce (HTTPD_SESSION *hs)
 /*  Check if the SessionID is valid.                                     */
 /*                                                                       */
 /*  Return -1 if the SID is invalid, otherwise return the position       */ 
-/*  in the SIDList.                                                      */
+/*  in the SIDList. For a valid SID the permission and the user of the   */
+/*  session are set in the request while the list is locked. The entry   */
+/*  could be evicted and reused as soon as the lock is released.         */
 /*                                                                       */
 /*  In    : hs, pSessionID, nIsHttp                                      */
-/*  Out   : none                                                         */
+/*  Out   : hs->s_req.req_sid_perm, hs->s_req.req_sid_user               */
 /*  Return: -1 == invalid / nSIDEntry                                    */
 /*************************************************************************/
 int WebSidCheck (HTTPD_SESSION *hs, char *pSessionID, int nIsHttp)
 {
-   int      nSIDEntry = -1;
-   int      nIndex;
-   sid_t   *pSIDEntry = NULL;
-   uint32_t dIPAddr;
-   char      Hex[3];
-
-   /* Get source IP address */   
-   dIPAddr = hs->s_stream->strm_caddr.sin_addr.s_addr;
+   int           nSIDEntry;
+   sid_t        *pSIDEntry;
+   HTTP_REQUEST *req = &hs->s_req;
    
-   if (pSessionID != NULL)
+   OS_RES_LOCK(&SIDSema);
+   
+   nSIDEntry = SIDCheck(hs, pSessionID, nIsHttp);
+   if (nSIDEntry != -1)
    {
-      Hex[0] = pSessionID[0];
-      Hex[1] = pSessionID[1];
-      Hex[2] = 0;
-      nIndex = atoi(Hex);
+      pSIDEntry = &SIDList[nSIDEntry];
       
-      if (nIndex < SID_LIST_CNT)
+      xfree(req->req_sid_user);
+      req->req_sid_user = NULL;
+      req->req_sid_perm = pSIDEntry->dPermission;
+      if (pSIDEntry->nUserIndex != -1)
       {
-         pSIDEntry = &SIDList[nIndex];
-         
-         if( (dIPAddr == pSIDEntry->dIPAddr)                    &&
-             (0 == memcmp(pSIDEntry->StrSID, pSessionID, SID_LEN)) )
-         {      
-            if (WEB_SID_HTTP == nIsHttp)
-            {
-               /* Check HTTP timeout */       
-               if (OS_TEST_TIMEOUT(OS_TimeGetSeconds(), pSIDEntry->dLastAccessHTTPTimeSec, SID_TIMEOUT_SEC))
-               {
-                  /* Timeout => not valid anymore */
-                  nSIDEntry = -1;
-                  pSIDEntry->nAccessGranted = 0;
-               }
-               else
-               {
-                  /* Retrigger => valid */
-                  pSIDEntry->dLastAccessHTTPTimeSec = OS_TimeGetSeconds();
-               
-                  nSIDEntry = nIndex;
-               }
-            }
-            else
-            {
-               /* Check CGI timeout */       
-               if (OS_TEST_TIMEOUT(OS_TimeGetSeconds(), pSIDEntry->dLastAccessCGITimeSec, SID_TIMEOUT_SEC))
-               {
-                  /* Timeout => not valid anymore */
-                  nSIDEntry = -1;
-                  pSIDEntry->nAccessGranted = 0;
-               }
-               else
-               {
-                  /* Retrigger => valid */
-                  pSIDEntry->dLastAccessCGITimeSec = OS_TimeGetSeconds();
-               
-                  nSIDEntry = nIndex;
-               }
-            }             
-         }
+         req->req_sid_user = xstrdup(XM_ID_WEB, UserList[pSIDEntry->nUserIndex].User);
       }
    }
+   
+   OS_RES_FREE(&SIDSema);
       
    return(nSIDEntry);
 } /* WebSidCheck */
@@ -718,55 +1020,49 @@ int WebSidCheckAccessGranted (HTTPD_SESSION *hs, char *pSessionID, int nIsHttp)
    int      nIndex;
    sid_t   *pSIDEntry = NULL;
    uint32_t dIPAddr;
-   char      Hex[3];
 
    /* Get source IP address */   
    dIPAddr = hs->s_stream->strm_caddr.sin_addr.s_addr;
    
-   if (pSessionID != NULL)
+   OS_RES_LOCK(&SIDSema);
+   
+   nIndex = SIDFind(pSessionID, dIPAddr);
+   if (nIndex != -1)
    {
-      Hex[0] = pSessionID[0];
-      Hex[1] = pSessionID[1];
-      Hex[2] = 0;
-      nIndex = atoi(Hex);
+      pSIDEntry = &SIDList[nIndex];
       
-      if (nIndex < SID_LIST_CNT)
-      {
-         pSIDEntry = &SIDList[nIndex];
-         
-         if( (dIPAddr == pSIDEntry->dIPAddr)                       &&
-             (0 == memcmp(pSIDEntry->StrSID, pSessionID, SID_LEN)) &&
-             (1 == pSIDEntry->nAccessGranted)                      )
-         {      
-            if (WEB_SID_HTTP == nIsHttp)
+      if (1 == pSIDEntry->nAccessGranted)
+      {      
+         if (WEB_SID_HTTP == nIsHttp)
+         {
+            /* Check HTTP timeout */       
+            if (OS_TEST_TIMEOUT(OS_TimeGetSeconds(), pSIDEntry->dLastAccessHTTPTimeSec, SID_TIMEOUT_SEC))
             {
-               /* Check HTTP timeout */       
-               if (OS_TEST_TIMEOUT(OS_TimeGetSeconds(), pSIDEntry->dLastAccessHTTPTimeSec, SID_TIMEOUT_SEC))
-               {
-                  /* Timeout => not valid anymore */
-                  pSIDEntry->nAccessGranted = 0;
-               }
-               else
-               {
-                  nGranted = 1;
-               }
+               /* Timeout => not valid anymore */
+               pSIDEntry->nAccessGranted = 0;
             }
             else
             {
-               /* Check CGI timeout */       
-               if (OS_TEST_TIMEOUT(OS_TimeGetSeconds(), pSIDEntry->dLastAccessCGITimeSec, SID_TIMEOUT_SEC))
-               {
-                  /* Timeout => not valid anymore */
-                  pSIDEntry->nAccessGranted = 0;
-               }
-               else
-               {
-                  nGranted = 1;
-               }
-            }             
+               nGranted = 1;
+            }
          }
+         else
+         {
+            /* Check CGI timeout */       
+            if (OS_TEST_TIMEOUT(OS_TimeGetSeconds(), pSIDEntry->dLastAccessCGITimeSec, SID_TIMEOUT_SEC))
+            {
+               /* Timeout => not valid anymore */
+               pSIDEntry->nAccessGranted = 0;
+            }
+            else
+            {
+               nGranted = 1;
+            }
+         }             
       }
    }
+   
+   OS_RES_FREE(&SIDSema);
       
    return(nGranted);
 } /* WebSidCheckAccessGranted */
@@ -789,8 +1085,10 @@ int WebSidCheckUserPass (HTTPD_SESSION *hs, char *pUser, char *pPass)
    sid_t       *pSIDEntry;   
    HTTP_REQUEST *req = &hs->s_req;
    
+   OS_RES_LOCK(&SIDSema);
+   
    /* Check first if the SID is valid */
-   nSIDEntry = WebSidCheck(hs, req->req_sid, FALSE); 
+   nSIDEntry = SIDCheck(hs, req->req_sid, FALSE); 
    if (nSIDEntry != -1)
    {
       pSIDEntry = &SIDList[nSIDEntry];
@@ -812,7 +1110,9 @@ int WebSidCheckUserPass (HTTPD_SESSION *hs, char *pUser, char *pPass)
          pSIDEntry->dPermission    = 0;
       }
    }
-   
+
+   OS_RES_FREE(&SIDSema);
+
    return(nValid);
 } /* WebSidCheckUserPass */
 
@@ -828,80 +1128,23 @@ int WebSidCheckUserPass (HTTPD_SESSION *hs, char *pUser, char *pPass)
 void WebSidInvalidate (HTTPD_SESSION *hs)
 {
    char    *pSessionID = hs->s_req.req_sid;
-   sid_t   *pSIDEntry;
    uint32_t dIPAddr;
    int      nIndex;
-   char      Hex[3];
 
    /* Get source IP address */   
    dIPAddr = hs->s_stream->strm_caddr.sin_addr.s_addr;
    
-   if (pSessionID != NULL)
-   {
-      Hex[0] = pSessionID[0];
-      Hex[1] = pSessionID[1];
-      Hex[2] = 0;
-      nIndex = atoi(Hex);
-      
-      if (nIndex < SID_LIST_CNT)
-      {
-         pSIDEntry = &SIDList[nIndex];
-         
-         if( (dIPAddr == pSIDEntry->dIPAddr)                       &&
-             (0 == memcmp(pSIDEntry->StrSID, pSessionID, SID_LEN)) )
-         {
-            pSIDEntry->dIPAddr        = 0;
-            pSIDEntry->nAccessGranted = 0;
-         }             
-      }
-   }
+   OS_RES_LOCK(&SIDSema);
    
-} /* WebSidInvalidate */
-
-/*************************************************************************/
-/*  WebSidGetPermission                                                  */
-/*                                                                       */
-/*  Return the permission for session.                                   */
-/*                                                                       */
-/*  In    : nSIDEntry                                                    */
-/*  Out   : none                                                         */
-/*  Return: dPermission                                                  */
-/*************************************************************************/
-uint32_t WebSidGetPermission (int nSIDEntry)
-{
-   uint32_t dPermission = 0;
-
-   if (nSIDEntry < SID_LIST_CNT)
+   nIndex = SIDFind(pSessionID, dIPAddr);
+   if (nIndex != -1)
    {
-      dPermission = SIDList[nSIDEntry].dPermission;
+      SIDRemove(nIndex);
    }
    
-   return(dPermission);
-} /* WebSidGetPermission */
-
-/*************************************************************************/
-/*  WebSidGetUser                                                        */
-/*                                                                       */
-/*  Return the user for the session.                                     */
-/*                                                                       */
-/*  In    : nSIDEntry                                                    */
-/*  Out   : none                                                         */
-/*  Return: NULL = invalid / otherwise user pointer                      */
-/*************************************************************************/
-char *WebSidGetUser (int nSIDEntry)
-{
-   char *pUser = NULL;
-
-   if (nSIDEntry < SID_LIST_CNT)
-   {
-      if (SIDList[nSIDEntry].nUserIndex != -1)
-      {
-         pUser = xstrdup(XM_ID_WEB, UserList[SIDList[nSIDEntry].nUserIndex].User);
-      }
-   }
+   OS_RES_FREE(&SIDSema);
    
-   return(pUser);
-} /* WebSidGetUser */
+} /* WebSidInvalidate */
 
 /*************************************************************************/
 /*  WebSidSetNewPass                                                     */
@@ -930,8 +1173,10 @@ int WebSidSetNewPass (HTTPD_SESSION *hs, char *pPassUser, char *pPassNewEncoded)
    /* Convert string hash to binary hash */
    ConvStrHash2BinHash(UserHash, pPassUser);
       
+   OS_RES_LOCK(&SIDSema);
+   
    /* Check first if the SID is valid */
-   nSIDEntry = WebSidCheck(hs, hs->s_req.req_sid, FALSE);
+   nSIDEntry = SIDCheck(hs, hs->s_req.req_sid, FALSE);
    if (nSIDEntry != -1)
    {
       pSIDEntry = &SIDList[nSIDEntry];
@@ -967,8 +1212,10 @@ int WebSidSetNewPass (HTTPD_SESSION *hs, char *pPassUser, char *pPassNewEncoded)
          }
          break;      
       }   
-   }   
-   
+   }
+
+   OS_RES_FREE(&SIDSema);
+
    return(nValid);
 } /* WebSidSetNewPass */
 
@@ -1025,11 +1272,16 @@ char *WebSidParseCookie (char *pCookie)
    
    return(NULL);
 }
-char *WebSidCreateNonce (HTTPD_SESSION *hs)
+int WebSidCreateNonce (HTTPD_SESSION *hs, char *pNonce, int nSize)
 {
    (void)hs;
    
-   return(NULL);
+   if ((pNonce != NULL) && (nSize > 0))
+   {
+      pNonce[0] = 0;
+   }
+   
+   return(-1);
 }
 int  WebSidCheckUserPass (HTTPD_SESSION *hs, char *pUser, char *pPass)
 {
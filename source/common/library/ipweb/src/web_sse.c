@@ -0,0 +1,452 @@
+/**************************************************************************
+*  Copyright (c) 2026 by Michael Fischer (www.emb4fun.de).
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without 
+*  modification, are permitted provided that the following conditions 
+*  are met:
+*  
+*  1. Redistributions of source code must retain the above copyright 
+*     notice, this list of conditions and the following disclaimer.
+*
+*  2. Redistributions in binary form must reproduce the above copyright
+*     notice, this list of conditions and the following disclaimer in the 
+*     documentation and/or other materials provided with the distribution.
+*
+*  3. Neither the name of the author nor the names of its contributors may 
+*     be used to endorse or promote products derived from this software 
+*     without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS 
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL 
+*  THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, 
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS 
+*  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF 
+*  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+*  SUCH DAMAGE.
+*
+***************************************************************************
+*  History:
+*
+*  16.10.2026  mifi  First Version.
+*  17.10.2026  mifi  Each event has its own budget, truncation is reported.
+**************************************************************************/
+#define __WEB_SSE_C__
+
+/*=======================================================================*/
+/*  Includes                                                             */
+/*=======================================================================*/
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "tcts.h"
+#include "ipweb.h"
+#include "web_sse.h"
+
+/*=======================================================================*/
+/*  All Structures and Common Constants                                  */
+/*=======================================================================*/
+
+/* Number of connections which can subscribe at the same time */
+#if !defined(IP_WEB_SSE_MAX_CLIENTS)
+#define _SSE_MAX_CLIENTS      2
+#else
+#define _SSE_MAX_CLIENTS      IP_WEB_SSE_MAX_CLIENTS
+#endif
+
+/* Size of one frame, all events of one sample */
+#if !defined(IP_WEB_SSE_FRAME_SIZE)
+#define _SSE_FRAME_SIZE       2048
+#else
+#define _SSE_FRAME_SIZE       IP_WEB_SSE_FRAME_SIZE
+#endif
+
+/* Room for the "\n\n" which ends an event */
+#define _SSE_EVENT_END        2
+
+typedef struct _sse_frame_
+{
+   uint32_t dSeq;
+   uint16_t wLen;
+   uint8_t  bReaders;
+   char     Data[_SSE_FRAME_SIZE];
+} sse_frame_t;
+
+/*=======================================================================*/
+/*  Definition of all local Data                                         */
+/*=======================================================================*/
+
+static OS_SEMA           SseSema;
+static OS_SEMA          *SubscriberList[_SSE_MAX_CLIENTS];
+
+/*
+ * Two frames, the sample function fills the one which is not the
+ * latest. A subscriber only holds a frame while it is sending it.
+ */
+static sse_frame_t       FrameList[2];
+static sse_frame_t      *pLatest = NULL;
+
+static web_sse_sample_t *pSampleFunc = NULL;
+static uint32_t          dIntervalTicks;
+static uint32_t          dLastSample;
+static uint32_t          dSeq = 0;
+
+static web_sse_stats_t   Stats;
+
+/*=======================================================================*/
+/*  Definition of all local Procedures                                   */
+/*=======================================================================*/
+
+/*************************************************************************/
+/*  Sample                                                               */
+/*                                                                       */
+/*  Create a new frame and wake up all subscribers, SseSema must be      */
+/*  locked. If both frames are in use by slow subscribers, the sample    */
+/*  is skipped and the latest frame remains valid.                       */
+/*                                                                       */
+/*  In    : dNow                                                         */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void Sample (uint32_t dNow)
+{
+   sse_frame_t   *pFrame;
+   web_sse_buf_t  Buf;
+   int            nIndex;
+   
+   dLastSample = dNow;
+   
+   pFrame = (pLatest == &FrameList[0]) ? &FrameList[1] : &FrameList[0];
+   if (pFrame->bReaders != 0)
+   {
+      Stats.dSkipped++;
+      return;
+   }
+   
+   web_SSEBufInit(&Buf, pFrame->Data, sizeof(pFrame->Data));
+   
+   pSampleFunc(&Buf);
+   
+   if (Buf.bTrunc)
+   {
+      Stats.dTruncated++;
+   }
+   
+   pFrame->wLen = Buf.wLen;
+   pFrame->dSeq = ++dSeq;
+   pLatest      = pFrame;
+   Stats.dSamples++;
+   
+   /* 
+    * The semaphore of a subscriber counts up to one only, a subscriber
+    * which is still sending will see the latest frame only.
+    */
+   for (nIndex = 0; nIndex < _SSE_MAX_CLIENTS; nIndex++)
+   {
+      if (SubscriberList[nIndex] != NULL)
+      {
+         OS_SemaSignalNoSched(SubscriberList[nIndex]);
+      }
+   }
+   
+} /* Sample */
+
+/*=======================================================================*/
+/*  All code exported                                                    */
+/*=======================================================================*/
+
+/*************************************************************************/
+/*  web_SSEInit                                                          */
+/*                                                                       */
+/*  In    : pSample, dIntervalMs                                         */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+void web_SSEInit (web_sse_sample_t *pSample, uint32_t dIntervalMs)
+{
+   OS_RES_CREATE(&SseSema);
+   
+   memset(SubscriberList, 0x00, sizeof(SubscriberList));
+   memset(&Stats, 0x00, sizeof(Stats));
+   
+   pSampleFunc    = pSample;
+   dIntervalTicks = OS_MS_2_TICKS(dIntervalMs);
+   
+} /* web_SSEInit */
+
+/*************************************************************************/
+/*  web_SSERun                                                           */
+/*                                                                       */
+/*  Subscribe the connection and send the frames until the connection    */
+/*  is closed. The subscriber which finds the latest frame too old       */
+/*  creates the next one, therefore nothing is sampled as long as        */
+/*  nobody is listening.                                                 */
+/*                                                                       */
+/*  In    : hs                                                           */
+/*  Out   : none                                                         */
+/*  Return: 0 = OK / -1 = ERROR                                          */
+/*************************************************************************/
+int web_SSERun (HTTPD_SESSION *hs)
+{
+   OS_SEMA      Wake;
+   sse_frame_t *pFrame;
+   uint32_t     dSent = 0;
+   uint32_t     dAge;
+   int          nSlot;
+   int          rc = 0;
+   
+   if (NULL == pSampleFunc)
+   {
+      HttpSendError(hs, 404);
+      return(-1);
+   }
+   
+   OS_SemaCreate(&Wake, 0, 1);
+   
+   OS_RES_LOCK(&SseSema);
+   for (nSlot = 0; nSlot < _SSE_MAX_CLIENTS; nSlot++)
+   {
+      if (NULL == SubscriberList[nSlot])
+      {
+         SubscriberList[nSlot] = &Wake;
+         Stats.dSubscribers++;
+         break;
+      }
+   }
+   if (_SSE_MAX_CLIENTS == nSlot)
+   {
+      Stats.dRejected++;
+   }
+   OS_RES_FREE(&SseSema);
+   
+   if (_SSE_MAX_CLIENTS == nSlot)
+   {
+      /* The page falls back to polling */
+      OS_SemaDelete(&Wake);
+      HttpSendError(hs, 503);
+      return(0);
+   }
+   
+   /* The event stream ends with the connection */
+   hs->s_req.req_connection = HTTP_CONN_CLOSE;
+   HttpSendHeaderSse(hs);
+   
+   while (rc >= 0)
+   {
+      OS_RES_LOCK(&SseSema);
+      
+      if ((NULL == pLatest) || ((OS_TimeGet() - dLastSample) >= dIntervalTicks))
+      {
+         Sample(OS_TimeGet());
+      }
+      
+      pFrame = NULL;
+      if ((pLatest != NULL) && (pLatest->dSeq != dSent))
+      {
+         pFrame = pLatest;
+         pFrame->bReaders++;
+         
+         if (dSent != 0)
+         {
+            Stats.dDropped += pFrame->dSeq - dSent - 1;
+         }
+      }
+      
+      dAge = OS_TimeGet() - dLastSample;
+      
+      OS_RES_FREE(&SseSema);
+      
+      if (pFrame != NULL)
+      {
+         rc = s_write(pFrame->Data, 1, pFrame->wLen, hs->s_stream);
+         if (rc >= 0)
+         {
+            rc = s_flush(hs->s_stream);
+         }
+         dSent = pFrame->dSeq;
+         
+         OS_RES_LOCK(&SseSema);
+         pFrame->bReaders--;
+         Stats.dSent++;
+         OS_RES_FREE(&SseSema);
+      }
+      
+      if (rc >= 0)
+      {
+         /* Wait for the next frame, or become the sampler */
+         dAge = (dAge < dIntervalTicks) ? (dIntervalTicks - dAge) : 1;
+         OS_SemaWait(&Wake, OS_TICKS_2_MS(dAge));
+      }
+   }
+   
+   OS_RES_LOCK(&SseSema);
+   SubscriberList[nSlot] = NULL;
+   Stats.dSubscribers--;
+   OS_RES_FREE(&SseSema);
+   
+   OS_SemaDelete(&Wake);
+   
+   return(0);
+} /* web_SSERun */
+
+/*************************************************************************/
+/*  web_SSEGetStats                                                      */
+/*                                                                       */
+/*  In    : pStats                                                       */
+/*  Out   : pStats                                                       */
+/*  Return: none                                                         */
+/*************************************************************************/
+void web_SSEGetStats (web_sse_stats_t *pStats)
+{
+   OS_RES_LOCK(&SseSema);
+   *pStats = Stats;
+   OS_RES_FREE(&SseSema);
+   
+} /* web_SSEGetStats */
+
+/*************************************************************************/
+/*  web_SSEBufInit                                                       */
+/*                                                                       */
+/*  In    : pBuf, pData, wSize                                           */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+void web_SSEBufInit (web_sse_buf_t *pBuf, char *pData, uint16_t wSize)
+{
+   pBuf->pData  = pData;
+   pBuf->pTrunc = NULL;
+   pBuf->wSize  = wSize;
+   pBuf->wLen   = 0;
+   pBuf->bFull  = 0;
+   pBuf->bOpen  = 0;
+   pBuf->bTrunc = 0;
+   
+} /* web_SSEBufInit */
+
+/*************************************************************************/
+/*  web_SSEPrintf                                                        */
+/*                                                                       */
+/*  Append to the frame. Output which does not fit is removed, and the   */
+/*  buffer, or the open event, is marked as full.                        */
+/*                                                                       */
+/*  In    : pBuf, fmt                                                    */
+/*  Out   : none                                                         */
+/*  Return: 0 = OK / -1 = ERROR                                          */
+/*************************************************************************/
+int web_SSEPrintf (web_sse_buf_t *pBuf, const char *fmt, ...)
+{
+   va_list ap;
+   int     nFree;
+   int     nLen;
+   
+   if (pBuf->bFull)
+   {
+      return(-1);
+   }
+   
+   nFree = pBuf->wSize - pBuf->wLen;
+   if (nFree <= 0)
+   {
+      pBuf->bFull = 1;
+      return(-1);
+   }
+   
+   va_start(ap, fmt);
+   nLen = vsnprintf(&pBuf->pData[pBuf->wLen], (size_t)nFree, fmt, ap);
+   va_end(ap);
+   
+   if ((nLen < 0) || (nLen >= nFree))
+   {
+      pBuf->bFull = 1;
+      return(-1);
+   }
+   pBuf->wLen += (uint16_t)nLen;
+   
+   return(0);
+} /* web_SSEPrintf */
+
+/*************************************************************************/
+/*  web_SSEEventBegin                                                    */
+/*                                                                       */
+/*  Start an event, the data of the event must not contain a newline.    */
+/*  The event gets the room which is left by the events before. The      */
+/*  room for the end of the event and the text pTrunc is reserved here.  */
+/*  pTrunc replaces the output which does not fit, it can be NULL.       */
+/*                                                                       */
+/*  In    : pBuf, pName, pTrunc                                          */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+void web_SSEEventBegin (web_sse_buf_t *pBuf, const char *pName, const char *pTrunc)
+{
+   uint16_t wReserve;
+   
+   if (pBuf->bOpen)
+   {
+      return;
+   }
+   
+   pBuf->pTrunc = (pTrunc != NULL) ? pTrunc : "";
+   wReserve     = (uint16_t)(_SSE_EVENT_END + strlen(pBuf->pTrunc));
+   if ((pBuf->wLen + wReserve) >= pBuf->wSize)
+   {
+      /* No room left, the event is skipped */
+      pBuf->bTrunc = 1;
+      return;
+   }
+   
+   pBuf->bFull  = 0;
+   pBuf->wSize -= wReserve;
+   if (0 == web_SSEPrintf(pBuf, "event: %s\ndata: ", pName))
+   {
+      pBuf->bOpen = 1;
+   }
+   else
+   {
+      pBuf->wSize += wReserve;
+      pBuf->bTrunc = 1;
+   }
+   
+} /* web_SSEEventBegin */
+
+/*************************************************************************/
+/*  web_SSEEventEnd                                                      */
+/*                                                                       */
+/*  End the event, this uses the reserved room and cannot fail. If       */
+/*  output of the event was removed, the truncation text is added.       */
+/*                                                                       */
+/*  In    : pBuf                                                         */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+void web_SSEEventEnd (web_sse_buf_t *pBuf)
+{
+   size_t Len;
+   
+   if (pBuf->bOpen)
+   {
+      Len = strlen(pBuf->pTrunc);
+      pBuf->wSize += (uint16_t)(_SSE_EVENT_END + Len);
+      
+      if (pBuf->bFull)
+      {
+         memcpy(&pBuf->pData[pBuf->wLen], pBuf->pTrunc, Len);
+         pBuf->wLen  += (uint16_t)Len;
+         pBuf->bTrunc = 1;
+      }
+      
+      pBuf->pData[pBuf->wLen++] = '\n';
+      pBuf->pData[pBuf->wLen++] = '\n';
+      pBuf->bOpen = 0;
+   }
+   
+} /* web_SSEEventEnd */
+
+/*** EOF ***/
@@ -36,6 +36,8 @@
 *  25.01.2015  mifi  First Version.
 *  13.03.2016  mifi  Renamed to web_asp.c.
 *  29.12.2018  mifi  Renamed to web_ssi.c.
+*  16.10.2026  mifi  Added HttpSsiLookupExt for the compiled SSI files.
+*  17.10.2026  mifi  The NONCE is copied to a local buffer.
 **************************************************************************/
 #define __WEB_SSI_C__
 
@@ -59,6 +61,7 @@
 
 #include <pro/uhttp/uhttpd.h>
 #include <pro/uhttp/streamio.h>
+#include <pro/uhttp/modules/mod_ssi.h>
 
 #if !defined(IP_WEB_SSI_EXT_CST) 
 #define _IP_WEB_SSI_EXT_CST   0
@@ -255,12 +258,11 @@ static int sys_login_user (HTTPD_SESSION *hs)
 /*************************************************************************/
 static int sys_nonce (HTTPD_SESSION *hs)
 {
-   char *pNonce;
+   char Nonce[WEB_SID_NONCE_SIZE];
    
-   pNonce = WebSidCreateNonce(hs);
-   if (pNonce != NULL)
+   if (0 == WebSidCreateNonce(hs, Nonce, sizeof(Nonce)))
    {
-      s_printf(hs->s_stream, "%s", pNonce);
+      s_printf(hs->s_stream, "%s", Nonce);
    }
    else
    {
@@ -1222,20 +1224,19 @@ void web_SSIStart (void)
 } /* web_SSIStart */
 
 /*************************************************************************/
-/*  HttpSsiParseExt                                                      */
+/*  HttpSsiLookupExt                                                     */
 /*                                                                       */
-/*  In    : hs, buf, len                                                 */
+/*  Find the handler of an ASP variable, the name is not terminated.     */
+/*                                                                       */
+/*  In    : name, len                                                    */
 /*  Out   : none                                                         */
-/*  Return: 0 = OK / -1 = Error                                          */
+/*  Return: Handler / NULL = not found                                   */
 /*************************************************************************/
-int HttpSsiParseExt (HTTPD_SESSION *hs, char *buf, int len)
+HTTP_SSI_EXTHANDLER HttpSsiLookupExt (const char *name, int len)
 {
-   int                  res = -1;
    uint16_t             ListIndex = 0;
    SSI_EXT_LIST_ENTRY *pList;
    
-   buf[len] = 0;
-
    /* Loop over the registered lists */   
    while ((ListIndex != MAX_SSI_LIST_ENTRY) && (ListTable[ListIndex] != NULL))
    {
@@ -1245,11 +1246,9 @@ int HttpSsiParseExt (HTTPD_SESSION *hs, char *buf, int len)
       /* Loop over the actual list */   
       while(pList->Var != NULL)
       {
-         if (0 == strcasecmp(pList->Var, buf))
+         if ((0 == strncasecmp(pList->Var, name, (size_t)len)) && (0 == pList->Var[len]))
          {
-            res = pList->pFunc(hs);
-            return(res);
-            break;   /*lint !e527*/
+            return(pList->pFunc);
          }
          
          /* Switch to next entry inside the list */
@@ -1260,7 +1259,27 @@ int HttpSsiParseExt (HTTPD_SESSION *hs, char *buf, int len)
       ListIndex++;
    }      
    
-   return(-1);
+   return(NULL);
+} /* HttpSsiLookupExt */
+
+/*************************************************************************/
+/*  HttpSsiParseExt                                                      */
+/*                                                                       */
+/*  In    : hs, buf, len                                                 */
+/*  Out   : none                                                         */
+/*  Return: 0 = OK / -1 = Error                                          */
+/*************************************************************************/
+int HttpSsiParseExt (HTTPD_SESSION *hs, char *buf, int len)
+{
+   HTTP_SSI_EXTHANDLER pFunc;
+   
+   pFunc = HttpSsiLookupExt(buf, len);
+   if (NULL == pFunc)
+   {
+      return(-1);
+   }
+   
+   return(pFunc(hs));
 } /* HttpSsiParseExt */
 
 /*** EOF ***/
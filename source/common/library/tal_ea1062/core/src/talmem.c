@@ -36,6 +36,8 @@
 *  History:
 *
 *  30.06.2018  mifi  First Version.
+*  16.10.2026  mifi  Added optional TLSF allocator.
+*  17.10.2026  mifi  TLSF first level covers the largest heap memory.
 **************************************************************************/
 #define __TALMEM_C__
 
@@ -44,11 +46,16 @@
  * See: https://barrgroup.com/Embedded-Systems/How-To/Malloc-Free-Dynamic-Memory-Allocation
  *
  * Here the free list "First Fit" allocate and "Address Order" free management is used.
+ *
+ * Optional a "Two-Level Segregated Fit" (TLSF) allocator can be used, where
+ * allocate and free are O(1). See: http://www.gii.upv.es/tlsf/
+ * Set TAL_MEM_SUPPORT_TLSF to 1 in tal_conf.h to enable it.
  */
 
 /*=======================================================================*/
 /*  Include                                                              */
 /*=======================================================================*/
+#include <stddef.h>
 #include <string.h>
 #include "tal.h"
 
@@ -73,6 +80,12 @@ extern uint32_t TAL_HEAP_MEM2_END;
 #define SUPPORT_BIG_MEM    TAL_MEM_SUPPORT_BIG_MEM
 #endif
 
+#if !defined(TAL_MEM_SUPPORT_TLSF)
+#define SUPPORT_TLSF       0
+#else
+#define SUPPORT_TLSF       TAL_MEM_SUPPORT_TLSF
+#endif
+
 /*=======================================================================*/
 /*  All Structures and Common Constants                                  */
 /*=======================================================================*/
@@ -93,13 +106,51 @@ typedef struct _mem_hdr_
 } mem_hdr_t;   
 
 
+#if (SUPPORT_TLSF >= 1)
+/*
+ * TLSF block header. The header of a used block is compatible to 
+ * mem_hdr_t, the free list pointers are only valid if the block is
+ * free, and are located in the user data area.
+ */
+typedef struct _tlsf_blk_
+{
+   struct _tlsf_blk_ *pPrevPhys;    /* Physical previous block */
+   uint32_t           dSize;        /* Size incl. header, flags and ID */
+   
+#if (SUPPORT_BIG_MEM >= 1)
+   uint32_t           dListID;
+   uint32_t           dSpare;
+#endif
+
+   struct _tlsf_blk_ *pNextFree;
+   struct _tlsf_blk_ *pPrevFree;
+} tlsf_blk_t;
+
+/*
+ * TLSF control structure, located at the start of the pool
+ */
+typedef struct _tlsf_ctl_
+{
+   uint32_t     dFLBitmap;
+   uint32_t     dFLCount;
+   uint32_t     dMaxSize;
+   uint32_t    *pSLBitmap;          /* [dFLCount] */
+   tlsf_blk_t **pFree;              /* [dFLCount][TLSF_SL_COUNT] */
+} tlsf_ctl_t;
+#endif
+
+
 /*
  * Memory context
  */
 typedef struct _mem_ctx_
 {
    const char  *pName;
+#if (SUPPORT_TLSF == 0)
    mem_hdr_t   *pFreelist;
+#else
+   tlsf_ctl_t  *pTLSF;
+#endif   
    uint32_t     dSize;
    int32_t       UsedRawMemory;
    int32_t       UsedRawMemoryMax;
@@ -118,6 +169,36 @@ typedef struct _mem_ctx_
 #define MEM_ALIGN       16
 #endif
 
+
+#if (SUPPORT_TLSF >= 1)
+
+#if (SUPPORT_BIG_MEM == 0)
+#define TLSF_ALIGN_LOG2    3
+#else
+#define TLSF_ALIGN_LOG2    4
+#endif
+
+/* Second level, each first level range is split in 16 lists */
+#define TLSF_SL_LOG2       4
+#define TLSF_SL_COUNT      (1 << TLSF_SL_LOG2)
+
+/* Blocks smaller than TLSF_SMALL_BLOCK are handled by the first level 0 */
+#define TLSF_FL_SHIFT      (TLSF_SL_LOG2 + TLSF_ALIGN_LOG2)
+#define TLSF_SMALL_BLOCK   (1 << TLSF_FL_SHIFT)
+
+#define TLSF_HDR_SIZE      offsetof(tlsf_blk_t, pNextFree)
+#define TLSF_MIN_BLOCK     ((sizeof(tlsf_blk_t) + (MEM_ALIGN - 1)) & ~(MEM_ALIGN - 1))
+
+/* The size is aligned, the lower bits are free for the flags */
+#define TLSF_FLAG_FREE     0x00000001
+#define TLSF_FLAG_MASK     (MEM_ALIGN - 1)
+
+#define BLK_SIZE(_b)       ((_b)->dSize & MEM_MAX_SIZE & ~TLSF_FLAG_MASK)
+#define BLK_IS_FREE(_b)    ((_b)->dSize & TLSF_FLAG_FREE)
+#define BLK_NEXT(_b)       ((tlsf_blk_t*)((uint32_t)(_b) + BLK_SIZE(_b)))
+
+#endif /* (SUPPORT_TLSF >= 1) */
+
 /*=======================================================================*/
 /*  Definition of all local Data                                         */
 /*=======================================================================*/
@@ -129,6 +210,442 @@ static mem_ctx_t MemList[MEM_LIST_COUNT];
 /*  Definition of all local Procedures                                   */
 /*=======================================================================*/
 
+#if (SUPPORT_TLSF >= 1)
+
+/*************************************************************************/
+/*  TLSFfls                                                              */
+/*                                                                       */
+/*  Return the index of the most significant bit which is set.           */
+/*                                                                       */
+/*  In    : dValue (must not be 0)                                       */
+/*  Out   : none                                                         */
+/*  Return: Bit index                                                    */
+/*************************************************************************/
+static __inline__ uint32_t TLSFfls (uint32_t dValue)
+{
+   return(31 - (uint32_t)__builtin_clz(dValue));
+} /* TLSFfls */
+
+/*************************************************************************/
+/*  TLSFffs                                                              */
+/*                                                                       */
+/*  Return the index of the least significant bit which is set.          */
+/*                                                                       */
+/*  In    : dValue (must not be 0)                                       */
+/*  Out   : none                                                         */
+/*  Return: Bit index                                                    */
+/*************************************************************************/
+static __inline__ uint32_t TLSFffs (uint32_t dValue)
+{
+   return((uint32_t)__builtin_ctz(dValue));
+} /* TLSFffs */
+
+/*************************************************************************/
+/*  TLSFMapping                                                          */
+/*                                                                       */
+/*  Calculate the first and second level index of a block size.          */
+/*                                                                       */
+/*  In    : dSize, pFL, pSL                                              */
+/*  Out   : pFL, pSL                                                     */
+/*  Return: none                                                         */
+/*************************************************************************/
+static __inline__ void TLSFMapping (uint32_t dSize, uint32_t *pFL, uint32_t *pSL)
+{
+   uint32_t dFLS;
+   
+   if (dSize < TLSF_SMALL_BLOCK)
+   {
+      /* Small blocks, the second level is linear */
+      *pFL = 0;
+      *pSL = dSize >> TLSF_ALIGN_LOG2;
+   }
+   else
+   {
+      dFLS = TLSFfls(dSize);
+      *pSL = (dSize >> (dFLS - TLSF_SL_LOG2)) ^ TLSF_SL_COUNT;
+      *pFL = dFLS - (TLSF_FL_SHIFT - 1);
+   }
+   
+} /* TLSFMapping */
+
+/*************************************************************************/
+/*  TLSFInsert                                                           */
+/*                                                                       */
+/*  Insert a free block in the list of its size class.                   */
+/*                                                                       */
+/*  In    : pCtl, pBlk                                                   */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void TLSFInsert (tlsf_ctl_t *pCtl, tlsf_blk_t *pBlk)
+{
+   uint32_t     dFL;
+   uint32_t     dSL;
+   tlsf_blk_t **ppHead;
+   
+   TLSFMapping(BLK_SIZE(pBlk), &dFL, &dSL);
+   ppHead = &pCtl->pFree[(dFL * TLSF_SL_COUNT) + dSL];
+   
+   pBlk->dSize    |= TLSF_FLAG_FREE;
+   pBlk->pPrevFree = NULL;
+   pBlk->pNextFree = *ppHead;
+   if (*ppHead != NULL)
+   {
+      (*ppHead)->pPrevFree = pBlk;
+   }
+   *ppHead = pBlk;
+   
+   pCtl->dFLBitmap      |= (1UL << dFL);
+   pCtl->pSLBitmap[dFL] |= (1UL << dSL);
+   
+} /* TLSFInsert */
+
+/*************************************************************************/
+/*  TLSFRemove                                                           */
+/*                                                                       */
+/*  Remove a free block from the list of its size class.                 */
+/*                                                                       */
+/*  In    : pCtl, pBlk                                                   */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void TLSFRemove (tlsf_ctl_t *pCtl, tlsf_blk_t *pBlk)
+{
+   uint32_t     dFL;
+   uint32_t     dSL;
+   tlsf_blk_t **ppHead;
+   
+   TLSFMapping(BLK_SIZE(pBlk), &dFL, &dSL);
+   ppHead = &pCtl->pFree[(dFL * TLSF_SL_COUNT) + dSL];
+
+   if (pBlk->pNextFree != NULL)
+   {
+      pBlk->pNextFree->pPrevFree = pBlk->pPrevFree;
+   }
+   
+   if (pBlk->pPrevFree != NULL)
+   {
+      pBlk->pPrevFree->pNextFree = pBlk->pNextFree;
+   }
+   else
+   {
+      /* First block of the list */
+      *ppHead = pBlk->pNextFree;
+      if (NULL == *ppHead)
+      {
+         pCtl->pSLBitmap[dFL] &= ~(1UL << dSL);
+         if (0 == pCtl->pSLBitmap[dFL])
+         {
+            pCtl->dFLBitmap &= ~(1UL << dFL);
+         }
+      }
+   }
+   
+   pBlk->dSize &= ~TLSF_FLAG_FREE;
+   
+} /* TLSFRemove */
+
+/*************************************************************************/
+/*  TLSFFind                                                             */
+/*                                                                       */
+/*  Find a free block for the given size.                                */
+/*                                                                       */
+/*  In    : pCtl, dSize                                                  */
+/*  Out   : none                                                         */
+/*  Return: pBlk / NULL                                                  */
+/*************************************************************************/
+static tlsf_blk_t *TLSFFind (tlsf_ctl_t *pCtl, uint32_t dSize)
+{
+   tlsf_blk_t *pBlk = NULL;
+   uint32_t    dSearch;
+   uint32_t    dFL;
+   uint32_t    dSL;
+   uint32_t    dMap;
+   
+   /* Round up to the next size class, each block of this class will fit */
+   dSearch = dSize;
+   if (dSearch >= TLSF_SMALL_BLOCK)
+   {
+      dSearch += (1UL << (TLSFfls(dSearch) - TLSF_SL_LOG2)) - 1;
+   }
+   TLSFMapping(dSearch, &dFL, &dSL);
+   
+   if (dFL < pCtl->dFLCount)
+   {
+      /* Find a list with a suitable block */
+      dMap = pCtl->pSLBitmap[dFL] & (~0UL << dSL);
+      if (0 == dMap)
+      {
+         dMap = pCtl->dFLBitmap & (~0UL << (dFL + 1));
+         if (dMap != 0)
+         {
+            dFL  = TLSFffs(dMap);
+            dMap = pCtl->pSLBitmap[dFL];
+         }
+      }
+      
+      if (dMap != 0)
+      {
+         dSL  = TLSFffs(dMap);
+         pBlk = pCtl->pFree[(dFL * TLSF_SL_COUNT) + dSL];
+      }
+   }
+   
+   if (NULL == pBlk)
+   {
+      /* 
+       * No bigger class is available, but a block of the 
+       * own class can still fit. This is only a problem in
+       * case of very big allocations compared to the pool.
+       */
+      TLSFMapping(dSize, &dFL, &dSL);
+      if (dFL < pCtl->dFLCount)
+      {
+         pBlk = pCtl->pFree[(dFL * TLSF_SL_COUNT) + dSL];
+         while ((pBlk != NULL) && (BLK_SIZE(pBlk) < dSize))
+         {
+            pBlk = pBlk->pNextFree;
+         }
+      }
+   }
+   
+   return(pBlk);
+} /* TLSFFind */
+
+/*************************************************************************/
+/*  MEMMalloc                                                            */
+/*                                                                       */
+/*  Allocate memory of the given size.                                   */
+/*  Returns NULL if memory cannot be allocated.                          */
+/*                                                                       */
+/*  In    : ID, dSize                                                    */
+/*  Out   : none                                                         */
+/*  Return: p / NULL                                                     */
+/*************************************************************************/
+static void *MEMMalloc (tal_mem_id ID, uint32_t dSize)
+{
+   tlsf_ctl_t *pCtl = MemList[ID].pTLSF;
+   tlsf_blk_t *pBlk;
+   tlsf_blk_t *pRest;
+   
+   if ((NULL == pCtl) || (dSize > pCtl->dMaxSize))
+   {
+      return(NULL);
+   }
+   
+   /* Align size and add header info */
+   dSize = ((dSize + (MEM_ALIGN - 1)) & ~(MEM_ALIGN - 1)) + TLSF_HDR_SIZE;
+   if (dSize < TLSF_MIN_BLOCK)
+   {
+      dSize = TLSF_MIN_BLOCK;
+   }
+   
+   pBlk = TLSFFind(pCtl, dSize);
+   if (NULL == pBlk)
+   {
+      return(NULL);
+   }
+   
+   TLSFRemove(pCtl, pBlk);
+   
+   /* Split the block if the rest is big enough */
+   if ((BLK_SIZE(pBlk) - dSize) >= TLSF_MIN_BLOCK)
+   {
+      pRest = (tlsf_blk_t*)((uint32_t)pBlk + dSize);
+      pRest->pPrevPhys = pBlk;
+      pRest->dSize     = (pBlk->dSize & ~MEM_MAX_SIZE) | (BLK_SIZE(pBlk) - dSize);
+#if (SUPPORT_BIG_MEM >= 1)
+      pRest->dListID   = (uint32_t)ID;
+      pRest->dSpare    = 0;
+#endif      
+      BLK_NEXT(pRest)->pPrevPhys = pRest;
+      
+      pBlk->dSize = (pBlk->dSize & ~MEM_MAX_SIZE) | dSize;
+      
+      TLSFInsert(pCtl, pRest);
+   }
+   
+   MemList[ID].UsedRawMemory += (int32_t)BLK_SIZE(pBlk);
+   
+   if (MemList[ID].UsedRawMemory > MemList[ID].UsedRawMemoryMax)
+   {
+      MemList[ID].UsedRawMemoryMax = MemList[ID].UsedRawMemory;
+   }
+   
+   return((void*)((uint32_t)pBlk + TLSF_HDR_SIZE));
+} /* MEMMalloc */
+
+/*************************************************************************/
+/*  MEMFree                                                              */
+/*                                                                       */
+/*  Frees the allocated memory.                                          */
+/*                                                                       */
+/*  In    : pBuffer                                                      */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void MEMFree (void *pBuffer)
+{
+   tlsf_ctl_t *pCtl;
+   tlsf_blk_t *pBlk;
+   tlsf_blk_t *pPrev;
+   tlsf_blk_t *pNext;
+   uint32_t    dListID;
+
+   if (pBuffer != NULL)
+   {
+      pBlk = (tlsf_blk_t*)((uint32_t)pBuffer - TLSF_HDR_SIZE);
+      
+      /* Get list ID  */
+#if (SUPPORT_BIG_MEM == 0)
+      dListID = ((pBlk->dSize & 0xF0000000) >> 28);
+#else
+      dListID = pBlk->dListID;
+#endif      
+
+      pCtl = MemList[dListID].pTLSF;
+      
+      MemList[dListID].UsedRawMemory -= (int32_t)BLK_SIZE(pBlk);
+      
+      /* Merge with the previous block */
+      pPrev = pBlk->pPrevPhys;
+      if ((pPrev != NULL) && BLK_IS_FREE(pPrev))
+      {
+         TLSFRemove(pCtl, pPrev);
+         pPrev->dSize += BLK_SIZE(pBlk);
+         pBlk = pPrev;
+         BLK_NEXT(pBlk)->pPrevPhys = pBlk;
+      }
+      
+      /* Merge with the next block, the end of a pool is never free */
+      pNext = BLK_NEXT(pBlk);
+      if (BLK_IS_FREE(pNext))
+      {
+         TLSFRemove(pCtl, pNext);
+         pBlk->dSize += BLK_SIZE(pNext);
+         BLK_NEXT(pBlk)->pPrevPhys = pBlk;
+      }
+      
+      TLSFInsert(pCtl, pBlk);
+
+   } /* end if (pBuffer != NULL) */
+
+} /* MEMFree */
+
+/*************************************************************************/
+/*  MEMAdd                                                               */
+/*                                                                       */
+/*  Add the memroy to the dynamic memory system.                         */
+/*                                                                       */
+/*  The control structure is located at the start of the first memory   */
+/*  which is added to a pool. Its first level is sized for dMaxSize,     */
+/*  the largest memory which will be added to the pool. Each memory is   */
+/*  terminated by a used block without data, this prevents merging       */
+/*  beyond the end.                                                      */
+/*                                                                       */
+/*  In    : ID, pBuffer, dSize, dMaxSize                                 */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void MEMAdd (tal_mem_id ID, void *pBuffer, uint32_t dSize, uint32_t dMaxSize)
+{
+   uint32_t    dAddress;
+   uint32_t    dRest;
+   uint32_t    dFLCount;
+   uint32_t    dCtlSize;
+   uint32_t    dListID;
+   tlsf_ctl_t *pCtl;
+   tlsf_blk_t *pBlk;
+   tlsf_blk_t *pEnd;
+   
+   /* Align address to 8/16 */
+   dAddress  = (uint32_t)pBuffer;
+   dRest     = dAddress % MEM_ALIGN;
+   
+   if ((dRest != 0) && (dSize > 32))
+   {
+      dRest     = MEM_ALIGN - dRest;
+      dAddress += dRest;
+      dSize    -= dRest;
+   }
+   
+   /* Align size to 8/16 */
+   dSize -= dSize % MEM_ALIGN;
+   
+   pCtl = MemList[ID].pTLSF;
+   if (NULL == pCtl)
+   {
+      /* The first level must cover the largest memory of the pool */
+      if (dMaxSize < dSize)
+      {
+         dMaxSize = dSize;
+      }
+      dFLCount = (dMaxSize < TLSF_SMALL_BLOCK) ? 1 : (TLSFfls(dMaxSize) - (TLSF_FL_SHIFT - 1) + 1);
+      dCtlSize = sizeof(tlsf_ctl_t) + (dFLCount * sizeof(uint32_t)) + 
+                 (dFLCount * TLSF_SL_COUNT * sizeof(tlsf_blk_t*));
+      dCtlSize = (dCtlSize + (MEM_ALIGN - 1)) & ~(MEM_ALIGN - 1);
+      
+      if (dSize < (dCtlSize + TLSF_MIN_BLOCK + TLSF_HDR_SIZE))
+      {
+         return;
+      }
+      
+      pCtl = (tlsf_ctl_t*)dAddress;
+      memset(pCtl, 0x00, dCtlSize);
+      pCtl->dFLCount  = dFLCount;
+      pCtl->dMaxSize  = (1UL << (dFLCount + TLSF_FL_SHIFT - 1)) - TLSF_SMALL_BLOCK;
+      pCtl->pSLBitmap = (uint32_t*)((uint32_t)pCtl + sizeof(tlsf_ctl_t));
+      pCtl->pFree     = (tlsf_blk_t**)((uint32_t)pCtl->pSLBitmap + (dFLCount * sizeof(uint32_t)));
+      
+      MemList[ID].pTLSF = pCtl;
+      
+      dAddress += dCtlSize;
+      dSize    -= dCtlSize;
+   }
+   
+   /* A memory which was not announced by dMaxSize can not be used completely */
+   if (dSize > pCtl->dMaxSize)
+   {
+      dSize = pCtl->dMaxSize;
+   }
+   
+   if (dSize < (TLSF_MIN_BLOCK + TLSF_HDR_SIZE))
+   {
+      return;
+   }
+   
+   /* The end block needs only a header */
+   dSize -= TLSF_HDR_SIZE;
+
+#if (SUPPORT_BIG_MEM == 0)
+   dListID = ((uint32_t)ID << 28);
+#else
+   dListID = 0;
+#endif      
+   
+   pBlk = (tlsf_blk_t*)dAddress;
+   pBlk->pPrevPhys = NULL;
+   pBlk->dSize     = dListID | dSize;
+   
+   pEnd = BLK_NEXT(pBlk);
+   pEnd->pPrevPhys = pBlk;
+   pEnd->dSize     = dListID;
+   
+#if (SUPPORT_BIG_MEM >= 1)
+   pBlk->dListID = (uint32_t)ID;
+   pBlk->dSpare  = 0;
+   pEnd->dListID = (uint32_t)ID;
+   pEnd->dSpare  = 0;
+#endif      
+
+   MemList[ID].dSize += dSize;
+   
+   TLSFInsert(pCtl, pBlk);
+
+} /* MEMAdd */
+
+#else /* (SUPPORT_TLSF == 0) */
+
 /*************************************************************************/
 /*  MEMMalloc                                                            */
 /*                                                                       */
@@ -246,29 +763,6 @@ static void *MEMMalloc (tal_mem_id ID, uint32_t dSize)
    return(p);
 } /* MEMMalloc */
 
-/*************************************************************************/
-/*  MEMCalloc                                                            */
-/*                                                                       */
-/*  Allocate memory of the given size, and initialize them to zero.      */
-/*  Returns NULL if memory cannot be allocated.                          */
-/*                                                                       */
-/*  In    : ID, dSize                                                    */
-/*  Out   : none                                                         */
-/*  Return: p / NULL                                                     */
-/*************************************************************************/
-static void *MEMCalloc (tal_mem_id ID, uint32_t dSize)
-{
-   void *p;
-   
-   p = MEMMalloc(ID, dSize);
-   if (p != NULL)
-   {
-      memset(p, 0, dSize);
-   }
-   
-   return(p);
-} /* MEMCalloc */
-
 /*************************************************************************/
 /*  MEMFree                                                              */
 /*                                                                       */
@@ -394,17 +888,19 @@ static void MEMFree (void *pBuffer)
 /*                                                                       */
 /*  Add the memroy to the dynamic memory system.                         */
 /*                                                                       */
-/*  In    : ID, pBuffer, dSize                                           */
+/*  In    : ID, pBuffer, dSize, dMaxSize                                 */
 /*  Out   : none                                                         */
 /*  Return: none                                                         */
 /*************************************************************************/
-static void MEMAdd (tal_mem_id ID, void *pBuffer, uint32_t dSize)
+static void MEMAdd (tal_mem_id ID, void *pBuffer, uint32_t dSize, uint32_t dMaxSize)
 {
    uint32_t   dAddress;
    uint32_t   dRest;
    mem_hdr_t *pMem;
    uint32_t   dListID;
    
+   (void)dMaxSize;
+   
    /* Align address to 8/16 */
    dAddress  = (uint32_t)pBuffer;
    dRest     = dAddress % MEM_ALIGN;
@@ -444,6 +940,31 @@ static void MEMAdd (tal_mem_id ID, void *pBuffer, uint32_t dSize)
 
 } /* MEMAdd */
 
+#endif /* (SUPPORT_TLSF >= 1) */
+
+/*************************************************************************/
+/*  MEMCalloc                                                            */
+/*                                                                       */
+/*  Allocate memory of the given size, and initialize them to zero.      */
+/*  Returns NULL if memory cannot be allocated.                          */
+/*                                                                       */
+/*  In    : ID, dSize                                                    */
+/*  Out   : none                                                         */
+/*  Return: p / NULL                                                     */
+/*************************************************************************/
+static void *MEMCalloc (tal_mem_id ID, uint32_t dSize)
+{
+   void *p;
+   
+   p = MEMMalloc(ID, dSize);
+   if (p != NULL)
+   {
+      memset(p, 0, dSize);
+   }
+   
+   return(p);
+} /* MEMCalloc */
+
 /*=======================================================================*/
 /*  All code exported                                                    */
 /*=======================================================================*/
@@ -457,8 +978,11 @@ static void MEMAdd (tal_mem_id ID, void *pBuffer, uint32_t dSize)
 /*************************************************************************/
 void tal_MEMInit (void)
 {
-   uint32_t dAddr;
-   uint32_t dSize;
+   uint32_t dAddr1 = 0;
+   uint32_t dSize1 = 0;
+   uint32_t dAddr2 = 0;
+   uint32_t dSize2 = 0;
+   uint32_t dMaxSize;
 
    /* 
     * Clear context list first 
@@ -480,38 +1004,51 @@ void tal_MEMInit (void)
    /*lint -restore */ 
    
    /* 
-    * Add memory #1 if available
+    * Get memory #1 if available
     */
 #if defined(TAL_HEAP_MEM1_START)
    /* Get memory pointer */ 
-   dAddr = (uint32_t)&TAL_HEAP_MEM1_START;
-   dSize = ((uint32_t)(&TAL_HEAP_MEM1_END) - (uint32_t)(&TAL_HEAP_MEM1_START)) - 1;
-   if (dSize != (uint32_t)-1)
+   dAddr1 = (uint32_t)&TAL_HEAP_MEM1_START;
+   dSize1 = ((uint32_t)(&TAL_HEAP_MEM1_END) - (uint32_t)(&TAL_HEAP_MEM1_START)) - 1;
+   if (dSize1 != (uint32_t)-1)
    {
 #if (SUPPORT_BIG_MEM == 0)
       /* Sepcial check, for B3 */
-      if (dSize > 0x0FFFFFFF) dSize = 0x0FFFFFFF;
+      if (dSize1 > 0x0FFFFFFF) dSize1 = 0x0FFFFFFF;
 #endif      
-   
-      MEMAdd(XM_ID_HEAP, (uint8_t*)dAddr, dSize);
+   }
+   else
+   {
+      dSize1 = 0;
    }
 #endif
 
    /* 
-    * Add memory #2 if available
+    * Get memory #2 if available
     */
 
 #if defined(TAL_HEAP_MEM2_START)
    /* Get memory pointer */ 
-   dAddr = (uint32_t)&TAL_HEAP_MEM2_START;
-   dSize = ((uint32_t)(&TAL_HEAP_MEM2_END) - (uint32_t)(&TAL_HEAP_MEM2_START)) - 1;
+   dAddr2 = (uint32_t)&TAL_HEAP_MEM2_START;
+   dSize2 = ((uint32_t)(&TAL_HEAP_MEM2_END) - (uint32_t)(&TAL_HEAP_MEM2_START)) - 1;
 
 #if (SUPPORT_BIG_MEM == 0)
-      if (dSize > 0x0FFFFFFF) dSize = 0x0FFFFFFF;
+      if (dSize2 > 0x0FFFFFFF) dSize2 = 0x0FFFFFFF;
 #endif      
-   
-   MEMAdd(XM_ID_HEAP, (uint8_t*)dAddr, dSize);
 #endif   
+
+   /* 
+    * Add the memories, the pool must be set up for the larger one
+    */
+   dMaxSize = (dSize1 > dSize2) ? dSize1 : dSize2;
+   if (dSize1 != 0)
+   {
+      MEMAdd(XM_ID_HEAP, (uint8_t*)dAddr1, dSize1, dMaxSize);
+   }
+   if (dSize2 != 0)
+   {
+      MEMAdd(XM_ID_HEAP, (uint8_t*)dAddr2, dSize2, dMaxSize);
+   }
    
    MemList[XM_ID_HEAP].pName = "Heap";
    MemList[XM_ID_HEAP].UsedRawMemory = 0;
@@ -531,9 +1068,13 @@ void tal_MEMInit (void)
 /*************************************************************************/
 void tal_MEMAdd (tal_mem_id ID, const char *pName, void *pBuffer, uint32_t dSize)
 {
+#if (SUPPORT_TLSF == 0)
    if ((ID < XM_ID_MAX) && (NULL == MemList[ID].pFreelist))
+#else
+   if ((ID < XM_ID_MAX) && (NULL == MemList[ID].pTLSF))
+#endif   
    {
-      MEMAdd(ID, pBuffer, dSize);
+      MEMAdd(ID, pBuffer, dSize, dSize);
 
       MemList[ID].pName = pName;
       MemList[ID].UsedRawMemory = 0;
@@ -225,7 +225,7 @@ struct _os_tcb_
    OS_TCB          *pTaskPrev;            /* Used for the TaskList */
    
    char              Name[17];            /* Name */
-   int              nPrio;                /* Priority */
+   int              nPrio;                /* Priority, 0 (highest) ... 255 (lowest) */
    os_task_state_t   State;               /* State, for debug purpose */
    uintptr_t         StackPtr;            /* Actual stack pointer */
    uint8_t         *pStackStart;          /* Start of the stack */
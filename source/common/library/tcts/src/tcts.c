@@ -72,6 +72,10 @@
 *                    Change version to v0.18.1
 *  26.05.2020  mifi  Change API from OSxx to OS_xx.
 *                    Change version to v0.20.0.
+*  16.10.2026  mifi  Use a priority bitmap with a fifo for each
+*                    priority for the ReadyList.
+*                    The WaitList is a delta list now.
+*  17.10.2026  mifi  Added the host port for the scheduler benchmark.
 **************************************************************************/
 #define __TCTS_C__
 
@@ -120,6 +124,21 @@
 #define IDLE_TASK_PRIO     255
 #define STAT_TASK_PRIO     2
 
+/*
+ * The ReadyList supports the priorities 0...255. The ready bitmap use
+ * one bit for each priority, the group bitmap one bit for each 32 bit
+ * word of the ready bitmap. The highest priority is the lowest number,
+ * therefore priority 0 is mapped to bit 31. Now the highest ready
+ * priority can be found with count leading zeros (CLZ).
+ */
+#define READY_PRIO_CNT     256
+#define READY_GROUP_CNT    (READY_PRIO_CNT / 32)
+
+#define READY_BIT(_p)      (0x80000000UL >> ((_p) & 31))
+#define READY_GROUP(_p)    ((_p) >> 5)
+
+#define OS_CLZ(_x)         __builtin_clz(_x)
+
 /*
  * Test if the fifo is empty
  */
@@ -182,13 +201,19 @@ static uint32_t  dStatHirResPeriod  = 0;
 static OS_TCB *pTaskList = NULL;
 
 /* 
- * The ReadyList contains the tasks which are ready to run. 
+ * The ReadyList contains the tasks which are ready to run,
+ * one fifo for each priority.
  */
-static os_tcb_fifo_t ReadyList;
+static os_tcb_fifo_t ReadyList[READY_PRIO_CNT];
+static uint32_t      ReadyMap[READY_GROUP_CNT];
+static uint32_t      dReadyGroup;
 
 /*
  * The WaitList contains the tasks which are waiting
  * with timeout, e.g. OSTimeDly, OSSemaWait or OSEventWait.
+ * It is a delta list, sorted by the expiry time. The dTimeoutTicks
+ * of a task in the list is relative to the task in front of it.
+ * Tasks waiting with OS_WAIT_INFINITE are not part of the list.
  */
 static os_tcb_fifo_t WaitList;
 
@@ -237,6 +262,13 @@ static uint32_t      UserTimerTimeout = 0;
 #include "tcts_nios.c"
 #endif
 
+/*
+ * Check for the Linux host, used by the scheduler benchmark
+ */
+#if defined(__linux__) && defined(__x86_64__)
+#include "tcts_host.c"
+#endif
+
 /*************************************************************************/
 /*  GetStackFreeCount                                                    */
 /*                                                                       */
@@ -346,6 +378,36 @@ static __inline__ void TCBFifoAddPrio (os_tcb_fifo_t *pFifo, OS_TCB *pTask)
    
 } /* TCBFifoAddPrio */
 
+/*************************************************************************/
+/*  TCBFifoAdd                                                           */
+/*                                                                       */
+/*  Add the task to the input side of the FIFO.                          */ 
+/*                                                                       */
+/*  Note: Interrupts are disabled and must be disabled.                  */
+/*                                                                       */
+/*  In    : pFifo, pTask                                                 */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static __inline__ void TCBFifoAdd (os_tcb_fifo_t *pFifo, OS_TCB *pTask)
+{
+   pTask->pPrev = NULL;             /* This is the new first task, therefore no prev. */
+   pTask->pNext = pFifo->pIn;       /* Link the new task in front of the fifo. */
+
+   /* Check if the fifo is empty */
+   if (NULL == pFifo->pIn)
+   {
+      pFifo->pOut = pTask;          /* Fifo out points to the new task too */
+   }
+   else
+   {
+      pFifo->pIn->pPrev = pTask;    /* Link the old first task back to the new first task. */
+   }
+   
+   pFifo->pIn = pTask;
+   
+} /* TCBFifoAdd */
+
 /*************************************************************************/
 /*  TCBFifoRemove                                                        */
 /*                                                                       */
@@ -537,7 +599,8 @@ static void TaskListRemove (OS_TCB *pTask)
 /*************************************************************************/
 /*  AddTaskToWaitList                                                    */
 /*                                                                       */
-/*  Add the task to the WaitList fifo.                                   */
+/*  Add the task to the WaitList delta list. The timeout must be set     */
+/*  in dTimeoutTicks before.                                             */
 /*                                                                       */
 /*  Note: Interrupts are disabled and must be disabled.                  */
 /*                                                                       */
@@ -548,47 +611,83 @@ static void TaskListRemove (OS_TCB *pTask)
 static __inline__ void AddTaskToWaitList (OS_TCB *pTask)
 {
    os_tcb_fifo_t *pFifo = &WaitList;
+   OS_TCB        *pList;
+   uint32_t       dTicks;
     
    SET_TASK_STATE(pTask, OS_TASK_STATE_WAITING);
    
+   /* The Idle task must not added to any lists */
+   if (&TCBIdle == pTask)
+   {
+      return;
+   }
+   
+   pTask->pWaitPrev = NULL;
+   pTask->pWaitNext = NULL;
+   
+   /* A task without a timeout will be never expired */
+   if (OS_WAIT_INFINITE == pTask->dTimeoutTicks)
+   {
+      return;
+   }
+   
+   /* A timeout of 0 expires with the next tick, like a timeout of 1 */
+   dTicks = (pTask->dTimeoutTicks > 0) ? pTask->dTimeoutTicks : 1;
+   
    /*
     * For the correct order of task processing the task must be 
-    * added at the end. For example, if there exist three tasks, A, B and C 
-    * with the same priority. And the tasks was started in the ABC order the
+    * added behind all tasks with the same expiry time. For example, 
+    * if there exist three tasks, A, B and C with the same priority and
+    * the same timeout. And the tasks was started in the ABC order the
     * WaitList looks like A->B->C after all tasks was added to the WaitList
     * now.
     *
-    * CheckWaitList will move the tasks later from the WaitList to  
+    * HandleWaitList will move the tasks later from the WaitList to  
     * the ReadyList if the timeout is expired. But this will be
-    * done with TCBFifoAddPrio. The ReadyList will look like C->B->A.
+    * done with AddTaskToReadyList. The ReadyList will look like C->B->A.
     *
     * The task which is started is taken by the scheduler from the 
     * end of the ReadyList. Now the order of task processing is correct.
     */
-
-   /* The Idle task must not added to any lists */
-   if (&TCBIdle == pTask)
+   pList = pFifo->pIn;
+   while ((pList != NULL) && (pList->dTimeoutTicks <= dTicks))
    {
-      return;
+      dTicks -= pList->dTimeoutTicks;
+      pList   = pList->pWaitNext;
    }
-
-   /* Check if the fifo is empty */
-   if (NULL == pFifo->pIn)
+   
+   pTask->dTimeoutTicks = dTicks;
+   
+   if (NULL == pList)
    {
-      /* Fifo is empty */
-      pTask->pWaitPrev = NULL;         /* Task has no prev */
-      pTask->pWaitNext = NULL;         /* and no next */
-      
-      pFifo->pIn  = pTask;             /* Fifo in and out */      
-      pFifo->pOut = pTask;             /* points to the new task */
+      /* Add the task at the end of the list */
+      pTask->pWaitPrev = pFifo->pOut;
+      if (NULL == pFifo->pOut)
+      {
+         pFifo->pIn = pTask;
+      }
+      else
+      {
+         pFifo->pOut->pWaitNext = pTask;
+      }
+      pFifo->pOut = pTask;
    }
-   else   
+   else
    {
-      /* Fifo is not empty */
-      pTask->pWaitNext = NULL;         /* This is the new last task, therefore no next. */    
-      pTask->pWaitPrev = pFifo->pOut;  /* Link the new task at the end of the fifo. */
-      pFifo->pOut->pWaitNext = pTask;  /* Link the old last to the new last. */
-      pFifo->pOut = pTask;             /* Set the fifo-pOut to the new last task. */
+      /* Insert the task in front of pList, pList is relative to the new task now */
+      pList->dTimeoutTicks -= dTicks;
+      
+      pTask->pWaitNext = pList;
+      pTask->pWaitPrev = pList->pWaitPrev;
+      if (NULL == pList->pWaitPrev)
+      {
+         pFifo->pIn = pTask;
+      }
+      else
+      {
+         pList->pWaitPrev->pWaitNext = pTask;
+      }
+      pList->pWaitPrev = pTask;
    }
    
 } /* AddTaskToWaitList */
@@ -596,7 +695,7 @@ static __inline__ void AddTaskToWaitList (OS_TCB *pTask)
 /*************************************************************************/
 /*  WaitListRemove                                                       */
 /*                                                                       */
-/*  Remove a task from the WaitList fifo.                                */
+/*  Remove a task from the WaitList delta list, if it is part of it.     */
 /*                                                                       */
 /*  Note: Interrupts are disabled and must be disabled.                  */
 /*                                                                       */
@@ -608,40 +707,30 @@ static void WaitListRemove (OS_TCB *pTask)
 {
    os_tcb_fifo_t *pFifo = &WaitList;
    
-   /* Check if fifo is empty */
-   if (NULL == pFifo->pIn)
+   /* Check if the task is in the list, OS_WAIT_INFINITE is not */
+   if ((NULL == pTask->pWaitPrev) && (pFifo->pIn != pTask))
    {
-      /* Error */
-      TAL_FAILED();
+      return;
    }
    
-   /* Check if only one element is in the list */
-   if (pFifo->pIn == pFifo->pOut)
+   /* The remaining time of the task belongs to the next one now */
+   if (pTask->pWaitNext != NULL)
    {
-      /* Clear the fifo in/out */
-      pFifo->pIn  = NULL;
-      pFifo->pOut = NULL;
+      pTask->pWaitNext->dTimeoutTicks += pTask->dTimeoutTicks;
+      pTask->pWaitNext->pWaitPrev      = pTask->pWaitPrev;
    }
    else
    {
-      /* Check if the task is in the middle of the list */
-      if      ((pTask->pWaitPrev != NULL) && (pTask->pWaitNext != NULL))
-      {
-         pTask->pWaitNext->pWaitPrev = pTask->pWaitPrev;
-         pTask->pWaitPrev->pWaitNext = pTask->pWaitNext;
-      }
-      /* Check for the first element */
-      else if (pTask->pWaitPrev == NULL)
-      {
-         pTask->pWaitNext->pWaitPrev = NULL;
-         pFifo->pIn = pTask->pWaitNext;
-      }
-      /* Check for the last element */
-      else if (pTask->pWaitNext == NULL)
-      {
-         pTask->pWaitPrev->pWaitNext = NULL;
-         pFifo->pOut = pTask->pWaitPrev;
-      }
+      pFifo->pOut = pTask->pWaitPrev;
+   }
+   
+   if (pTask->pWaitPrev != NULL)
+   {
+      pTask->pWaitPrev->pWaitNext = pTask->pWaitNext;
+   }
+   else
+   {
+      pFifo->pIn = pTask->pWaitNext;
    }
 
    pTask->pWaitPrev = NULL;
@@ -661,35 +750,61 @@ static void WaitListRemove (OS_TCB *pTask)
 /*************************************************************************/
 static __inline__ void AddTaskToReadyList (OS_TCB *pTask)
 {
+   uint32_t dPrio = (uint32_t)pTask->nPrio;
+   
    SET_TASK_STATE(pTask, OS_TASK_STATE_READY);
-   TCBFifoAddPrio(&ReadyList, pTask);   
+   
+   /*
+    * Tasks with the same priority are added to the input side of the
+    * fifo. Therefore the round robin order is the same like before with
+    * TCBFifoAddPrio and the one ReadyList.
+    */
+   TCBFifoAdd(&ReadyList[dPrio], pTask);
+   
+   ReadyMap[READY_GROUP(dPrio)] |= READY_BIT(dPrio);
+   dReadyGroup                  |= READY_BIT(READY_GROUP(dPrio));
+   
 } /* AddTaskToReadyList */
 
 /*************************************************************************/
 /*  GetReadyTask                                                         */
 /*                                                                       */
-/*  Get the task which is ready.                                         */
+/*  Get the task with the highest priority which is ready.               */
 /*                                                                       */
 /*  Note: Interrupts are disabled and must be disabled.                  */
 /*                                                                       */
-/*  In    : pTask                                                        */
+/*  In    : none                                                         */
 /*  Out   : none                                                         */
-/*  Return: none                                                         */
+/*  Return: pTask                                                        */
 /*************************************************************************/
 static OS_TCB *GetReadyTask (void)
 {
-   OS_TCB *pTask;
+   OS_TCB   *pTask;
+   uint32_t  dGroup;
+   uint32_t  dPrio;
 
-#if 0 /* TODO: double check if it is a good idea */
-   /* In case the ReadyList fifo is empty, return the Idle task */
-   if (NULL == ReadyList.pIn)
+   /* Check if the ReadyList is empty */
+   if (0 == dReadyGroup)
    {
-      pTask = &TCBIdle;
+      /* Error */
+      TAL_FAILED();
+      return(NULL);
    }
-   else
-#endif   
+   
+   /* Find the highest priority which is ready */
+   dGroup = OS_CLZ(dReadyGroup);
+   dPrio  = (dGroup << 5) + OS_CLZ(ReadyMap[dGroup]);
+   
+   pTask = TCBFifoRemove(&ReadyList[dPrio]);
+   
+   /* Clear the bitmap if no more task with this priority is ready */
+   if (IsFifoEmpty(&ReadyList[dPrio]))
    {
-      pTask = TCBFifoRemove(&ReadyList);
+      ReadyMap[dGroup] &= ~READY_BIT(dPrio);
+      if (0 == ReadyMap[dGroup])
+      {
+         dReadyGroup &= ~READY_BIT(dGroup);
+      }
    }
 
    return(pTask);
@@ -700,8 +815,9 @@ static OS_TCB *GetReadyTask (void)
 /*                                                                       */
 /*  The WaitList is used for handling a timeout or a delay.              */
 /*                                                                       */
-/*  Go through the WaitList and decrease the WaitCount. Check if the     */
-/*  task from the WaitList can be moved to the ReadyList.                */
+/*  Only the first task of the WaitList delta list must be decreased.    */
+/*  All tasks at the front of the list with an expired timeout will be   */
+/*  moved to the ReadyList.                                              */
 /*                                                                       */
 /*  Note: Interrupts are disabled and must be disabled.                  */
 /*                                                                       */
@@ -712,77 +828,61 @@ static OS_TCB *GetReadyTask (void)
 static void HandleWaitList (void)
 {
    OS_TCB *pTask = WaitList.pIn;
-   OS_TCB *pNext;
 
-   while (pTask != NULL)
+   /* Decrease the WaitCount of the first task only */
+   if ((pTask != NULL) && (pTask->dTimeoutTicks > 0))
    {
-      /* Decrease the WaitCount if allowed */
-      if ((pTask->dTimeoutTicks > 0) && (pTask->dTimeoutTicks != OS_WAIT_INFINITE))
+      pTask->dTimeoutTicks--;
+   }
+
+   /* Check if the timeout is expired */
+   while ((pTask != NULL) && (0 == pTask->dTimeoutTicks))
+   {
+      /* Remove the task from the WaitList */
+      WaitListRemove(pTask);
+      
+      /* Check if the task was waiting for a semaphore */
+      if (pTask->pSemaWait)
       {
-         pTask->dTimeoutTicks--;
+         /* 
+          * This is a timeout of the semaphore, 
+          * the task must be removed from the semaphore list too.
+          */
+         TCBFifoRemoveMiddle(&pTask->pSemaWait->Fifo, pTask);
+         pTask->pSemaWait   = NULL;
+         pTask->nReturnCode = OS_RC_TIMEOUT;  /* Return code for OSSemaWait */
       }
-   
-      /* Check if the timeout is expired */
-      if (0 == pTask->dTimeoutTicks)
+
+      /* Check if the task was waiting for a mutex */
+      if (pTask->pMutexWait)
       {
          /* 
-          * Save the next pointer of the task.
-          * pTask->pNext could not be used later, because it wil be changed
-          * by the TCBFifoAdd before we can use the Next for the loop.
+          * This is a timeout of the mutex, 
+          * the task must be removed from the mutex list too.
           */
-         pNext = pTask->pWaitNext;
-         
-         /* Remove the task from the WaitList */
-         WaitListRemove(pTask);
-         
-         /* Check if the task was waiting for a semaphore */
-         if (pTask->pSemaWait)
-         {
-            /* 
-             * This is a timeout of the semaphore, 
-             * the task must be removed from the semaphore list too.
-             */
-            TCBFifoRemoveMiddle(&pTask->pSemaWait->Fifo, pTask);
-            pTask->pSemaWait   = NULL;
-            pTask->nReturnCode = OS_RC_TIMEOUT;  /* Return code for OSSemaWait */
-         }
-
-         /* Check if the task was waiting for a mutex */
-         if (pTask->pMutexWait)
-         {
-            /* 
-             * This is a timeout of the mutex, 
-             * the task must be removed from the mutex list too.
-             */
-            TCBFifoRemoveMiddle(&pTask->pMutexWait->Fifo, pTask);
-            pTask->pMutexWait  = NULL;
-            pTask->nReturnCode = OS_RC_TIMEOUT;  /* Return code for OSMutexWait */
-         }
-
-         /* Check if the task was waiting for an event */
-         if (pTask->pEventWait)
-         {
-            /* 
-             * This is a timeout of the event, 
-             * the task must be removed from the event list too.
-             */
-            TCBFifoRemoveMiddle(&pTask->pEventWait->Fifo, pTask);
-            pTask->pEventWait  = NULL;
-            pTask->nReturnCode = OS_RC_TIMEOUT;  /* Return code for OSEventWait */
-         }
-         
-         /* Add the task to the ReadyList */            
-         AddTaskToReadyList(pTask);
-         
-         /* Loop through the list */
-         pTask = pNext;
+         TCBFifoRemoveMiddle(&pTask->pMutexWait->Fifo, pTask);
+         pTask->pMutexWait  = NULL;
+         pTask->nReturnCode = OS_RC_TIMEOUT;  /* Return code for OSMutexWait */
       }
-      else
+
+      /* Check if the task was waiting for an event */
+      if (pTask->pEventWait)
       {
-         /* Loop through the list */
-         pTask = pTask->pWaitNext;
+         /* 
+          * This is a timeout of the event, 
+          * the task must be removed from the event list too.
+          */
+         TCBFifoRemoveMiddle(&pTask->pEventWait->Fifo, pTask);
+         pTask->pEventWait  = NULL;
+         pTask->nReturnCode = OS_RC_TIMEOUT;  /* Return code for OSEventWait */
       }
-   } /* end while (pTask != NULL) */
+      
+      /* Add the task to the ReadyList */            
+      AddTaskToReadyList(pTask);
+      
+      /* The next task is the first one now */
+      pTask = WaitList.pIn;
+   }
    
 } /* HandleWaitList */
 
@@ -1039,7 +1139,9 @@ static void IdleTask (void *pParam)
 void OS_Init (void)
 {
    /* Init the Ready and Wait List */
-   memset(&ReadyList, 0x00, sizeof(ReadyList));
+   memset(ReadyList, 0x00, sizeof(ReadyList));
+   memset(ReadyMap,  0x00, sizeof(ReadyMap));
+   dReadyGroup = 0;
    memset(&WaitList,  0x00, sizeof(WaitList));
    
    bIsSchedLocked = 1;     /* Used in tcts_cm, _arm and _nios */
@@ -1112,7 +1214,7 @@ void OS_OutputTaskInfo (void)
    /* Display "IRQ" Stack */
    pStart = GetIRQStackStart();
    pEnd   = GetIRQStackEnd();
-   dSize  = (uint32_t)pEnd - (uint32_t)pStart;
+   dSize  = (uint32_t)(pEnd - pStart);
    dFree  = GetStackFreeCount(pStart, pEnd);
    
    TAL_PRINTF("%-16s  ", "- IRQ -");
@@ -1199,7 +1301,7 @@ uint32_t OS_GetStackInfo (OS_TCB *pTCB, uint32_t *pSize)
    
    pStart = pTCB->pStackStart;
    pEnd   = (uint8_t*)pStart + pTCB->wStackSize;
-   dSize  = (uint32_t)pEnd - (uint32_t)pStart;
+   dSize  = (uint32_t)(pEnd - pStart);
    dFree  = GetStackFreeCount(pStart, pEnd);
    
    *pSize = dSize;
@@ -1432,7 +1534,7 @@ void OS_TimerCallback (void)
    }
 
    /* 
-    * Go through the WaitList and decrease the WaitCount. 
+    * Handle the expired tasks of the WaitList. 
     */
    HandleWaitList();
    
@@ -0,0 +1,354 @@
+/**************************************************************************
+*  This file is part of the TCTS project (Tiny Cooperative Task Scheduler)
+*
+*  Copyright (c) 2026 by Michael Fischer (www.emb4fun.de).
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*  1. Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*
+*  2. Redistributions in binary form must reproduce the above copyright
+*     notice, this list of conditions and the following disclaimer in the
+*     documentation and/or other materials provided with the distribution.
+*
+*  3. Neither the name of the author nor the names of its contributors may
+*     be used to endorse or promote products derived from this software
+*     without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+*  THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+*  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+*  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+*  SUCH DAMAGE.
+*
+***************************************************************************
+*  History:
+*
+*  17.10.2026  mifi  First Version, Linux x86-64 host port for the
+*                    scheduler benchmark of tools/webhost.
+**************************************************************************/
+#define __TCTS_HOST_C__
+
+/*
+ * All tasks run in the one thread of the process, there are no
+ * interrupts on the host. The context switch saves the callee saved
+ * registers of the System V ABI on the task stack, like tcts_cm.c.
+ */
+
+/*=======================================================================*/
+/*  Include                                                              */
+/*=======================================================================*/
+#include <string.h>
+#include <stdint.h>
+
+#include "tcts.h"
+
+/*=======================================================================*/
+/*  All extern data                                                      */
+/*=======================================================================*/
+
+/*=======================================================================*/
+/*  All Structures and Common Constants                                  */
+/*=======================================================================*/
+
+#define EnterCritical()    ((void)0)
+#define ExitCritical()     ((void)0)
+
+
+/*
+ * x86-64 context switch frame layout.
+ *
+ * This is the layout of the stack after a task's context has been
+ * switched-out. The stack pointer is stored in the task control block
+ * and points to this structure.
+ */
+typedef struct _switch_frame_
+{
+   uint64_t csf_r15;
+   uint64_t csf_r14;
+   uint64_t csf_r13;
+   uint64_t csf_r12;
+   uint64_t csf_rbx;
+   uint64_t csf_rbp;
+   uint64_t csf_rip;
+} switch_frame_t;
+
+
+/*
+ * Forward declaration
+ */
+static uint32_t GetStackFreeCount (uint8_t *pStart, uint8_t *pEnd);
+static OS_TCB  *GetReadyTask (void);
+static void TaskListAdd (OS_TCB *pTask);
+static __inline__ void AddTaskToReadyList (OS_TCB *pTask);
+static void TaskSchedule (void);
+
+void tcts_HostSwitch (uintptr_t *pStackPtr, uintptr_t NewStackPtr);
+void tcts_HostTaskCall (void);
+
+/*=======================================================================*/
+/*  Definition of all global Data                                        */
+/*=======================================================================*/
+
+/*=======================================================================*/
+/*  Definition of all local Data                                         */
+/*=======================================================================*/
+
+/*=======================================================================*/
+/*  Definition of all local Procedures                                   */
+/*=======================================================================*/
+
+/*
+ * tcts_HostSwitch saves the registers on the stack of the running task,
+ * stores the stack pointer in pStackPtr and restores the registers from
+ * NewStackPtr.
+ *
+ * tcts_HostTaskCall calls a new task, simulate a C call. The task entry
+ * is in r13, the argument in r12 and OS_TaskExit in r14, the content was
+ * set in OS_TaskCreate.
+ */
+__asm__ ( ".text\n"
+          ".globl tcts_HostSwitch\n"
+          ".type  tcts_HostSwitch, @function\n"
+          "tcts_HostSwitch:\n"
+          "   pushq %rbp\n"
+          "   pushq %rbx\n"
+          "   pushq %r12\n"
+          "   pushq %r13\n"
+          "   pushq %r14\n"
+          "   pushq %r15\n"
+          "   movq  %rsp, (%rdi)\n"         /* Save stack pointer. */
+          "   movq  %rsi, %rsp\n"           /* Restore stack pointer. */
+          "   popq  %r15\n"
+          "   popq  %r14\n"
+          "   popq  %r13\n"
+          "   popq  %r12\n"
+          "   popq  %rbx\n"
+          "   popq  %rbp\n"
+          "   ret\n"
+          ".size  tcts_HostSwitch, .-tcts_HostSwitch\n"
+          "\n"
+          ".globl tcts_HostTaskCall\n"
+          ".type  tcts_HostTaskCall, @function\n"
+          "tcts_HostTaskCall:\n"
+          "   movq  %r12, %rdi\n"
+          "   call  *%r13\n"
+          "   call  *%r14\n"
+          "   ud2\n"
+          ".size  tcts_HostTaskCall, .-tcts_HostTaskCall\n" );
+
+/*************************************************************************/
+/*  OutputRuntimeStackInfo                                               */
+/*                                                                       */
+/*  In    : none                                                         */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void OutputRuntimeStackInfo (void)
+{
+   TAL_PRINTF("*** Runtime Stack Info ***\n");
+   TAL_PRINTF("\n");
+   TAL_PRINTF("Not available on the host\n");
+   TAL_PRINTF("\n");
+} /* OutputRuntimeStackInfo */
+
+/*************************************************************************/
+/*  GetIRQStackStart                                                     */
+/*                                                                       */
+/*  No IRQ stack on the host.                                            */
+/*                                                                       */
+/*  In    : none                                                         */
+/*  Out   : none                                                         */
+/*  Return: stack start address                                          */
+/*************************************************************************/
+static uint8_t *GetIRQStackStart (void)
+{
+   return(NULL);
+} /* GetIRQStackStart */
+
+/*************************************************************************/
+/*  GetIRQStackEnd                                                       */
+/*                                                                       */
+/*  No IRQ stack on the host.                                            */
+/*                                                                       */
+/*  In    : none                                                         */
+/*  Out   : none                                                         */
+/*  Return: stack end address                                            */
+/*************************************************************************/
+static uint8_t *GetIRQStackEnd (void)
+{
+   return(NULL);
+} /* GetIRQStackEnd */
+
+/*************************************************************************/
+/*  ContextSwitch                                                        */
+/*                                                                       */
+/*  Switch to the new task.                                              */
+/*                                                                       */
+/*  In    : none                                                         */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void ContextSwitch (void)
+{
+   OS_TCB *pTask = RunningTask;
+
+   /* Set the new task */
+   RunningTask = NewTask;
+   RunningTask->State = OS_TASK_STATE_RUNNING;
+
+   tcts_HostSwitch(&pTask->StackPtr, RunningTask->StackPtr);
+
+} /* ContextSwitch */
+
+/*************************************************************************/
+/*  ContextSwitchExit                                                    */
+/*                                                                       */
+/*  Switch to the new task, like ContextSwitch.                          */
+/*  But without to save the CPU context. Used by OSTaskExit.             */
+/*                                                                       */
+/*  In    : none                                                         */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void ContextSwitchExit (void)
+{
+   uintptr_t StackPtr;
+
+   /* Set the new task */
+   RunningTask = NewTask;
+   RunningTask->State = OS_TASK_STATE_RUNNING;
+
+   tcts_HostSwitch(&StackPtr, RunningTask->StackPtr);
+
+} /* ContextSwitchExit */
+
+/*=======================================================================*/
+/*  All code exported                                                    */
+/*=======================================================================*/
+
+/*************************************************************************/
+/*  OS_Start                                                             */
+/*                                                                       */
+/*  Start the "Cooperative Task Scheduler".                              */
+/*                                                                       */
+/*  In    : none                                                         */
+/*  Out   : none                                                         */
+/*  Return: never                                                        */
+/*************************************************************************/
+void OS_Start (void)
+{
+   OS_TCB   *pTask;
+   uintptr_t StackPtr;
+
+   /* Disable all interrupts */
+   EnterCritical();
+
+   /* Unlock the scheduler */
+   bIsSchedLocked = 0;
+
+   /*  Get a task from the ReadyList */
+   pTask = GetReadyTask();
+
+   /*
+    * Start the task
+    */
+   RunningTask = pTask;
+   RunningTask->State = OS_TASK_STATE_RUNNING;
+   RunningTask->dStatStartTime = tal_CPUStatGetHiResCnt();
+
+   tcts_HostSwitch(&StackPtr, RunningTask->StackPtr);
+
+} /* OS_Start */
+
+/*************************************************************************/
+/*  OS_TaskCreate                                                        */
+/*                                                                       */
+/*  In    : none                                                         */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+void OS_TaskCreate (OS_TCB *pTCB, OS_TASK Task, void *pParam, int nPrio,
+                    uint8_t *pStack, uint16_t wStackSize, char *pName)
+{
+   switch_frame_t *sf;
+   uintptr_t       addr;
+
+   /* Check 16 byte alignment of the stack */
+   addr = (uintptr_t)pStack;
+   if ((addr & 0xF) != 0)
+   {
+      /* Corrected start and size */
+      wStackSize -= (uint16_t)(16 - (addr & 0xF));
+
+      addr += 15;
+      addr &= ~(uintptr_t)15;
+
+      pStack = (uint8_t*)addr;
+   }
+   wStackSize &= ~15;
+
+   /* Clear the TCB memory */
+   memset(pTCB, 0x00, sizeof(OS_TCB));
+
+   /* Fill the stack memory with a check pattern */
+   memset(pStack, 0xCC, wStackSize);
+
+   /* Copy name */
+   memcpy(pTCB->Name, pName, sizeof(pTCB->Name) - 1); /*lint !e420*/
+
+   /*
+    * -- Do not use the macro SET_TASK_STATE here --
+    *
+    * The macro can be "empty" in case of performance
+    * optimisation and will not work.
+    */
+   pTCB->State       = OS_TASK_STATE_CREATED;
+
+   pTCB->nPrio       = nPrio;
+   pTCB->pStackStart = pStack;
+   pTCB->wStackSize  = wStackSize;
+
+   /*
+    * Setup the switch frame below the stack top. The task entry must
+    * see the stack like after a call, 16 byte aligned plus the return
+    * address. Therefore the frame starts 16 bytes below the top.
+    */
+   sf = (switch_frame_t*)((uintptr_t)&pStack[wStackSize] - 16 - sizeof(switch_frame_t));
+
+   sf->csf_r15 = 0x1515151515151515;
+   sf->csf_r14 = (uintptr_t)OS_TaskExit;
+   sf->csf_r13 = (uintptr_t)Task;
+   sf->csf_r12 = (uintptr_t)pParam;
+   sf->csf_rbx = 0;
+   sf->csf_rbp = 0;
+   sf->csf_rip = (uintptr_t)tcts_HostTaskCall;
+
+   pTCB->StackPtr = (uintptr_t)sf;
+
+   EnterCritical();
+   TaskListAdd(pTCB);         /* Add the task to the TaskList */
+   AddTaskToReadyList(pTCB);  /* Add the task to the ReadyList */
+
+   /* Schedule the new task if the scheduler is not locked */
+   if (0 == bIsSchedLocked)
+   {
+      AddTaskToReadyList(RunningTask);
+      TaskSchedule();
+   }
+   ExitCritical();
+
+} /* OS_TaskCreate */
+
+/*** EOF ***/
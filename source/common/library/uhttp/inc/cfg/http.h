@@ -27,10 +27,30 @@
 #define HTTP_MAX_REQUEST_SIZE 256
 #endif
 
+#ifndef HTTP_MAX_HEADER_SIZE
+#define HTTP_MAX_HEADER_SIZE  1024
+#endif
+
+#ifndef HTTP_MAX_INFO_SIZE
+#define HTTP_MAX_INFO_SIZE    128
+#endif
+
+#ifndef HTTP_HEADER_RESERVE
+#define HTTP_HEADER_RESERVE   512
+#endif
+
 #ifndef HTTP_FILE_CHUNK_SIZE
 #define HTTP_FILE_CHUNK_SIZE  512
 #endif
 
+#ifndef HTTP_FORM_MAX_FIELDS
+#define HTTP_FORM_MAX_FIELDS  48
+#endif
+
+#ifndef HTTP_FORM_MAX_SIZE
+#define HTTP_FORM_MAX_SIZE    4096
+#endif
+
 
 #ifdef HTTP_KEEP_ALIVE_REQ
 #undef HTTP_KEEP_ALIVE_REQ
@@ -46,6 +46,8 @@
 
 #if defined(_WIN32)
 #include <pro/uhttp/os/win/compiler.h>
+#elif defined(__linux__)
+#include <pro/uhttp/os/posix/compiler.h>
 #elif defined(RTOS_TCTS) /* @@MF */
 #include <pro/uhttp/os/lwip/compiler.h>
 #else
@@ -52,6 +52,11 @@
  */
 typedef const char* (*HTTP_SSI_VARHANDLER) (HTTPD_SESSION*, const char*);
 
+/*!
+ * \brief SSI handler type for ASP variables, see HttpSsiLookupExt().
+ */
+typedef int (*HTTP_SSI_EXTHANDLER) (HTTPD_SESSION*);
+
 /*!
  * \brief Default SSI handler.
  */
@@ -62,5 +67,20 @@ extern int HttpSsiHandler(HTTPD_SESSION *hs, const MEDIA_TYPE_ENTRY *mt, const c
  */
 extern HTTP_SSI_VARHANDLER HttpRegisterSsiVarHandler(HTTP_SSI_VARHANDLER handler);
 
+/*!
+ * \brief Initialize the SSI templates.
+ *
+ * Must be called once before the first request.
+ */
+extern void HttpSsiInit(void);
+
+/*!
+ * \brief Remove all compiled SSI files.
+ *
+ * SSI files are compiled at their first request. This function must
+ * be called if the files may have changed, e.g. at a new mount.
+ */
+extern void HttpSsiFlushTemplates(void);
+
 /*@}*/
 #endif
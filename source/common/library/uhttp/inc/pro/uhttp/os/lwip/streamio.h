@@ -54,8 +54,13 @@
 
 #ifdef HTTP_CHUNKED_TRANSFER
 #define STREAM_OBUF_SIZE   1450
+/* Headroom for the chunk size line, tailroom for the CRLF and the last chunk. */
+#define STREAM_OBUF_HEAD   8
+#define STREAM_OBUF_TAIL   7
 #else
 #define STREAM_OBUF_SIZE   1460
+#define STREAM_OBUF_HEAD   0
+#define STREAM_OBUF_TAIL   0
 #endif
 
 /*!
@@ -66,12 +71,16 @@ struct _HTTP_STREAM {
     int strm_ilen;
     char strm_ibuf[1460 + 128];
     int strm_olen;
-    char strm_obuf[STREAM_OBUF_SIZE];
+    char strm_obuf[STREAM_OBUF_HEAD + STREAM_OBUF_SIZE + STREAM_OBUF_TAIL];
     SOCKET strm_ssock;
     SOCKET strm_csock;
     struct sockaddr_in strm_saddr;
     struct sockaddr_in strm_caddr;
     unsigned int strm_flags;
+    int strm_tmo_phase;
+    void *strm_tmo_ctx;
+    int strm_status;
+    unsigned long strm_bytes;
 };
 
 /*@}*/
@@ -0,0 +1,88 @@
+#ifndef _PRO_UHTTPD_OS_POSIX_STREAMIO_H_
+#define _PRO_UHTTPD_OS_POSIX_STREAMIO_H_
+
+/*
+ * Copyright (C) 2012 by egnite GmbH
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * For additional information see http://www.ethernut.de/
+ */
+
+/*
+ * $Id$
+ */
+
+#ifndef _PRO_UHTTP_STREAMIO_H_
+#error Do not include this file directly. Use pro/uhttp/streamio.h instead.
+#endif
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+/*!
+ * \addtogroup xgUHTTP
+ */
+/*@{*/
+
+#define SOCKET int 
+
+#ifdef HTTP_CHUNKED_TRANSFER
+#define STREAM_OBUF_SIZE   1450
+/* Headroom for the chunk size line, tailroom for the CRLF and the last chunk. */
+#define STREAM_OBUF_HEAD   8
+#define STREAM_OBUF_TAIL   7
+#else
+#define STREAM_OBUF_SIZE   1460
+#define STREAM_OBUF_HEAD   0
+#define STREAM_OBUF_TAIL   0
+#endif
+
+/*!
+ * \brief Stream information structure for POSIX implementations.
+ */
+struct _HTTP_STREAM {
+    int strm_ipos;
+    int strm_ilen;
+    char strm_ibuf[1460 + 128];
+    int strm_olen;
+    char strm_obuf[STREAM_OBUF_HEAD + STREAM_OBUF_SIZE + STREAM_OBUF_TAIL];
+    SOCKET strm_ssock;
+    SOCKET strm_csock;
+    struct sockaddr_in strm_saddr;
+    struct sockaddr_in strm_caddr;
+    unsigned int strm_flags;
+    int strm_tmo_phase;
+    void *strm_tmo_ctx;
+    int strm_status;
+    unsigned long strm_bytes;
+};
+
+/*@}*/
+#endif
@@ -0,0 +1,76 @@
+/**************************************************************************
+*  Copyright (c) 2026 by Michael Fischer (www.emb4fun.de).
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*  1. Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*
+*  2. Redistributions in binary form must reproduce the above copyright
+*     notice, this list of conditions and the following disclaimer in the
+*     documentation and/or other materials provided with the distribution.
+*
+*  3. Neither the name of the author nor the names of its contributors may
+*     be used to endorse or promote products derived from this software
+*     without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+*  THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+*  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+*  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+*  SUCH DAMAGE.
+*
+***************************************************************************
+*  History:
+*
+*  16.10.2026  mifi  First Version.
+**************************************************************************/
+#if !defined(_PRO_UHTTP_ROUTES_H_)
+#define _PRO_UHTTP_ROUTES_H_
+
+/**************************************************************************
+*  Includes
+**************************************************************************/
+
+/**************************************************************************
+*  Global Definitions
+**************************************************************************/
+
+/*
+ * Kind of a route, the same key can be used by different kinds.
+ */
+#define HTTP_ROUTE_EXT        1     /* File extension, MEDIA_TYPE_ENTRY  */
+#define HTTP_ROUTE_CGI        2     /* CGI path, HTTP_CGI_FUNCTION       */
+#define HTTP_ROUTE_REDIR      3     /* Redirected path, HTTP_LOCATION    */
+
+/**************************************************************************
+*  Macro Definitions
+**************************************************************************/
+
+/**************************************************************************
+*  Functions Definitions
+**************************************************************************/
+
+int  HttpRoutesFreeze (void);
+int  HttpRoutesFrozen (void);
+
+int  HttpRouteAdd (int nKind, const char *pKey, void *pTarget);
+int  HttpRouteLookup (int nKind, const char *pKey, void **ppTarget);
+
+int  MediaTypeRoutes (void);
+int  HttpCgiFunctionRoutes (void);
+int  HttpLocationRoutes (void);
+
+#endif /* !_PRO_UHTTP_ROUTES_H_ */
+
+/*** EOF ***/
@@ -45,7 +45,7 @@
 #if defined(_WIN32)
 #include <pro/uhttp/os/win/streamio.h>
 #elif defined(__linux__)
-#include <unistd.h>
+#include <pro/uhttp/os/posix/streamio.h>
 #elif defined(RTOS_TCTS) /* @@MF */
 #include <pro/uhttp/os/lwip/streamio.h>
 #elif defined(HTTP_PLATFORM_STREAMS)
@@ -68,6 +68,19 @@ typedef FILE HTTP_STREAM;
 
 typedef int ssl_write_t (void *ctx, const unsigned char *buf, size_t len);
 typedef int ssl_read_t (void *ctx, const unsigned char *buf, size_t len);
+typedef void stream_tmo_t (HTTP_STREAM *sp, int phase);
+
+/*!
+ * \brief Precompiled multipart boundary.
+ *
+ * Holds the Boyer-Moore-Horspool skip table of a boundary string,
+ * see StreamBoundaryInit() and StreamReadUntilBoundary().
+ */
+typedef struct _HTTP_BOUNDARY {
+    const char *bnd_str;
+    int bnd_len;
+    unsigned char bnd_skip[256];
+} HTTP_BOUNDARY;
 
 /* \brief Client handler type. */
 typedef void (*HTTP_CLIENT_HANDLER) (HTTP_STREAM *);
@@ -84,6 +97,19 @@ typedef void (*HTTP_CLIENT_HANDLER) (HTTP_STREAM *);
 extern int StreamInit(void);
 extern int StreamInitSsl(ssl_write_t *func_write, ssl_read_t *func_read);
 
+/*!
+ * \brief Register the connection timeout handler.
+ *
+ * The handler is called by s_set_timeout() when the phase of a
+ * stream changes. In the \ref S_TMO_BODY phase it is called again
+ * on every data transfer, the body timeout is an inactivity timeout.
+ *
+ * \param func Timeout handler, NULL disables the timeouts.
+ *
+ * \return Always 0.
+ */
+extern int StreamInitTimeout(stream_tmo_t *func);
+
 /*!
  * \brief Accept stream clients.
  *
@@ -135,9 +161,66 @@ extern int StreamReadUntilChars(HTTP_STREAM *sp, const char *delim, const char *
  */
 extern int StreamReadUntilString(HTTP_STREAM *sp, const char *delim, char *buf, int siz);
 
+/*!
+ * \brief Precompile a boundary string for StreamReadUntilBoundary().
+ *
+ * \param bp    Pointer to the boundary structure to initialize.
+ * \param delim The boundary string, must be at least 1 and at most
+ *              255 characters long. It is not copied and must stay
+ *              valid while the structure is in use.
+ *
+ * \return 0 on success, -1 if the string length is out of range.
+ */
+extern int StreamBoundaryInit(HTTP_BOUNDARY *bp, const char *delim);
+
+/*!
+ * \brief Read data from a stream until a precompiled boundary appears.
+ *
+ * Same as StreamReadUntilString(), but uses a Boyer-Moore-Horspool
+ * scan over the stream buffer. The boundary itself is not consumed.
+ *
+ * \param sp  Pointer to the stream's information structure.
+ * \param bp  Pointer to the boundary, see StreamBoundaryInit().
+ * \param buf Pointer to the buffer that will receive the data read
+ *            from the stream. The data is not terminated.
+ * \param siz Size of the buffer, given in bytes.
+ *
+ * \return The number of bytes consumed from the stream. A return value
+ *         of 0 indicates that the boundary is next in the stream or
+ *         the connection was closed, -1 indicates an error.
+ */
+extern int StreamReadUntilBoundary(HTTP_STREAM *sp, const HTTP_BOUNDARY *bp, char *buf, int siz);
+
+/*!
+ * \brief Get the buffered input data of a stream.
+ *
+ * The data stays in the stream buffer until it is consumed with
+ * StreamSkip(). If no more data is buffered, the buffer will be
+ * re-filled from the connection.
+ *
+ * \param sp  Pointer to the stream's information structure.
+ * \param buf Pointer to a variable that receives the pointer to
+ *            the buffered data.
+ *
+ * \return The number of buffered bytes. A return value of 0 indicates
+ *         a closed connection, -1 indicates an error or timeout.
+ */
+extern int StreamPeek(HTTP_STREAM *sp, char **buf);
+
+/*!
+ * \brief Consume data previously returned by StreamPeek().
+ *
+ * \param sp  Pointer to the stream's information structure.
+ * \param len Number of bytes to consume.
+ */
+extern void StreamSkip(HTTP_STREAM *sp, int len);
+
 /*!
  * \brief Write a variable number of strings to a stream.
  *
+ * The strings are copied one by one to the output buffer, the heap
+ * is not used.
+ *
  * \param sp Pointer to the stream's information structure.
  *
  * \return A non-negative value if successful or EOF to indicate an error.
@@ -176,13 +259,18 @@ extern int s_puts(const char *str, HTTP_STREAM *sp);
 /*!
  * \brief Print formatted data to a stream.
  *
- * This function is similar to the standard function fprintf().
+ * This function is similar to the standard function fprintf(), but
+ * it does not return the number of characters written.
+ *
+ * The output is formatted directly into the output buffer, the heap
+ * is not used. If it does not fit, the buffer is flushed and the
+ * output is formatted again. Output which is larger than the buffer
+ * is truncated.
  *
  * \param sp  Pointer to the stream's information structure.
  * \param fmt Format string containing conversion specifications.
  *
- * \return The number of characters written or a negative value to
- *         indicate an error.
+ * \return 0 if successful or a negative value to indicate an error.
  */
 extern int s_printf(HTTP_STREAM *sp, const char *fmt, ...);
 
@@ -254,6 +342,52 @@ extern int s_clr_flags(HTTP_STREAM *sp, unsigned int flags);
 
 extern const char *StreamInfo(HTTP_STREAM *hs, int item);
 
+/*! \name Connection timeout phases */
+/*@{*/
+/*! \brief No timeout, the connection is not monitored. */
+#define S_TMO_NONE         0
+/*! \brief Keep-alive, waiting for the next request. */
+#define S_TMO_IDLE         1
+/*! \brief Reading the request header. */
+#define S_TMO_HEADER       2
+/*! \brief Processing the request, reading the body. */
+#define S_TMO_BODY         3
+/*@}*/
+
+/*!
+ * \brief Set the timeout phase of a stream.
+ *
+ * \param sp    Pointer to the stream's information structure.
+ * \param phase New phase, see \ref S_TMO_NONE.
+ */
+extern void s_set_timeout(HTTP_STREAM *sp, int phase);
+
+/*!
+ * \brief Record the response status of a stream.
+ *
+ * Used by the access log, which also reads the number of bytes
+ * sent since the last status.
+ *
+ * \param sp     Pointer to the stream's information structure.
+ * \param status HTTP status code of the response.
+ */
+extern void s_set_status(HTTP_STREAM *sp, int status);
+
+/*!
+ * \brief Write data which is sent from the caller's buffer.
+ *
+ * The output buffer is filled first, the remaining data is sent
+ * without a copy. The buffer must stay valid until the call returns.
+ * In chunked mode this is the same as s_write().
+ *
+ * \param sp   Pointer to the stream's information structure.
+ * \param buf  Pointer to the data.
+ * \param size Number of bytes to write.
+ *
+ * \return 0 on success, -1 if an error occured.
+ */
+extern int s_send(HTTP_STREAM *sp, const void *buf, size_t size);
+
 
 extern void s_end(HTTP_STREAM *sp);
 
@@ -145,6 +145,9 @@ struct _HTTP_REQUEST {
 #if !defined(HTTPD_EXCLUDE_DATE)
     time_t req_ims;             /*!< \brief If-modified-since condition */
 #endif
+    char *req_inm;              /*!< \brief If-none-match condition */
+    char *req_range;            /*!< \brief Requested byte range */
+    char *req_ifrange;          /*!< \brief If-range condition */
     char *req_referer;          /*!< \brief Misspelled HTTP referrer */
     char *req_host;             /*!< \brief Server host */
     char *req_encoding;         /*!< \brief Accept encoding */
@@ -154,6 +157,47 @@ struct _HTTP_REQUEST {
     char *req_sid;               /* Session ID */
     char *req_sid_user;          /* Session ID user */
     uint32_t req_sid_perm;       /* Session ID permission */
+    
+    uint32_t req_log_start;      /* Access log, HiRes start count */
+    uint32_t req_log_ms;         /* Access log, start time in ms */
+};
+
+/*! \name HTTP header parser states */
+/*@{*/
+/*! \brief Waiting for the request line. */
+#define HTTP_PARSE_REQUEST      0
+/*! \brief Waiting for the header lines. */
+#define HTTP_PARSE_HEADER       1
+/*! \brief Empty line received, header is complete. */
+#define HTTP_PARSE_DONE         2
+/*! \brief Invalid request. */
+#define HTTP_PARSE_ERROR        3
+/*@}*/
+
+/*! \brief HTTP request header parser structure type. */
+typedef struct _HTTP_PARSER HTTP_PARSER;
+
+/*!
+ * \brief HTTP request header parser structure.
+ *
+ * The header is collected line by line in hp_buf. Lines with a value
+ * which is needed later are kept and terminated in place, the string
+ * pointers of the request point into this buffer. All other lines are
+ * dropped as soon as they have been evaluated.
+ *
+ * The informational values User-Agent and Referer are cut to
+ * HTTP_MAX_INFO_SIZE, and never use the last HTTP_HEADER_RESERVE
+ * bytes. So long values can not push out Cookie, Content-Length
+ * or Range.
+ */
+struct _HTTP_PARSER {
+    int hp_state;               /*!< \brief Parser state, HTTP_PARSE_ */
+    int hp_status;              /*!< \brief Response status in case of an error */
+    int hp_line;                /*!< \brief Start of the current line in hp_buf */
+    int hp_len;                 /*!< \brief Number of bytes used in hp_buf */
+    int hp_skip;                /*!< \brief Current line does not fit and is skipped */
+    int hp_minimal;             /*!< \brief Only request line, Host, Connection and Content-Length */
+    char hp_buf[HTTP_MAX_HEADER_SIZE];
 };
 
 /*! \brief HTTP session information structure type. */
@@ -163,6 +207,28 @@ typedef struct _HTTPD_SESSION HTTPD_SESSION;
 struct _HTTPD_SESSION {
     HTTP_STREAM *s_stream;
     HTTP_REQUEST s_req;
+    HTTP_PARSER s_parser;
+};
+
+/*! \brief Form-urlencoded argument list type. */
+typedef struct _HTTP_FORM HTTP_FORM;
+
+/*!
+ * \brief Form-urlencoded argument list.
+ *
+ * Names and values are decoded and terminated in place. The index
+ * keeps their offsets into form_buf, a value offset of zero marks a
+ * field without value. The arguments are stored in the unused part of
+ * the session's header buffer. Only if they do not fit there, a buffer
+ * of up to HTTP_FORM_MAX_SIZE bytes is taken from the heap.
+ */
+struct _HTTP_FORM {
+    char *form_buf;             /*!< \brief Decoded names and values */
+    char *form_alloc;           /*!< \brief Heap buffer, NULL if not used */
+    int form_fields;            /*!< \brief Number of indexed fields */
+    int form_next;              /*!< \brief Next field returned by HttpFormNext() */
+    uint16_t form_name[HTTP_FORM_MAX_FIELDS];   /*!< \brief Name offsets */
+    uint16_t form_value[HTTP_FORM_MAX_FIELDS];  /*!< \brief Value offsets */
 };
 
 /*! \name HTTP static texts */
@@ -184,6 +250,12 @@ extern const char ct_Referer[];
 extern const char ct_User_Agent[];
 extern const char ct_Content_Encoding[];
 extern const char ct_Location[];
+extern const char ct_If_None_Match[];
+extern const char ct_ETag[];
+extern const char ct_Range[];
+extern const char ct_If_Range[];
+extern const char ct_Accept_Ranges[];
+extern const char ct_Content_Range[];
 
 #if !defined(HTTPD_EXCLUDE_DATE)
 extern const char ct_If_Modified_Since[];
@@ -231,6 +303,39 @@ extern int HttpRegisterRootPath(char *path);
  */
 extern int HttpParseHeader(HTTPD_SESSION *hs);
 
+/*!
+ * \brief Parse only the parts of the HTTP header needed for a redirect.
+ *
+ * Evaluates the request line, Host, Connection and Content-Length.
+ * The URL is neither unescaped nor split, it includes the query.
+ *
+ * \param hs Pointer to the session info structure.
+ */
+extern int HttpParseHeaderMinimal(HTTPD_SESSION *hs);
+
+/*!
+ * \brief Initialize the HTTP header parser.
+ *
+ * \param hs Pointer to the session info structure.
+ */
+extern void HttpParseInit(HTTPD_SESSION *hs);
+
+/*!
+ * \brief Feed data into the HTTP header parser.
+ *
+ * The parser can be resumed with the next data at any position.
+ * Parsing is complete when the state of the parser has reached
+ * HTTP_PARSE_DONE or HTTP_PARSE_ERROR.
+ *
+ * \param hs  Pointer to the session info structure.
+ * \param buf Pointer to the received data.
+ * \param len Number of bytes available.
+ *
+ * \return The number of bytes consumed. Data following the
+ *         header is not consumed.
+ */
+extern int HttpParseExecute(HTTPD_SESSION *hs, const char *buf, int len);
+
 /*!
  * \brief Parse HTTP multipart header.
  *
@@ -364,6 +469,82 @@ extern char *HttpArgValue(HTTP_REQUEST * req);
  */
 extern const char *HttpArgValueSub(const char *str, const char *name, int *len);
 
+/*!
+ * \brief Read the form-urlencoded body of an HTTP post request.
+ *
+ * The complete body is read and split into name/value pairs, which
+ * are then available by HttpFormNext() and HttpFormValue(). Unlike
+ * HttpArgReadNext(), no memory is allocated per argument. HttpFormRelease()
+ * must be called when the arguments are no longer used.
+ *
+ * \param hs   Pointer to the session info structure.
+ * \param form Pointer to the argument list to fill.
+ *
+ * \return Number of fields or -1 in case of an error. On errors the list
+ *         contains the fields which could be read, if any. This is the
+ *         case if the body exceeds HTTP_FORM_MAX_SIZE or contains more
+ *         than HTTP_FORM_MAX_FIELDS fields.
+ */
+extern int HttpFormRead(HTTPD_SESSION *hs, HTTP_FORM *form);
+
+/*!
+ * \brief Split the query of an HTTP request line into name/value pairs.
+ *
+ * Works like HttpFormRead(), but evaluates the query string of the
+ * request line. The query string itself is left unchanged.
+ *
+ * \param hs   Pointer to the session info structure.
+ * \param form Pointer to the argument list to fill.
+ *
+ * \return Number of fields or -1 in case of an error.
+ */
+extern int HttpFormParseQuery(HTTPD_SESSION *hs, HTTP_FORM *form);
+
+/*!
+ * \brief Split a form-urlencoded string into name/value pairs.
+ *
+ * The string is decoded in place and must stay valid as long as the
+ * arguments are used.
+ *
+ * \param form Pointer to the argument list to fill.
+ * \param buf  Pointer to the string.
+ *
+ * \return Number of fields or -1 if the string contains more than
+ *         HTTP_FORM_MAX_FIELDS fields.
+ */
+extern int HttpFormParse(HTTP_FORM *form, char *buf);
+
+/*!
+ * \brief Get the next argument of a form.
+ *
+ * \param form  Pointer to the argument list.
+ * \param value Pointer to a variable that receives the value of the
+ *              argument, or NULL if the argument has no value.
+ *
+ * \return Pointer to the name of the argument. NULL is returned, if
+ *         all arguments had been returned.
+ */
+extern char *HttpFormNext(HTTP_FORM *form, char **value);
+
+/*!
+ * \brief Get the value of a form argument specified by its name.
+ *
+ * \param form Pointer to the argument list.
+ * \param name Name of the argument.
+ *
+ * \return Pointer to the value of the first argument with this name.
+ *         NULL is returned, if the argument does not exist or has no
+ *         value.
+ */
+extern char *HttpFormValue(HTTP_FORM *form, const char *name);
+
+/*!
+ * \brief Release the buffer of a form.
+ *
+ * \param form Pointer to the argument list.
+ */
+extern void HttpFormRelease(HTTP_FORM *form);
+
 /*!
  * \brief Default client handler.
  *
@@ -372,6 +553,21 @@ extern const char *HttpArgValueSub(const char *str, const char *name, int *len);
 void HttpdClientHandler(HTTP_STREAM *sp);
 void TlsRedirHandler(HTTP_STREAM *sp);
 
+/*!
+ * \brief Process a single request of a client connection.
+ *
+ * Used by servers which multiplex several connections over a
+ * small number of tasks, instead of running HttpdClientHandler()
+ * in a task per connection.
+ *
+ * \param sp Pointer to the stream's information structure.
+ *
+ * \return 0 if the connection should be kept alive, -1 if it
+ *         must be closed.
+ */
+int HttpdClientRequest(HTTP_STREAM *sp);
+int TlsRedirRequest(HTTP_STREAM *sp);
+
 /*@}*/
 
 /*!
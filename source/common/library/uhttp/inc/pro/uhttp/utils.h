@@ -45,6 +45,8 @@
  */
 /*@{*/
 
+#include <stdint.h>
+
 #if !defined(MIN)
 #define MIN(a, b) ((a) < (b) ? (a) : (b))
 #endif
@@ -57,5 +59,11 @@ extern char *UriUnescape(char *path);
 extern char *AllocConcatStrings(const char *str, ...);
 extern char *AllocConcatStringLen(const char *str1, const char *str2, int len2);
 
+/*! \brief Start value of a FNV-1a hash. */
+#define HTTP_HASH_INIT  2166136261UL
+
+extern uint32_t HttpHashBuf(uint32_t hash, const void *buf, int len);
+extern uint32_t HttpHashStr(uint32_t hash, const char *str, int nocase);
+
 /*@}*/
 #endif
@@ -56,9 +56,13 @@
 #include <pro/uhttp/streamio.h>
 #include <pro/uhttp/modules/mod_ssi.h>
 #include <pro/uhttp/mediatypes.h>
+#include <pro/uhttp/routes.h>
+#include "web_cache.h"
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 #include <memdebug.h>
 
 ISC_LIST(MEDIA_TYPE_ENTRY) mediaTypeList = ISC_LIST_INITIAL_TYPE(MEDIA_TYPE_ENTRY);
@@ -68,6 +72,9 @@ MEDIA_TYPE_ENTRY *MediaTypesFindByExt(const char *ext)
     MEDIA_TYPE_ENTRY *mt;
     int i;
 
+    if (HttpRouteLookup(HTTP_ROUTE_EXT, ext, (void **) &mt) == 0) {
+        return mt;
+    }
     for (mt = ISC_LIST_HEAD(mediaTypeList); mt; mt = ISC_LIST_NEXT(mt, media_link)) {
         i = strcasecmp(mt->media_ext, ext);
         if (i <= 0) {
@@ -80,6 +87,18 @@ MEDIA_TYPE_ENTRY *MediaTypesFindByExt(const char *ext)
     return mt;
 }
 
+int MediaTypeRoutes(void)
+{
+    MEDIA_TYPE_ENTRY *mt;
+
+    for (mt = ISC_LIST_HEAD(mediaTypeList); mt; mt = ISC_LIST_NEXT(mt, media_link)) {
+        if (HttpRouteAdd(HTTP_ROUTE_EXT, mt->media_ext, mt)) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
 MEDIA_TYPE_ENTRY *GetMediaTypeEntry(char *name)
 {
     MEDIA_TYPE_ENTRY *mt;
@@ -95,20 +114,147 @@ MEDIA_TYPE_ENTRY *GetMediaTypeEntry(char *name)
     return mt;
 }
 
+/*
+ * Create the quoted entity tag string, buffer size must be 11.
+ */
+static void EtagString(char *buf, uint32_t etag)
+{
+    static const char hex[] = "0123456789abcdef";
+    int i;
+
+    buf[0] = '"';
+    for (i = 0; i < 8; i++) {
+        buf[8 - i] = hex[etag & 0x0f];
+        etag >>= 4;
+    }
+    buf[9] = '"';
+    buf[10] = '\0';
+}
+
+/*
+ * Check the If-None-Match condition. The weak comparison is
+ * used, a W/ prefix of the tag in the request does not matter.
+ */
+static int EtagMatch(const char *inm, const char *tag)
+{
+    while (*inm == ' ') {
+        inm++;
+    }
+    if (*inm == '*') {
+        return 1;
+    }
+    return (strstr(inm, tag) != NULL);
+}
+
+/*
+ * Check the If-Range condition. Only the strong comparison with the
+ * entity tag can succeed, dates are checked by the caller.
+ */
+static int IfRangeMatch(const char *ifr, const char *tag)
+{
+    if (ifr == NULL) {
+        return 1;
+    }
+    while (*ifr == ' ') {
+        ifr++;
+    }
+    return (tag != NULL && strncmp(ifr, tag, strlen(tag)) == 0);
+}
+
+/*
+ * Parse a single byte range "bytes=first-last", "bytes=first-" or
+ * "bytes=-suffix". Returns 1 if the range is valid, -1 if it cannot
+ * be satisfied and 0 if the header is ignored. A list of ranges is
+ * ignored too, the complete file is sent in this case.
+ */
+static int RangeParse(const char *range, long size, long *first, long *last)
+{
+    char *ep;
+    long lo;
+    long hi;
+
+    while (*range == ' ') {
+        range++;
+    }
+    if (size < 0 || strncasecmp(range, "bytes=", 6) || strchr(range, ',')) {
+        return 0;
+    }
+    range += 6;
+    if (*range == '-') {
+        /* Suffix range, the last bytes of the file. */
+        hi = strtol(range + 1, &ep, 10);
+        if (ep == range + 1 || hi < 0) {
+            return 0;
+        }
+        if (hi == 0 || size == 0) {
+            return -1;
+        }
+        lo = (hi < size) ? size - hi : 0;
+        hi = size - 1;
+    } else {
+        lo = strtol(range, &ep, 10);
+        if (ep == range || *ep != '-' || lo < 0) {
+            return 0;
+        }
+        range = ep + 1;
+        if (*range == '\0') {
+            hi = size - 1;
+        } else {
+            hi = strtol(range, &ep, 10);
+            if (ep == range || hi < lo) {
+                return 0;
+            }
+            if (hi >= size) {
+                hi = size - 1;
+            }
+        }
+        if (lo >= size) {
+            return -1;
+        }
+    }
+    *first = lo;
+    *last = hi;
+
+    return 1;
+}
+
 int MediaTypeHandlerBinary(HTTPD_SESSION *hs, const MEDIA_TYPE_ENTRY *mt, const char *filepath)
 {
     int fd;
     int got;
+    int off = 0;
     char *data;
     long fsize = -1;
+    long first = 0;
+    long last = -1;
+    long remain;
+    int range = 0;
     int isgzip = 0;
     struct _stat s;
+    uint32_t etag;
+    char etag_str[11];
+    int has_etag;
 #if !defined(HTTPD_EXCLUDE_DATE)
     time_t mtime;
 #endif
 
 #define READ_DATA_SIZE  1460
 
+    /* The entity tag is available without opening the file. */
+    has_etag = (_etag(filepath, &etag) == 0);
+    if (has_etag) {
+        EtagString(etag_str, etag);
+
+        /* Check if-none-match condition. */
+        if (hs->s_req.req_inm && EtagMatch(hs->s_req.req_inm, etag_str)) {
+            HttpSendHeaderTop(hs, 304);
+            s_vputs(hs->s_stream, ct_ETag, ": ", etag_str, "\r\n", NULL);
+            HttpSendHeaderBottom(hs, NULL, NULL, 0, 0);
+            s_flush(hs->s_stream);
+            return 0;
+        }
+    }
+
     data = xmalloc(XM_ID_WEB, READ_DATA_SIZE);
 
     fd = _open(filepath, _O_BINARY | _O_RDONLY);
@@ -128,36 +274,92 @@ int MediaTypeHandlerBinary(HTTPD_SESSION *hs, const MEDIA_TYPE_ENTRY *mt, const
         } else {
             mtime = s.st_mtime;
         }
-        /* Check if-modified-since condition. */
-        if (hs->s_req.req_ims && s.st_mtime <= hs->s_req.req_ims) {
+#endif
+
+        /* The range is only valid for the file the client already has. */
+        if (hs->s_req.req_range && 
+            (IfRangeMatch(hs->s_req.req_ifrange, has_etag ? etag_str : NULL)
+#if !defined(HTTPD_EXCLUDE_DATE)
+             || RfcTimeParse(hs->s_req.req_ifrange) == mtime
+#endif
+            )) {
+            range = RangeParse(hs->s_req.req_range, fsize, &first, &last);
+        }
+
+#if !defined(HTTPD_EXCLUDE_DATE)
+        /* Check if-modified-since condition, if-none-match takes precedence. */
+        if (hs->s_req.req_inm == NULL && hs->s_req.req_ims && s.st_mtime <= hs->s_req.req_ims) {
             HttpSendHeaderTop(hs, 304);
             HttpSendHeaderDate(hs, mtime);
             HttpSendHeaderBottom(hs, NULL, NULL, 0, 0);
         } else
 #endif
-        {
+        if (range < 0) {
+            HttpSendHeaderTop(hs, 416);
+            s_printf(hs->s_stream, "%s: bytes */%ld\r\n", ct_Content_Range, fsize);
+            HttpSendHeaderBottom(hs, NULL, NULL, 0, 0);
+        } else if (range == 0 && web_CacheAdd(hs, mt, fd, fsize, has_etag ? etag_str : NULL) == 0) {
+            /* Sent from the new cache entry. */
+        } else {
             /* Read first chunk of data */
             got = _read(fd, data, READ_DATA_SIZE);
             if ((0x1f == (unsigned char)data[0]) && (0x8b == (unsigned char)data[1]))
             {
                 isgzip = 1;
             }
-        
-            HttpSendHeaderTop(hs, 200);
+            remain = (fsize < 0) ? LONG_MAX : fsize;
+
+            if (range > 0) {
+                if (first < got) {
+                    /* Range starts in the first chunk. */
+                    off = (int)first;
+                    got -= off;
+                } else if (_seek(fd, first, SEEK_SET) == first) {
+                    got = 0;
+                } else {
+                    /* File system cannot seek, send the complete file. */
+                    range = 0;
+                }
+            }
+            if (range > 0) {
+                remain = last - first + 1;
+                if (got > remain) {
+                    got = (int)remain;
+                }
+                HttpSendHeaderTop(hs, 206);
+                s_printf(hs->s_stream, "%s: bytes %ld-%ld/%ld\r\n", ct_Content_Range, first, last, fsize);
+            } else {
+                HttpSendHeaderTop(hs, 200);
+            }
 #if !defined(HTTPD_EXCLUDE_DATE) && (HTTP_VERSION >= 0x10)
             HttpSendHeaderDate(hs, mtime);
 #endif
-            HttpSendHeaderBottom(hs, mt->media_type, mt->media_subtype ? mt->media_subtype : mt->media_ext, fsize, isgzip);
-
-            /* Write first chunk */
-            s_write(data, 1, got, hs->s_stream);
+            if (has_etag) {
+                s_vputs(hs->s_stream, ct_ETag, ": ", etag_str, "\r\n", NULL);
+            }
+            if (fsize >= 0) {
+                s_vputs(hs->s_stream, ct_Accept_Ranges, ": bytes\r\n", NULL);
+            }
+            HttpSendHeaderBottom(hs, mt->media_type, mt->media_subtype ? mt->media_subtype : mt->media_ext, 
+                                 (range > 0) ? remain : fsize, isgzip);
 
-            do {
-                got = _read(fd, data, READ_DATA_SIZE);
+            /* The response to HEAD is the header only. */
+            if (hs->s_req.req_method != HTTP_METHOD_HEAD) {
+                /* Write first chunk */
                 if (got > 0) {
+                    s_write(&data[off], 1, got, hs->s_stream);
+                    remain -= got;
+                }
+
+                while (remain > 0) {
+                    got = _read(fd, data, (remain < READ_DATA_SIZE) ? (int)remain : READ_DATA_SIZE);
+                    if (got <= 0) {
+                        break;
+                    }
                     s_write(data, 1, got, hs->s_stream);
+                    remain -= got;
                 }
-            } while(got == READ_DATA_SIZE);
+            }
         }
         _close(fd);
     }
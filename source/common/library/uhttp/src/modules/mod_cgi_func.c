@@ -39,6 +39,7 @@
 #include "xmem.h"
 
 #include <pro/uhttp/modules/mod_cgi_func.h>
+#include <pro/uhttp/routes.h>
 
 #include <stdlib.h>
 #include <string.h>
@@ -52,6 +53,9 @@ HTTP_CGI_FUNCTION *HttpCgiFunctionLookup(const char *uri)
 
     HTTP_ASSERT(uri != NULL);
 
+    if (HttpRouteLookup(HTTP_ROUTE_CGI, uri, (void **) &cgi) == 0) {
+        return cgi;
+    }
     for (cgi = ISC_LIST_HEAD(cgiFunctionList); cgi; cgi = ISC_LIST_NEXT(cgi, cgi_link)) {
         i = strcasecmp(cgi->cgi_uri, uri);
         if (i <= 0) {
@@ -64,6 +68,18 @@ HTTP_CGI_FUNCTION *HttpCgiFunctionLookup(const char *uri)
     return cgi;
 }
 
+int HttpCgiFunctionRoutes(void)
+{
+    HTTP_CGI_FUNCTION *cgi;
+
+    for (cgi = ISC_LIST_HEAD(cgiFunctionList); cgi; cgi = ISC_LIST_NEXT(cgi, cgi_link)) {
+        if (HttpRouteAdd(HTTP_ROUTE_CGI, cgi->cgi_uri, cgi)) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
 int HttpRegisterCgiFunction(const char *uri, HTTP_CGI_HANDLER handler)
 {
     int rc = -1;
@@ -78,7 +94,10 @@ int HttpRegisterCgiFunction(const char *uri, HTTP_CGI_HANDLER handler)
             break;
         }
     }
-    if (i) {
+    if (i && HttpRoutesFrozen()) {
+        /* The route table cannot be extended. */
+    }
+    else if (i) {
         HTTP_CGI_FUNCTION *cgi;
 
         cgi = xcalloc(XM_ID_WEB, 1, sizeof(HTTP_CGI_FUNCTION));
@@ -101,6 +120,9 @@ int HttpRegisterCgiFunction(const char *uri, HTTP_CGI_HANDLER handler)
         /* Override registered handler. */
         cur->cgi_handler = handler;
     }
+    else if (HttpRoutesFrozen()) {
+        /* The route table refers to the entry, keep it. */
+    }
     else {
         /* Remove registered handler. */
         ISC_LIST_UNLINK_TYPE(cgiFunctionList, cur, cgi_link, HTTP_CGI_FUNCTION);
@@ -39,6 +39,7 @@
 #include "xmem.h"
 
 #include <pro/uhttp/modules/mod_redir.h>
+#include <pro/uhttp/routes.h>
 
 #include <stdlib.h>
 #include <string.h>
@@ -50,6 +51,9 @@ HTTP_LOCATION *HttpLocationLookup(const char *uri)
     HTTP_LOCATION *loc;
     int i;
 
+    if (HttpRouteLookup(HTTP_ROUTE_REDIR, uri, (void **) &loc) == 0) {
+        return loc;
+    }
     for (loc = ISC_LIST_HEAD(locationList); loc; loc = ISC_LIST_NEXT(loc, loc_link)) {
         i = strcasecmp(loc->loc_uri, uri);
         if (i <= 0) {
@@ -62,6 +66,18 @@ HTTP_LOCATION *HttpLocationLookup(const char *uri)
     return loc;
 }
 
+int HttpLocationRoutes(void)
+{
+    HTTP_LOCATION *loc;
+
+    for (loc = ISC_LIST_HEAD(locationList); loc; loc = ISC_LIST_NEXT(loc, loc_link)) {
+        if (HttpRouteAdd(HTTP_ROUTE_REDIR, loc->loc_uri, loc)) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
 int HttpRegisterRedir(const char *uri, const char *redir, int response)
 {
     int rc = -1;
@@ -83,7 +99,7 @@ int HttpRegisterRedir(const char *uri, const char *redir, int response)
             break;
         }
     }
-    if (i) {
+    if (i && !HttpRoutesFrozen()) {
         loc = xcalloc(XM_ID_WEB, 1, sizeof(HTTP_LOCATION));
         if (loc) {
             loc->loc_uri = xstrdup(XM_ID_WEB, uri);
@@ -38,6 +38,7 @@
  */
 
 #include "tcts.h"
+#include "tal.h"
 #include "xmem.h"
 
 #include <uhttp_io.h>
@@ -75,6 +76,18 @@
 #define HTTP_SSI_CMD_ENDBLOCK   10
 
 extern int HttpSsiParseExt (HTTPD_SESSION *hs, const char *buf, int len);
+extern HTTP_SSI_EXTHANDLER HttpSsiLookupExt (const char *name, int len);
+
+/*
+ * Memory for the compiled SSI files, 0 disables the templates.
+ */
+#ifndef HTTP_SSI_TEMPLATE_SIZE
+#define HTTP_SSI_TEMPLATE_SIZE  131072
+#endif
+
+#define SSI_OP_TEXT     1
+#define SSI_OP_EXT      2
+#define SSI_OP_CMD      3
 
 static const char* HttpSsiVarHandler(HTTPD_SESSION *hs, const char *name);
 
@@ -82,6 +95,11 @@ static HTTP_SSI_VARHANDLER ssivar_handler = HttpSsiVarHandler;
 
 int HttpSsiProcessFile(HTTPD_SESSION *hs, int fd);
 
+typedef struct _HTTP_SSI_TEMPLATE HTTP_SSI_TEMPLATE;
+
+static int HttpSsiOpen(const char *path, HTTP_SSI_TEMPLATE **tplp, int *fdp);
+static void HttpSsiSend(HTTPD_SESSION *hs, HTTP_SSI_TEMPLATE *tpl, int fd);
+
 typedef struct _HTTP_SSI_PARAM HTTP_SSI_PARAM;
 
 struct _HTTP_SSI_PARAM {
@@ -114,10 +132,10 @@ int HttpSsiIncludeHandler(HTTPD_SESSION *hs, HTTP_SSI_PARAM *prm)
             }
         }
         if (path) {
-            fd = _open(path, _O_BINARY | _O_RDONLY);
-            if (fd != -1) {
-                HttpSsiProcessFile(hs, fd);
-                _close(fd);
+            HTTP_SSI_TEMPLATE *tpl;
+
+            if (HttpSsiOpen(path, &tpl, &fd) == 0) {
+                HttpSsiSend(hs, tpl, fd);
                 xfree(path);
                 return 0;
             }
@@ -221,13 +239,47 @@ HTTP_SSI_COMMAND ssiCmdList[] = {
 
 #define HTTP_SSI_NUM_COMMANDS   (sizeof(ssiCmdList) / sizeof(HTTP_SSI_COMMAND))
 
-int HttpSsiParse(HTTPD_SESSION *hs, const char *buf, int len)
+typedef struct _HTTP_SSI_OP HTTP_SSI_OP;
+
+/*
+ * Operation of a compiled SSI file. The text refers to the template data.
+ */
+struct _HTTP_SSI_OP {
+    int op_type;                        /* SSI_OP_ */
+    const char *op_text;                /* Literal text or the unprocessed command */
+    int op_len;
+    HTTP_SSI_EXTHANDLER op_ext;         /* Resolved ASP variable */
+    HTTP_SSI_COMMAND *op_cmd;           /* Resolved SSI command */
+    HTTP_SSI_PARAM op_prm;
+};
+
+/*
+ * Compiled SSI file. Without data, the file is too large and is
+ * processed directly.
+ */
+struct _HTTP_SSI_TEMPLATE {
+    HTTP_SSI_TEMPLATE *tpl_next;
+    char *tpl_path;
+    char *tpl_data;                     /* File contents, or NULL */
+    HTTP_SSI_OP *tpl_op;
+    int tpl_ops;
+    long tpl_size;                      /* Memory used by the template */
+    int tpl_refs;                       /* Requests which use the template */
+    int tpl_stale;                      /* Flushed, the last user frees it */
+};
+
+static HTTP_SSI_TEMPLATE *ssiTemplateList;
+static long ssiTemplateUsed;
+/* Protects the template list and the reference counts. */
+static OS_SEMA ssiTemplateSema;
+static int ssiTemplateInit;
+
+/*
+ * Resolve the command and its parameter, the parameter refers to buf.
+ */
+static HTTP_SSI_COMMAND *HttpSsiParseCmd(const char *buf, int len, HTTP_SSI_PARAM *prm)
 {
     int i;
-    //const char *var_name;
-    //int var_name_len;
-    //const char *var_value;
-    //int var_value_len;
     HTTP_SSI_COMMAND *ssiCmd = NULL;
     HTTP_SSI_PARAM ssiPrm;
 
@@ -246,7 +298,7 @@ int HttpSsiParse(HTTPD_SESSION *hs, const char *buf, int len)
         }
     }
     if (i == HTTP_SSI_NUM_COMMANDS) {
-        return -1;
+        return NULL;
     }
     while (len && isspace((int)*buf)) {
         buf++;
@@ -290,6 +342,20 @@ int HttpSsiParse(HTTPD_SESSION *hs, const char *buf, int len)
             }
         }
     }
+    *prm = ssiPrm;
+
+    return ssiCmd;
+}
+
+int HttpSsiParse(HTTPD_SESSION *hs, const char *buf, int len)
+{
+    HTTP_SSI_COMMAND *ssiCmd;
+    HTTP_SSI_PARAM ssiPrm;
+
+    ssiCmd = HttpSsiParseCmd(buf, len, &ssiPrm);
+    if (ssiCmd == NULL) {
+        return -1;
+    }
     ssiCmd->icmd_handler(hs, &ssiPrm);
 
     return 0;
@@ -417,12 +483,311 @@ int HttpSsiProcessFile(HTTPD_SESSION *hs, int fd)
     return 0;
 }
 
+/*
+ * Add a text operation, if the text is not empty.
+ */
+static int HttpSsiCompileText(HTTP_SSI_OP *op, const char *text, const char *end)
+{
+    if (end > text) {
+        if (op) {
+            op->op_type = SSI_OP_TEXT;
+            op->op_text = text;
+            op->op_len = (int) (end - text);
+        }
+        return 1;
+    }
+    return 0;
+}
+
+/*
+ * Translate the file contents into operations. Returns the number of
+ * operations, which are only counted if op is NULL. Commands which
+ * cannot be resolved remain part of the text, like they would be sent
+ * by HttpSsiProcessFile.
+ */
+static int HttpSsiCompileOps(const char *data, long len, HTTP_SSI_OP *op)
+{
+    const char *lit = data;
+    const char *cp = data;
+    const char *cep;
+    HTTP_SSI_COMMAND *cmd;
+    HTTP_SSI_PARAM prm;
+    HTTP_SSI_EXTHANDLER ext;
+    int n = 0;
+
+    while ((cp = strchr(cp, '<')) != NULL) {
+        if (strncmp(cp, "<!--#", 5) == 0 && (cep = strstr(cp + 5, "-->")) != NULL) {
+            cmd = HttpSsiParseCmd(cp + 5, (int) (cep - cp) - 5, &prm);
+            if (cmd) {
+                n += HttpSsiCompileText(op ? &op[n] : NULL, lit, cp);
+                if (op) {
+                    op[n].op_type = SSI_OP_CMD;
+                    op[n].op_cmd = cmd;
+                    op[n].op_prm = prm;
+                }
+                n++;
+                lit = cep + 3;
+            }
+            cp = cep + 3;
+        }
+        else if (cp[1] == '%' && (cep = strstr(cp + 2, "%>")) != NULL) {
+            ext = HttpSsiLookupExt(cp + 2, (int) (cep - cp) - 2);
+            if (ext) {
+                n += HttpSsiCompileText(op ? &op[n] : NULL, lit, cp);
+                if (op) {
+                    op[n].op_type = SSI_OP_EXT;
+                    op[n].op_text = cp;
+                    op[n].op_len = (int) (cep - cp) + 2;
+                    op[n].op_ext = ext;
+                }
+                n++;
+                lit = cep + 2;
+            }
+            cp = cep + 2;
+        }
+        else {
+            cp++;
+        }
+    }
+    n += HttpSsiCompileText(op ? &op[n] : NULL, lit, data + len);
+
+    return n;
+}
+
+static void HttpSsiTemplateFree(HTTP_SSI_TEMPLATE *tpl)
+{
+    xfree(tpl->tpl_op);
+    xfree(tpl);
+}
+
+static void HttpSsiTemplateRelease(HTTP_SSI_TEMPLATE *tpl)
+{
+    int unused;
+
+    if (tpl) {
+        OS_RES_LOCK(&ssiTemplateSema);
+        tpl->tpl_refs--;
+        unused = (tpl->tpl_stale && tpl->tpl_refs == 0);
+        OS_RES_FREE(&ssiTemplateSema);
+
+        if (unused) {
+            HttpSsiTemplateFree(tpl);
+        }
+    }
+}
+
+static HTTP_SSI_TEMPLATE *HttpSsiTemplateFind(const char *path)
+{
+    HTTP_SSI_TEMPLATE *tpl;
+
+    if (!ssiTemplateInit) {
+        return NULL;
+    }
+    OS_RES_LOCK(&ssiTemplateSema);
+    for (tpl = ssiTemplateList; tpl; tpl = tpl->tpl_next) {
+        if (strcmp(tpl->tpl_path, path) == 0) {
+            tpl->tpl_refs++;
+            break;
+        }
+    }
+    OS_RES_FREE(&ssiTemplateSema);
+
+    return tpl;
+}
+
+/*
+ * Compile an opened file and add the template. If the file does not fit
+ * into the remaining memory, a template without data is added, which
+ * tells the next requests to process the file directly. In this case
+ * the file position is at the start again.
+ */
+static HTTP_SSI_TEMPLATE *HttpSsiTemplateCompile(const char *path, int fd)
+{
+    HTTP_SSI_TEMPLATE *tpl;
+    HTTP_SSI_TEMPLATE *cur;
+    HTTP_SSI_OP *op = NULL;
+    char *data;
+    long size;
+    long need;
+    long pos;
+    int plen;
+    int got;
+    int n;
+
+    if (HTTP_SSI_TEMPLATE_SIZE == 0 || !ssiTemplateInit) {
+        return NULL;
+    }
+    size = _filelength(fd);
+    plen = strlen(path) + 1;
+    need = sizeof(HTTP_SSI_TEMPLATE) + plen;
+    if (size >= 0 && ssiTemplateUsed + need + size + 1 <= HTTP_SSI_TEMPLATE_SIZE) {
+        need += size + 1;
+    } else {
+        size = -1;
+    }
+
+    tpl = xmalloc(XM_ID_WEB, need);
+    if (tpl == NULL) {
+        return NULL;
+    }
+    memset(tpl, 0, sizeof(HTTP_SSI_TEMPLATE));
+    tpl->tpl_path = (char *) &tpl[1];
+    memcpy(tpl->tpl_path, path, plen);
+
+    if (size >= 0) {
+        data = tpl->tpl_path + plen;
+        for (pos = 0; pos < size; pos += got) {
+            got = _read(fd, data + pos, (size_t) (size - pos));
+            if (got <= 0) {
+                break;
+            }
+        }
+        if (pos == size) {
+            data[size] = '\0';
+            n = HttpSsiCompileOps(data, size, NULL);
+            if (n) {
+                op = xmalloc(XM_ID_WEB, n * sizeof(HTTP_SSI_OP));
+            }
+            if (n == 0 || op) {
+                HttpSsiCompileOps(data, size, op);
+                tpl->tpl_data = data;
+                tpl->tpl_op = op;
+                tpl->tpl_ops = n;
+                need += n * sizeof(HTTP_SSI_OP);
+            }
+        }
+        if (tpl->tpl_data == NULL) {
+            _seek(fd, 0, SEEK_SET);
+        }
+    }
+    tpl->tpl_size = need;
+    tpl->tpl_refs = 1;
+
+    OS_RES_LOCK(&ssiTemplateSema);
+    for (cur = ssiTemplateList; cur; cur = cur->tpl_next) {
+        if (strcmp(cur->tpl_path, path) == 0) {
+            break;
+        }
+    }
+    if (cur || ssiTemplateUsed + tpl->tpl_size > HTTP_SSI_TEMPLATE_SIZE) {
+        /* Compiled by another request in the meantime or out of memory,
+           use it for this request only. */
+        tpl->tpl_stale = 1;
+    } else {
+        tpl->tpl_next = ssiTemplateList;
+        ssiTemplateList = tpl;
+        ssiTemplateUsed += tpl->tpl_size;
+    }
+    OS_RES_FREE(&ssiTemplateSema);
+
+    return tpl;
+}
+
+/*
+ * Get the template of a file. Returns -1 if the file does not exist.
+ * Otherwise the file is open, if the template has no data.
+ */
+static int HttpSsiOpen(const char *path, HTTP_SSI_TEMPLATE **tplp, int *fdp)
+{
+    HTTP_SSI_TEMPLATE *tpl;
+    int fd = -1;
+
+    tpl = HttpSsiTemplateFind(path);
+    if (tpl == NULL || tpl->tpl_data == NULL) {
+        fd = _open(path, _O_BINARY | _O_RDONLY);
+        if (fd == -1) {
+            HttpSsiTemplateRelease(tpl);
+            return -1;
+        }
+        if (tpl == NULL) {
+            tpl = HttpSsiTemplateCompile(path, fd);
+        }
+    }
+    *tplp = tpl;
+    *fdp = fd;
+
+    return 0;
+}
+
+/*
+ * Send the operations of the template, or process the file directly.
+ */
+static void HttpSsiSend(HTTPD_SESSION *hs, HTTP_SSI_TEMPLATE *tpl, int fd)
+{
+    const HTTP_SSI_OP *op;
+    int i;
+
+    if (tpl && tpl->tpl_data) {
+        for (i = 0, op = tpl->tpl_op; i < tpl->tpl_ops; i++, op++) {
+            switch (op->op_type) {
+            case SSI_OP_EXT:
+                if ((*op->op_ext) (hs) == 0) {
+                    break;
+                }
+                /* Bad ASP command, send it unprocessed. */
+                /* fall through */
+            case SSI_OP_TEXT:
+                s_write(op->op_text, 1, op->op_len, hs->s_stream);
+                break;
+            case SSI_OP_CMD:
+                op->op_cmd->icmd_handler(hs, (HTTP_SSI_PARAM *) &op->op_prm);
+                break;
+            }
+        }
+        s_flush(hs->s_stream);
+    } else {
+        HttpSsiProcessFile(hs, fd);
+    }
+    HttpSsiTemplateRelease(tpl);
+    if (fd != -1) {
+        _close(fd);
+    }
+}
+
+void HttpSsiInit(void)
+{
+    if (!ssiTemplateInit) {
+        OS_RES_CREATE(&ssiTemplateSema);
+        ssiTemplateInit = 1;
+    }
+}
+
+void HttpSsiFlushTemplates(void)
+{
+    HTTP_SSI_TEMPLATE *tpl;
+    HTTP_SSI_TEMPLATE *next;
+    HTTP_SSI_TEMPLATE *unused = NULL;
+
+    /* No template is compiled before HttpSsiInit(). */
+    if (!ssiTemplateInit) {
+        return;
+    }
+    OS_RES_LOCK(&ssiTemplateSema);
+    for (tpl = ssiTemplateList; tpl; tpl = next) {
+        next = tpl->tpl_next;
+        tpl->tpl_stale = 1;
+        if (tpl->tpl_refs == 0) {
+            tpl->tpl_next = unused;
+            unused = tpl;
+        }
+    }
+    ssiTemplateList = NULL;
+    ssiTemplateUsed = 0;
+    OS_RES_FREE(&ssiTemplateSema);
+
+    while (unused) {
+        next = unused->tpl_next;
+        HttpSsiTemplateFree(unused);
+        unused = next;
+    }
+}
+
 int HttpSsiHandler(HTTPD_SESSION *hs, const MEDIA_TYPE_ENTRY *mt, const char *filepath)
 {
+    HTTP_SSI_TEMPLATE *tpl;
     int fd;
 
-    fd = _open(filepath, _O_BINARY | _O_RDONLY);
-    if (fd == -1) {
+    if (HttpSsiOpen(filepath, &tpl, &fd)) {
         HttpSendError(hs, 404);
         return 0;
     }
@@ -436,9 +801,8 @@ int HttpSsiHandler(HTTPD_SESSION *hs, const MEDIA_TYPE_ENTRY *mt, const char *fi
 #endif
     HttpSendHeaderBottom(hs, mt->media_type, mt->media_subtype ? mt->media_subtype : mt->media_ext, -1, 0);
     s_set_flags(hs->s_stream, S_FLG_CHUNKED);
-    HttpSsiProcessFile(hs, fd);
+    HttpSsiSend(hs, tpl, fd);
     s_end(hs->s_stream);
-    _close(fd);
 
     return 0;
 }
@@ -42,6 +42,7 @@
 
 #include <pro/uhttp/modules/mod_ssi.h>
 #include <pro/uhttp/mediatypes.h>
+#include <pro/uhttp/routes.h>
 
 #include <stdlib.h>
 #include <string.h>
@@ -77,6 +78,9 @@ int HttpRegisterMediaType(char *ext, char *type, char *subtype, MEDIATYPE_HANDLE
                 cur->media_subtype = xstrdup(XM_ID_WEB, subtype);
                 cur->media_flags = 0;
             }
+            rc = 0;
+        } else if (HttpRoutesFrozen()) {
+            /* The route table refers to the entry, keep it. */
         } else {
             /* Remove entry. */
             ISC_LIST_UNLINK_TYPE(mediaTypeList, cur, media_link, MEDIA_TYPE_ENTRY);
@@ -85,10 +89,10 @@ int HttpRegisterMediaType(char *ext, char *type, char *subtype, MEDIATYPE_HANDLE
                 xfree(cur->media_subtype);
                 xfree(cur);
             }
+            rc = 0;
         }
-        rc = 0;
     }
-    if (handler && i) {
+    if (handler && i && !HttpRoutesFrozen()) {
         /* New entry. */
         mt = (MEDIA_TYPE_ENTRY *) xcalloc(XM_ID_WEB, 1, sizeof(MEDIA_TYPE_ENTRY));
         if (mt) {
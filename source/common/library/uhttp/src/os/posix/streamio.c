@@ -0,0 +1,890 @@
+/**************************************************************************
+*  Copyright (c) 2026 by Michael Fischer (www.emb4fun.de).
+*  All rights reserved.
+*
+*  This module based on the win example from the Ethernut
+*  (www.ethernut.de) project. Therefore:
+*
+*  Partial Copyright (C) 2012 by egnite GmbH.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without 
+*  modification, are permitted provided that the following conditions 
+*  are met:
+*  
+*  1. Redistributions of source code must retain the above copyright 
+*     notice, this list of conditions and the following disclaimer.
+*  2. Redistributions in binary form must reproduce the above copyright
+*     notice, this list of conditions and the following disclaimer in the 
+*     documentation and/or other materials provided with the distribution.
+*  3. Neither the name of the author nor the names of its contributors may 
+*     be used to endorse or promote products derived from this software 
+*     without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS 
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL 
+*  THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, 
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS 
+*  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, 
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF 
+*  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+*  SUCH DAMAGE.
+*
+***************************************************************************
+*  History:
+*
+*  16.10.2026  mifi  First Version, based on the tcts backend.
+**************************************************************************/
+#define __STREAMIO_C__
+
+/*=======================================================================*/
+/*  Include                                                              */
+/*=======================================================================*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <time.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#include "pro/uhttp/streamio.h"
+
+/*=======================================================================*/
+/*  All extern data                                                      */
+/*=======================================================================*/
+
+/*=======================================================================*/
+/*  All Structures and Common Constants                                  */
+/*=======================================================================*/
+
+/* 256 bit character set, used by StreamReadUntilChars */
+#define CHARSET_ADD(_set, _ch)   ((_set)[(uint8_t)(_ch) >> 5] |= (1UL << ((uint8_t)(_ch) & 31)))
+#define CHARSET_TEST(_set, _ch)  ((_set)[(uint8_t)(_ch) >> 5] &  (1UL << ((uint8_t)(_ch) & 31)))
+
+#define STREAM_LISTEN_BACKLOG  64
+#define STREAM_RECV_TMO_SEC    5
+
+typedef struct _client_param_
+{
+   HTTP_CLIENT_HANDLER  handler;
+   HTTP_STREAM         *sp;
+} client_param_t;
+
+/*=======================================================================*/
+/*  Definition of all global Data                                        */
+/*=======================================================================*/   
+
+/*=======================================================================*/
+/*  Definition of all local Data                                         */
+/*=======================================================================*/
+
+static stream_tmo_t *stream_tmo = NULL;
+
+/*=======================================================================*/
+/*  Definition of all local Procedures                                   */
+/*=======================================================================*/
+
+static void _activity (HTTP_STREAM *sp)
+{
+   /* The body timeout is restarted by every data transfer */
+   if ((stream_tmo != NULL) && (S_TMO_BODY == sp->strm_tmo_phase))
+   {
+      stream_tmo(sp, S_TMO_BODY);
+   }
+} /* _activity */
+
+static void *ClientThread (void *arg)
+{
+   client_param_t *cp = (client_param_t*)arg;
+   
+   cp->handler(cp->sp);
+   
+   close(cp->sp->strm_csock);
+   free(cp->sp);
+   free(cp);
+   
+   return(NULL);
+} /* ClientThread */
+
+static int _recv (HTTP_STREAM *sp, void *mem, size_t len, int flags)
+{
+   int got;
+   
+   got = (int)recv(sp->strm_csock, mem, len, flags);
+   if (got > 0)
+   {
+      _activity(sp);
+   }
+   
+   return(got);
+} /* _recv */
+
+static int _send (HTTP_STREAM *sp, const void *dataptr, size_t size)
+{
+   int rc;
+   
+   /* A client which has gone away must not raise SIGPIPE */
+   rc = (int)send(sp->strm_csock, dataptr, size, MSG_NOSIGNAL);
+   if (rc > 0)
+   {
+      sp->strm_bytes += rc;
+      _activity(sp);
+   }
+   
+   return(rc);
+} /* _send */
+
+static int _out (HTTP_STREAM *sp, const void *dataptr, size_t size)
+{
+   int      rc = 0;
+   uint8_t *data = (uint8_t*)dataptr;
+   int      free;
+   int      copy;
+   
+   while (size > 0)
+   {
+      free = STREAM_OBUF_SIZE - sp->strm_olen;
+      copy = (free >= size) ? size : free;
+      
+      memcpy(&sp->strm_obuf[STREAM_OBUF_HEAD + sp->strm_olen], data, copy);
+      sp->strm_olen += copy;
+      data          += copy;
+      size          -= copy;
+
+      if (STREAM_OBUF_SIZE == sp->strm_olen)
+      {
+         rc = s_flush(sp);
+      }
+   }
+
+   return(rc);
+} /* _out */
+
+static int _flush (HTTP_STREAM *sp, int last)
+{
+   int   rc   = 0;
+   char *data = &sp->strm_obuf[STREAM_OBUF_HEAD];
+   int   len  = sp->strm_olen;
+#ifdef HTTP_CHUNKED_TRANSFER
+   static const char hex[] = "0123456789abcdef";
+   int   val;
+   
+   if (sp->strm_flags & S_FLG_CHUNKED)
+   {
+      if (len != 0)
+      {
+         /* Add the trailer, and the size line in front of the data. */
+         data[len++] = '\r';
+         data[len++] = '\n';
+         
+         *--data = '\n';
+         *--data = '\r';
+         len += 2;
+         
+         val = sp->strm_olen;
+         do 
+         {
+            *--data = hex[val & 0x0F];
+            len++;
+            val >>= 4;
+         } while (val != 0);
+      }
+      
+      if (last)
+      {
+         /* Append the last chunk. */
+         memcpy(&data[len], "0\r\n\r\n", 5);
+         len += 5;
+      }
+   }
+#else
+   (void)last;
+#endif
+
+   if (len != 0)
+   {
+      rc = _send(sp, data, len);
+   }
+   sp->strm_olen = 0;
+   
+   return(rc);
+} /* _flush */
+
+/*=======================================================================*/
+/*  All code exported                                                    */
+/*=======================================================================*/
+
+int StreamInit (void)
+{
+   return(0);
+} /* StreamInit */
+
+
+int StreamInitSsl (ssl_write_t *func_write, ssl_read_t *func_read)
+{
+   (void)func_write;
+   (void)func_read;
+
+   /* TLS is not supported by the host backend */
+   return(-1);
+} /* StreamInitSsl */
+
+
+int StreamInitTimeout (stream_tmo_t *func)
+{
+   stream_tmo = func;
+
+   return(0);
+} /* StreamInitTimeout */
+
+
+/*
+ * Listen on the port given by params and run the handler in a detached
+ * thread for every client. An idle client is closed by the receive timeout.
+ */
+int StreamClientAccept (HTTP_CLIENT_HANDLER handler, const char *params)
+{
+   int                 on = 1;
+   unsigned short      port = 80;
+   SOCKET              sock;
+   SOCKET              csock;
+   struct sockaddr_in  addr;
+   struct sockaddr_in  caddr;
+   socklen_t           len;
+   struct timeval      tmo;
+   client_param_t     *cp;
+   pthread_t           thread;
+   
+   HTTP_ASSERT(handler != NULL);
+   if (params != NULL)
+   {
+      port = (unsigned short)atoi(params);
+   }
+   
+   sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+   if (sock < 0)
+   {
+      return(-1);
+   }
+   setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+   
+   memset(&addr, 0, sizeof(addr));
+   addr.sin_family      = AF_INET;
+   addr.sin_addr.s_addr = htonl(INADDR_ANY);
+   addr.sin_port        = htons(port);
+   
+   if ((bind(sock, (struct sockaddr*)&addr, sizeof(addr)) != 0) ||
+       (listen(sock, STREAM_LISTEN_BACKLOG) != 0))
+   {
+      close(sock);
+      return(-1);
+   }
+   
+   for (;;)
+   {
+      len   = sizeof(caddr);
+      csock = accept(sock, (struct sockaddr*)&caddr, &len);
+      if (csock < 0)
+      {
+         continue;
+      }
+      
+      tmo.tv_sec  = STREAM_RECV_TMO_SEC;
+      tmo.tv_usec = 0;
+      setsockopt(csock, SOL_SOCKET, SO_RCVTIMEO, &tmo, sizeof(tmo));
+      setsockopt(csock, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+      
+      cp = malloc(sizeof(client_param_t));
+      if (cp != NULL)
+      {
+         cp->handler = handler;
+         cp->sp      = calloc(1, sizeof(HTTP_STREAM));
+      }
+      if ((NULL == cp) || (NULL == cp->sp))
+      {
+         free(cp);
+         close(csock);
+         continue;
+      }
+      cp->sp->strm_ssock = sock;
+      cp->sp->strm_csock = csock;
+      memcpy(&cp->sp->strm_saddr, &addr, sizeof(cp->sp->strm_saddr));
+      memcpy(&cp->sp->strm_caddr, &caddr, sizeof(cp->sp->strm_caddr));
+      
+      if (pthread_create(&thread, NULL, ClientThread, cp) != 0)
+      {
+         close(csock);
+         free(cp->sp);
+         free(cp);
+         continue;
+      }
+      pthread_detach(thread);
+   }
+   
+   return(-1);
+} /* StreamClientAccept */
+
+
+const char *StreamInfo (HTTP_STREAM *sp, int item)
+{
+   /* One buffer per client thread */
+   static __thread char Info[INET_ADDRSTRLEN];
+   
+   Info[0] = 0;
+   switch (item)
+   {
+      case SITEM_REMOTE_ADDR:
+         inet_ntop(AF_INET, &sp->strm_caddr.sin_addr, Info, sizeof(Info));
+         break;
+      case SITEM_REMOTE_PORT:
+         snprintf(Info, sizeof(Info), "%u", ntohs(sp->strm_caddr.sin_port));
+         break;
+      case SITEM_SERVER_NAME:
+      case SITEM_SERVER_ADDR:
+         inet_ntop(AF_INET, &sp->strm_saddr.sin_addr, Info, sizeof(Info));
+         break;
+      case SITEM_SERVER_PORT:
+         snprintf(Info, sizeof(Info), "%u", ntohs(sp->strm_saddr.sin_port));
+         break;
+      default:
+         break;
+   }
+   
+   return(Info);
+} /* StreamInfo */
+
+
+int StreamReadUntilChars (HTTP_STREAM *sp, const char *delim, const char *ignore, char *buf, int siz)
+{
+   int            rc = 0;
+   int            skip = 0;
+   int            len;
+   uint32_t       delim_set[8];
+   uint32_t       stop_set[8];
+   const uint8_t *start;
+   const uint8_t *end;
+   const uint8_t *p;
+
+   HTTP_ASSERT(sp != NULL);
+
+   /*
+    * Build the character sets once per call. Like strchr() the
+    * terminating zero is part of the delimiter and ignore list.
+    */
+   memset(delim_set, 0, sizeof(delim_set));
+   if (delim) 
+   {
+      CHARSET_ADD(delim_set, 0);
+      for (p = (const uint8_t*)delim; *p != 0; p++)
+      {
+         CHARSET_ADD(delim_set, *p);
+      }
+   }
+   
+   memcpy(stop_set, delim_set, sizeof(stop_set));
+   if (ignore) 
+   {
+      CHARSET_ADD(stop_set, 0);
+      for (p = (const uint8_t*)ignore; *p != 0; p++)
+      {
+         CHARSET_ADD(stop_set, *p);
+      }
+   }
+
+   /* Do not read more characters than requested. */
+   while (rc < siz)
+   {
+      /* Check the current stream buffer. */
+      if (sp->strm_ipos == sp->strm_ilen)
+      {
+         /* No more buffered data, re-fill the buffer. */
+         int got = _recv(sp, sp->strm_ibuf, 1460, 0);
+         if (got <= 0)
+         {
+            /* Broken connection or timeout. */
+            if (got < 0) 
+            {
+               rc = -1;
+               skip = 0;
+            }
+            break;
+         }
+         
+         sp->strm_ilen = got;
+         sp->strm_ipos = 0;
+      }
+      
+      start = (const uint8_t*)&sp->strm_ibuf[sp->strm_ipos];
+      end   = (const uint8_t*)&sp->strm_ibuf[sp->strm_ilen];
+      
+      if (rc == 0)
+      {
+         /* Skip leading spaces. */
+         while ((start < end) && (*start == ' '))
+         {
+            start++;
+            skip++;
+         }
+         sp->strm_ipos = (int)(start - (const uint8_t*)sp->strm_ibuf);
+         
+         if (start == end)
+         {
+            continue;
+         }
+      }
+      
+      if ((end - start) > (siz - rc))
+      {
+         end = start + (siz - rc);
+      }
+      
+      /* Scan the run of characters which are neither delimiter nor ignored. */
+      p = start;
+      while ((p < end) && !CHARSET_TEST(stop_set, *p))
+      {
+         p++;
+      }
+      
+      len = (int)(p - start);
+      if (len > 0)
+      {
+         /* Add the run to the application buffer. */
+         if (buf)
+         {
+            memcpy(buf, start, len);
+            buf += len;
+         }
+         rc            += len;
+         sp->strm_ipos += len;
+      }
+      
+      if (p < end)
+      {
+         /* Delimiter or ignored character, consume it. */
+         sp->strm_ipos++;
+         rc++;
+         
+         if (CHARSET_TEST(delim_set, *p))
+         {
+            /* Delimiter found. */
+            break;
+         }
+      }
+   }
+   
+   if (buf) 
+   {
+      *buf = '\0';
+   }
+   
+   return(rc + skip);
+} /* StreamReadUntilChars */
+
+
+int StreamReadUntilString (HTTP_STREAM *sp, const char *delim, char *buf, int siz)
+{
+   int rc = 0;
+   int n;
+   int i;
+   int delen = strlen(delim);
+
+   HTTP_ASSERT(sp != NULL);
+
+   /* Do not read more characters than requested. */
+   while (rc < siz)
+   {
+      /* Check if the delimiter fits in the current stream buffer. */
+      if (sp->strm_ipos >= sp->strm_ilen - delen)
+      {
+         int got;
+         /* Not enough data to fit the delimiter, re-fill the buffer. */
+         sp->strm_ilen -= sp->strm_ipos;
+         memcpy(sp->strm_ibuf, sp->strm_ibuf + sp->strm_ipos, sp->strm_ilen);
+         got = _recv(sp, sp->strm_ibuf + sp->strm_ilen, sizeof(sp->strm_ibuf) - sp->strm_ilen, 0);
+         if (got <= 0)
+         {
+            /* Broken connection or timeout. */
+            if (got < 0) 
+            {
+               rc = -1;
+            }
+            break;
+         }
+         sp->strm_ilen += got;
+         sp->strm_ipos = 0;
+      }
+      
+      for (i = sp->strm_ipos, n = 0; i < sp->strm_ilen && rc + n < siz; i++, n++)
+      {
+         if (*delim == sp->strm_ibuf[i])
+         {
+            if (i + delen >= sp->strm_ilen)
+            {
+               break;
+            }
+            if (memcmp(&sp->strm_ibuf[i], delim, delen) == 0)
+            {
+               break;
+            }
+         }
+      }
+      
+      if (n)
+      {
+         memcpy(buf, sp->strm_ibuf + sp->strm_ipos, n);
+         buf += n;
+         rc += n;
+         sp->strm_ipos += n;
+      }
+      else
+      {
+         break;
+      }
+   }
+   
+   return(rc);
+} /* StreamReadUntilString */
+
+
+int StreamBoundaryInit (HTTP_BOUNDARY *bp, const char *delim)
+{
+   int i;
+   int len = strlen(delim);
+
+   HTTP_ASSERT(bp != NULL);
+   
+   if ((len < 1) || (len > 255))
+   {
+      return(-1);
+   }
+
+   bp->bnd_str = delim;
+   bp->bnd_len = len;
+   
+   /* Horspool skip table, the last character does not count */
+   memset(bp->bnd_skip, len, sizeof(bp->bnd_skip));
+   for (i = 0; i < (len - 1); i++)
+   {
+      bp->bnd_skip[(uint8_t)delim[i]] = (unsigned char)(len - 1 - i);
+   }
+   
+   return(0);
+} /* StreamBoundaryInit */
+
+
+int StreamReadUntilBoundary (HTTP_STREAM *sp, const HTTP_BOUNDARY *bp, char *buf, int siz)
+{
+   int   rc = 0;
+   int   i;
+   int   n;
+   int   found;
+   int   got;
+   int   len  = bp->bnd_len;
+   char  last = bp->bnd_str[len - 1];
+   char  ch;
+
+   HTTP_ASSERT(sp != NULL);
+
+   while (rc < siz)
+   {
+      /* 
+       * Search the buffered data. All positions in front of i
+       * can not be the start of the boundary.
+       */
+      found = 0;
+      i     = sp->strm_ipos;
+      while ((i + len) <= sp->strm_ilen)
+      {
+         ch = sp->strm_ibuf[i + len - 1];
+         if ((ch == last) && (0 == memcmp(&sp->strm_ibuf[i], bp->bnd_str, len - 1)))
+         {
+            found = 1;
+            break;
+         }
+         i += bp->bnd_skip[(uint8_t)ch];
+      }
+      
+      /* Copy the data in front of the boundary */
+      n = i - sp->strm_ipos;
+      if (n > (siz - rc))
+      {
+         n = siz - rc;
+      }
+      if (n)
+      {
+         memcpy(buf, &sp->strm_ibuf[sp->strm_ipos], n);
+         buf += n;
+         rc  += n;
+         sp->strm_ipos += n;
+      }
+      else if (found)
+      {
+         /* Boundary reached */
+         break;
+      }
+      else
+      {
+         /* The rest could be the start of the boundary, re-fill the buffer. */
+         sp->strm_ilen -= sp->strm_ipos;
+         memmove(sp->strm_ibuf, &sp->strm_ibuf[sp->strm_ipos], sp->strm_ilen);
+         sp->strm_ipos = 0;
+         
+         got = _recv(sp, &sp->strm_ibuf[sp->strm_ilen], sizeof(sp->strm_ibuf) - sp->strm_ilen, 0);
+         if (got <= 0)
+         {
+            /* Broken connection or timeout. */
+            if (got < 0) 
+            {
+               rc = -1;
+            }
+            break;
+         }
+         sp->strm_ilen += got;
+      }
+   }
+   
+   return(rc);
+} /* StreamReadUntilBoundary */
+
+
+
+int StreamPeek (HTTP_STREAM *sp, char **buf)
+{
+   HTTP_ASSERT(sp != NULL);
+
+   /* Check the current stream buffer. */
+   if (sp->strm_ipos == sp->strm_ilen)
+   {
+      /* No more buffered data, re-fill the buffer. */
+      int got = _recv(sp, sp->strm_ibuf, 1460, 0);
+      if (got <= 0)
+      {
+         /* Broken connection or timeout. */
+         return((got < 0) ? -1 : 0);
+      }
+      
+      sp->strm_ilen = got;
+      sp->strm_ipos = 0;
+   }
+   
+   *buf = &sp->strm_ibuf[sp->strm_ipos];
+   
+   return(sp->strm_ilen - sp->strm_ipos);
+} /* StreamPeek */
+
+
+void StreamSkip (HTTP_STREAM *sp, int len)
+{
+   HTTP_ASSERT(sp != NULL);
+   HTTP_ASSERT(len <= (sp->strm_ilen - sp->strm_ipos));
+   
+   sp->strm_ipos += len;
+} /* StreamSkip */
+
+
+int s_set_flags (HTTP_STREAM *sp, unsigned int flags)
+{
+#ifdef HTTP_CHUNKED_TRANSFER
+   s_flush(sp);
+
+   sp->strm_flags |= flags;
+
+   return(0);
+#else
+   (void)sp;
+   (void)flags; 
+   
+   return(-1);
+#endif
+} /* s_set_flags */
+
+
+void s_set_timeout (HTTP_STREAM *sp, int phase)
+{
+   HTTP_ASSERT(sp != NULL);
+   
+   if (phase != sp->strm_tmo_phase)
+   {
+      sp->strm_tmo_phase = phase;
+      
+      if (stream_tmo != NULL)
+      {
+         stream_tmo(sp, phase);
+      }
+   }
+} /* s_set_timeout */
+
+
+void s_set_status (HTTP_STREAM *sp, int status)
+{
+   HTTP_ASSERT(sp != NULL);
+   
+   sp->strm_status = status;
+   
+} /* s_set_status */
+
+
+int s_write (const void *buf, size_t size, size_t count, HTTP_STREAM *sp)
+{
+   HTTP_ASSERT(sp != NULL);
+   HTTP_ASSERT(buf != NULL);
+   
+   return( _out(sp, (const char *)buf, size * count) );
+} /* s_write */
+
+
+int s_send (HTTP_STREAM *sp, const void *buf, size_t size)
+{
+   const uint8_t *data = (const uint8_t*)buf;
+   int            rc   = 0;
+   size_t         free;
+   size_t         copy;
+   
+   HTTP_ASSERT(sp != NULL);
+   HTTP_ASSERT(buf != NULL);
+   
+   if (sp->strm_flags & S_FLG_CHUNKED)
+   {
+      return( _out(sp, buf, size) );
+   }
+   
+   /* The start of the data is sent together with the header */
+   free = (size_t)(STREAM_OBUF_SIZE - sp->strm_olen);
+   copy = (free >= size) ? size : free;
+   memcpy(&sp->strm_obuf[STREAM_OBUF_HEAD + sp->strm_olen], data, copy);
+   sp->strm_olen += (int)copy;
+   data          += copy;
+   size          -= copy;
+   
+   if (size > 0)
+   {
+      if (_flush(sp, 0) < 0)
+      {
+         return(-1);
+      }
+      
+      while (size > 0)
+      {
+         rc = _send(sp, data, size);
+         if (rc <= 0)
+         {
+            return(-1);
+         }
+         data += rc;
+         size -= (size_t)rc;
+      }
+   }
+   
+   return(0);
+} /* s_send */
+
+
+int s_puts (const char *str, HTTP_STREAM *sp)
+{
+   HTTP_ASSERT(sp != NULL);
+   HTTP_ASSERT(str != NULL);
+
+   return( _out(sp, str, strlen(str)) );
+} /* s_puts */
+
+
+int s_vputs (HTTP_STREAM *sp, ...)
+{
+   int rc = 0;
+   char *cp;
+   va_list ap;
+
+   HTTP_ASSERT(sp != NULL);
+
+   va_start(ap, sp);
+   while ((rc >= 0) && ((cp = va_arg(ap, char *)) != NULL))
+   {
+      rc = _out(sp, cp, strlen(cp));
+   }
+   va_end(ap);
+   
+   return(rc);
+} /* s_vputs */
+
+
+int s_printf (HTTP_STREAM *sp, const char *fmt, ...)
+{
+   int rc = 0;
+   int len;
+   int free;
+   va_list ap;
+
+   HTTP_ASSERT(sp != NULL);
+   HTTP_ASSERT(fmt != NULL);
+
+   /* Format directly into the free space of the output buffer. */
+   free = STREAM_OBUF_SIZE - sp->strm_olen;
+   va_start(ap, fmt);
+   len = vsnprintf(&sp->strm_obuf[STREAM_OBUF_HEAD + sp->strm_olen], free, fmt, ap);
+   va_end(ap);
+   
+   if (len < 0)
+   {
+      return(-1);
+   }
+   
+   if (len >= free)
+   {
+      /* 
+       * Does not fit, flush and format again. Output which is larger
+       * than the buffer will be truncated.
+       */
+      rc = s_flush(sp);
+      
+      free = STREAM_OBUF_SIZE;
+      va_start(ap, fmt);
+      len = vsnprintf(&sp->strm_obuf[STREAM_OBUF_HEAD], free, fmt, ap);
+      va_end(ap);
+      
+      if (len < 0)
+      {
+         return(-1);
+      }
+      
+      if (len >= free)
+      {
+         len = free - 1;
+      }
+   }
+   
+   sp->strm_olen += len;
+   
+   return(rc);
+} /* s_printf */
+
+
+int s_flush (HTTP_STREAM *sp)
+{
+   return( _flush(sp, 0) );
+} /* s_flush */
+
+
+void s_end (HTTP_STREAM *sp)
+{
+#ifdef HTTP_CHUNKED_TRANSFER
+   /* Remaining data and the last chunk are sent together. */
+   _flush(sp, 1);
+   
+   sp->strm_flags &= ~S_FLG_CHUNKED;
+#else
+   s_flush(sp);
+#endif
+} /* s_end */
+
+/*** EOF ***/
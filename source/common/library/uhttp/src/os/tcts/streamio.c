@@ -38,6 +38,14 @@
 *  History:
 *
 *  08.02.2015  mifi  First Version.
+*  16.10.2026  mifi  Added StreamPeek and StreamSkip.
+*  16.10.2026  mifi  Added StreamReadUntilBoundary.
+*  16.10.2026  mifi  StreamReadUntilChars scans and copies runs of characters.
+*  16.10.2026  mifi  Send a chunk with header and trailer in one _send.
+*  16.10.2026  mifi  s_printf and s_vputs do not use the heap anymore.
+*  16.10.2026  mifi  Added s_set_timeout.
+*  16.10.2026  mifi  Added s_set_status and the byte counter.
+*  16.10.2026  mifi  Added s_send.
 **************************************************************************/
 #define __STREAMIO_C__
 
@@ -59,8 +67,6 @@
 
 #include "pro\uhttp\streamio.h"
 
-static int send_chunked (SOCKET sock, const char *buf, int len);
-
 /*=======================================================================*/
 /*  All extern data                                                      */
 /*=======================================================================*/
@@ -69,6 +75,10 @@ static int send_chunked (SOCKET sock, const char *buf, int len);
 /*  All Structures and Common Constants                                  */
 /*=======================================================================*/
 
+/* 256 bit character set, used by StreamReadUntilChars */
+#define CHARSET_ADD(_set, _ch)   ((_set)[(uint8_t)(_ch) >> 5] |= (1UL << ((uint8_t)(_ch) & 31)))
+#define CHARSET_TEST(_set, _ch)  ((_set)[(uint8_t)(_ch) >> 5] &  (1UL << ((uint8_t)(_ch) & 31)))
+
 /*=======================================================================*/
 /*  Definition of all global Data                                        */
 /*=======================================================================*/   
@@ -80,13 +90,25 @@ static int send_chunked (SOCKET sock, const char *buf, int len);
 static ssl_write_t *ssl_write = NULL;
 static ssl_read_t  *ssl_read  = NULL;
 
+static stream_tmo_t *stream_tmo = NULL;
+
 /*=======================================================================*/
 /*  Definition of all local Procedures                                   */
 /*=======================================================================*/
 
-static int _recv (int s, void *mem, size_t len, int flags)
+static void _activity (HTTP_STREAM *sp)
+{
+   /* The body timeout is restarted by every data transfer */
+   if ((stream_tmo != NULL) && (S_TMO_BODY == sp->strm_tmo_phase))
+   {
+      stream_tmo(sp, S_TMO_BODY);
+   }
+} /* _activity */
+
+static int _recv (HTTP_STREAM *sp, void *mem, size_t len, int flags)
 {
    int                got = -1;
+   int                s   = sp->strm_csock;
    struct lwip_sock  *sock;
    void              *ssl;
    
@@ -104,12 +126,18 @@ static int _recv (int s, void *mem, size_t len, int flags)
       }   
    } 
    
+   if (got > 0)
+   {
+      _activity(sp);
+   }
+   
    return(got);
 } /* _recv */
 
-static int _send (int s, const void *dataptr, size_t size)
+static int _send (HTTP_STREAM *sp, const void *dataptr, size_t size)
 {
    int                rc = -1;
+   int                s  = sp->strm_csock;
    struct lwip_sock  *sock;
    void              *ssl;
    
@@ -127,6 +155,12 @@ static int _send (int s, const void *dataptr, size_t size)
       }
    }
    
+   if (rc > 0)
+   {
+      sp->strm_bytes += rc;
+      _activity(sp);
+   }
+   
    return(rc);
 } /* _send */
 
@@ -142,7 +176,7 @@ static int _out (HTTP_STREAM *sp, const void *dataptr, size_t size)
       free = STREAM_OBUF_SIZE - sp->strm_olen;
       copy = (free >= size) ? size : free;
       
-      memcpy(&sp->strm_obuf[sp->strm_olen], data, copy);
+      memcpy(&sp->strm_obuf[STREAM_OBUF_HEAD + sp->strm_olen], data, copy);
       sp->strm_olen += copy;
       data          += copy;
       size          -= copy;
@@ -156,6 +190,56 @@ static int _out (HTTP_STREAM *sp, const void *dataptr, size_t size)
    return(rc);
 } /* _out */
 
+static int _flush (HTTP_STREAM *sp, int last)
+{
+   int   rc   = 0;
+   char *data = &sp->strm_obuf[STREAM_OBUF_HEAD];
+   int   len  = sp->strm_olen;
+#ifdef HTTP_CHUNKED_TRANSFER
+   static const char hex[] = "0123456789abcdef";
+   int   val;
+   
+   if (sp->strm_flags & S_FLG_CHUNKED)
+   {
+      if (len != 0)
+      {
+         /* Add the trailer, and the size line in front of the data. */
+         data[len++] = '\r';
+         data[len++] = '\n';
+         
+         *--data = '\n';
+         *--data = '\r';
+         len += 2;
+         
+         val = sp->strm_olen;
+         do 
+         {
+            *--data = hex[val & 0x0F];
+            len++;
+            val >>= 4;
+         } while (val != 0);
+      }
+      
+      if (last)
+      {
+         /* Append the last chunk. */
+         memcpy(&data[len], "0\r\n\r\n", 5);
+         len += 5;
+      }
+   }
+#else
+   (void)last;
+#endif
+
+   if (len != 0)
+   {
+      rc = _send(sp, data, len);
+   }
+   sp->strm_olen = 0;
+   
+   return(rc);
+} /* _flush */
+
 /*=======================================================================*/
 /*  All code exported                                                    */
 /*=======================================================================*/
@@ -175,14 +259,51 @@ int StreamInitSsl (ssl_write_t *func_write, ssl_read_t *func_read)
 } /* StreamInitSsl */
 
 
+int StreamInitTimeout (stream_tmo_t *func)
+{
+   stream_tmo = func;
+
+   return(0);
+} /* StreamInitTimeout */
+
+
 int StreamReadUntilChars (HTTP_STREAM *sp, const char *delim, const char *ignore, char *buf, int siz)
 {
-   int  rc = 0;
-   int  skip = 0;
-   char ch;
+   int            rc = 0;
+   int            skip = 0;
+   int            len;
+   uint32_t       delim_set[8];
+   uint32_t       stop_set[8];
+   const uint8_t *start;
+   const uint8_t *end;
+   const uint8_t *p;
 
    HTTP_ASSERT(sp != NULL);
 
+   /*
+    * Build the character sets once per call. Like strchr() the
+    * terminating zero is part of the delimiter and ignore list.
+    */
+   memset(delim_set, 0, sizeof(delim_set));
+   if (delim) 
+   {
+      CHARSET_ADD(delim_set, 0);
+      for (p = (const uint8_t*)delim; *p != 0; p++)
+      {
+         CHARSET_ADD(delim_set, *p);
+      }
+   }
+   
+   memcpy(stop_set, delim_set, sizeof(stop_set));
+   if (ignore) 
+   {
+      CHARSET_ADD(stop_set, 0);
+      for (p = (const uint8_t*)ignore; *p != 0; p++)
+      {
+         CHARSET_ADD(stop_set, *p);
+      }
+   }
+
    /* Do not read more characters than requested. */
    while (rc < siz)
    {
@@ -190,7 +311,7 @@ int StreamReadUntilChars (HTTP_STREAM *sp, const char *delim, const char *ignore
       if (sp->strm_ipos == sp->strm_ilen)
       {
          /* No more buffered data, re-fill the buffer. */
-         int got = _recv(sp->strm_csock, sp->strm_ibuf, 1460, 0);
+         int got = _recv(sp, sp->strm_ibuf, 1460, 0);
          if (got <= 0)
          {
             /* Broken connection or timeout. */
@@ -206,29 +327,61 @@ int StreamReadUntilChars (HTTP_STREAM *sp, const char *delim, const char *ignore
          sp->strm_ipos = 0;
       }
       
-      ch = sp->strm_ibuf[sp->strm_ipos];
-      sp->strm_ipos++;
+      start = (const uint8_t*)&sp->strm_ibuf[sp->strm_ipos];
+      end   = (const uint8_t*)&sp->strm_ibuf[sp->strm_ilen];
       
-      if (rc == 0 && ch == ' ')
+      if (rc == 0)
       {
          /* Skip leading spaces. */
-         skip++;
-      } 
-      else 
+         while ((start < end) && (*start == ' '))
+         {
+            start++;
+            skip++;
+         }
+         sp->strm_ipos = (int)(start - (const uint8_t*)sp->strm_ibuf);
+         
+         if (start == end)
+         {
+            continue;
+         }
+      }
+      
+      if ((end - start) > (siz - rc))
       {
+         end = start + (siz - rc);
+      }
+      
+      /* Scan the run of characters which are neither delimiter nor ignored. */
+      p = start;
+      while ((p < end) && !CHARSET_TEST(stop_set, *p))
+      {
+         p++;
+      }
+      
+      len = (int)(p - start);
+      if (len > 0)
+      {
+         /* Add the run to the application buffer. */
+         if (buf)
+         {
+            memcpy(buf, start, len);
+            buf += len;
+         }
+         rc            += len;
+         sp->strm_ipos += len;
+      }
+      
+      if (p < end)
+      {
+         /* Delimiter or ignored character, consume it. */
+         sp->strm_ipos++;
          rc++;
          
-         if (delim && strchr(delim, ch)) 
+         if (CHARSET_TEST(delim_set, *p))
          {
             /* Delimiter found. */
             break;
          }
-         
-         if (buf && (ignore == NULL || strchr(ignore, ch) == NULL)) 
-         {
-            /* Add valid character to application buffer. */
-            *buf++ = ch;
-         }
       }
    }
    
@@ -260,7 +413,7 @@ int StreamReadUntilString (HTTP_STREAM *sp, const char *delim, char *buf, int si
          /* Not enough data to fit the delimiter, re-fill the buffer. */
          sp->strm_ilen -= sp->strm_ipos;
          memcpy(sp->strm_ibuf, sp->strm_ibuf + sp->strm_ipos, sp->strm_ilen);
-         got = _recv(sp->strm_csock, sp->strm_ibuf + sp->strm_ilen, sizeof(sp->strm_ibuf) - sp->strm_ilen, 0);
+         got = _recv(sp, sp->strm_ibuf + sp->strm_ilen, sizeof(sp->strm_ibuf) - sp->strm_ilen, 0);
          if (got <= 0)
          {
             /* Broken connection or timeout. */
@@ -306,6 +459,142 @@ int StreamReadUntilString (HTTP_STREAM *sp, const char *delim, char *buf, int si
 } /* StreamReadUntilString */
 
 
+int StreamBoundaryInit (HTTP_BOUNDARY *bp, const char *delim)
+{
+   int i;
+   int len = strlen(delim);
+
+   HTTP_ASSERT(bp != NULL);
+   
+   if ((len < 1) || (len > 255))
+   {
+      return(-1);
+   }
+
+   bp->bnd_str = delim;
+   bp->bnd_len = len;
+   
+   /* Horspool skip table, the last character does not count */
+   memset(bp->bnd_skip, len, sizeof(bp->bnd_skip));
+   for (i = 0; i < (len - 1); i++)
+   {
+      bp->bnd_skip[(uint8_t)delim[i]] = (unsigned char)(len - 1 - i);
+   }
+   
+   return(0);
+} /* StreamBoundaryInit */
+
+
+int StreamReadUntilBoundary (HTTP_STREAM *sp, const HTTP_BOUNDARY *bp, char *buf, int siz)
+{
+   int   rc = 0;
+   int   i;
+   int   n;
+   int   found;
+   int   got;
+   int   len  = bp->bnd_len;
+   char  last = bp->bnd_str[len - 1];
+   char  ch;
+
+   HTTP_ASSERT(sp != NULL);
+
+   while (rc < siz)
+   {
+      /* 
+       * Search the buffered data. All positions in front of i
+       * can not be the start of the boundary.
+       */
+      found = 0;
+      i     = sp->strm_ipos;
+      while ((i + len) <= sp->strm_ilen)
+      {
+         ch = sp->strm_ibuf[i + len - 1];
+         if ((ch == last) && (0 == memcmp(&sp->strm_ibuf[i], bp->bnd_str, len - 1)))
+         {
+            found = 1;
+            break;
+         }
+         i += bp->bnd_skip[(uint8_t)ch];
+      }
+      
+      /* Copy the data in front of the boundary */
+      n = i - sp->strm_ipos;
+      if (n > (siz - rc))
+      {
+         n = siz - rc;
+      }
+      if (n)
+      {
+         memcpy(buf, &sp->strm_ibuf[sp->strm_ipos], n);
+         buf += n;
+         rc  += n;
+         sp->strm_ipos += n;
+      }
+      else if (found)
+      {
+         /* Boundary reached */
+         break;
+      }
+      else
+      {
+         /* The rest could be the start of the boundary, re-fill the buffer. */
+         sp->strm_ilen -= sp->strm_ipos;
+         memmove(sp->strm_ibuf, &sp->strm_ibuf[sp->strm_ipos], sp->strm_ilen);
+         sp->strm_ipos = 0;
+         
+         got = _recv(sp, &sp->strm_ibuf[sp->strm_ilen], sizeof(sp->strm_ibuf) - sp->strm_ilen, 0);
+         if (got <= 0)
+         {
+            /* Broken connection or timeout. */
+            if (got < 0) 
+            {
+               rc = -1;
+            }
+            break;
+         }
+         sp->strm_ilen += got;
+      }
+   }
+   
+   return(rc);
+} /* StreamReadUntilBoundary */
+
+
+
+int StreamPeek (HTTP_STREAM *sp, char **buf)
+{
+   HTTP_ASSERT(sp != NULL);
+
+   /* Check the current stream buffer. */
+   if (sp->strm_ipos == sp->strm_ilen)
+   {
+      /* No more buffered data, re-fill the buffer. */
+      int got = _recv(sp, sp->strm_ibuf, 1460, 0);
+      if (got <= 0)
+      {
+         /* Broken connection or timeout. */
+         return((got < 0) ? -1 : 0);
+      }
+      
+      sp->strm_ilen = got;
+      sp->strm_ipos = 0;
+   }
+   
+   *buf = &sp->strm_ibuf[sp->strm_ipos];
+   
+   return(sp->strm_ilen - sp->strm_ipos);
+} /* StreamPeek */
+
+
+void StreamSkip (HTTP_STREAM *sp, int len)
+{
+   HTTP_ASSERT(sp != NULL);
+   HTTP_ASSERT(len <= (sp->strm_ilen - sp->strm_ipos));
+   
+   sp->strm_ipos += len;
+} /* StreamSkip */
+
+
 int s_set_flags (HTTP_STREAM *sp, unsigned int flags)
 {
 #ifdef HTTP_CHUNKED_TRANSFER
@@ -323,6 +612,31 @@ int s_set_flags (HTTP_STREAM *sp, unsigned int flags)
 } /* s_set_flags */
 
 
+void s_set_timeout (HTTP_STREAM *sp, int phase)
+{
+   HTTP_ASSERT(sp != NULL);
+   
+   if (phase != sp->strm_tmo_phase)
+   {
+      sp->strm_tmo_phase = phase;
+      
+      if (stream_tmo != NULL)
+      {
+         stream_tmo(sp, phase);
+      }
+   }
+} /* s_set_timeout */
+
+
+void s_set_status (HTTP_STREAM *sp, int status)
+{
+   HTTP_ASSERT(sp != NULL);
+   
+   sp->strm_status = status;
+   
+} /* s_set_status */
+
+
 int s_write (const void *buf, size_t size, size_t count, HTTP_STREAM *sp)
 {
    HTTP_ASSERT(sp != NULL);
@@ -332,6 +646,52 @@ int s_write (const void *buf, size_t size, size_t count, HTTP_STREAM *sp)
 } /* s_write */
 
 
+int s_send (HTTP_STREAM *sp, const void *buf, size_t size)
+{
+   const uint8_t *data = (const uint8_t*)buf;
+   int            rc   = 0;
+   size_t         free;
+   size_t         copy;
+   
+   HTTP_ASSERT(sp != NULL);
+   HTTP_ASSERT(buf != NULL);
+   
+   if (sp->strm_flags & S_FLG_CHUNKED)
+   {
+      return( _out(sp, buf, size) );
+   }
+   
+   /* The start of the data is sent together with the header */
+   free = (size_t)(STREAM_OBUF_SIZE - sp->strm_olen);
+   copy = (free >= size) ? size : free;
+   memcpy(&sp->strm_obuf[STREAM_OBUF_HEAD + sp->strm_olen], data, copy);
+   sp->strm_olen += (int)copy;
+   data          += copy;
+   size          -= copy;
+   
+   if (size > 0)
+   {
+      if (_flush(sp, 0) < 0)
+      {
+         return(-1);
+      }
+      
+      while (size > 0)
+      {
+         rc = _send(sp, data, size);
+         if (rc <= 0)
+         {
+            return(-1);
+         }
+         data += rc;
+         size -= (size_t)rc;
+      }
+   }
+   
+   return(0);
+} /* s_send */
+
+
 int s_puts (const char *str, HTTP_STREAM *sp)
 {
    HTTP_ASSERT(sp != NULL);
@@ -343,102 +703,89 @@ int s_puts (const char *str, HTTP_STREAM *sp)
 
 int s_vputs (HTTP_STREAM *sp, ...)
 {
-   int rc = -1;
-   int len;
+   int rc = 0;
    char *cp;
-   char *buf;
    va_list ap;
 
    HTTP_ASSERT(sp != NULL);
 
    va_start(ap, sp);
-   for (len = 0; (cp = va_arg(ap, char *)) != NULL; len += strlen(cp));
-   va_end(ap);
-   
-   buf = xmalloc(XM_ID_WEB, len + 1);
-   if (buf) 
+   while ((rc >= 0) && ((cp = va_arg(ap, char *)) != NULL))
    {
-      va_start(ap, sp);
-      for (*buf = '\0'; (cp = va_arg(ap, char *)) != NULL; strcat(buf, cp));
-      va_end(ap);
-      
-      rc = _out(sp, buf, strlen(buf));
-      
-      xfree(buf);
+      rc = _out(sp, cp, strlen(cp));
    }
+   va_end(ap);
+   
    return(rc);
 } /* s_vputs */
 
 
 int s_printf (HTTP_STREAM *sp, const char *fmt, ...)
 {
-   int rc = -1;
-   char *buf;
+   int rc = 0;
+   int len;
+   int free;
    va_list ap;
 
    HTTP_ASSERT(sp != NULL);
    HTTP_ASSERT(fmt != NULL);
 
-   buf = xmalloc(XM_ID_WEB, 1024);
-   if (buf)
+   /* Format directly into the free space of the output buffer. */
+   free = STREAM_OBUF_SIZE - sp->strm_olen;
+   va_start(ap, fmt);
+   len = vsnprintf(&sp->strm_obuf[STREAM_OBUF_HEAD + sp->strm_olen], free, fmt, ap);
+   va_end(ap);
+   
+   if (len < 0)
    {
+      return(-1);
+   }
+   
+   if (len >= free)
+   {
+      /* 
+       * Does not fit, flush and format again. Output which is larger
+       * than the buffer will be truncated.
+       */
+      rc = s_flush(sp);
+      
+      free = STREAM_OBUF_SIZE;
       va_start(ap, fmt);
-      rc = vsnprintf(buf, 1023, fmt, ap);
+      len = vsnprintf(&sp->strm_obuf[STREAM_OBUF_HEAD], free, fmt, ap);
       va_end(ap);
       
-      rc = _out(sp, buf, rc);
+      if (len < 0)
+      {
+         return(-1);
+      }
       
-      xfree(buf);
+      if (len >= free)
+      {
+         len = free - 1;
+      }
    }
+   
+   sp->strm_olen += len;
+   
    return(rc);
 } /* s_printf */
 
 
 int s_flush (HTTP_STREAM *sp)
 {
-   int rc;
-
-   if (sp->strm_olen != 0)
-   {
-#ifdef HTTP_CHUNKED_TRANSFER
-      if (sp->strm_flags & S_FLG_CHUNKED)
-      {
-         static const char *crlf = "\r\n";
-         char cs[11];
-      
-         itoa(sp->strm_olen, cs, 16);
-         strcat(cs, crlf);
-         rc  = _send(sp->strm_csock, cs, strlen(cs));
-         rc |= _send(sp->strm_csock, sp->strm_obuf, sp->strm_olen);
-         rc |= _send(sp->strm_csock, crlf, 2);
-      }   
-      else
-#endif      
-      {      
-         rc = _send(sp->strm_csock, sp->strm_obuf, sp->strm_olen);
-      }         
-      
-      sp->strm_olen = 0;
-   }
-   
-   return(rc);
+   return( _flush(sp, 0) );
 } /* s_flush */
 
 
 void s_end (HTTP_STREAM *sp)
 {
-   s_flush(sp);
-
 #ifdef HTTP_CHUNKED_TRANSFER
-   if (sp->strm_flags & S_FLG_CHUNKED)
-   {
-      _send(sp->strm_csock, "0\r\n\r\n", 5);
-   }
+   /* Remaining data and the last chunk are sent together. */
+   _flush(sp, 1);
    
    sp->strm_flags &= ~S_FLG_CHUNKED;
 #else
-   (void)sp;
-   (void)flags; 
+   s_flush(sp);
 #endif
 } /* s_end */
 
@@ -37,6 +37,7 @@
  */
 
 #include "tcts.h"
+#include "tal.h"
 #include "xmem.h"
 
 #include <cfg/http.h>
@@ -55,100 +56,134 @@ typedef struct _HTTP_RESPONSE_STATUS HTTP_RESPONSE_STATUS;
 struct _HTTP_RESPONSE_STATUS {
     int rs_code;
     const char *rs_text;
+    const char *rs_line;
+    int rs_len;
 };
 
+#define HTTP_STR_(x)    #x
+#define HTTP_STR(x)     HTTP_STR_(x)
+
+/*
+ * Status line and common headers are composed by the preprocessor,
+ * no formatting is needed at runtime.
+ */
+#define HTTP_STATUS_LINE(code, text) \
+    "HTTP/" HTTP_STR(HTTP_MAJOR_VERSION) "." HTTP_STR(HTTP_MINOR_VERSION) " " #code " " text "\r\nServer: uHTTP 0.0\r\n"
+
+#define RS(code, text) \
+    { code, text, HTTP_STATUS_LINE(code, text), sizeof(HTTP_STATUS_LINE(code, text)) - 1 }
+
 static const HTTP_RESPONSE_STATUS response_list[] = {
-    { 100, "Continue" },
-    { 101, "Switching Protocols" },
-    { 102, "Processing" },
-    { 103, "Checkpoint" },
-    { 200, "OK" },
-    { 201, "Created" },
-    { 202, "Accepted" },
+    RS(100, "Continue"),
+    RS(101, "Switching Protocols"),
+    RS(102, "Processing"),
+    RS(103, "Checkpoint"),
+    RS(200, "OK"),
+    RS(201, "Created"),
+    RS(202, "Accepted"),
 #if HTTP_VERSION >= 0x11
-    { 203, "Non-Authoritative Information" },
+    RS(203, "Non-Authoritative Information"),
 #endif
-    { 204, "No Content" },
-    { 205, "Reset Content" },
-    { 206, "Partial Content" },
-    { 207, "Multi-Status" },
-    { 208, "Already Reported" },
-    { 226, "IM Used" },
-    { 300, "Multiple Choices" },
-    { 301, "Moved Permanently" },
-    { 302, "Moved Temporarily" },
+    RS(204, "No Content"),
+    RS(205, "Reset Content"),
+    RS(206, "Partial Content"),
+    RS(207, "Multi-Status"),
+    RS(208, "Already Reported"),
+    RS(226, "IM Used"),
+    RS(300, "Multiple Choices"),
+    RS(301, "Moved Permanently"),
+    RS(302, "Moved Temporarily"),
 #if HTTP_VERSION >= 0x11
-    { 303, "See Other" },
+    RS(303, "See Other"),
 #endif
-    { 304, "Not Modified" },
+    RS(304, "Not Modified"),
 #if HTTP_VERSION >= 0x11
-    { 305, "Use Proxy" },
+    RS(305, "Use Proxy"),
 #endif
-    { 306, "Switch Proxy" },
+    RS(306, "Switch Proxy"),
 #if HTTP_VERSION >= 0x11
-    { 307, "Temporary Redirect" },
+    RS(307, "Temporary Redirect"),
 #endif
-    { 308, "Resume Incomplete" },
-    { 400, "Bad Request" },
-    { 401, "Unauthorized" },
-    { 402, "Payment Required" },
-    { 403, "Forbidden" },
-    { 404, "Not Found" },
-    { 405, "Not Allowed" },
-    { 406, "Not Acceptable" },
-    { 407, "Proxy Authentication Required" },
-    { 408, "Request Time-out" },
-    { 409, "Conflict" },
-    { 410, "Gone" },
-    { 411, "Length Required" },
-    { 412, "Precondition Failed" },
-    { 413, "Request Entity Too Large" },
-    { 414, "Request-URI Too Large" },
-    { 415, "Unsupported Media Type" },
-    { 416, "Requested Range Not Satisfiable" },
-    { 417, "Expectation Failed" },
-    { 418, "I'm a teapot" },
-    { 422, "Unprocessable Entity" },
-    { 423, "Locked" },
-    { 424, "Failed Dependency" },
-    { 425, "Unordered Collection" },
-    { 426, "Upgrade Required" },
-    { 428, "Precondition Required" },
-    { 429, "Too Many Requests" },
-    { 431, "Request Header Fields Too Large" },
-    { 444, "No Response" },
-    { 449, "Retry With" },
-    { 499, "Client Closed Request" },
-    { 500, "Internal Server Error" },
-    { 501, "Method Not Implemented" },
-    { 502, "Bad Gateway" },
-    { 503, "Service Temporarily Unavailable" },
-    { 504, "Gateway Time-out" },
-    { 505, "HTTP Version Not Supported" },
-    { 506, "Variant Also Negotiates" },
-    { 507, "Insufficient Storage" },
-    { 508, "Loop Detected" },
-    { 509, "Bandwidth Limit Exceeded" },
-    { 510, "Not Extended" },
-    { 511, "Network Authentication Required" },
-    { 598, "Network read timeout error" },
-    { 599, "Network connect timeout error" }
+    RS(308, "Resume Incomplete"),
+    RS(400, "Bad Request"),
+    RS(401, "Unauthorized"),
+    RS(402, "Payment Required"),
+    RS(403, "Forbidden"),
+    RS(404, "Not Found"),
+    RS(405, "Not Allowed"),
+    RS(406, "Not Acceptable"),
+    RS(407, "Proxy Authentication Required"),
+    RS(408, "Request Time-out"),
+    RS(409, "Conflict"),
+    RS(410, "Gone"),
+    RS(411, "Length Required"),
+    RS(412, "Precondition Failed"),
+    RS(413, "Request Entity Too Large"),
+    RS(414, "Request-URI Too Large"),
+    RS(415, "Unsupported Media Type"),
+    RS(416, "Requested Range Not Satisfiable"),
+    RS(417, "Expectation Failed"),
+    RS(418, "I'm a teapot"),
+    RS(422, "Unprocessable Entity"),
+    RS(423, "Locked"),
+    RS(424, "Failed Dependency"),
+    RS(425, "Unordered Collection"),
+    RS(426, "Upgrade Required"),
+    RS(428, "Precondition Required"),
+    RS(429, "Too Many Requests"),
+    RS(431, "Request Header Fields Too Large"),
+    RS(444, "No Response"),
+    RS(449, "Retry With"),
+    RS(499, "Client Closed Request"),
+    RS(500, "Internal Server Error"),
+    RS(501, "Method Not Implemented"),
+    RS(502, "Bad Gateway"),
+    RS(503, "Service Temporarily Unavailable"),
+    RS(504, "Gateway Time-out"),
+    RS(505, "HTTP Version Not Supported"),
+    RS(506, "Variant Also Negotiates"),
+    RS(507, "Insufficient Storage"),
+    RS(508, "Loop Detected"),
+    RS(509, "Bandwidth Limit Exceeded"),
+    RS(510, "Not Extended"),
+    RS(511, "Network Authentication Required"),
+    RS(598, "Network read timeout error"),
+    RS(599, "Network connect timeout error")
 };
 
 #define HTTP_NUM_RESPONSES   (sizeof(response_list) / sizeof(HTTP_RESPONSE_STATUS))
 
+/*
+ * Find the entry of a status code, the list is sorted.
+ */
+static const HTTP_RESPONSE_STATUS *HttpResponseFind(int code)
+{
+    int lo = 0;
+    int hi = (int)HTTP_NUM_RESPONSES - 1;
+    int mid;
+
+    while (lo <= hi) {
+        mid = (lo + hi) / 2;
+        if (response_list[mid].rs_code == code) {
+            return &response_list[mid];
+        }
+        if (response_list[mid].rs_code < code) {
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return NULL;
+}
+
 const char *HttpResponseText(int code)
 {
     const char *rp = NULL;
-    int i;
+    const HTTP_RESPONSE_STATUS *rs;
 
-    for (i = 0; i < (int)HTTP_NUM_RESPONSES; i++) {
-        if (code == response_list[i].rs_code) {
-            break;
-        }
-    }
-    if (i < (int)HTTP_NUM_RESPONSES && code == response_list[i].rs_code) {
-        rp = response_list[i].rs_text;
+    rs = HttpResponseFind(code);
+    if (rs) {
+        rp = rs->rs_text;
     }
     if (rp == NULL) {
         static const char *err_txt = "Error";
@@ -163,17 +198,129 @@ const char *HttpResponseText(int code)
     return rp;
 }
 
-void HttpSendStreamHeaderTop(HTTP_STREAM *stream, int status)
+#if !defined(HTTPD_EXCLUDE_DATE)
+
+/*
+ * Length of "Sun, 06 Nov 1994 08:49:37 GMT".
+ */
+#define HTTP_TIME_LEN   29
+
+/*
+ * Length of the complete "Date: ... GMT\r\n" header line.
+ */
+#define HTTP_DATE_LEN   (6 + HTTP_TIME_LEN + 2)
+
+static char   date_line[HTTP_DATE_LEN] = "Date: ";
+static time_t date_time = 0;
+
+static void Put2(char *buf, int val)
+{
+    buf[0] = (char)('0' + val / 10);
+    buf[1] = (char)('0' + val % 10);
+}
+
+/*
+ * Create the RFC 1123 time string in GMT, without gmtime() and
+ * its static buffer. The string is not terminated.
+ */
+static void HttpTimeString(char *buf, time_t t)
+{
+    static const char wkday[] = "ThuFriSatSunMonTueWed";
+    static const char month[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+    uint32_t secs = (uint32_t)t;
+    uint32_t days = secs / 86400;
+    uint32_t doe;
+    uint32_t yoe;
+    uint32_t doy;
+    uint32_t mp;
+    uint32_t year;
+    uint32_t mon;
+    uint32_t mday;
+
+    secs %= 86400;
+
+    /* Civil date from days since 1970-01-01, the year starts at March 1st. */
+    doe  = (days + 719468) % 146097;
+    yoe  = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    year = yoe + ((days + 719468) / 146097) * 400;
+    doy  = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    mp   = (5 * doy + 2) / 153;
+    mday = doy - (153 * mp + 2) / 5 + 1;
+    mon  = (mp < 10) ? mp + 2 : mp - 10;
+    if (mon < 2) {
+        year++;
+    }
+
+    memcpy(&buf[0], &wkday[(days % 7) * 3], 3);
+    buf[3] = ',';
+    buf[4] = ' ';
+    Put2(&buf[5], (int)mday);
+    buf[7] = ' ';
+    memcpy(&buf[8], &month[mon * 3], 3);
+    buf[11] = ' ';
+    Put2(&buf[12], (int)(year / 100));
+    Put2(&buf[14], (int)(year % 100));
+    buf[16] = ' ';
+    Put2(&buf[17], (int)(secs / 3600));
+    buf[19] = ':';
+    Put2(&buf[20], (int)((secs / 60) % 60));
+    buf[22] = ':';
+    Put2(&buf[23], (int)(secs % 60));
+    memcpy(&buf[25], " GMT", 4);
+}
+
+/*
+ * Send the Date header. The line is created only once per second,
+ * all other calls use the cached one.
+ */
+static void HttpSendStreamDate(HTTP_STREAM *stream)
+{
+    char line[HTTP_DATE_LEN];
+    time_t now = OSUnixtimeGet();
+
+    if (now != date_time) {
+        memcpy(line, "Date: ", 6);
+        HttpTimeString(&line[6], now);
+        line[HTTP_DATE_LEN - 2] = '\r';
+        line[HTTP_DATE_LEN - 1] = '\n';
+
+        TAL_CPU_DISABLE_ALL_INTS();
+        memcpy(date_line, line, HTTP_DATE_LEN);
+        date_time = now;
+        TAL_CPU_ENABLE_ALL_INTS();
+    } else {
+        TAL_CPU_DISABLE_ALL_INTS();
+        memcpy(line, date_line, HTTP_DATE_LEN);
+        TAL_CPU_ENABLE_ALL_INTS();
+    }
+    s_write(line, 1, HTTP_DATE_LEN, stream);
+}
+
+#endif
+
+/*
+ * Send the status line and the common headers.
+ */
+static void HttpSendStreamStatus(HTTP_STREAM *stream, int status)
 {
     static const char fmt_P[] = "HTTP/%d.%d %d %s\r\nServer: uHTTP 0.0\r\n";
+    const HTTP_RESPONSE_STATUS *rs;
+
+    s_set_status(stream, status);
+    rs = HttpResponseFind(status);
+    if (rs) {
+        s_write(rs->rs_line, 1, rs->rs_len, stream);
+    } else {
+        s_printf(stream, fmt_P, HTTP_MAJOR_VERSION, HTTP_MINOR_VERSION, status, HttpResponseText(status));
+    }
+}
 
-    s_printf(stream, fmt_P, HTTP_MAJOR_VERSION, HTTP_MINOR_VERSION, status, HttpResponseText(status));
+void HttpSendStreamHeaderTop(HTTP_STREAM *stream, int status)
+{
+    HttpSendStreamStatus(stream, status);
 
 #if !defined(HTTPD_EXCLUDE_DATE)
-    {
-        time_t now = OSUnixtimeGet();
-        s_vputs(stream, ct_Date, ": ", Rfc1123TimeString(gmtime(&now)), " GMT\r\n", NULL);
-    }
+    HttpSendStreamDate(stream);
 #endif
 }
 
@@ -184,9 +331,7 @@ void HttpSendHeaderTop(HTTPD_SESSION *hs, int status)
 
 void HttpSendStreamHeaderSse(HTTP_STREAM *stream)
 {
-    static const char fmt[] = "HTTP/%d.%d %d %s\r\nServer: uHTTP 0.0\r\n";
-
-    s_printf(stream, fmt, HTTP_MAJOR_VERSION, HTTP_MINOR_VERSION, 200, HttpResponseText(200));
+    HttpSendStreamStatus(stream, 200);
     s_puts("Content-Type: text/event-stream\r\n", stream);
     s_puts("Expires: 1 JAN 2018 00:00:00 GMT\r\n", stream);
     s_puts("Last-Modified: 1 JAN 2018 00:00:00 GMT\r\n", stream);
@@ -206,10 +351,16 @@ void HttpSendHeaderSse(HTTPD_SESSION *hs)
 
 void HttpSendStreamHeaderDate(HTTP_STREAM *stream, time_t mtime)
 {
+    static const char hdr[] = "Last-Modified: ";
+    char line[sizeof(hdr) - 1 + HTTP_TIME_LEN + 2];
+
     if (mtime) {
-        s_vputs(stream, ct_Last_Modified, ": ", Rfc1123TimeString(gmtime(&mtime)), " GMT\r\n", NULL);
-    }
+        memcpy(line, hdr, sizeof(hdr) - 1);
+        HttpTimeString(&line[sizeof(hdr) - 1], mtime);
+        memcpy(&line[sizeof(line) - 2], "\r\n", 2);
+        s_write(line, 1, sizeof(line), stream);
     }
+}
 
 void HttpSendHeaderDate(HTTPD_SESSION *hs, time_t mtime)
 {
@@ -220,15 +371,30 @@ void HttpSendHeaderDate(HTTPD_SESSION *hs, time_t mtime)
 
 void HttpSendStreamHeaderBottom(HTTP_STREAM *stream, const char *type, const char *subtype, int conn, long bytes)
 {
+    char num[12];
+    int pos;
+
     (void)conn;
     if (type && subtype) {
-        s_vputs(stream, ct_Content_Type, ": ", type, "/", subtype, "\r\n", NULL);
+        s_write("Content-Type: ", 1, 14, stream);
+        s_puts(type, stream);
+        s_write("/", 1, 1, stream);
+        s_puts(subtype, stream);
+        s_write("\r\n", 1, 2, stream);
     } else {
         s_puts("Content-Type: Unknown\r\n", stream);
     }
     
     if (bytes >= 0) {
-        s_printf(stream, "%s: %ld\r\n", ct_Content_Length, bytes);
+        /* Convert the length from the right, no formatting needed. */
+        pos = sizeof(num);
+        do {
+            num[--pos] = (char)('0' + bytes % 10);
+            bytes /= 10;
+        } while (bytes);
+        s_write("Content-Length: ", 1, 16, stream);
+        s_write(&num[pos], 1, sizeof(num) - pos, stream);
+        s_write("\r\n", 1, 2, stream);
     }
     
 #ifdef HTTP_CHUNKED_TRANSFER
@@ -309,82 +475,68 @@ void HttpSendError(HTTPD_SESSION *hs, int status)
     HttpSendStreamError(hs->s_stream, status, realm);
 }
 
-/*!
- * \brief Transmit a redirection page.
+/*
+ * Send a redirection without body. The location is the concatenation
+ * of the string arguments. The connection is kept alive if the client
+ * asked for it and no request body is left which was not read.
  */
-int HttpSendRedirection(HTTPD_SESSION *hs, int code, ...)
+static void HttpSendRedirectionV(HTTPD_SESSION *hs, const char *cookie, int code, va_list ap)
 {
-    va_list ap;
-    int len;
+    HTTP_STREAM *sp = hs->s_stream;
     char *cp;
-    char *loc;
 
-    va_start(ap, code);
-    for (len = 0; (cp = va_arg(ap, char *)) != NULL; len += strlen(cp));
-    va_end(ap);
-    loc = xmalloc(XM_ID_WEB, len + 1);
-    if (loc) {
-        static const char body[] =
-                "<html><body><a href=\"%s\">Continue</a></body></html>\r\n";
-        HTTP_STREAM *sp = hs->s_stream;
-
-        HttpSendHeaderTop(hs, code);
+#if HTTP_KEEP_ALIVE_REQ
+    if (hs->s_req.req_length > 0) {
+        hs->s_req.req_connection = HTTP_CONN_CLOSE;
+    }
+#else
+    hs->s_req.req_connection = HTTP_CONN_CLOSE;
+#endif
 
-        va_start(ap, code);
-        for (*loc = '\0'; (cp = va_arg(ap, char *)) != NULL; strcat(loc, cp));
-        va_end(ap);
+    HttpSendHeaderTop(hs, code);
 
-        /* Close the connection after the redirect */
-        hs->s_req.req_connection = HTTP_CONN_CLOSE;
+    s_puts(ct_Location, sp);
+    s_write(": ", 1, 2, sp);
+    while ((cp = va_arg(ap, char *)) != NULL) {
+        s_puts(cp, sp);
+    }
+    s_write("\r\n", 1, 2, sp);
 
-        s_vputs(sp, ct_Location, ": ", loc, "\r\n", NULL);
-        HttpSendHeaderBottom(hs, "text", "html", sizeof(body) - 1 + strlen(loc) - 2, 0);
+    if (cookie != NULL) {
+        s_vputs(sp, "Set-Cookie: ", cookie, "\r\n", NULL);
+    }
 
-        s_printf(sp, body, loc);
-        s_flush(sp);
-        xfree(loc);
+    s_puts("Content-Length: 0\r\n", sp);
+    if (hs->s_req.req_connection == HTTP_CONN_KEEP_ALIVE) {
+        s_puts("Connection: keep-alive\r\n\r\n", sp);
+    } else {
+        s_puts("Connection: close\r\n\r\n", sp);
     }
-    return 0;
+    s_flush(sp);
 }
 
-int HttpSendRedirectionCookie(HTTPD_SESSION *hs, char *cookie, int code, ...)
+/*!
+ * \brief Transmit a redirection.
+ */
+int HttpSendRedirection(HTTPD_SESSION *hs, int code, ...)
 {
     va_list ap;
-    int len;
-    char *cp;
-    char *loc;
 
     va_start(ap, code);
-    for (len = 0; (cp = va_arg(ap, char *)) != NULL; len += strlen(cp));
+    HttpSendRedirectionV(hs, NULL, code, ap);
     va_end(ap);
-    loc = xmalloc(XM_ID_WEB, len + 1);
-    if (loc) {
-        static const char body[] =
-                "<html><body><a href=\"%s\">Continue</a></body></html>\r\n";
-        HTTP_STREAM *sp = hs->s_stream;
 
-        HttpSendHeaderTop(hs, code);
-
-        va_start(ap, code);
-        for (*loc = '\0'; (cp = va_arg(ap, char *)) != NULL; strcat(loc, cp));
-        va_end(ap);
+    return 0;
+}
 
-        /* Close the connection after the redirect */
-        hs->s_req.req_connection = HTTP_CONN_CLOSE;
+int HttpSendRedirectionCookie(HTTPD_SESSION *hs, char *cookie, int code, ...)
+{
+    va_list ap;
 
-        s_vputs(sp, ct_Location, ": ", loc, "\r\n", NULL);
-        
-        if (cookie != NULL)
-        {
-            s_printf(sp, "Set-Cookie: %s\r\n", cookie); 
-        }
-        
-        HttpSendHeaderBottom(hs, "text", "html", sizeof(body) - 1 + strlen(loc) - 2, 0);
+    va_start(ap, code);
+    HttpSendRedirectionV(hs, cookie, code, ap);
+    va_end(ap);
 
-        s_printf(sp, body, loc);
-        s_flush(sp);
-        xfree(loc);
-    }
     return 0;
 }
 
@@ -0,0 +1,227 @@
+/**************************************************************************
+*  Copyright (c) 2026 by Michael Fischer (www.emb4fun.de).
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*  1. Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*
+*  2. Redistributions in binary form must reproduce the above copyright
+*     notice, this list of conditions and the following disclaimer in the
+*     documentation and/or other materials provided with the distribution.
+*
+*  3. Neither the name of the author nor the names of its contributors may
+*     be used to endorse or promote products derived from this software
+*     without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+*  THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+*  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+*  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+*  SUCH DAMAGE.
+*
+***************************************************************************
+*  History:
+*
+*  16.10.2026  mifi  First Version.
+*  17.10.2026  mifi  Use the shared FNV-1a hash, see HttpHashStr.
+**************************************************************************/
+#define __ROUTES_C__
+
+/*=======================================================================*/
+/*  Includes                                                             */
+/*=======================================================================*/
+#include <stdint.h>
+#include <string.h>
+
+#include <pro/uhttp/routes.h>
+#include <pro/uhttp/utils.h>
+
+/*=======================================================================*/
+/*  All Structures and Common Constants                                  */
+/*=======================================================================*/
+
+/*
+ * Number of slots for all media types, CGI functions and redirections
+ * together, must be a power of 2. It is filled up to 3/4 only, to keep
+ * the probe sequences short.
+ */
+#ifndef HTTP_ROUTE_TABLE_SIZE
+#define HTTP_ROUTE_TABLE_SIZE 128
+#endif
+
+#if ((HTTP_ROUTE_TABLE_SIZE & (HTTP_ROUTE_TABLE_SIZE - 1)) != 0)
+#error HTTP_ROUTE_TABLE_SIZE must be a power of 2
+#endif
+
+#define _ROUTE_MASK           (HTTP_ROUTE_TABLE_SIZE - 1)
+#define _ROUTE_LIMIT          ((HTTP_ROUTE_TABLE_SIZE * 3) / 4)
+
+typedef struct _route_
+{
+   uint32_t    dHash;
+   int         nKind;      /* 0 = free slot */
+   const char *pKey;       /* Key of the target, not copied */
+   void       *pTarget;
+} route_t;
+
+/*=======================================================================*/
+/*  Definition of all local Data                                         */
+/*=======================================================================*/
+
+static route_t RouteTable[HTTP_ROUTE_TABLE_SIZE];
+static int     nRoutes = 0;
+static int     nFrozen = 0;
+
+/*=======================================================================*/
+/*  Definition of all local Procedures                                   */
+/*=======================================================================*/
+
+/*************************************************************************/
+/*  KeyHash                                                              */
+/*                                                                       */
+/*  FNV-1a hash of the key, case is ignored like by the lists.           */
+/*                                                                       */
+/*  In    : nKind, pKey                                                  */
+/*  Out   : none                                                         */
+/*  Return: Hash                                                         */
+/*************************************************************************/
+static uint32_t KeyHash (int nKind, const char *pKey)
+{
+   return(HttpHashStr(HTTP_HASH_INIT ^ (uint32_t)nKind, pKey, 1));
+} /* KeyHash */
+
+/*=======================================================================*/
+/*  All code exported                                                    */
+/*=======================================================================*/
+
+/*************************************************************************/
+/*  HttpRoutesFreeze                                                     */
+/*                                                                       */
+/*  Build the route table from the media types, CGI functions and        */
+/*  redirections which are registered now. Afterwards the lookups use    */
+/*  the table, which is not changed anymore. Registered entries can      */
+/*  still be overridden, but no entry can be added or removed.           */
+/*                                                                       */
+/*  In    : none                                                         */
+/*  Out   : none                                                         */
+/*  Return: 0 = OK / -1 = error, the lists are used further              */
+/*************************************************************************/
+int HttpRoutesFreeze (void)
+{
+   int rc = -1;
+   
+   if (0 == nFrozen)
+   {
+      memset(RouteTable, 0x00, sizeof(RouteTable));
+      nRoutes = 0;
+      
+      if ((0 == MediaTypeRoutes()) && (0 == HttpCgiFunctionRoutes()) && (0 == HttpLocationRoutes()))
+      {
+         nFrozen = 1;
+         rc      = 0;
+      }
+   }
+   
+   return(rc);
+} /* HttpRoutesFreeze */
+
+/*************************************************************************/
+/*  HttpRoutesFrozen                                                     */
+/*                                                                       */
+/*  In    : none                                                         */
+/*  Out   : none                                                         */
+/*  Return: 1 = route table is used / 0 = lists are used                 */
+/*************************************************************************/
+int HttpRoutesFrozen (void)
+{
+   return(nFrozen);
+} /* HttpRoutesFrozen */
+
+/*************************************************************************/
+/*  HttpRouteAdd                                                         */
+/*                                                                       */
+/*  Add a route while the table is built. The key must be valid as       */
+/*  long as the target is registered.                                    */
+/*                                                                       */
+/*  In    : nKind, pKey, pTarget                                         */
+/*  Out   : none                                                         */
+/*  Return: 0 = OK / -1 = error                                          */
+/*************************************************************************/
+int HttpRouteAdd (int nKind, const char *pKey, void *pTarget)
+{
+   uint32_t dHash;
+   uint32_t dSlot;
+   
+   if ((1 == nFrozen) || (nRoutes >= _ROUTE_LIMIT) || (NULL == pKey))
+   {
+      return(-1);
+   }
+   
+   dHash = KeyHash(nKind, pKey);
+   for (dSlot = dHash & _ROUTE_MASK; RouteTable[dSlot].nKind != 0; dSlot = (dSlot + 1) & _ROUTE_MASK)
+   {
+      if ((RouteTable[dSlot].dHash == dHash) && (RouteTable[dSlot].nKind == nKind) &&
+          (0 == strcasecmp(RouteTable[dSlot].pKey, pKey)))
+      {
+         /* Key exists already */
+         return(-1);
+      }
+   }
+   
+   RouteTable[dSlot].dHash   = dHash;
+   RouteTable[dSlot].nKind   = nKind;
+   RouteTable[dSlot].pKey    = pKey;
+   RouteTable[dSlot].pTarget = pTarget;
+   nRoutes++;
+   
+   return(0);
+} /* HttpRouteAdd */
+
+/*************************************************************************/
+/*  HttpRouteLookup                                                      */
+/*                                                                       */
+/*  Find the target of a key. The table is not changed after it was      */
+/*  frozen, therefore no lock is needed.                                 */
+/*                                                                       */
+/*  In    : nKind, pKey, ppTarget                                        */
+/*  Out   : ppTarget, NULL if the key is not registered                  */
+/*  Return: 0 = OK / -1 = not frozen, the list must be used              */
+/*************************************************************************/
+int HttpRouteLookup (int nKind, const char *pKey, void **ppTarget)
+{
+   uint32_t dHash;
+   uint32_t dSlot;
+   
+   if (0 == nFrozen)
+   {
+      return(-1);
+   }
+   
+   *ppTarget = NULL;
+   
+   dHash = KeyHash(nKind, pKey);
+   for (dSlot = dHash & _ROUTE_MASK; RouteTable[dSlot].nKind != 0; dSlot = (dSlot + 1) & _ROUTE_MASK)
+   {
+      if ((RouteTable[dSlot].dHash == dHash) && (RouteTable[dSlot].nKind == nKind) &&
+          (0 == strcasecmp(RouteTable[dSlot].pKey, pKey)))
+      {
+         *ppTarget = RouteTable[dSlot].pTarget;
+         break;
+      }
+   }
+   
+   return(0);
+} /* HttpRouteLookup */
+
+/*** EOF ***/
@@ -45,6 +45,7 @@
 #include <pro/uhttp/utils.h>
 #include <pro/uhttp/uhttpd.h>
 #include <pro/uhttp/mediatypes.h>
+#include <pro/uhttp/modules/mod_ssi.h>
 
 #include <stdlib.h>
 #include <string.h>
@@ -53,6 +54,8 @@
 #include <memdebug.h>
 
 #include "web_sid.h"
+#include "web_log.h"
+#include "web_cache.h"
 
 #ifndef HTTP_MAX_REQUEST_SIZE
 #define HTTP_MAX_REQUEST_SIZE   64
@@ -62,6 +65,15 @@
 #define HTTP_MAX_ARG_SIZE      384
 #endif
 
+/* The form index keeps 16 bit offsets. */
+#if (HTTP_FORM_MAX_SIZE > 65535) || (HTTP_MAX_HEADER_SIZE > 65535)
+#error HTTP_FORM_MAX_SIZE and HTTP_MAX_HEADER_SIZE must not exceed 65535
+#endif
+
+#if (HTTP_HEADER_RESERVE >= HTTP_MAX_HEADER_SIZE)
+#error HTTP_HEADER_RESERVE must be less than HTTP_MAX_HEADER_SIZE
+#endif
+
 
 /*! Constant string "GET". */
 const char ct_GET[] = "GET";
@@ -105,6 +117,18 @@ const char ct_Date[] = "Date";
 const char ct_Content_Encoding[] = "Content-Encoding";
 /*! Constant string "Location". */
 const char ct_Location[] = "Location";
+/*! Constant string "If-None-Match". */
+const char ct_If_None_Match[] = "If-None-Match";
+/*! Constant string "ETag". */
+const char ct_ETag[] = "ETag";
+/*! Constant string "Range". */
+const char ct_Range[] = "Range";
+/*! Constant string "If-Range". */
+const char ct_If_Range[] = "If-Range";
+/*! Constant string "Accept-Ranges". */
+const char ct_Accept_Ranges[] = "Accept-Ranges";
+/*! Constant string "Content-Range". */
+const char ct_Content_Range[] = "Content-Range";
 
 char *http_root_path;
 
@@ -245,6 +269,190 @@ const char *HttpArgValueSub(const char *str, const char *name, int *len)
     return cp;
 }
 
+static int HttpFormHexDigit(char ch)
+{
+    if (ch >= '0' && ch <= '9')
+        return ch - '0';
+    if (ch >= 'a' && ch <= 'f')
+        return ch - 'a' + 10;
+    if (ch >= 'A' && ch <= 'F')
+        return ch - 'A' + 10;
+    return -1;
+}
+
+static int HttpFormIndex(HTTP_FORM *form, char *buf)
+{
+    char *rp = buf;
+    char *wp = buf;
+    char ch;
+    int hi;
+    int lo;
+    int i;
+
+    form->form_buf = buf;
+    form->form_fields = 0;
+    form->form_next = 0;
+    if (buf == NULL) {
+        return 0;
+    }
+    while (*rp) {
+        /* Skip empty fields. */
+        if (*rp == '&') {
+            rp++;
+            continue;
+        }
+        if (form->form_fields >= HTTP_FORM_MAX_FIELDS) {
+            return -1;
+        }
+        i = form->form_fields++;
+        form->form_name[i] = (uint16_t) (wp - buf);
+        form->form_value[i] = 0;
+        /* Decoding never expands, the writer stays behind the reader. */
+        while ((ch = *rp) != '\0' && ch != '&') {
+            rp++;
+            if (ch == '=' && form->form_value[i] == 0) {
+                *wp++ = '\0';
+                form->form_value[i] = (uint16_t) (wp - buf);
+                continue;
+            }
+            if (ch == '+') {
+                ch = ' ';
+            } else if (ch == '%' && (hi = HttpFormHexDigit(rp[0])) >= 0 && (lo = HttpFormHexDigit(rp[1])) >= 0) {
+                ch = (char) ((hi << 4) | lo);
+                rp += 2;
+            }
+            *wp++ = ch;
+        }
+        /* Check the delimiter before the terminator may overwrite it. */
+        if (*rp) {
+            rp++;
+        }
+        *wp++ = '\0';
+    }
+    return form->form_fields;
+}
+
+int HttpFormParse(HTTP_FORM *form, char *buf)
+{
+    form->form_alloc = NULL;
+
+    return HttpFormIndex(form, buf);
+}
+
+/*
+ * Get a buffer for the arguments. The free part of the header buffer
+ * is claimed, so the strings of the request remain valid.
+ */
+static char *HttpFormBuffer(HTTPD_SESSION *hs, HTTP_FORM *form, long len)
+{
+    HTTP_PARSER *hp = &hs->s_parser;
+    char *buf = NULL;
+
+    if (len < (long) sizeof(hp->hp_buf) - hp->hp_len) {
+        buf = hp->hp_buf + hp->hp_len;
+        hp->hp_len += (int) len + 1;
+    } else if (len <= HTTP_FORM_MAX_SIZE) {
+        buf = xmalloc(XM_ID_WEB, len + 1);
+        form->form_alloc = buf;
+    }
+    return buf;
+}
+
+int HttpFormRead(HTTPD_SESSION *hs, HTTP_FORM *form)
+{
+    long avail = hs->s_req.req_length;
+    long pos = 0;
+    char *buf;
+    char *cp;
+    int got;
+
+    form->form_alloc = NULL;
+    if (avail < 0) {
+        HttpFormRelease(form);
+        return -1;
+    }
+    buf = HttpFormBuffer(hs, form, avail);
+    while (avail) {
+        got = StreamPeek(hs->s_stream, &cp);
+        if (got <= 0) {
+            /* Broken connection or timeout. */
+            HttpFormRelease(form);
+            return -1;
+        }
+        if (got > avail) {
+            got = (int) avail;
+        }
+        if (buf) {
+            memcpy(buf + pos, cp, got);
+        }
+        StreamSkip(hs->s_stream, got);
+        pos += got;
+        avail -= got;
+    }
+    if (buf == NULL) {
+        /* Body too large or out of memory, it has been discarded. */
+        HttpFormRelease(form);
+        return -1;
+    }
+    buf[pos] = '\0';
+
+    return HttpFormIndex(form, buf);
+}
+
+int HttpFormParseQuery(HTTPD_SESSION *hs, HTTP_FORM *form)
+{
+    char *query = hs->s_req.req_query;
+    char *buf = NULL;
+    long len;
+
+    form->form_alloc = NULL;
+    if (query) {
+        len = (long) strlen(query);
+        buf = HttpFormBuffer(hs, form, len);
+        if (buf == NULL) {
+            HttpFormRelease(form);
+            return -1;
+        }
+        memcpy(buf, query, len + 1);
+    }
+    return HttpFormIndex(form, buf);
+}
+
+char *HttpFormNext(HTTP_FORM *form, char **value)
+{
+    int i = form->form_next;
+
+    if (i >= form->form_fields) {
+        *value = NULL;
+        return NULL;
+    }
+    form->form_next++;
+    *value = form->form_value[i] ? form->form_buf + form->form_value[i] : NULL;
+
+    return form->form_buf + form->form_name[i];
+}
+
+char *HttpFormValue(HTTP_FORM *form, const char *name)
+{
+    int i;
+
+    for (i = 0; i < form->form_fields; i++) {
+        if (strcmp(form->form_buf + form->form_name[i], name) == 0) {
+            return form->form_value[i] ? form->form_buf + form->form_value[i] : NULL;
+        }
+    }
+    return NULL;
+}
+
+void HttpFormRelease(HTTP_FORM *form)
+{
+    xfree(form->form_alloc);
+    form->form_alloc = NULL;
+    form->form_buf = NULL;
+    form->form_fields = 0;
+    form->form_next = 0;
+}
+
 int HttpParseMultipartHeader(HTTPD_SESSION *hs, const char *bnd, long *avail)
 {
     int rc = -1;
@@ -318,135 +526,351 @@ int HttpParseMultipartHeader(HTTPD_SESSION *hs, const char *bnd, long *avail)
     return rc;
 }
 
-int HttpParseHeader(HTTPD_SESSION *hs)
+static int HttpParseRequestLine(HTTPD_SESSION *hs, char *line)
 {
-    int got;
-    char *buf;
     char *cp;
+    char *url;
 
-    buf = xmalloc(XM_ID_WEB, HTTP_MAX_REQUEST_SIZE + 1);
-    if (buf == NULL) {
-        return -1;
+    /* Split the first word of the request. */
+    while (*line == ' ') {
+        line++;
     }
-    memset(&hs->s_req, 0, sizeof(HTTP_REQUEST));
-
-    /* Read the first word of the request. */
-    got = StreamReadUntilChars(hs->s_stream, " \n", "\r", buf, HTTP_MAX_REQUEST_SIZE);
-    if (got <= 0) {
-        xfree(buf);
-        return -1;
+    cp = strchr(line, ' ');
+    if (cp) {
+        *cp++ = '\0';
+    } else {
+        cp = line + strlen(line);
     }
     /* Expect a valid method. */
-    if (strcasecmp(buf, ct_GET) == 0) {
+    if (strcasecmp(line, ct_GET) == 0) {
         hs->s_req.req_method = HTTP_METHOD_GET;
     }
-    else if (strcasecmp(buf, ct_HEAD) == 0) {
+    else if (strcasecmp(line, ct_HEAD) == 0) {
         hs->s_req.req_method = HTTP_METHOD_HEAD;
     }
-    else if (strcasecmp(buf, ct_POST) == 0) {
+    else if (strcasecmp(line, ct_POST) == 0) {
         hs->s_req.req_method = HTTP_METHOD_POST;
     }
     else {
         /* Method not implemented. */
-        HttpSendError(hs, 501);
-        xfree(buf);
+        hs->s_parser.hp_status = 501;
         return -1;
     }
 
-    /* Read the second word of the request. */
-    got = StreamReadUntilChars(hs->s_stream, " \n", "\r", buf, HTTP_MAX_REQUEST_SIZE);
-    /* Expect a valid URI. */
-    cp = strchr(buf, '?');
+    /* Split the second word of the request, expect a valid URI. */
+    while (*cp == ' ') {
+        cp++;
+    }
+    url = cp;
+    cp = strchr(url, ' ');
     if (cp) {
         *cp++ = '\0';
-        hs->s_req.req_query = xstrdup(XM_ID_WEB, cp);
+    } else {
+        cp = url + strlen(url);
+    }
+    if (hs->s_parser.hp_minimal) {
+        /* Keep the escaped target including the query, e.g. for a redirect. */
+        hs->s_req.req_url = url;
+        return 0;
+    }
+    hs->s_req.req_query = strchr(url, '?');
+    if (hs->s_req.req_query) {
+        *hs->s_req.req_query++ = '\0';
     }
-    hs->s_req.req_url = UriUnescape(xstrdup(XM_ID_WEB, buf));
+    hs->s_req.req_url = UriUnescape(url);
 
-    /* Read the remaining part of the request. */
-    got = StreamReadUntilChars(hs->s_stream, "\n", " \r", buf, HTTP_MAX_REQUEST_SIZE);
     /* If no HTTP version is provided, then assume HTTP/0.9. */
-    if (strncasecmp(buf, "HTTP/", 5)) {
+    while (*cp == ' ') {
+        cp++;
+    }
+    if (strncasecmp(cp, "HTTP/", 5) || cp[5] == '\0' || cp[6] == '\0') {
         hs->s_req.req_version = 0x09;
     } else {
-        hs->s_req.req_version = buf[5] - '0';
+        hs->s_req.req_version = cp[5] - '0';
         hs->s_req.req_version <<= 4;
-        hs->s_req.req_version += buf[6] - '0';
+        hs->s_req.req_version += cp[7] - '0';
     }
+    return 0;
+}
 
-#if HTTP_VERSION >= 0x11 && HTTP_KEEP_ALIVE_REQ
-    hs->s_req.req_connection = HTTP_CONN_KEEP_ALIVE;
-#endif
-    do {
-        char **strval;
+/*
+ * Evaluate the Content-Length. A negative or malformed length would
+ * corrupt the body handling, the request is rejected.
+ */
+static void HttpParseContentLength(HTTPD_SESSION *hs, const char *cp)
+{
+    long len = -1;
 
-        /* Get next header name. */
-        if (StreamReadUntilChars(hs->s_stream, ":\n", "\r", buf, HTTP_MAX_REQUEST_SIZE) <= 0) {
-            /* Broken connection, stop parsing. */
-            break;
-        }
-        if (*buf == '\0') {
-            /* Empty line marks the end of the request header. */
-            break;
-        }
-        strval = NULL;
-        if (strcasecmp(buf, ct_Accept_Encoding) == 0) {
-            strval = &hs->s_req.req_encoding;
+    if (*cp >= '0' && *cp <= '9') {
+        len = strtol(cp, NULL, 10);
+    }
+    if (len < 0) {
+        hs->s_parser.hp_status = 400;
+        hs->s_parser.hp_state = HTTP_PARSE_ERROR;
+        len = 0;
+    }
+    hs->s_req.req_length = len;
+}
+
+/*
+ * Cut an informational value, which must not use the reserved part
+ * of the header buffer. Returns the number of bytes to keep of the
+ * line, or 0 if there is no room left.
+ */
+static int HttpParseInfoValue(HTTPD_SESSION *hs, char *line, char *cp)
+{
+    int room;
+
+    room = (int)sizeof(hs->s_parser.hp_buf) - HTTP_HEADER_RESERVE;
+    room -= hs->s_parser.hp_line + (int)(cp - line) + 1;
+    if (room > HTTP_MAX_INFO_SIZE) {
+        room = HTTP_MAX_INFO_SIZE;
+    }
+    if (room <= 0) {
+        return 0;
+    }
+    if ((int)strlen(cp) > room) {
+        cp[room] = '\0';
+    }
+    return (int)(cp - line) + (int)strlen(cp);
+}
+
+/*
+ * Evaluate a header line. Returns the number of bytes of the line
+ * which must be kept, because a string pointer of the request refers
+ * to it, or 0 if the line can be dropped.
+ */
+static int HttpParseHeaderLine(HTTPD_SESSION *hs, char *line, int len)
+{
+    char **strval = NULL;
+    char *cp;
+    int keep = len;
+
+    cp = strchr(line, ':');
+    if (cp == NULL) {
+        return 0;
+    }
+    *cp++ = '\0';
+    while (*cp == ' ' || *cp == '\t') {
+        cp++;
+    }
+
+    if (hs->s_parser.hp_minimal) {
+        /* Only the values which are needed for a redirect. */
+        if (strcasecmp(line, ct_Host) == 0) {
+            hs->s_req.req_host = cp;
+            return len;
         }
-        else if (strcasecmp(buf, ct_Authorization) == 0) {
-            strval = &hs->s_req.req_auth;
+        if (strcasecmp(line, ct_Content_Length) == 0) {
+            HttpParseContentLength(hs, cp);
         }
 #if HTTP_KEEP_ALIVE_REQ
-        else if (strcasecmp(buf, ct_Connection) == 0) {
-            got = StreamReadUntilChars(hs->s_stream, "\n", "\r", buf, HTTP_MAX_REQUEST_SIZE);
-            if (strcasecmp(buf, ct_close) == 0) {
+        else if (strcasecmp(line, ct_Connection) == 0) {
+            if (strcasecmp(cp, ct_close) == 0) {
                 hs->s_req.req_connection = HTTP_CONN_CLOSE;
             }
-            else if (strcasecmp(buf, ct_Keep_Alive) == 0) {
+            else if (strcasecmp(cp, ct_Keep_Alive) == 0) {
                 hs->s_req.req_connection = HTTP_CONN_KEEP_ALIVE;
             }
         }
 #endif
-        else if (strcasecmp(buf, ct_Content_Length) == 0) {
-            got = StreamReadUntilChars(hs->s_stream, "\n", "\r", buf, HTTP_MAX_REQUEST_SIZE);
-            hs->s_req.req_length = atol(buf);
-        }
-        else if (strcasecmp(buf, ct_Content_Type) == 0) {
-            strval = &hs->s_req.req_type;
-        }
-        else if (strcasecmp(buf, ct_Cookie) == 0) {
-            strval = &hs->s_req.req_cookie;
+        return 0;
+    }
+
+    if (strcasecmp(line, ct_Accept_Encoding) == 0) {
+        strval = &hs->s_req.req_encoding;
+    }
+    else if (strcasecmp(line, ct_Authorization) == 0) {
+        strval = &hs->s_req.req_auth;
+    }
+#if HTTP_KEEP_ALIVE_REQ
+    else if (strcasecmp(line, ct_Connection) == 0) {
+        if (strcasecmp(cp, ct_close) == 0) {
+            hs->s_req.req_connection = HTTP_CONN_CLOSE;
         }
-        else if (strcasecmp(buf, ct_Host) == 0) {
-            strval = &hs->s_req.req_host;
+        else if (strcasecmp(cp, ct_Keep_Alive) == 0) {
+            hs->s_req.req_connection = HTTP_CONN_KEEP_ALIVE;
         }
+    }
+#endif
+    else if (strcasecmp(line, ct_Content_Length) == 0) {
+        HttpParseContentLength(hs, cp);
+    }
+    else if (strcasecmp(line, ct_Content_Type) == 0) {
+        strval = &hs->s_req.req_type;
+    }
+    else if (strcasecmp(line, ct_Cookie) == 0) {
+        strval = &hs->s_req.req_cookie;
+    }
+    else if (strcasecmp(line, ct_Host) == 0) {
+        strval = &hs->s_req.req_host;
+    }
 #if !defined(HTTPD_EXCLUDE_DATE)
-        else if (strcasecmp(buf, ct_If_Modified_Since) == 0) {
-            got = StreamReadUntilChars(hs->s_stream, "\n", "\r", buf, HTTP_MAX_REQUEST_SIZE);
-            hs->s_req.req_ims = RfcTimeParse(buf);
-        }
+    else if (strcasecmp(line, ct_If_Modified_Since) == 0) {
+        hs->s_req.req_ims = RfcTimeParse(cp);
+    }
 #endif
-        else if (strcasecmp(buf, ct_Referer) == 0) {
-            strval = &hs->s_req.req_referer;
+    else if (strcasecmp(line, ct_If_None_Match) == 0) {
+        strval = &hs->s_req.req_inm;
+    }
+    else if (strcasecmp(line, ct_Range) == 0) {
+        strval = &hs->s_req.req_range;
+    }
+    else if (strcasecmp(line, ct_If_Range) == 0) {
+        strval = &hs->s_req.req_ifrange;
+    }
+    else if (strcasecmp(line, ct_Referer) == 0) {
+        strval = &hs->s_req.req_referer;
+        keep = HttpParseInfoValue(hs, line, cp);
+    }
+    else if (strcasecmp(line, ct_User_Agent) == 0) {
+        strval = &hs->s_req.req_agent;
+        keep = HttpParseInfoValue(hs, line, cp);
+    }
+    if (strval && keep) {
+        *strval = cp;
+        return keep;
+    }
+    return 0;
+}
+
+/*
+ * Evaluate the line which was collected in the header buffer.
+ */
+static void HttpParseLine(HTTPD_SESSION *hs)
+{
+    HTTP_PARSER *hp = &hs->s_parser;
+    char *line = hp->hp_buf + hp->hp_line;
+    int len = hp->hp_len - hp->hp_line;
+    int keep = 0;
+
+    if (hp->hp_skip) {
+        /* Line was too long, drop it. The request line is essential. */
+        hp->hp_skip = 0;
+        hp->hp_len = hp->hp_line;
+        if (hp->hp_state == HTTP_PARSE_REQUEST) {
+            hp->hp_status = 414;
+            hp->hp_state = HTTP_PARSE_ERROR;
         }
-        else if (strcasecmp(buf, ct_User_Agent) == 0) {
-            strval = &hs->s_req.req_agent;
+        return;
+    }
+
+    /* Remove trailing white space and terminate the line. */
+    while (len && (line[len - 1] == '\r' || line[len - 1] == ' ' || line[len - 1] == '\t')) {
+        len--;
+    }
+    line[len] = '\0';
+
+    if (hp->hp_state == HTTP_PARSE_REQUEST) {
+        /* Empty lines in front of the request line are ignored. */
+        if (len) {
+            if (HttpParseRequestLine(hs, line)) {
+                hp->hp_state = HTTP_PARSE_ERROR;
+            } else {
+                hp->hp_state = HTTP_PARSE_HEADER;
+                keep = len;
+            }
         }
-        else {
-            got = StreamReadUntilChars(hs->s_stream, "\n", NULL, NULL, 9999);
+    }
+    else if (len == 0) {
+        /* Empty line marks the end of the request header. */
+        hp->hp_state = HTTP_PARSE_DONE;
+    }
+    else {
+        keep = HttpParseHeaderLine(hs, line, len);
+    }
+
+    if (keep) {
+        hp->hp_line += keep + 1;
+    }
+    hp->hp_len = hp->hp_line;
+}
+
+void HttpParseInit(HTTPD_SESSION *hs)
+{
+    memset(&hs->s_req, 0, sizeof(HTTP_REQUEST));
+#if HTTP_VERSION >= 0x11 && HTTP_KEEP_ALIVE_REQ
+    hs->s_req.req_connection = HTTP_CONN_KEEP_ALIVE;
+#endif
+    hs->s_parser.hp_state = HTTP_PARSE_REQUEST;
+    hs->s_parser.hp_status = 0;
+    hs->s_parser.hp_line = 0;
+    hs->s_parser.hp_len = 0;
+    hs->s_parser.hp_skip = 0;
+    hs->s_parser.hp_minimal = 0;
+}
+
+int HttpParseExecute(HTTPD_SESSION *hs, const char *buf, int len)
+{
+    HTTP_PARSER *hp = &hs->s_parser;
+    const char *eol;
+    int used = 0;
+    int n;
+
+    while (used < len && hp->hp_state < HTTP_PARSE_DONE) {
+        eol = memchr(buf + used, '\n', len - used);
+        n = eol ? (int)(eol - (buf + used)) : len - used;
+        /* Collect the line, one byte is reserved for the terminator. */
+        if (!hp->hp_skip) {
+            if (hp->hp_len + n < (int)sizeof(hp->hp_buf)) {
+                memcpy(hp->hp_buf + hp->hp_len, buf + used, n);
+                hp->hp_len += n;
+            } else {
+                hp->hp_skip = 1;
+            }
         }
-        if (strval) {
-            got = StreamReadUntilChars(hs->s_stream, "\n", "\r", buf, HTTP_MAX_REQUEST_SIZE);
-            *strval = xstrdup(XM_ID_WEB, buf);
+        used += n;
+        if (eol == NULL) {
+            /* Incomplete line, resume with the next data. */
+            break;
         }
-    } while(1);
+        used++;
+        HttpParseLine(hs);
+    }
+    return used;
+}
 
-    xfree(buf);
+static int HttpParseHeaderExt(HTTPD_SESSION *hs, int minimal)
+{
+    char *buf;
+    int got;
+
+    HttpParseInit(hs);
+    hs->s_parser.hp_minimal = minimal;
+    while (hs->s_parser.hp_state < HTTP_PARSE_DONE) {
+        got = StreamPeek(hs->s_stream, &buf);
+        if (got <= 0) {
+            /* Broken connection or timeout. */
+            return -1;
+        }
+        /* The request has started, the header timeout applies. */
+        s_set_timeout(hs->s_stream, S_TMO_HEADER);
+        StreamSkip(hs->s_stream, HttpParseExecute(hs, buf, got));
+    }
+    s_set_timeout(hs->s_stream, S_TMO_BODY);
+    if (hs->s_parser.hp_state == HTTP_PARSE_ERROR) {
+        if (hs->s_parser.hp_status) {
+            HttpSendError(hs, hs->s_parser.hp_status);
+        }
+        return -1;
+    }
     return 0;
 }
 
+int HttpParseHeader(HTTPD_SESSION *hs)
+{
+    return HttpParseHeaderExt(hs, 0);
+}
+
+int HttpParseHeaderMinimal(HTTPD_SESSION *hs)
+{
+    return HttpParseHeaderExt(hs, 1);
+}
+
 int HttpRegisterRootPath(char *path)
 {
+    web_CacheFlush();
+    HttpSsiFlushTemplates();
     if (http_root_path) {
         xfree(http_root_path);
     }
@@ -461,13 +885,28 @@ int HttpRegisterRootPath(char *path)
     return 0;
 }
 
-void HttpdClientHandler(HTTP_STREAM *sp)
+static void HttpFreeRequest(HTTP_REQUEST *req)
+{
+   /* 
+    * The header strings are part of the session, see HTTP_PARSER.
+    * The argument pointer refers to the query and is not allocated.
+    */
+   xfree(req->req_argn);
+   xfree(req->req_realm);
+   xfree(req->req_bnd_dispo);
+   xfree(req->req_bnd_type);
+   xfree(req->req_sid);
+   xfree(req->req_sid_user);
+}
+
+int HttpdClientRequest(HTTP_STREAM *sp)
 {
    char *filename;
    HTTPD_SESSION *hs;
    HTTP_REQUEST *req;
-   MEDIA_TYPE_ENTRY *mt;
+   const MEDIA_TYPE_ENTRY *mt = NULL;
    int err = 0;
+   int rc  = -1;
    
    int   nMustRedir = 0;
    int   nSIDEntry  = -1;
@@ -475,186 +914,179 @@ void HttpdClientHandler(HTTP_STREAM *sp)
 
    hs = xmalloc(XM_ID_WEB, sizeof(HTTPD_SESSION));
    if (hs) {
-      do {
-         hs->s_stream = sp;
-         req = &hs->s_req;
+      hs->s_stream = sp;
+      req = &hs->s_req;
          
-         if (HttpParseHeader(hs)) {
-            break;
-         }
-         req->req_sid = WebSidParseCookie(hs->s_req.req_cookie);
-           
-         if ((*httpd_auth_validator) (hs)) {
-            err = 401;
-         }
-         else if ((*httpd_loc_redirector) (hs)) {
-            /* No redirection available. */
-            filename = AllocConcatStrings(HTTP_ROOT, req->req_url, NULL);
-            if (filename) {
-               mt = GetMediaTypeEntry(filename);
-               
+      if (HttpParseHeader(hs)) {
+         HttpFreeRequest(req);
+         xfree(hs);
+         return -1;
+      }
+      web_LogBegin(hs);
+      req->req_sid = WebSidParseCookie(hs->s_req.req_cookie);
+        
+      if ((*httpd_auth_validator) (hs)) {
+         err = 401;
+      }
+      else if ((*httpd_loc_redirector) (hs)) {
+         /* No redirection available. */
+         mt = web_CacheSend(hs);
+         if (mt != NULL) {
+            /* Sent from the cache of the static files. */
+         } else if ((filename = AllocConcatStrings(HTTP_ROOT, req->req_url, NULL)) != NULL) {
+            mt = GetMediaTypeEntry(filename);
+            
 #if (_IP_WEB_SID_SUPPORT >= 1)
-               /* Default user and permission */   
-               req->req_sid_user = NULL;
-               req->req_sid_perm = 0;  
-               
-               /* 
-                * Check in case of htm/html 
-                */ 
-               if ((mt->media_subtype != NULL) && (0 == strcmp(mt->media_subtype, "html")))
+            /* Default user and permission */   
+            req->req_sid_user = NULL;
+            req->req_sid_perm = 0;  
+            
+            /* 
+             * Check in case of htm/html 
+             */ 
+            if ((mt->media_subtype != NULL) && (0 == strcmp(mt->media_subtype, "html")))
+            {
+               /* Check for a valid session id */
+               nSIDEntry = WebSidCheck(hs, req->req_sid, WEB_SID_HTTP);
+               if (-1 == nSIDEntry)
+               {
+                  /* SID is not valid, create a cookie and redirect */
+                  pCookie    = WebSidCreateCookie(hs);
+                  nMustRedir = 1;
+               }
+               else
                {
-                  /* Check for a valid session id */
-                  nSIDEntry = WebSidCheck(hs, req->req_sid, WEB_SID_HTTP);
-                  if (-1 == nSIDEntry)
+                  /* req_sid_perm and req_sid_user are set by WebSidCheck */
+                  /* Here we have a vaild SID, check if access is granted */
+                  if (0 == strcmp(req->req_url, "login.htm"))
                   {
-                     /* SID is not valid, create a cookie and redirect */
-                     pCookie    = WebSidCreateCookie(hs);
-                     nMustRedir = 1;
+                     nMustRedir = 0;
                   }
                   else
                   {
-                     req->req_sid_perm = WebSidGetPermission(nSIDEntry);
-                     req->req_sid_user = WebSidGetUser(nSIDEntry); 
-                     
-                     /* Here we have a vaild SID, check if access is granted */
-                     if (0 == strcmp(req->req_url, "login.htm"))
+                     if (0 == WebSidCheckAccessGranted(hs, req->req_sid, WEB_SID_HTTP))
                      {
-                        nMustRedir = 0;
-                     }
-                     else
-                     {
-                        if (0 == WebSidCheckAccessGranted(hs, req->req_sid, WEB_SID_HTTP))
-                        {
-                           nMustRedir = 1;
-                        }
+                        nMustRedir = 1;
                      }
                   }
                }
-               
-               /*
-                * Check in case of cgi
-                */
-               if ((mt->media_subtype != NULL) && (0 == strcmp(mt->media_ext, "cgi")))
+            }
+            
+            /*
+             * Check in case of cgi
+             */
+            if ((mt->media_subtype != NULL) && (0 == strcmp(mt->media_ext, "cgi")))
+            {
+               /* Check for a valid session id */
+               nSIDEntry = WebSidCheck(hs, req->req_sid, WEB_SID_CGI);
+               if (-1 == nSIDEntry)
                {
-                  /* Check for a valid session id */
-                  nSIDEntry = WebSidCheck(hs, req->req_sid, WEB_SID_CGI);
-                  if (-1 == nSIDEntry)
+                  /* SID is not valid, create a cookie and redirect */
+                  pCookie    = WebSidCreateCookie(hs);
+                  nMustRedir = 1;
+               }
+               else
+               {
+                  /* req_sid_perm and req_sid_user are set by WebSidCheck */
+                  /* Here we have a vaild SID, check if access is granted */
+                  if (0 == strcmp(req->req_url, "cgi-bin/login.cgi"))
                   {
-                     /* SID is not valid, create a cookie and redirect */
-                     pCookie    = WebSidCreateCookie(hs);
-                     nMustRedir = 1;
+                     nMustRedir = 0;
                   }
                   else
                   {
-                     req->req_sid_perm = WebSidGetPermission(nSIDEntry);
-                     req->req_sid_user = WebSidGetUser(nSIDEntry); 
-                  
-                     /* Here we have a vaild SID, check if access is granted */
-                     if (0 == strcmp(req->req_url, "cgi-bin/login.cgi"))
-                     {
-                        nMustRedir = 0;
-                     }
-                     else
+                     if (0 == WebSidCheckAccessGranted(hs, req->req_sid, WEB_SID_CGI))
                      {
-                        if (0 == WebSidCheckAccessGranted(hs, req->req_sid, WEB_SID_CGI))
-                        {
-                           nMustRedir = 1;
-                        }
+                        nMustRedir = 1;
                      }
                   }
                }
+            }
 #else
-               (void)nSIDEntry;
-               req->req_sid_perm = 0xFFFFFFFF;               
+            (void)nSIDEntry;
+            req->req_sid_perm = 0xFFFFFFFF;               
 #endif /* (_IP_WEB_SID_SUPPORT >= 1) */
-     
-               if (0 == nMustRedir)
-               {
-                  if (mt == NULL) {
-                     err = 404;
-                  } else {
-                     err = mt->media_handler(hs, mt, filename);
-                  }
+  
+            if (0 == nMustRedir)
+            {
+               if (mt == NULL) {
+                  err = 404;
+               } else {
+                  err = mt->media_handler(hs, mt, filename);
                }
+            }
+            else
+            {
+               if (pCookie != NULL)
+               {
+                  /* The NONCE was created with the cookie too */
+                  HttpSendRedirectionCookie(hs, pCookie, 303, "/login.htm", NULL);      
+                  xfree(pCookie);
+               }    
                else
                {
-                  if (pCookie != NULL)
-                  {
-                     /* The NONCE was created with the cookie too */
-                     HttpSendRedirectionCookie(hs, pCookie, 303, "/login.htm", NULL);      
-                     xfree(pCookie);
-                  }    
-                  else
-                  {
-                     /* A new NONCE must be created for a new login */
-                     WebSidCreateNonce(hs);  
-                     HttpSendRedirection(hs, 303, "/login.htm", NULL);
-                  }   
-               }
-               
-               xfree(filename);
-            } else {
-               err = 404;
+                  /* A new NONCE must be created for a new login */
+                  WebSidCreateNonce(hs, NULL, 0);  
+                  HttpSendRedirection(hs, 303, "/login.htm", NULL);
+               }   
             }
+            
+            xfree(filename);
+         } else {
+            err = 404;
          }
-         if (err) {
-            HttpSendError(hs, err);
-         }
-         xfree(req->req_url);
-         xfree(req->req_query);
-         xfree(req->req_argp);
-         xfree(req->req_argn);
-         xfree(req->req_realm);
-         xfree(req->req_type);
-         xfree(req->req_cookie);
-         xfree(req->req_auth);
-         xfree(req->req_agent);
-         xfree(req->req_referer);
-         xfree(req->req_host);
-         xfree(req->req_encoding);
-         xfree(req->req_bnd_dispo);
-         xfree(req->req_bnd_type);
-         xfree(req->req_sid);
-         xfree(req->req_sid_user);
-      } while(req->req_connection == HTTP_CONN_KEEP_ALIVE);
-
+      }
+      if (err) {
+         HttpSendError(hs, err);
+      }
+      web_LogEnd(hs, mt);
+      if (req->req_connection == HTTP_CONN_KEEP_ALIVE) {
+         /* Wait for the next request. */
+         s_set_timeout(sp, S_TMO_IDLE);
+         rc = 0;
+      }
+      HttpFreeRequest(req);
       xfree(hs);
    }
+   return rc;
 }
 
-void TlsRedirHandler(HTTP_STREAM *sp)
+void HttpdClientHandler(HTTP_STREAM *sp)
+{
+   while (HttpdClientRequest(sp) == 0) {
+   }
+}
+
+int TlsRedirRequest(HTTP_STREAM *sp)
 {
    HTTPD_SESSION *hs;
    HTTP_REQUEST *req;
+   int rc = -1;
    
    hs = xmalloc(XM_ID_WEB, sizeof(HTTPD_SESSION));
    if (hs) {
-      do {
-         hs->s_stream = sp;
-         req = &hs->s_req;
+      hs->s_stream = sp;
+      req = &hs->s_req;
          
-         if (HttpParseHeader(hs) == 0) {
-            HttpSendRedirection(hs, 301, "https://", req->req_host, "/", req->req_url, NULL);
-            s_flush(sp);
+      if (HttpParseHeaderMinimal(hs) == 0) {
+         if ((req->req_host != NULL) && (req->req_url[0] == '/')) {
+            HttpSendRedirection(hs, 301, "https://", req->req_host, req->req_url, NULL);
+         } else {
+            HttpSendError(hs, 400);
          }
-         xfree(req->req_url);
-         xfree(req->req_query);
-         xfree(req->req_argp);
-         xfree(req->req_argn);
-         xfree(req->req_realm);
-         xfree(req->req_type);
-         xfree(req->req_cookie);
-         xfree(req->req_auth);
-         xfree(req->req_agent);
-         xfree(req->req_referer);
-         xfree(req->req_host);
-         xfree(req->req_encoding);
-         xfree(req->req_bnd_dispo);
-         xfree(req->req_bnd_type);
-         xfree(req->req_sid);
-         xfree(req->req_sid_user);
-      } while(req->req_connection == HTTP_CONN_KEEP_ALIVE);
-
+         if (req->req_connection == HTTP_CONN_KEEP_ALIVE) {
+            s_set_timeout(sp, S_TMO_IDLE);
+            rc = 0;
+         }
+      }
+      HttpFreeRequest(req);
       xfree(hs);
    }
+   return rc;
+}
+
+void TlsRedirHandler(HTTP_STREAM *sp)
+{
+   while (TlsRedirRequest(sp) == 0) {
+   }
 }
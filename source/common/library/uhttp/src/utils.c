@@ -175,3 +175,42 @@ char *AllocConcatStringLen(const char *str1, const char *str2, int len2)
     }
     return rp;
 }
+
+/*!
+ * \brief Continue a FNV-1a hash with a number of bytes.
+ *
+ * \param hash HTTP_HASH_INIT or the result of a previous call.
+ */
+uint32_t HttpHashBuf(uint32_t hash, const void *buf, int len)
+{
+    const uint8_t *bp = (const uint8_t *) buf;
+
+    while (len-- > 0) {
+        hash ^= *bp++;
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
+/*!
+ * \brief Continue a FNV-1a hash with a string.
+ *
+ * \param hash HTTP_HASH_INIT or the result of a previous call.
+ * \param nocase If not zero, upper case letters are hashed like lower
+ *        case ones. A NULL string leaves the hash unchanged.
+ */
+uint32_t HttpHashStr(uint32_t hash, const char *str, int nocase)
+{
+    uint8_t ch;
+
+    if (str) {
+        while ((ch = (uint8_t) *str++) != 0) {
+            if (nocase && ch >= 'A' && ch <= 'Z') {
+                ch |= 0x20;
+            }
+            hash ^= ch;
+            hash *= 16777619UL;
+        }
+    }
+    return hash;
+}
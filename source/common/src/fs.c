@@ -35,6 +35,11 @@
 *
 *  31.05.2019  mifi  First Version.
 *  15.08.2020  mifi  Added support for compressed web image data.
+*  16.10.2026  mifi  Stream the upload to a temporary file.
+*  16.10.2026  mifi  Flush the web cache at mount and unmount.
+*  16.10.2026  mifi  Flush the compiled SSI files at mount and unmount.
+*  17.10.2026  mifi  The upload context is owned by the session.
+*  17.10.2026  mifi  Replace the image by a backup rename, recover at mount.
 **************************************************************************/
 #define __FS_C__
 
@@ -55,8 +60,10 @@
 #include "fs_xfile.h"
 #include "fs_romfs.h"
 #include "ipweb.h"
+#include "web_cache.h"
 #include "xfile.h"
 #include "xbin.h"
+#include "adler32.h"
 
 /*=======================================================================*/
 /*  Definition of all extern Data                                        */
@@ -75,6 +82,46 @@ int xbin_Copy (uint8_t bIndex);
 
 #define ROMFS_HTTP_ROOT_PATH  "ROMFS:/htdocs/"
 
+/*
+ * The upload is written to a temporary file first, and
+ * renamed to the target name after the image was checked.
+ * The old image is kept as backup until the new one is in
+ * place, see UploadFinish and UploadRecover.
+ */
+#define UPLOAD_TMP_NAME       "/etc/upload.tmp"
+#define UPLOAD_CHUNK_SIZE     4096
+
+#define UPLOAD_TYPE_UNKNOWN   0
+#define UPLOAD_TYPE_XFILE     1
+#define UPLOAD_TYPE_XBIN      2
+
+typedef struct _upload_target_
+{
+   const char *pName;
+   const char *pBackup;
+} upload_target_t;
+
+typedef struct _upload_ctx_
+{
+   FIL       File;
+   int       nErr;
+   int       nType;
+   uint8_t   bOpen;
+   uint8_t   bExpanded;
+   uint32_t dSize;
+   uint32_t dChunkLen;
+   uint32_t dHeaderSize;
+   uint32_t dCRCSize;
+   uint32_t dCRC32;
+   union
+   {
+      XFILE_HEADER Xfile;
+      XBIN_HEADER  Xbin;
+      uint8_t      Raw[sizeof(XBIN_HEADER)];   /* The largest header */
+   } Header;
+   uint8_t   Chunk[UPLOAD_CHUNK_SIZE];
+} upload_ctx_t;
+
 /*=======================================================================*/
 /*  Definition of all global Data                                        */
 /*=======================================================================*/
@@ -99,6 +146,20 @@ static uint32_t  dFw2Version = 0;
 static XFILE_HEADER Xfile;
 static XBIN_HEADER  Xbin;
 
+static OS_SEMA       UploadSema;
+
+static const upload_target_t WebTarget[2] =
+{
+   { "/etc/web1.bin", "/etc/web1.bak" },
+   { "/etc/web2.bin", "/etc/web2.bak" }
+};
+
+static const upload_target_t FwTarget[2] =
+{
+   { "/etc/fw1.bin", "/etc/fw1.bak" },
+   { "/etc/fw2.bin", "/etc/fw2.bak" }
+};
+
 /*=======================================================================*/
 /*  Definition of all local Procedures                                   */
 /*=======================================================================*/
@@ -160,6 +221,10 @@ static int Mount (int fd)
       {
          nErr = 0;
          
+         /* Files which are cached from an older image must be removed */
+         web_CacheFlush();
+         HttpSsiFlushTemplates();
+         
          /* Check if the "new buffer" is the correct one */
          if (pBuffer != pWebImageBuffer)
          {
@@ -181,6 +246,8 @@ static int Mount (int fd)
 /*************************************************************************/
 static void UnMount (void)
 {
+  web_CacheFlush();
+  HttpSsiFlushTemplates();
   xfile_UnMount();
   xfree(pWebImageBuffer);
   WebImageSize    = 0;
@@ -188,6 +255,62 @@ static void UnMount (void)
   
 } /* UnMount */
 
+/*************************************************************************/
+/*  UploadRecover                                                        */
+/*                                                                       */
+/*  Complete a replace of the image, which was interrupted e.g. by a     */
+/*  power loss. If the new image is in place, the backup is deleted.     */
+/*  Otherwise the backup is the old image and is renamed back.           */
+/*                                                                       */
+/*  In    : pTarget                                                      */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void UploadRecover (const upload_target_t *pTarget)
+{
+   FILINFO Info;
+   
+   if (FR_OK == f_stat(pTarget->pBackup, &Info))
+   {
+      if (FR_OK == f_stat(pTarget->pName, &Info))
+      {
+         (void)f_unlink(pTarget->pBackup);
+      }
+      else
+      {
+         (void)f_rename(pTarget->pBackup, pTarget->pName);
+      }
+   }
+   
+} /* UploadRecover */
+
+/*************************************************************************/
+/*  UploadRecoverAll                                                     */
+/*                                                                       */
+/*  Recover all images, and remove the temporary file of an upload       */
+/*  which was interrupted. Must be called before the image is read.      */
+/*                                                                       */
+/*  In    : none                                                         */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void UploadRecoverAll (void)
+{
+   /* Poll, the files of an upload in progress are not touched */
+   if (OS_RC_OK == OS_SemaWait(&UploadSema, 0))
+   {
+      UploadRecover(&WebTarget[0]);
+      UploadRecover(&WebTarget[1]);
+      UploadRecover(&FwTarget[0]);
+      UploadRecover(&FwTarget[1]);
+      
+      (void)f_unlink(UPLOAD_TMP_NAME);
+      
+      OS_RES_FREE(&UploadSema);
+   }
+   
+} /* UploadRecoverAll */
+
 /*************************************************************************/
 /*  SDMountCallback                                                      */
 /*                                                                       */
@@ -203,6 +326,8 @@ static void SDMountCallback (void)
 #if 1 /* New functionality */      
    uint8_t bIndex = 1;
    
+   UploadRecoverAll();
+   
    /*
     * Read index
     */
@@ -305,74 +430,255 @@ static void SDUnMountCallback (void)
 } /* SDUnMountCallback */
 
 /*************************************************************************/
-/*  WebUpload                                                            */
+/*  UploadCheck                                                          */
 /*                                                                       */
-/*  Handle the upload from the web interface.                            */
+/*  Collect the image header and calculate the data CRC32 on the fly.    */
+/*  The data is located at file offset dSize.                            */
 /*                                                                       */
-/*  In    : pUpload                                                      */
+/*  In    : pCtx, pData, dSize                                           */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void UploadCheck (upload_ctx_t *pCtx, const uint8_t *pData, uint32_t dSize)
+{
+   uint32_t dOffset = pCtx->dSize;
+   uint32_t dEnd    = pCtx->dSize + dSize;
+   uint32_t dCount;
+   
+   /* Collect the header */
+   if (dOffset < sizeof(pCtx->Header.Raw))
+   {
+      dCount = MIN(dSize, sizeof(pCtx->Header.Raw) - dOffset);
+      memcpy(&pCtx->Header.Raw[dOffset], pData, dCount);
+   }
+   
+   /* Detect the image type by the magic */
+   if ((0 == pCtx->dHeaderSize) && (dEnd >= 8))
+   {
+      if ((XFILE_HEADER_MAGIC_1 == pCtx->Header.Xfile.dMagic1) &&
+          (XFILE_HEADER_MAGIC_2 == pCtx->Header.Xfile.dMagic2))
+      {
+         pCtx->nType       = UPLOAD_TYPE_XFILE;
+         pCtx->dHeaderSize = sizeof(XFILE_HEADER);
+      }
+      else if ((XBIN_HEADER_MAGIC_1 == pCtx->Header.Xbin.dMagic1) &&
+               (XBIN_HEADER_MAGIC_2 == pCtx->Header.Xbin.dMagic2))
+      {
+         pCtx->nType       = UPLOAD_TYPE_XBIN;
+         pCtx->dHeaderSize = sizeof(XBIN_HEADER);
+      }
+      else
+      {
+         /* Unknown, nothing to check */
+         pCtx->dHeaderSize = 0xFFFFFFFF;
+      }
+   }
+   
+   /* The header is complete, setup the size of the CRC range */
+   if ((pCtx->nType != UPLOAD_TYPE_UNKNOWN) && (dOffset <= pCtx->dHeaderSize) && (dEnd >= pCtx->dHeaderSize))
+   {
+      if (UPLOAD_TYPE_XFILE == pCtx->nType)
+      {
+         if ((0 == pCtx->Header.Xfile.dDataCompSize) && (0 == pCtx->Header.Xfile.dDataCompCRC32))
+         {
+            pCtx->dCRCSize = pCtx->Header.Xfile.dDataTotalSize;
+         }
+         else
+         {
+            pCtx->dCRCSize = pCtx->Header.Xfile.dDataCompSize;
+         }
+      }
+      else
+      {
+         pCtx->dCRCSize = pCtx->Header.Xbin.dDataTotalSize;
+      }
+   }
+   
+   /* Calculate the CRC32 of the data behind the header */
+   if ((pCtx->nType != UPLOAD_TYPE_UNKNOWN) && (dEnd > pCtx->dHeaderSize) && (pCtx->dCRCSize > 0))
+   {
+      if (dOffset < pCtx->dHeaderSize)
+      {
+         pData += pCtx->dHeaderSize - dOffset;
+         dSize -= pCtx->dHeaderSize - dOffset;
+      }
+      
+      dCount = MIN(dSize, pCtx->dCRCSize);
+      pCtx->dCRC32    = adler32(pCtx->dCRC32, pData, dCount);
+      pCtx->dCRCSize -= dCount;
+   }
+
+} /* UploadCheck */
+
+/*************************************************************************/
+/*  UploadClose                                                          */
+/*                                                                       */
+/*  Write the last chunk and close the temporary file.                   */
+/*                                                                       */
+/*  In    : pCtx                                                         */
 /*  Out   : none                                                         */
 /*  Return: 0 = OK / error case                                          */
 /*************************************************************************/
-static int WebUpload (web_upload_t *pUpload)
+static int UploadClose (upload_ctx_t *pCtx)
 {
+   FRESULT Res;
+   UINT    Written;
+   
+   if (0 == pCtx->bOpen)
+   {
+      return(pCtx->nErr);
+   }
+   
+   if ((0 == pCtx->nErr) && (pCtx->dChunkLen > 0))
+   {
+      Res = f_write(&pCtx->File, pCtx->Chunk, pCtx->dChunkLen, &Written);
+      if ((Res != FR_OK) || (Written != pCtx->dChunkLen))
+      {
+         pCtx->nErr = XFILE_ERROR_SD;
+      }
+   }
+   
+   /* Release the preallocated area behind the data */
+   if ((0 == pCtx->nErr) && (1 == pCtx->bExpanded))
+   {
+      if (f_truncate(&pCtx->File) != FR_OK)
+      {
+         pCtx->nErr = XFILE_ERROR_SD;
+      }
+   }
+   
+   if (f_close(&pCtx->File) != FR_OK)
+   {
+      pCtx->nErr = XFILE_ERROR_SD;
+   }
+   pCtx->bOpen = 0;
+   
+   return(pCtx->nErr);
+} /* UploadClose */
+
+/*************************************************************************/
+/*  UploadFinish                                                         */
+/*                                                                       */
+/*  Check the image and rename the temporary file to the target name.    */
+/*  The old image is renamed to the backup name first, and deleted when  */
+/*  the new one is in place. So there is always one complete image, see */
+/*  UploadRecover.                                                       */
+/*                                                                       */
+/*  In    : pCtx, nType, pTarget                                         */
+/*  Out   : none                                                         */
+/*  Return: 0 = OK / error case                                          */
+/*************************************************************************/
+static int UploadFinish (upload_ctx_t *pCtx, int nType, const upload_target_t *pTarget)
+{
+   FRESULT  Res;
    int      nErr;
-   int       fd;   
-   uint32_t dWriteCount;
-   uint8_t *pBuffer = pUpload->pBuffer;
-   uint32_t dSize   = (uint32_t)pUpload->lFileSize;
-   uint32_t dWriteSize;
-   XFILE_HEADER *pXfile;
-      
-   /* Check file first */ 
-   nErr = xfile_Check(pBuffer, dSize);    
-   if (0 == nErr)
+   uint32_t CRC32;
+   uint32_t dHeaderCRC32;
+   uint32_t dDataCRC32;
+   
+   nErr = UploadClose(pCtx);
+   if (nErr != 0)
    {
-      pXfile = (XFILE_HEADER*)pUpload->pBuffer; /*lint !e826*/
+      return(nErr);
+   }
+   
+   /* Check header */
+   if (UPLOAD_TYPE_XFILE == nType)
+   {
+      if ( (pCtx->nType != UPLOAD_TYPE_XFILE)                          ||
+           (!XFILE_HEADER_SIZEVER_VALID(pCtx->Header.Xfile.dSizeVersion)) ||
+           (pCtx->dSize < sizeof(XFILE_HEADER)) )
+      {
+         return(XFILE_ERROR_NO_WEB);
+      }
       
-      /* Setup header info and open file */
-      if (1 == pUpload->bBufferIndex)
+      CRC32        = adler32(ADLER_START_VALUE, pCtx->Header.Raw, sizeof(XFILE_HEADER) - XFILE_SIZE_OF_CRC32);
+      dHeaderCRC32 = pCtx->Header.Xfile.dHeaderCRC32;
+      if ((0 == pCtx->Header.Xfile.dDataCompSize) && (0 == pCtx->Header.Xfile.dDataCompCRC32))
       {
-         memcpy(Web1Name, pXfile->DataName, XFILE_HEADER_NAME_SIZE);
-         dWeb1Version = pXfile->dDataVersion;
-         
-         fd = _open("SD0:/etc/web1.bin", _O_BINARY | _O_WRONLY | _O_CREATE_ALWAYS);
+         dDataCRC32 = pCtx->Header.Xfile.dDataCRC32;
       }
       else
       {
-         memcpy(Web2Name, pXfile->DataName, XFILE_HEADER_NAME_SIZE);
-         dWeb2Version = pXfile->dDataVersion;
-      
-         fd = _open("SD0:/etc/web2.bin", _O_BINARY | _O_WRONLY | _O_CREATE_ALWAYS);
-      }   
-
-      /* Write file */
-      if (fd != -1)
+         dDataCRC32 = pCtx->Header.Xfile.dDataCompCRC32;
+      }
+   }
+   else
+   {
+      if ( (pCtx->nType != UPLOAD_TYPE_XBIN)                          ||
+           (XBIN_HEADER_SIZEVER != pCtx->Header.Xbin.dSizeVersion)    ||
+           (pCtx->dSize < sizeof(XBIN_HEADER)) )
       {
-         nErr = 0;
-         while(dSize > 0)
-         {
-            dWriteSize = MIN(dSize, 4096);
+         return(XFILE_ERROR_NO_WEB);
+      }
       
-            dWriteCount = (uint32_t)_write(fd, pBuffer, dWriteSize);
-            if (dWriteCount != dWriteSize)
-            {
-               nErr = XFILE_ERROR_SD;
-               break;
-            }
-         
-            pBuffer += dWriteSize;
-            dSize   -= dWriteSize; 
-            
-            OS_TaskYield(); 
-         }         
-         _close(fd);
+      CRC32        = adler32(ADLER_START_VALUE, pCtx->Header.Raw, sizeof(XBIN_HEADER) - XBIN_SIZE_OF_CRC32);
+      dHeaderCRC32 = pCtx->Header.Xbin.dHeaderCRC32;
+      dDataCRC32   = pCtx->Header.Xbin.dDataCRC32;
+   }
+   
+   /* Check CRC32 of the header and the data */
+   if ( (CRC32 != dHeaderCRC32)     ||
+        (pCtx->dCRCSize != 0)       ||
+        (pCtx->dCRC32 != dDataCRC32) )
+   {
+      return(XFILE_ERROR_CRC);
+   }
+   
+   /* A backup which is left from an earlier replace is resolved first */
+   UploadRecover(pTarget);
+   
+   /* Keep the old image, it could be missing at the first upload */
+   Res = f_rename(pTarget->pName, pTarget->pBackup);
+   if ((Res != FR_OK) && (Res != FR_NO_FILE))
+   {
+      return(XFILE_ERROR_SD);
+   }
+   
+   if (f_rename(UPLOAD_TMP_NAME, pTarget->pName) != FR_OK)
+   {
+      /* Put the old image back */
+      (void)f_rename(pTarget->pBackup, pTarget->pName);
+      return(XFILE_ERROR_SD);
+   }
+   
+   (void)f_unlink(pTarget->pBackup);
+   
+   return(nErr);
+} /* UploadFinish */
+
+/*************************************************************************/
+/*  WebUpload                                                            */
+/*                                                                       */
+/*  Handle the upload from the web interface.                            */
+/*                                                                       */
+/*  In    : pCtx, pUpload                                                */
+/*  Out   : none                                                         */
+/*  Return: 0 = OK / error case                                          */
+/*************************************************************************/
+static int WebUpload (upload_ctx_t *pCtx, web_upload_t *pUpload)
+{
+   int           nErr;
+   XFILE_HEADER *pXfile = &pCtx->Header.Xfile;
       
+   if (1 == pUpload->bBufferIndex)
+   {
+      nErr = UploadFinish(pCtx, UPLOAD_TYPE_XFILE, &WebTarget[0]);
+      if (0 == nErr)
+      {
+         memcpy(Web1Name, pXfile->DataName, XFILE_HEADER_NAME_SIZE);
+         dWeb1Version = pXfile->dDataVersion;
       }
-      else
+   }
+   else
+   {
+      nErr = UploadFinish(pCtx, UPLOAD_TYPE_XFILE, &WebTarget[1]);
+      if (0 == nErr)
       {
-         nErr = XFILE_ERROR_SD; 
+         memcpy(Web2Name, pXfile->DataName, XFILE_HEADER_NAME_SIZE);
+         dWeb2Version = pXfile->dDataVersion;
       }
-   } /* end if "WebCheck(" */     
+   }
    
    return(nErr);
 } /* WebUpload */
@@ -382,70 +688,33 @@ static int WebUpload (web_upload_t *pUpload)
 /*                                                                       */
 /*  Handle the upload from the web interface.                            */
 /*                                                                       */
-/*  In    : pUpload                                                      */
+/*  In    : pCtx, pUpload                                                */
 /*  Out   : none                                                         */
 /*  Return: 0 = OK / error case                                          */
 /*************************************************************************/
-static int FwUpload (web_upload_t *pUpload)
+static int FwUpload (upload_ctx_t *pCtx, web_upload_t *pUpload)
 {
-   int      nErr;
-   int       fd;   
-   uint32_t dWriteCount;
-   uint8_t *pBuffer = pUpload->pBuffer;
-   uint32_t dSize   = (uint32_t)pUpload->lFileSize;
-   uint32_t dWriteSize;
-   XBIN_HEADER *pXbin;
+   int          nErr;
+   XBIN_HEADER *pXbin = &pCtx->Header.Xbin;
       
-   /* Check file first */ 
-   nErr = xbin_Check(pBuffer, dSize);    
-   if (0 == nErr)
+   if (1 == pUpload->bBufferIndex)
    {
-      pXbin = (XBIN_HEADER*)pUpload->pBuffer; /*lint !e826*/
-      
-      /* Setup header info and open file */
-      if (1 == pUpload->bBufferIndex)
+      nErr = UploadFinish(pCtx, UPLOAD_TYPE_XBIN, &FwTarget[0]);
+      if (0 == nErr)
       {
          memcpy(Fw1Name, pXbin->DataName, XBIN_DATA_NAME_SIZE);
          dFw1Version = pXbin->dDataVersion;
-         
-         fd = _open("SD0:/etc/fw1.bin", _O_BINARY | _O_WRONLY | _O_CREATE_ALWAYS);
       }
-      else
+   }
+   else
+   {
+      nErr = UploadFinish(pCtx, UPLOAD_TYPE_XBIN, &FwTarget[1]);
+      if (0 == nErr)
       {
          memcpy(Fw2Name, pXbin->DataName, XBIN_DATA_NAME_SIZE);
          dFw2Version = pXbin->dDataVersion;
-      
-         fd = _open("SD0:/etc/fw2.bin", _O_BINARY | _O_WRONLY | _O_CREATE_ALWAYS);
-      }   
-
-      /* Write file */
-      if (fd != -1)
-      {
-         nErr = 0;
-         while(dSize > 0)
-         {
-            dWriteSize = MIN(dSize, 4096);
-      
-            dWriteCount = (uint32_t)_write(fd, pBuffer, dWriteSize);
-            if (dWriteCount != dWriteSize)
-            {
-               nErr = XFILE_ERROR_SD;
-               break;
-            }
-         
-            pBuffer += dWriteSize;
-            dSize   -= dWriteSize; 
-            
-            OS_TaskYield(); 
-         }         
-         _close(fd);
-      
-      }
-      else
-      {
-         nErr = XFILE_ERROR_SD; 
       }
-   } /* end if "WebCheck(" */     
+   }
    
    return(nErr);
 } /* FwUpload */
@@ -495,6 +764,9 @@ void fs_Init (void)
    HttpRegisterRootPath(ROMFS_HTTP_ROOT_PATH); 
    HttpRegisterRedir("", "/nocard.htm", 307);
    
+   /* Needed by SDMountCallback already */
+   OS_RES_CREATE(&UploadSema);
+   
    /* 
     * Check if a SD card is available
     */   
@@ -511,10 +783,150 @@ void fs_Init (void)
 
 } /* fs_Init */
 
+/*************************************************************************/
+/*  fs_UploadStart                                                       */
+/*                                                                       */
+/*  Create the temporary upload file. Only one upload can be active,     */
+/*  the handle belongs to the caller which started the upload and must   */
+/*  be passed to fs_UploadWrite, fs_UploadAbort and fs_Upload.           */
+/*                                                                       */
+/*  In    : dMaxSize, upper limit of the file size                       */
+/*  Out   : ppHandle, NULL in case of an error                           */
+/*  Return: 0 = OK / error case                                          */
+/*************************************************************************/
+int fs_UploadStart (uint32_t dMaxSize, void **ppHandle)
+{
+   upload_ctx_t *pCtx;
+   
+   *ppHandle = NULL;
+   
+   /* Poll, an upload could be in progress */
+   if (OS_SemaWait(&UploadSema, 0) != OS_RC_OK)
+   {
+      return(XFILE_ERROR_SD);
+   }
+   
+   pCtx = (upload_ctx_t*)xcalloc(XM_ID_HEAP, 1, sizeof(upload_ctx_t));
+   if (NULL == pCtx)
+   {
+      OS_RES_FREE(&UploadSema);
+      return(XFILE_ERROR_SD);
+   }
+   
+   if (f_open(&pCtx->File, UPLOAD_TMP_NAME, FA_WRITE | FA_CREATE_ALWAYS) != FR_OK)
+   {
+      xfree(pCtx);
+      OS_RES_FREE(&UploadSema);
+      return(XFILE_ERROR_SD);
+   }
+   pCtx->bOpen = 1;
+   
+#if (FF_USE_EXPAND >= 1)
+   /* 
+    * Try to preallocate a contiguous area, the file will be
+    * truncated at the end. Without free contiguous space the
+    * clusters are allocated while writing.
+    */
+   if (FR_OK == f_expand(&pCtx->File, (FSIZE_t)dMaxSize, 1))
+   {
+      pCtx->bExpanded = 1;
+   }
+#else
+   (void)dMaxSize;
+#endif   
+   
+   pCtx->dCRC32 = ADLER_START_VALUE;
+   *ppHandle    = pCtx;
+   
+   return(0);
+} /* fs_UploadStart */
+
+/*************************************************************************/
+/*  fs_UploadWrite                                                       */
+/*                                                                       */
+/*  Write data to the temporary upload file. The data is collected and   */
+/*  written in chunks of UPLOAD_CHUNK_SIZE.                              */
+/*                                                                       */
+/*  In    : pHandle, pData, dSize                                        */
+/*  Out   : none                                                         */
+/*  Return: 0 = OK / error case                                          */
+/*************************************************************************/
+int fs_UploadWrite (void *pHandle, const uint8_t *pData, uint32_t dSize)
+{
+   upload_ctx_t *pCtx = (upload_ctx_t*)pHandle;
+   uint32_t      dCount;
+   UINT          Written;
+   
+   if (NULL == pCtx)
+   {
+      return(XFILE_ERROR_SD);
+   }
+   
+   if (pCtx->nErr != 0)
+   {
+      return(pCtx->nErr);
+   }
+   
+   UploadCheck(pCtx, pData, dSize);
+   pCtx->dSize += dSize;
+   
+   while (dSize > 0)
+   {
+      dCount = MIN(dSize, UPLOAD_CHUNK_SIZE - pCtx->dChunkLen);
+      memcpy(&pCtx->Chunk[pCtx->dChunkLen], pData, dCount);
+      pCtx->dChunkLen += dCount;
+      pData           += dCount;
+      dSize           -= dCount;
+      
+      if (UPLOAD_CHUNK_SIZE == pCtx->dChunkLen)
+      {
+         if ((f_write(&pCtx->File, pCtx->Chunk, UPLOAD_CHUNK_SIZE, &Written) != FR_OK) ||
+             (Written != UPLOAD_CHUNK_SIZE))
+         {
+            pCtx->nErr = XFILE_ERROR_SD;
+            break;
+         }
+         pCtx->dChunkLen = 0;
+         
+         OS_TaskYield();
+      }
+   }
+   
+   return(pCtx->nErr);
+} /* fs_UploadWrite */
+
+/*************************************************************************/
+/*  fs_UploadAbort                                                       */
+/*                                                                       */
+/*  Cancel the upload and remove the temporary file. A NULL handle, of   */
+/*  an upload which could not be started, is ignored.                    */
+/*                                                                       */
+/*  In    : pHandle                                                      */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+void fs_UploadAbort (void *pHandle)
+{
+   upload_ctx_t *pCtx = (upload_ctx_t*)pHandle;
+   
+   if (pCtx != NULL)
+   {
+      pCtx->nErr = XFILE_ERROR_SD;
+      (void)UploadClose(pCtx);
+      (void)f_unlink(UPLOAD_TMP_NAME);
+
+      xfree(pCtx);
+      OS_RES_FREE(&UploadSema);
+   }
+   
+} /* fs_UploadAbort */
+
 /*************************************************************************/
 /*  fs_Upload                                                            */
 /*                                                                       */
-/*  Handle the upload from the web interface.                            */
+/*  Finish the upload from the web interface, which was written with     */
+/*  fs_UploadStart and fs_UploadWrite before. The handle is released     */
+/*  in any case.                                                         */
 /*                                                                       */
 /*  In    : pUpload                                                      */
 /*  Out   : none                                                         */
@@ -522,16 +934,27 @@ void fs_Init (void)
 /*************************************************************************/
 int fs_Upload (web_upload_t *pUpload)
 {
-   int nErr = -1;
+   upload_ctx_t *pCtx = (upload_ctx_t*)pUpload->pHandle;
+   int           nErr = -1;
    
+   if (NULL == pCtx)
+   {
+      return(nErr);
+   }
+   pUpload->pHandle = NULL;
+
    term_printf("Upload\r\n");
    term_printf("   Name : %s\r\n", pUpload->pFileName); 
    term_printf("   Size : %d\r\n", pUpload->lFileSize); 
    term_printf("   Index: %d\r\n", pUpload->bBufferIndex); 
 
-   if (0 == strcmp(pUpload->pType, "web"))
+   if (NULL == pUpload->pType)
    {
-      nErr = WebUpload(pUpload);
+      /* Nothing to do */
+   }
+   else if (0 == strcmp(pUpload->pType, "web"))
+   {
+      nErr = WebUpload(pCtx, pUpload);
       if (0 == nErr)
       {
          term_printf("Web upload OK\r\n");
@@ -542,10 +965,9 @@ int fs_Upload (web_upload_t *pUpload)
       }
       term_printf("\r\n");
    }
-
-   if (0 == strcmp(pUpload->pType, "fw"))
+   else if (0 == strcmp(pUpload->pType, "fw"))
    {
-      nErr = FwUpload(pUpload);
+      nErr = FwUpload(pCtx, pUpload);
       if (0 == nErr)
       {
          term_printf("Fw upload OK\r\n");
@@ -556,6 +978,17 @@ int fs_Upload (web_upload_t *pUpload)
       }
       term_printf("\r\n");
    }
+   
+   if (nErr != 0)
+   {
+      /* Remove the temporary file */
+      fs_UploadAbort(pCtx);
+   }
+   else
+   {
+      xfree(pCtx);
+      OS_RES_FREE(&UploadSema);
+   }
 
    return(nErr);
 } /* fs_Upload */
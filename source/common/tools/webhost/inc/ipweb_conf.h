@@ -0,0 +1,63 @@
+/**************************************************************************
+*  Copyright (c) 2026 by Michael Fischer (www.emb4fun.de).
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*  1. Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*
+*  2. Redistributions in binary form must reproduce the above copyright
+*     notice, this list of conditions and the following disclaimer in the
+*     documentation and/or other materials provided with the distribution.
+*
+*  3. Neither the name of the author nor the names of its contributors may
+*     be used to endorse or promote products derived from this software
+*     without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+*  THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+*  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+*  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+*  SUCH DAMAGE.
+*
+***************************************************************************
+*  History:
+*
+*  16.10.2026  mifi  First Version, host configuration.
+*  17.10.2026  mifi  The SID test build enables the session ID.
+**************************************************************************/
+#if !defined(__IPWEB_CONF_H__)
+#define __IPWEB_CONF_H__
+
+/**************************************************************************
+*  Global Definitions
+**************************************************************************/
+
+/*
+ * Host configuration of the web server, no session ID and no TLS.
+ * Only the SID test is built with IP_WEB_SID_SUPPORT=1.
+ */
+#if !defined(IP_WEB_SID_SUPPORT)
+#define IP_WEB_SID_SUPPORT          0
+#endif
+
+#define IP_WEB_LOG_RING_SIZE        1024
+#define IP_WEB_LOG_SYSLOG           0
+
+#define IP_WEB_CACHE_SIZE           65536
+#define IP_WEB_CACHE_ENTRIES        16
+#define IP_WEB_CACHE_FILE_MAX       16384
+
+#endif /* !__IPWEB_CONF_H__ */
+
+/*** EOF ***/
@@ -0,0 +1,124 @@
+/**************************************************************************
+*  Copyright (c) 2026 by Michael Fischer (www.emb4fun.de).
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*  1. Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*
+*  2. Redistributions in binary form must reproduce the above copyright
+*     notice, this list of conditions and the following disclaimer in the
+*     documentation and/or other materials provided with the distribution.
+*
+*  3. Neither the name of the author nor the names of its contributors may
+*     be used to endorse or promote products derived from this software
+*     without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+*  THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+*  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+*  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+*  SUCH DAMAGE.
+*
+***************************************************************************
+*  History:
+*
+*  16.10.2026  mifi  First Version, host replacement for the TAL.
+*  17.10.2026  mifi  Add TAL_RESULT, TRUE/FALSE and tal_CPURngHardwarePoll.
+*  17.10.2026  mifi  Add host_TimeAdvance for the tests.
+**************************************************************************/
+#if !defined(__TAL_H__)
+#define __TAL_H__
+
+/**************************************************************************
+*  Includes
+**************************************************************************/
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#include "talmem.h"
+
+/**************************************************************************
+*  Global Definitions
+**************************************************************************/
+
+/*
+ * Host replacement of the TAL and TCTS parts used by the web server.
+ * A semaphore is a mutex, and "disable all interrupts" is a global lock.
+ */
+#define TAL_BOARD "Host"
+#define TAL_CPU   "Host"
+
+#define OS_WAIT_INFINITE   ((uint32_t)-1)
+
+typedef enum _tal_result_
+{
+   TAL_OK    = 0,
+   TAL_ERROR = 1
+} TAL_RESULT;
+
+#ifndef FALSE
+#define FALSE        0
+#endif
+
+#ifndef TRUE
+#define TRUE         1
+#endif
+
+typedef struct _os_sema_
+{
+   pthread_mutex_t Mutex;
+} OS_SEMA;
+
+extern pthread_mutex_t tal_HostIntLock;
+
+/**************************************************************************
+*  Macro Definitions
+**************************************************************************/
+
+#define OS_MS_2_TICKS(_a)     (_a)
+#define OS_TICKS_2_MS(_a)     (_a)
+
+#define OS_TEST_TIMEOUT(_a,_s,_t)   (((uint32_t)(_a) - (uint32_t)(_s)) >= (uint32_t)(_t))
+
+#define OS_RES_CREATE(_a)        OS_SemaCreate(_a, 1, 1)
+#define OS_RES_LOCK(_a)          OS_SemaWait(_a, OS_WAIT_INFINITE)
+#define OS_RES_FREE(_a)          OS_SemaSignal(_a)
+
+#define TAL_CPU_DISABLE_ALL_INTS()  { pthread_mutex_lock(&tal_HostIntLock);
+#define TAL_CPU_ENABLE_ALL_INTS()     pthread_mutex_unlock(&tal_HostIntLock); }
+
+/**************************************************************************
+*  Functions Definitions
+**************************************************************************/
+
+uint32_t OS_TimeGet (void);
+uint32_t OS_TimeGetSeconds (void);
+
+void     OS_SemaCreate (OS_SEMA *pSema, int32_t nCounterStart, int32_t nCounterMax);
+int      OS_SemaSignal (OS_SEMA *pSema);
+int      OS_SemaWait (OS_SEMA *pSema, uint32_t dTimeoutMs);
+
+uint32_t tal_CPUStatGetHiResPeriod (void);
+uint32_t tal_CPUStatGetHiResCnt (void);
+
+TAL_RESULT tal_CPURngHardwarePoll (uint8_t *pData, uint32_t dSize);
+
+/* Host only, a test can move the time forward */
+void     host_TimeAdvance (uint32_t dMs);
+
+#endif /* !__TAL_H__ */
+
+/*** EOF ***/
@@ -0,0 +1,91 @@
+/**************************************************************************
+*  Copyright (c) 2026 by Michael Fischer (www.emb4fun.de).
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*  1. Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*
+*  2. Redistributions in binary form must reproduce the above copyright
+*     notice, this list of conditions and the following disclaimer in the
+*     documentation and/or other materials provided with the distribution.
+*
+*  3. Neither the name of the author nor the names of its contributors may
+*     be used to endorse or promote products derived from this software
+*     without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+*  THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+*  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+*  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+*  SUCH DAMAGE.
+*
+***************************************************************************
+*  History:
+*
+*  16.10.2026  mifi  First Version, host replacement for the TAL.
+*  17.10.2026  mifi  Optional allocation trace for membench.
+*  17.10.2026  mifi  Add host_MemCallCount.
+**************************************************************************/
+#if !defined(__TALMEM_H__)
+#define __TALMEM_H__
+
+/**************************************************************************
+*  Includes
+**************************************************************************/
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**************************************************************************
+*  Global Definitions
+**************************************************************************/
+
+typedef enum _tal_mem_id_
+{
+   XM_ID_HEAP = 0,
+   XM_ID_FS,
+   XM_ID_WEB
+} tal_mem_id;
+
+/**************************************************************************
+*  Macro Definitions
+**************************************************************************/
+
+/*
+ * On the host the memory pools are mapped to the C library heap. If
+ * WEBHOST_MEM_TRACE is set in the environment, every call is written
+ * to this file, membench replays it with the allocators of talmem.c.
+ */
+#define xcalloc(_id,_n,_s)    host_xcalloc(_id, _n, _s)
+#define xmalloc(_id,_s)       host_xmalloc(_id, _s)
+#define xrealloc(_id,_p,_s)   host_xrealloc(_id, _p, _s)
+#define xfree(_p)             host_xfree(_p)
+#define xstrdup(_id,_s)       host_xstrdup(_id, _s)
+
+/**************************************************************************
+*  Functions Definitions
+**************************************************************************/
+
+void *host_xcalloc (tal_mem_id ID, size_t nobj, size_t size);
+void *host_xmalloc (tal_mem_id ID, size_t size);
+void *host_xrealloc (tal_mem_id ID, void *p, size_t size);
+void  host_xfree (void *p);
+char *host_xstrdup (tal_mem_id ID, const char *s1);
+
+/* Host only, the number of calls of the functions above */
+uint32_t host_MemCallCount (void);
+
+#endif /* !__TALMEM_H__ */
+
+/*** EOF ***/
@@ -0,0 +1,419 @@
+/**************************************************************************
+*  Copyright (c) 2026 by Michael Fischer (www.emb4fun.de).
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*  1. Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*
+*  2. Redistributions in binary form must reproduce the above copyright
+*     notice, this list of conditions and the following disclaimer in the
+*     documentation and/or other materials provided with the distribution.
+*
+*  3. Neither the name of the author nor the names of its contributors may
+*     be used to endorse or promote products derived from this software
+*     without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+*  THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+*  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+*  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+*  SUCH DAMAGE.
+*
+***************************************************************************
+*  History:
+*
+*  16.10.2026  mifi  First Version, host replacement for the TAL and TCTS.
+*  17.10.2026  mifi  Add tal_CPURngHardwarePoll.
+*  17.10.2026  mifi  Add host_TimeAdvance for the tests.
+*  17.10.2026  mifi  Add the memory functions with the allocation trace.
+*  17.10.2026  mifi  Add host_MemCallCount.
+**************************************************************************/
+#define __HOSTOS_C__
+
+/*=======================================================================*/
+/*  Includes                                                             */
+/*=======================================================================*/
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/random.h>
+
+#include "tal.h"
+
+/*=======================================================================*/
+/*  All Structures and Common Constants                                  */
+/*=======================================================================*/
+
+/* The HiRes count has the us inside the ms in the lower 16 bit */
+#define HIRES_PERIOD    1000
+
+/*=======================================================================*/
+/*  Definition of all global Data                                        */
+/*=======================================================================*/
+
+pthread_mutex_t tal_HostIntLock = PTHREAD_MUTEX_INITIALIZER;
+
+/*=======================================================================*/
+/*  Definition of all local Data                                         */
+/*=======================================================================*/
+
+/* Moved forward by host_TimeAdvance */
+static uint64_t qTimeOffsetUs = 0;
+
+/* Allocation trace, see WEBHOST_MEM_TRACE */
+static pthread_once_t  TraceOnce = PTHREAD_ONCE_INIT;
+static pthread_mutex_t TraceLock = PTHREAD_MUTEX_INITIALIZER;
+static FILE           *hTrace    = NULL;
+
+/* Calls of the memory functions, see host_MemCallCount */
+static uint32_t dMemCallCnt = 0;
+
+/*=======================================================================*/
+/*  Definition of all local Procedures                                   */
+/*=======================================================================*/
+
+/*************************************************************************/
+/*  TimeGetUs                                                            */
+/*                                                                       */
+/*  Return the monotonic time in us.                                     */
+/*                                                                       */
+/*  In    : none                                                         */
+/*  Out   : none                                                         */
+/*  Return: Time in us                                                   */
+/*************************************************************************/
+static uint64_t TimeGetUs (void)
+{
+   struct timespec ts;
+   
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   
+   return(((uint64_t)ts.tv_sec * 1000000) + ((uint64_t)ts.tv_nsec / 1000) + qTimeOffsetUs);
+} /* TimeGetUs */
+
+/*************************************************************************/
+/*  TraceOpen                                                            */
+/*************************************************************************/
+static void TraceOpen (void)
+{
+   const char *pName = getenv("WEBHOST_MEM_TRACE");
+   
+   if ((pName != NULL) && (pName[0] != 0))
+   {
+      /* Line buffered, the webhost is stopped by a signal */
+      hTrace = fopen(pName, "w");
+      if (hTrace != NULL)
+      {
+         setvbuf(hTrace, NULL, _IOLBF, 0);
+      }
+   }
+} /* TraceOpen */
+
+/*************************************************************************/
+/*  TraceEnabled                                                         */
+/*************************************************************************/
+static int TraceEnabled (void)
+{
+   pthread_once(&TraceOnce, TraceOpen);
+   
+   return(hTrace != NULL);
+} /* TraceEnabled */
+
+/*************************************************************************/
+/*  TraceWrite                                                           */
+/*                                                                       */
+/*  Write to the trace, "f Address" for a free and "a ID Size Address"   */
+/*  for an allocation, the address is hex. A realloc is a free and an    */
+/*  allocation. The caller must hold TraceLock.                          */
+/*                                                                       */
+/*  In    : ID, Size, New, Old (0 = none)                                */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void TraceWrite (tal_mem_id ID, size_t Size, uintptr_t New, uintptr_t Old)
+{
+   if (Old != 0)
+   {
+      fprintf(hTrace, "f %" PRIxPTR "\n", Old);
+   }
+   if (New != 0)
+   {
+      fprintf(hTrace, "a %d %zu %" PRIxPTR "\n", (int)ID, Size, New);
+   }
+} /* TraceWrite */
+
+/*************************************************************************/
+/*  TraceAlloc                                                           */
+/*                                                                       */
+/*  A free must be written before the memory is released, and an         */
+/*  allocation after it is done. So the trace is in the right order if   */
+/*  another thread gets the same memory.                                 */
+/*                                                                       */
+/*  In    : ID, Size, pNew, pOld                                         */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void TraceAlloc (tal_mem_id ID, size_t Size, void *pNew, void *pOld)
+{
+   __atomic_add_fetch(&dMemCallCnt, 1, __ATOMIC_RELAXED);
+
+   if (TraceEnabled())
+   {
+      pthread_mutex_lock(&TraceLock);
+      TraceWrite(ID, Size, (uintptr_t)pNew, (uintptr_t)pOld);
+      pthread_mutex_unlock(&TraceLock);
+   }
+} /* TraceAlloc */
+
+/*=======================================================================*/
+/*  All code exported                                                    */
+/*=======================================================================*/
+
+/*************************************************************************/
+/*  OS_TimeGet                                                           */
+/*                                                                       */
+/*  In    : none                                                         */
+/*  Out   : none                                                         */
+/*  Return: Time in ms (ticks)                                           */
+/*************************************************************************/
+uint32_t OS_TimeGet (void)
+{
+   return((uint32_t)(TimeGetUs() / 1000));
+} /* OS_TimeGet */
+
+/*************************************************************************/
+/*  OS_TimeGetSeconds                                                    */
+/*                                                                       */
+/*  In    : none                                                         */
+/*  Out   : none                                                         */
+/*  Return: Time in seconds                                              */
+/*************************************************************************/
+uint32_t OS_TimeGetSeconds (void)
+{
+   return((uint32_t)(TimeGetUs() / 1000000));
+} /* OS_TimeGetSeconds */
+
+/*************************************************************************/
+/*  host_TimeAdvance                                                     */
+/*                                                                       */
+/*  Move the time of OS_TimeGet and OS_TimeGetSeconds forward, e.g. to   */
+/*  test a timeout without waiting for it.                               */
+/*                                                                       */
+/*  In    : dMs                                                          */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+void host_TimeAdvance (uint32_t dMs)
+{
+   qTimeOffsetUs += (uint64_t)dMs * 1000;
+} /* host_TimeAdvance */
+
+/*************************************************************************/
+/*  host_xcalloc                                                         */
+/*                                                                       */
+/*  The memory functions of the TAL, see talmem.h.                       */
+/*************************************************************************/
+void *host_xcalloc (tal_mem_id ID, size_t nobj, size_t size)
+{
+   void *p = calloc(nobj, size);
+   
+   TraceAlloc(ID, nobj * size, p, NULL);
+   
+   return(p);
+} /* host_xcalloc */
+
+/*************************************************************************/
+/*  host_xmalloc                                                         */
+/*************************************************************************/
+void *host_xmalloc (tal_mem_id ID, size_t size)
+{
+   void *p = malloc(size);
+   
+   TraceAlloc(ID, size, p, NULL);
+   
+   return(p);
+} /* host_xmalloc */
+
+/*************************************************************************/
+/*  host_xrealloc                                                        */
+/*************************************************************************/
+void *host_xrealloc (tal_mem_id ID, void *p, size_t size)
+{
+   void *pNew;
+   
+   __atomic_add_fetch(&dMemCallCnt, 1, __ATOMIC_RELAXED);
+
+   if (!TraceEnabled())
+   {
+      return(realloc(p, size));
+   }
+   
+   /* 
+    * The old memory is released inside, see TraceAlloc. If realloc
+    * fails, the old memory is missing in the trace.
+    */
+   pthread_mutex_lock(&TraceLock);
+   TraceWrite(ID, 0, 0, (uintptr_t)p);
+   pNew = realloc(p, size);
+   TraceWrite(ID, size, (uintptr_t)pNew, 0);
+   pthread_mutex_unlock(&TraceLock);
+   
+   return(pNew);
+} /* host_xrealloc */
+
+/*************************************************************************/
+/*  host_xfree                                                           */
+/*************************************************************************/
+void host_xfree (void *p)
+{
+   if (p != NULL)
+   {
+      TraceAlloc(XM_ID_HEAP, 0, NULL, p);
+      free(p);
+   }
+} /* host_xfree */
+
+/*************************************************************************/
+/*  host_xstrdup                                                         */
+/*************************************************************************/
+char *host_xstrdup (tal_mem_id ID, const char *s1)
+{
+   char *p = strdup(s1);
+   
+   TraceAlloc(ID, strlen(s1) + 1, p, NULL);
+   
+   return(p);
+} /* host_xstrdup */
+
+/*************************************************************************/
+/*  host_MemCallCount                                                    */
+/*                                                                       */
+/*  Return the number of calls of the memory functions. On the target    */
+/*  each call takes the semaphore of the memory pools.                   */
+/*                                                                       */
+/*  In    : none                                                         */
+/*  Out   : none                                                         */
+/*  Return: Number of calls                                              */
+/*************************************************************************/
+uint32_t host_MemCallCount (void)
+{
+   return(__atomic_load_n(&dMemCallCnt, __ATOMIC_RELAXED));
+} /* host_MemCallCount */
+
+/*************************************************************************/
+/*  OS_SemaCreate                                                        */
+/*                                                                       */
+/*  Only the resource semaphore (1, 1) is used on the host.              */
+/*                                                                       */
+/*  In    : pSema, nCounterStart, nCounterMax                            */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+void OS_SemaCreate (OS_SEMA *pSema, int32_t nCounterStart, int32_t nCounterMax)
+{
+   (void)nCounterMax;
+   
+   pthread_mutex_init(&pSema->Mutex, NULL);
+   if (0 == nCounterStart)
+   {
+      pthread_mutex_lock(&pSema->Mutex);
+   }
+} /* OS_SemaCreate */
+
+/*************************************************************************/
+/*  OS_SemaSignal                                                        */
+/*                                                                       */
+/*  In    : pSema                                                        */
+/*  Out   : none                                                         */
+/*  Return: 0 = OK                                                       */
+/*************************************************************************/
+int OS_SemaSignal (OS_SEMA *pSema)
+{
+   pthread_mutex_unlock(&pSema->Mutex);
+   
+   return(0);
+} /* OS_SemaSignal */
+
+/*************************************************************************/
+/*  OS_SemaWait                                                          */
+/*                                                                       */
+/*  In    : pSema, dTimeoutMs                                            */
+/*  Out   : none                                                         */
+/*  Return: 0 = OK                                                       */
+/*************************************************************************/
+int OS_SemaWait (OS_SEMA *pSema, uint32_t dTimeoutMs)
+{
+   (void)dTimeoutMs;
+   
+   pthread_mutex_lock(&pSema->Mutex);
+   
+   return(0);
+} /* OS_SemaWait */
+
+/*************************************************************************/
+/*  tal_CPUStatGetHiResPeriod                                            */
+/*                                                                       */
+/*  In    : none                                                         */
+/*  Out   : none                                                         */
+/*  Return: HiRes units per ms                                           */
+/*************************************************************************/
+uint32_t tal_CPUStatGetHiResPeriod (void)
+{
+   return(HIRES_PERIOD);
+} /* tal_CPUStatGetHiResPeriod */
+
+/*************************************************************************/
+/*  tal_CPUStatGetHiResCnt                                               */
+/*                                                                       */
+/*  In    : none                                                         */
+/*  Out   : none                                                         */
+/*  Return: ms in the upper 16 bit, us in the lower 16 bit               */
+/*************************************************************************/
+uint32_t tal_CPUStatGetHiResCnt (void)
+{
+   uint64_t dUs = TimeGetUs();
+   
+   return((uint32_t)((dUs / 1000) << 16) | (uint32_t)(dUs % 1000));
+} /* tal_CPUStatGetHiResCnt */
+
+/*************************************************************************/
+/*  tal_CPURngHardwarePoll                                               */
+/*                                                                       */
+/*  The random numbers are taken from the kernel.                        */
+/*                                                                       */
+/*  In    : pData, dSize                                                 */
+/*  Out   : pData                                                        */
+/*  Return: TAL_OK / TAL_ERROR                                           */
+/*************************************************************************/
+TAL_RESULT tal_CPURngHardwarePoll (uint8_t *pData, uint32_t dSize)
+{
+   ssize_t nRead;
+   
+   while (dSize != 0)
+   {
+      nRead = getrandom(pData, dSize, 0);
+      if (nRead <= 0)
+      {
+         return(TAL_ERROR);
+      }
+      pData += nRead;
+      dSize -= (uint32_t)nRead;
+   }
+   
+   return(TAL_OK);
+} /* tal_CPURngHardwarePoll */
+
+/*** EOF ***/
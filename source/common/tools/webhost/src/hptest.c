@@ -0,0 +1,606 @@
+/**************************************************************************
+*  Copyright (c) 2026 by Michael Fischer (www.emb4fun.de).
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*  1. Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*
+*  2. Redistributions in binary form must reproduce the above copyright
+*     notice, this list of conditions and the following disclaimer in the
+*     documentation and/or other materials provided with the distribution.
+*
+*  3. Neither the name of the author nor the names of its contributors may
+*     be used to endorse or promote products derived from this software
+*     without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+*  THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+*  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+*  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+*  SUCH DAMAGE.
+*
+***************************************************************************
+*  History:
+*
+*  17.10.2026  mifi  First Version, header parser corpus test.
+*  17.10.2026  mifi  Added the benchmark mode.
+**************************************************************************/
+/*
+ * Test of the HTTP request header parser. Every corpus file is parsed
+ * in one piece, and then again in random pieces, like the data comes
+ * from the stream. In addition random mutations of the file are parsed
+ * the same way:
+ *
+ *    hptest [-n Mutations] [-s Seed] File...
+ *
+ * The result must not depend on how the data is split, and the parser
+ * must keep its invariants for any input: all request strings inside
+ * hp_buf, User-Agent and Referer within HTTP_MAX_INFO_SIZE and outside
+ * of the HTTP_HEADER_RESERVE. One summary line is output per file, the
+ * Makefile compares it with test/hptest.exp.
+ *
+ * With -b the files are not tested but parsed Count times in one piece
+ * and Count times in pieces of BENCH_PIECE bytes, and the requests/s
+ * are output per file and for the whole corpus:
+ *
+ *    hptest -b Count File...
+ */
+#define __HPTEST_C__
+
+/*=======================================================================*/
+/*  Includes                                                             */
+/*=======================================================================*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "pro/uhttp/uhttpd.h"
+
+/*=======================================================================*/
+/*  All Structures and Common Constants                                  */
+/*=======================================================================*/
+
+#define MAX_FILE_SIZE   8192
+#define MAX_RESULT_SIZE (HTTP_MAX_HEADER_SIZE + 256)
+#define SPLIT_CNT       64
+#define BENCH_PIECE     16
+
+/*=======================================================================*/
+/*  Definition of all local Data                                         */
+/*=======================================================================*/
+
+static HTTPD_SESSION Session;
+static uint32_t      dRandom;
+static int           nFailed;
+
+static char          FileBuffer[MAX_FILE_SIZE];
+static char          MutBuffer[MAX_FILE_SIZE * 2];
+static char          RefResult[MAX_RESULT_SIZE];
+static char          Result[MAX_RESULT_SIZE];
+
+/*=======================================================================*/
+/*  Definition of all local Procedures                                   */
+/*=======================================================================*/
+
+/*************************************************************************/
+/*  TimeGetUs                                                            */
+/*************************************************************************/
+static uint64_t TimeGetUs (void)
+{
+   struct timespec ts;
+   
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   
+   return(((uint64_t)ts.tv_sec * 1000000) + ((uint64_t)ts.tv_nsec / 1000));
+} /* TimeGetUs */
+
+/*************************************************************************/
+/*  Random                                                               */
+/*                                                                       */
+/*  xorshift32, the result must be the same on every host.               */
+/*************************************************************************/
+static uint32_t Random (uint32_t dRange)
+{
+   dRandom ^= dRandom << 13;
+   dRandom ^= dRandom >> 17;
+   dRandom ^= dRandom << 5;
+   
+   return(dRandom % dRange);
+} /* Random */
+
+/*************************************************************************/
+/*  Fail                                                                 */
+/*************************************************************************/
+static void Fail (const char *pName, const char *pText, int nSplit)
+{
+   /* Output only the first failures */
+   if (nFailed < 20)
+   {
+      printf("%s: FAIL %s (split %d)\n", pName, pText, nSplit);
+   }
+   nFailed++;
+} /* Fail */
+
+/*************************************************************************/
+/*  CheckString                                                          */
+/*                                                                       */
+/*  A request string must be terminated inside hp_buf.                   */
+/*************************************************************************/
+static int CheckString (const char *pString)
+{
+   const char *pBuf = Session.s_parser.hp_buf;
+   int         nSize = (int)sizeof(Session.s_parser.hp_buf);
+   
+   if (NULL == pString)
+   {
+      return(0);
+   }
+   if ((pString < pBuf) || (pString >= (pBuf + nSize)))
+   {
+      return(-1);
+   }
+   if (NULL == memchr(pString, 0, (size_t)((pBuf + nSize) - pString)))
+   {
+      return(-1);
+   }
+   
+   return(0);
+} /* CheckString */
+
+/*************************************************************************/
+/*  CheckInfo                                                            */
+/*                                                                       */
+/*  User-Agent and Referer must not use the reserve.                     */
+/*************************************************************************/
+static int CheckInfo (const char *pString)
+{
+   const char *pEnd = Session.s_parser.hp_buf + sizeof(Session.s_parser.hp_buf) - HTTP_HEADER_RESERVE;
+   
+   if (NULL == pString)
+   {
+      return(0);
+   }
+   if ((strlen(pString) > HTTP_MAX_INFO_SIZE) || ((pString + strlen(pString)) >= pEnd))
+   {
+      return(-1);
+   }
+   
+   return(0);
+} /* CheckInfo */
+
+/*************************************************************************/
+/*  CheckInvariants                                                      */
+/*                                                                       */
+/*  Return: NULL == ok / otherwise the failed invariant                  */
+/*************************************************************************/
+static const char *CheckInvariants (void)
+{
+   HTTP_PARSER  *hp  = &Session.s_parser;
+   HTTP_REQUEST *req = &Session.s_req;
+   
+   if ((hp->hp_line < 0) || (hp->hp_line > hp->hp_len) || (hp->hp_len >= (int)sizeof(hp->hp_buf)))
+   {
+      return("buffer index");
+   }
+   if (CheckString(req->req_url)    || CheckString(req->req_query)   ||
+       CheckString(req->req_type)   || CheckString(req->req_cookie)  ||
+       CheckString(req->req_auth)   || CheckString(req->req_agent)   ||
+       CheckString(req->req_inm)    || CheckString(req->req_range)   ||
+       CheckString(req->req_ifrange)|| CheckString(req->req_referer) ||
+       CheckString(req->req_host)   || CheckString(req->req_encoding))
+   {
+      return("string outside of hp_buf");
+   }
+   if (CheckInfo(req->req_agent) || CheckInfo(req->req_referer))
+   {
+      return("info value too long");
+   }
+   if ((HTTP_PARSE_DONE == hp->hp_state) && (req->req_length < 0))
+   {
+      return("negative length");
+   }
+   if ((HTTP_PARSE_ERROR == hp->hp_state) && (0 == hp->hp_status))
+   {
+      return("error without status");
+   }
+   
+   return(NULL);
+} /* CheckInvariants */
+
+/*************************************************************************/
+/*  AddString                                                            */
+/*************************************************************************/
+static void AddString (char *pResult, const char *pName, const char *pString)
+{
+   size_t Len = strlen(pResult);
+   
+   snprintf(&pResult[Len], MAX_RESULT_SIZE - Len, " %s=%s", pName, (pString != NULL) ? pString : "-");
+} /* AddString */
+
+/*************************************************************************/
+/*  GetResult                                                            */
+/*                                                                       */
+/*  Collect all values of the request which the parser has evaluated.    */
+/*************************************************************************/
+static void GetResult (char *pResult)
+{
+   HTTP_PARSER  *hp  = &Session.s_parser;
+   HTTP_REQUEST *req = &Session.s_req;
+   
+   snprintf(pResult, MAX_RESULT_SIZE, "%d %d %d %02x %d %ld",
+            hp->hp_state, hp->hp_status, req->req_method, req->req_version,
+            req->req_connection, req->req_length);
+   AddString(pResult, "url",     req->req_url);
+   AddString(pResult, "query",   req->req_query);
+   AddString(pResult, "type",    req->req_type);
+   AddString(pResult, "cookie",  req->req_cookie);
+   AddString(pResult, "auth",    req->req_auth);
+   AddString(pResult, "agent",   req->req_agent);
+   AddString(pResult, "inm",     req->req_inm);
+   AddString(pResult, "range",   req->req_range);
+   AddString(pResult, "ifrange", req->req_ifrange);
+   AddString(pResult, "referer", req->req_referer);
+   AddString(pResult, "host",    req->req_host);
+   AddString(pResult, "enc",     req->req_encoding);
+} /* GetResult */
+
+/*************************************************************************/
+/*  Parse                                                                */
+/*                                                                       */
+/*  Parse the data in pieces of random size, nMaxPiece == 0 parse the    */
+/*  data in one piece.                                                   */
+/*                                                                       */
+/*  Return: NULL == ok / otherwise the failed invariant                  */
+/*************************************************************************/
+static const char *Parse (const char *pData, int nLen, int nMinimal, int nMaxPiece)
+{
+   const char *pError;
+   int         nPos = 0;
+   int         nPiece;
+   int         nUsed;
+   
+   HttpParseInit(&Session);
+   Session.s_parser.hp_minimal = nMinimal;
+   
+   while ((nPos < nLen) && (Session.s_parser.hp_state < HTTP_PARSE_DONE))
+   {
+      nPiece = nLen - nPos;
+      if ((nMaxPiece != 0) && (nPiece > 1))
+      {
+         nPiece = 1 + (int)Random((uint32_t)((nPiece < nMaxPiece) ? nPiece : nMaxPiece));
+      }
+      
+      nUsed = HttpParseExecute(&Session, &pData[nPos], nPiece);
+      if ((nUsed < 0) || (nUsed > nPiece))
+      {
+         return("used out of range");
+      }
+      if ((nUsed < nPiece) && (Session.s_parser.hp_state < HTTP_PARSE_DONE))
+      {
+         return("data left while parsing");
+      }
+      nPos += nUsed;
+      
+      pError = CheckInvariants();
+      if (pError != NULL)
+      {
+         return(pError);
+      }
+   }
+   
+   return(NULL);
+} /* Parse */
+
+/*************************************************************************/
+/*  TestData                                                             */
+/*                                                                       */
+/*  Parse the data in one piece and in SPLIT_CNT random splits, all      */
+/*  results must be the same. The result of the full parse is left in    */
+/*  Session.                                                             */
+/*************************************************************************/
+static void TestData (const char *pName, const char *pData, int nLen)
+{
+   const char *pError;
+   int         nMinimal;
+   int         nSplit;
+   
+   /* The minimal parser first, the full result is left for the summary */
+   for (nMinimal = 1; nMinimal >= 0; nMinimal--)
+   {
+      pError = Parse(pData, nLen, nMinimal, 0);
+      if (pError != NULL)
+      {
+         Fail(pName, pError, 0);
+         continue;
+      }
+      GetResult(RefResult);
+      
+      for (nSplit = 1; nSplit <= SPLIT_CNT; nSplit++)
+      {
+         /* Many small pieces first, then larger ones */
+         pError = Parse(pData, nLen, nMinimal, (nSplit < (SPLIT_CNT / 2)) ? 8 : 256);
+         if (pError != NULL)
+         {
+            Fail(pName, pError, nSplit);
+            break;
+         }
+         GetResult(Result);
+         if (strcmp(Result, RefResult) != 0)
+         {
+            Fail(pName, "result depends on the split", nSplit);
+            break;
+         }
+      }
+   }
+   
+   Parse(pData, nLen, 0, 0);
+} /* TestData */
+
+/*************************************************************************/
+/*  Mutate                                                               */
+/*                                                                       */
+/*  Return: length of the mutated data in MutBuffer                      */
+/*************************************************************************/
+static int Mutate (int nLen)
+{
+   static const char Special[] = "\r\n:% \t\0";
+   int nCount;
+   int nPos;
+   int nSize;
+   
+   memcpy(MutBuffer, FileBuffer, (size_t)nLen);
+   if (0 == nLen)
+   {
+      return(0);
+   }
+   
+   for (nCount = 1 + (int)Random(4); nCount > 0; nCount--)
+   {
+      nPos = (int)Random((uint32_t)nLen);
+      switch (Random(5))
+      {
+         /* Replace a byte by a random one */
+         case 0:
+            MutBuffer[nPos] = (char)Random(256);
+            break;
+         
+         /* Replace a byte by a special one */
+         case 1:
+            MutBuffer[nPos] = Special[Random(sizeof(Special))];
+            break;
+         
+         /* Remove a block */
+         case 2:
+            nSize = 1 + (int)Random((uint32_t)(nLen - nPos));
+            memmove(&MutBuffer[nPos], &MutBuffer[nPos + nSize], (size_t)(nLen - nPos - nSize));
+            nLen -= nSize;
+            break;
+         
+         /* Duplicate a block, this creates long lines too */
+         case 3:
+            nSize = 1 + (int)Random((uint32_t)(nLen - nPos));
+            if ((nLen + nSize) <= (int)sizeof(MutBuffer))
+            {
+               memmove(&MutBuffer[nPos + nSize], &MutBuffer[nPos], (size_t)(nLen - nPos));
+               nLen += nSize;
+            }
+            break;
+         
+         /* Cut the data */
+         default:
+            nLen = nPos;
+            break;
+      }
+      if (0 == nLen)
+      {
+         break;
+      }
+   }
+   
+   return(nLen);
+} /* Mutate */
+
+/*************************************************************************/
+/*  TestFile                                                             */
+/*************************************************************************/
+static void TestFile (const char *pPath, int nMutations)
+{
+   static const char *StateName[] = { "REQUEST", "HEADER", "DONE", "ERROR" };
+   FILE         *hFile;
+   const char   *pName;
+   HTTP_REQUEST *req = &Session.s_req;
+   int           nLen;
+   int           nMutLen;
+   int           nIndex;
+   int           StateCnt[4] = { 0, 0, 0, 0 };
+   
+   pName = strrchr(pPath, '/');
+   pName = (pName != NULL) ? (pName + 1) : pPath;
+   
+   hFile = fopen(pPath, "rb");
+   if (NULL == hFile)
+   {
+      Fail(pName, "can not open the file", 0);
+      return;
+   }
+   nLen = (int)fread(FileBuffer, 1, sizeof(FileBuffer), hFile);
+   fclose(hFile);
+   
+   for (nIndex = 0; nIndex < nMutations; nIndex++)
+   {
+      nMutLen = Mutate(nLen);
+      TestData(pName, MutBuffer, nMutLen);
+      StateCnt[Session.s_parser.hp_state & 3]++;
+   }
+   
+   /* The summary shows the result of the original file */
+   TestData(pName, FileBuffer, nLen);
+   
+   printf("%-20s %-7s %3d  len %ld  agent %d  referer %d  cookie %s  range %s  "
+          "mutations %d/%d/%d/%d\n",
+          pName, StateName[Session.s_parser.hp_state & 3], Session.s_parser.hp_status,
+          req->req_length,
+          (req->req_agent   != NULL) ? (int)strlen(req->req_agent)   : -1,
+          (req->req_referer != NULL) ? (int)strlen(req->req_referer) : -1,
+          (req->req_cookie  != NULL) ? req->req_cookie : "-",
+          (req->req_range   != NULL) ? req->req_range  : "-",
+          StateCnt[0], StateCnt[1], StateCnt[2], StateCnt[3]);
+} /* TestFile */
+
+/*************************************************************************/
+/*  BenchParse                                                           */
+/*                                                                       */
+/*  Parse the data nCount times in pieces of nPiece bytes, without the   */
+/*  checks of Parse.                                                     */
+/*                                                                       */
+/*  Return: time in us                                                   */
+/*************************************************************************/
+static uint64_t BenchParse (const char *pData, int nLen, int nPiece, int nCount)
+{
+   uint64_t qStart;
+   int      nPos;
+   int      nUsed;
+   
+   qStart = TimeGetUs();
+   while (nCount-- > 0)
+   {
+      HttpParseInit(&Session);
+      
+      nPos = 0;
+      while ((nPos < nLen) && (Session.s_parser.hp_state < HTTP_PARSE_DONE))
+      {
+         nUsed = HttpParseExecute(&Session, &pData[nPos], ((nLen - nPos) < nPiece) ? (nLen - nPos) : nPiece);
+         if (nUsed <= 0)
+         {
+            break;
+         }
+         nPos += nUsed;
+      }
+   }
+   
+   return(TimeGetUs() - qStart);
+} /* BenchParse */
+
+/*************************************************************************/
+/*  BenchFile                                                            */
+/*                                                                       */
+/*  Parse the file in one piece and split, the times are added to        */
+/*  pTime[0] and pTime[1].                                               */
+/*************************************************************************/
+static void BenchFile (const char *pPath, int nCount, uint64_t *pTime)
+{
+   FILE       *hFile;
+   const char *pName;
+   uint64_t    qOne;
+   uint64_t    qSplit;
+   int         nLen;
+   
+   pName = strrchr(pPath, '/');
+   pName = (pName != NULL) ? (pName + 1) : pPath;
+   
+   hFile = fopen(pPath, "rb");
+   if (NULL == hFile)
+   {
+      Fail(pName, "can not open the file", 0);
+      return;
+   }
+   nLen = (int)fread(FileBuffer, 1, sizeof(FileBuffer), hFile);
+   fclose(hFile);
+   
+   qOne   = BenchParse(FileBuffer, nLen, nLen, nCount) + 1;
+   qSplit = BenchParse(FileBuffer, nLen, BENCH_PIECE, nCount) + 1;
+   pTime[0] += qOne;
+   pTime[1] += qSplit;
+   
+   printf("%-20s %5d bytes  one piece %9llu req/s  split %9llu req/s\n",
+          pName, nLen,
+          (unsigned long long)(((uint64_t)nCount * 1000000) / qOne),
+          (unsigned long long)(((uint64_t)nCount * 1000000) / qSplit));
+} /* BenchFile */
+
+/*************************************************************************/
+/*  Usage                                                                */
+/*************************************************************************/
+static void Usage (void)
+{
+   fprintf(stderr, "Usage: hptest [-n Mutations] [-s Seed] File...\n"
+                   "       hptest -b Count File...\n");
+} /* Usage */
+
+/*=======================================================================*/
+/*  All code exported                                                    */
+/*=======================================================================*/
+
+int main (int argc, char **argv)
+{
+   int      nMutations = 1000;
+   uint32_t dSeed      = 0x2026;
+   int      nBench     = 0;
+   int      nFiles;
+   int      nOpt;
+   uint64_t Time[2]    = { 0, 0 };
+   
+   while ((nOpt = getopt(argc, argv, "b:n:s:")) != -1)
+   {
+      switch (nOpt)
+      {
+         case 'b': nBench     = atoi(optarg);                      break;
+         case 'n': nMutations = atoi(optarg);                      break;
+         case 's': dSeed      = (uint32_t)strtoul(optarg, NULL, 0); break;
+         default:  Usage(); return(1);
+      }
+   }
+   if ((optind >= argc) || (nMutations < 0) || (nBench < 0) || (0 == dSeed))
+   {
+      Usage();
+      return(1);
+   }
+   
+   if (nBench != 0)
+   {
+      nFiles = argc - optind;
+      for (; optind < argc; optind++)
+      {
+         BenchFile(argv[optind], nBench, Time);
+      }
+      
+      /* The corpus as a whole, each file counts the same */
+      printf("%-20s %5d files  one piece %9llu req/s  split %9llu req/s\n",
+             "corpus", nFiles,
+             (unsigned long long)(((uint64_t)nFiles * (uint64_t)nBench * 1000000) / (Time[0] + 1)),
+             (unsigned long long)(((uint64_t)nFiles * (uint64_t)nBench * 1000000) / (Time[1] + 1)));
+      
+      return((nFailed != 0) ? 2 : 0);
+   }
+   
+   for (; optind < argc; optind++)
+   {
+      /* Each file starts with the same seed, the result of a file does not depend on the others */
+      dRandom = dSeed;
+      TestFile(argv[optind], nMutations);
+   }
+   
+   if (nFailed != 0)
+   {
+      printf("%d failures\n", nFailed);
+      return(2);
+   }
+   
+   return(0);
+} /* main */
+
+/*** EOF ***/
@@ -0,0 +1,654 @@
+/**************************************************************************
+*  Copyright (c) 2026 by Michael Fischer (www.emb4fun.de).
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*  1. Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*
+*  2. Redistributions in binary form must reproduce the above copyright
+*     notice, this list of conditions and the following disclaimer in the
+*     documentation and/or other materials provided with the distribution.
+*
+*  3. Neither the name of the author nor the names of its contributors may
+*     be used to endorse or promote products derived from this software
+*     without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+*  THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+*  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+*  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+*  SUCH DAMAGE.
+*
+***************************************************************************
+*  History:
+*
+*  16.10.2026  mifi  First Version, loopback load generator.
+*  17.10.2026  mifi  Output the memory use of the server with -m.
+**************************************************************************/
+/*
+ * Load generator for the host build of the web server. Every connection
+ * is a thread which sends the same GET request again and again over a
+ * keep-alive connection, and measures the time up to the end of the
+ * response:
+ *
+ *    loadgen [-a Addr] [-p Port] [-u Url] [-c Connections] [-d Seconds]
+ *            [-m StatUrl]
+ *
+ * The requests per second and the latency percentiles are output.
+ *
+ * With -m the JSON snapshot of the board, e.g. /cgi-bin/stat_json.cgi,
+ * is read with ?reset=1 before and after the run. The peaks of the
+ * memory pools and the netconns of the run, and the tasks with the
+ * stack used are output.
+ */
+#define __LOADGEN_C__
+
+/*=======================================================================*/
+/*  Includes                                                             */
+/*=======================================================================*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+/*=======================================================================*/
+/*  All Structures and Common Constants                                  */
+/*=======================================================================*/
+
+#define MAX_CONNECTIONS    256
+#define MAX_SAMPLES        (1024 * 1024)
+#define RX_BUFFER_SIZE     4096
+#define STAT_BUFFER_SIZE   16384
+
+typedef struct _conn_
+{
+   pthread_t   Thread;
+   int         Sock;
+   
+   /* Receive buffer */
+   char        Buffer[RX_BUFFER_SIZE];
+   int         nPos;
+   int         nLen;
+   
+   /* Results */
+   uint32_t    dRequests;
+   uint32_t    dErrors;
+   uint32_t    dConnects;
+   uint64_t    qBytes;
+   uint32_t   *pSamples;     /* Latency in us */
+   uint32_t    dSamples;
+} conn_t;
+
+/*=======================================================================*/
+/*  Definition of all local Data                                         */
+/*=======================================================================*/
+
+static struct sockaddr_in Addr;
+static char               Request[512];
+static int                nRequestLen;
+static volatile int       nRunning = 1;
+
+static conn_t             ConnList[MAX_CONNECTIONS];
+static char               StatBuffer[STAT_BUFFER_SIZE];
+
+/*=======================================================================*/
+/*  Definition of all local Procedures                                   */
+/*=======================================================================*/
+
+/*************************************************************************/
+/*  TimeGetUs                                                            */
+/*************************************************************************/
+static uint64_t TimeGetUs (void)
+{
+   struct timespec ts;
+   
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   
+   return(((uint64_t)ts.tv_sec * 1000000) + ((uint64_t)ts.tv_nsec / 1000));
+} /* TimeGetUs */
+
+/*************************************************************************/
+/*  Connect                                                              */
+/*************************************************************************/
+static int Connect (conn_t *pConn)
+{
+   int on = 1;
+   
+   pConn->Sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+   if (pConn->Sock < 0)
+   {
+      return(-1);
+   }
+   setsockopt(pConn->Sock, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+   
+   if (connect(pConn->Sock, (struct sockaddr*)&Addr, sizeof(Addr)) != 0)
+   {
+      close(pConn->Sock);
+      pConn->Sock = -1;
+      return(-1);
+   }
+   pConn->nPos = 0;
+   pConn->nLen = 0;
+   pConn->dConnects++;
+   
+   return(0);
+} /* Connect */
+
+/*************************************************************************/
+/*  Fill                                                                 */
+/*                                                                       */
+/*  Make sure data is available in the receive buffer.                   */
+/*************************************************************************/
+static int Fill (conn_t *pConn)
+{
+   int nGot;
+   
+   if (pConn->nPos < pConn->nLen)
+   {
+      return(0);
+   }
+   
+   nGot = (int)recv(pConn->Sock, pConn->Buffer, sizeof(pConn->Buffer), 0);
+   if (nGot <= 0)
+   {
+      return(-1);
+   }
+   pConn->qBytes += (uint64_t)nGot;
+   pConn->nPos    = 0;
+   pConn->nLen    = nGot;
+   
+   return(0);
+} /* Fill */
+
+/*************************************************************************/
+/*  ReadLine                                                             */
+/*************************************************************************/
+static int ReadLine (conn_t *pConn, char *pLine, int nSize)
+{
+   int  nLen = 0;
+   char ch;
+   
+   for (;;)
+   {
+      if (Fill(pConn) != 0)
+      {
+         return(-1);
+      }
+      ch = pConn->Buffer[pConn->nPos++];
+      if ('\n' == ch)
+      {
+         break;
+      }
+      if ((ch != '\r') && (nLen < (nSize - 1)))
+      {
+         pLine[nLen++] = ch;
+      }
+   }
+   pLine[nLen] = 0;
+   
+   return(nLen);
+} /* ReadLine */
+
+/*************************************************************************/
+/*  Skip                                                                 */
+/*************************************************************************/
+static int Skip (conn_t *pConn, long lCount)
+{
+   int nAvail;
+   
+   while (lCount > 0)
+   {
+      if (Fill(pConn) != 0)
+      {
+         return(-1);
+      }
+      nAvail = pConn->nLen - pConn->nPos;
+      if (nAvail > lCount)
+      {
+         nAvail = (int)lCount;
+      }
+      pConn->nPos += nAvail;
+      lCount      -= nAvail;
+   }
+   
+   return(0);
+} /* Skip */
+
+/*************************************************************************/
+/*  ReadResponse                                                         */
+/*                                                                       */
+/*  Read a complete response.                                            */
+/*                                                                       */
+/*  Return: 0 = OK and keep-alive / 1 = OK and close / -1 = ERROR        */
+/*************************************************************************/
+static int ReadResponse (conn_t *pConn)
+{
+   char  Line[256];
+   int   nStatus  = 0;
+   long  lLength  = -1;
+   int   nChunked = 0;
+   int   nClose   = 0;
+   long  lChunk;
+   
+   if ((ReadLine(pConn, Line, sizeof(Line)) < 12) || (sscanf(Line, "HTTP/1.%*d %d", &nStatus) != 1))
+   {
+      return(-1);
+   }
+   
+   /* Header */
+   while (ReadLine(pConn, Line, sizeof(Line)) > 0)
+   {
+      if (0 == strncasecmp(Line, "Content-Length:", 15))
+      {
+         lLength = atol(&Line[15]);
+      }
+      else if (0 == strncasecmp(Line, "Transfer-Encoding: chunked", 26))
+      {
+         nChunked = 1;
+      }
+      else if (0 == strncasecmp(Line, "Connection: close", 17))
+      {
+         nClose = 1;
+      }
+   }
+   
+   /* Body */
+   if (1 == nChunked)
+   {
+      do
+      {
+         if (ReadLine(pConn, Line, sizeof(Line)) < 1)
+         {
+            return(-1);
+         }
+         lChunk = strtol(Line, NULL, 16);
+         if ((Skip(pConn, lChunk) != 0) || (ReadLine(pConn, Line, sizeof(Line)) != 0))
+         {
+            return(-1);
+         }
+      } while (lChunk != 0);
+   }
+   else if (lLength > 0)
+   {
+      if (Skip(pConn, lLength) != 0)
+      {
+         return(-1);
+      }
+   }
+   else if (lLength < 0)
+   {
+      /* The body ends with the connection */
+      while (Fill(pConn) == 0)
+      {
+         pConn->nPos = pConn->nLen;
+      }
+      nClose = 1;
+   }
+   
+   if ((nStatus < 200) || (nStatus >= 400))
+   {
+      return(-1);
+   }
+   
+   return(nClose);
+} /* ReadResponse */
+
+/*************************************************************************/
+/*  ConnThread                                                           */
+/*************************************************************************/
+static void *ConnThread (void *arg)
+{
+   conn_t   *pConn = (conn_t*)arg;
+   uint64_t  qStart;
+   int       nRes;
+   
+   pConn->Sock = -1;
+   while (nRunning)
+   {
+      if ((pConn->Sock < 0) && (Connect(pConn) != 0))
+      {
+         pConn->dErrors++;
+         usleep(1000);
+         continue;
+      }
+      
+      qStart = TimeGetUs();
+      if (send(pConn->Sock, Request, (size_t)nRequestLen, MSG_NOSIGNAL) != nRequestLen)
+      {
+         nRes = -1;
+      }
+      else
+      {
+         nRes = ReadResponse(pConn);
+      }
+      
+      if (nRes < 0)
+      {
+         pConn->dErrors++;
+      }
+      else
+      {
+         pConn->dRequests++;
+         if (pConn->dSamples < MAX_SAMPLES)
+         {
+            pConn->pSamples[pConn->dSamples++] = (uint32_t)(TimeGetUs() - qStart);
+         }
+      }
+      
+      if (nRes != 0)
+      {
+         close(pConn->Sock);
+         pConn->Sock = -1;
+      }
+   }
+   
+   if (pConn->Sock >= 0)
+   {
+      close(pConn->Sock);
+   }
+   
+   return(NULL);
+} /* ConnThread */
+
+/*************************************************************************/
+/*  StatRead                                                             */
+/*                                                                       */
+/*  Read the JSON snapshot and clear the peaks of the server.            */
+/*                                                                       */
+/*  Return: pointer to the JSON document / NULL = ERROR                  */
+/*************************************************************************/
+static char *StatRead (const char *pStatUrl, const char *pAddr)
+{
+   char  Req[512];
+   char *pBody;
+   int   nReqLen;
+   int   nLen = 0;
+   int   nGot;
+   int   Sock;
+   
+   nReqLen = snprintf(Req, sizeof(Req),
+                      "GET %s?reset=1 HTTP/1.1\r\n"
+                      "Host: %s\r\n"
+                      "Connection: close\r\n"
+                      "\r\n", pStatUrl, pAddr);
+   if ((nReqLen < 0) || (nReqLen >= (int)sizeof(Req)))
+   {
+      return(NULL);
+   }
+   
+   Sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+   if (Sock < 0)
+   {
+      return(NULL);
+   }
+   if ((connect(Sock, (struct sockaddr*)&Addr, sizeof(Addr)) != 0) ||
+       (send(Sock, Req, (size_t)nReqLen, MSG_NOSIGNAL) != nReqLen))
+   {
+      close(Sock);
+      return(NULL);
+   }
+   
+   /* The response ends with the connection */
+   while ((nGot = (int)recv(Sock, &StatBuffer[nLen], sizeof(StatBuffer) - 1 - (size_t)nLen, 0)) > 0)
+   {
+      nLen += nGot;
+   }
+   close(Sock);
+   StatBuffer[nLen] = 0;
+   
+   if (strncmp(StatBuffer, "HTTP/1.1 200", 12) != 0)
+   {
+      return(NULL);
+   }
+   pBody = strstr(StatBuffer, "\r\n\r\n");
+   if ((NULL == pBody) || (pBody[4] != '{'))
+   {
+      return(NULL);
+   }
+   
+   return(pBody + 4);
+} /* StatRead */
+
+/*************************************************************************/
+/*  StatValue                                                            */
+/*                                                                       */
+/*  Return the number of "pName": between pStart and pEnd, or -1.        */
+/*************************************************************************/
+static long StatValue (const char *pStart, const char *pEnd, const char *pName)
+{
+   char        Key[32];
+   const char *pValue;
+   
+   snprintf(Key, sizeof(Key), "\"%s\":", pName);
+   pValue = strstr(pStart, Key);
+   if ((NULL == pValue) || (pValue >= pEnd))
+   {
+      return(-1);
+   }
+   
+   return(atol(pValue + strlen(Key)));
+} /* StatValue */
+
+/*************************************************************************/
+/*  StatOutput                                                           */
+/*                                                                       */
+/*  Output the peaks of the memory pools and the netconns, and the       */
+/*  number of tasks with the sum of the stack used.                      */
+/*************************************************************************/
+static void StatOutput (const char *pJson)
+{
+   const char *pList;
+   const char *pEnd;
+   const char *pObj;
+   const char *pSep   = "";
+   long        lTasks = 0;
+   long        lStack = 0;
+   
+   printf("Memory:      ");
+   
+   /* "mem":[{"name":"HEAP","size":..,"used":..,"free":..,"peak":..},...] */
+   pList = strstr(pJson, "\"mem\":[");
+   pEnd  = (pList != NULL) ? strchr(pList, ']') : NULL;
+   for (pObj = pList; (pEnd != NULL) && ((pObj = strstr(pObj + 1, "{\"name\":\"")) != NULL) && (pObj < pEnd); )
+   {
+      printf("%s%.*s peak %ld", pSep, (int)strcspn(pObj + 9, "\""), pObj + 9, StatValue(pObj, pEnd, "peak"));
+      pSep = ", ";
+   }
+   
+   /* "netconn":{"avail":..,"used":..,"max":..,"err":..} */
+   pObj = strstr(pJson, "\"netconn\":{");
+   if (pObj != NULL)
+   {
+      pEnd = strchr(pObj, '}');
+      printf("%snetconn max %ld", pSep, StatValue(pObj, pEnd, "max"));
+      pSep = ", ";
+   }
+   
+   /* "tasks":[{"name":..,"prio":..,"size":..,"used":..,"free":..,"cpu":..},...] */
+   pList = strstr(pJson, "\"tasks\":[");
+   pEnd  = (pList != NULL) ? strchr(pList, ']') : NULL;
+   for (pObj = pList; (pEnd != NULL) && ((pObj = strstr(pObj + 1, "{\"name\":")) != NULL) && (pObj < pEnd); )
+   {
+      lTasks++;
+      lStack += StatValue(pObj, pEnd, "used");
+   }
+   printf("%s%ld tasks stack used %ld\n", pSep, lTasks, lStack);
+   
+} /* StatOutput */
+
+/*************************************************************************/
+/*  Compare                                                              */
+/*************************************************************************/
+static int Compare (const void *a, const void *b)
+{
+   uint32_t da = *(const uint32_t*)a;
+   uint32_t db = *(const uint32_t*)b;
+   
+   return((da > db) - (da < db));
+} /* Compare */
+
+/*************************************************************************/
+/*  Usage                                                                */
+/*************************************************************************/
+static void Usage (void)
+{
+   fprintf(stderr, "Usage: loadgen [-a Addr] [-p Port] [-u Url] [-c Connections] [-d Seconds]\n"
+                   "               [-m StatUrl]\n");
+} /* Usage */
+
+/*=======================================================================*/
+/*  All code exported                                                    */
+/*=======================================================================*/
+
+int main (int argc, char **argv)
+{
+   const char *pAddr        = "127.0.0.1";
+   const char *pUrl         = "/index.htm";
+   const char *pStatUrl     = NULL;
+   char       *pStat;
+   int         nPort        = 8080;
+   int         nConnections = 8;
+   int         nSeconds     = 5;
+   int         nOpt;
+   int         i;
+   uint64_t    qStart;
+   double      fTime;
+   uint32_t   *pAll;
+   uint32_t    dCount    = 0;
+   uint32_t    dRequests = 0;
+   uint32_t    dErrors   = 0;
+   uint32_t    dConnects = 0;
+   uint64_t    qBytes    = 0;
+   
+   while ((nOpt = getopt(argc, argv, "a:p:u:c:d:m:")) != -1)
+   {
+      switch (nOpt)
+      {
+         case 'a': pAddr        = optarg;       break;
+         case 'p': nPort        = atoi(optarg); break;
+         case 'u': pUrl         = optarg;       break;
+         case 'c': nConnections = atoi(optarg); break;
+         case 'd': nSeconds     = atoi(optarg); break;
+         case 'm': pStatUrl     = optarg;       break;
+         default:  Usage(); return(1);
+      }
+   }
+   if ((nConnections < 1) || (nConnections > MAX_CONNECTIONS) || (nSeconds < 1))
+   {
+      Usage();
+      return(1);
+   }
+   
+   memset(&Addr, 0, sizeof(Addr));
+   Addr.sin_family = AF_INET;
+   Addr.sin_port   = htons((uint16_t)nPort);
+   if (inet_pton(AF_INET, pAddr, &Addr.sin_addr) != 1)
+   {
+      Usage();
+      return(1);
+   }
+   
+   nRequestLen = snprintf(Request, sizeof(Request),
+                          "GET %s HTTP/1.1\r\n"
+                          "Host: %s\r\n"
+                          "Connection: keep-alive\r\n"
+                          "\r\n", pUrl, pAddr);
+   
+   for (i = 0; i < nConnections; i++)
+   {
+      ConnList[i].pSamples = malloc(MAX_SAMPLES * sizeof(uint32_t));
+      if (NULL == ConnList[i].pSamples)
+      {
+         return(1);
+      }
+   }
+   
+   /* Clear the peaks of the server, the values of the run are read at the end */
+   if ((pStatUrl != NULL) && (NULL == StatRead(pStatUrl, pAddr)))
+   {
+      fprintf(stderr, "Can not read %s\n", pStatUrl);
+      return(1);
+   }
+   
+   qStart = TimeGetUs();
+   for (i = 0; i < nConnections; i++)
+   {
+      pthread_create(&ConnList[i].Thread, NULL, ConnThread, &ConnList[i]);
+   }
+   sleep((unsigned)nSeconds);
+   nRunning = 0;
+   for (i = 0; i < nConnections; i++)
+   {
+      pthread_join(ConnList[i].Thread, NULL);
+   }
+   fTime = (double)(TimeGetUs() - qStart) / 1000000.0;
+   
+   /* Merge the results */
+   for (i = 0; i < nConnections; i++)
+   {
+      dRequests += ConnList[i].dRequests;
+      dErrors   += ConnList[i].dErrors;
+      dConnects += ConnList[i].dConnects;
+      qBytes    += ConnList[i].qBytes;
+      dCount    += ConnList[i].dSamples;
+   }
+   pAll = malloc(((size_t)dCount + 1) * sizeof(uint32_t));
+   if (NULL == pAll)
+   {
+      return(1);
+   }
+   dCount = 0;
+   for (i = 0; i < nConnections; i++)
+   {
+      memcpy(&pAll[dCount], ConnList[i].pSamples, ConnList[i].dSamples * sizeof(uint32_t));
+      dCount += ConnList[i].dSamples;
+   }
+   qsort(pAll, dCount, sizeof(uint32_t), Compare);
+   
+   printf("URL:         %s\n", pUrl);
+   printf("Connections: %d (%u connects)\n", nConnections, dConnects);
+   printf("Requests:    %u in %.2f s, %u errors\n", dRequests, fTime, dErrors);
+   printf("Rate:        %.0f req/s, %.2f MB/s\n", (double)dRequests / fTime, (double)qBytes / fTime / 1000000.0);
+   if (dCount != 0)
+   {
+      printf("Latency us:  p50 %u, p90 %u, p99 %u, p99.9 %u, max %u\n",
+             pAll[dCount / 2], pAll[(dCount * 90ULL) / 100], pAll[(dCount * 99ULL) / 100],
+             pAll[(dCount * 999ULL) / 1000], pAll[dCount - 1]);
+   }
+   
+   if (pStatUrl != NULL)
+   {
+      pStat = StatRead(pStatUrl, pAddr);
+      if (pStat != NULL)
+      {
+         StatOutput(pStat);
+      }
+      else
+      {
+         printf("Memory:      %s not read\n", pStatUrl);
+      }
+   }
+   
+   return((0 == dErrors) ? 0 : 2);
+} /* main */
+
+/*** EOF ***/
@@ -0,0 +1,341 @@
+/**************************************************************************
+*  Copyright (c) 2026 by Michael Fischer (www.emb4fun.de).
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*  1. Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*
+*  2. Redistributions in binary form must reproduce the above copyright
+*     notice, this list of conditions and the following disclaimer in the
+*     documentation and/or other materials provided with the distribution.
+*
+*  3. Neither the name of the author nor the names of its contributors may
+*     be used to endorse or promote products derived from this software
+*     without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+*  THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+*  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+*  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+*  SUCH DAMAGE.
+*
+***************************************************************************
+*  History:
+*
+*  16.10.2026  mifi  First Version, uHTTP host server.
+*  17.10.2026  mifi  Initialize the file cache and the SSI templates.
+*  17.10.2026  mifi  Removed the low heap check, the handles are intptr_t.
+*  17.10.2026  mifi  Use the media types of ipweb.c.
+**************************************************************************/
+/*
+ * Linux host build of the web server. It serves a XFILE image from
+ * disk with the same uHTTP code as the target:
+ *
+ *    webhost Image [Port]
+ *
+ * The file system, media types and modules are initialized like on
+ * the target. Only the access log CGI is available, the board CGIs
+ * and SSI variables need the RTOS and the IP stack.
+ */
+#define __MAIN_C__
+
+/*=======================================================================*/
+/*  Includes                                                             */
+/*=======================================================================*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <signal.h>
+
+#include "tal.h"
+#include "fsapi.h"
+#include "fs_xfile.h"
+#include "ipweb.h"
+#include "web_log.h"
+#include "web_cache.h"
+#include "pro/uhttp/routes.h"
+#include "pro/uhttp/mediatypes.h"
+#include "pro/uhttp/modules/mod_ssi.h"
+
+/*=======================================================================*/
+/*  Extern                                                               */
+/*=======================================================================*/
+
+extern ISC_LIST(MEDIA_TYPE_ENTRY) mediaTypeList;
+
+/*=======================================================================*/
+/*  All Structures and Common Constants                                  */
+/*=======================================================================*/
+
+#define DEFAULT_PORT    "8080"
+
+/*
+ * Media types, the same list as mt_defaults of ipweb.c
+ */
+static char mtc_text[] = "text";
+static char mtc_image[] = "image";
+static char mtc_application[] = "application";
+
+static MEDIA_TYPE_ENTRY mt_defaults[] = {
+    { ISC_LINK_INITIAL(MEDIA_TYPE_ENTRY), mtc_text,        NULL,         MTFLAG_INITIAL, MediaTypeHandlerText,   "xml"   },
+    { ISC_LINK_INITIAL(MEDIA_TYPE_ENTRY), mtc_text,        "plain",      MTFLAG_INITIAL, MediaTypeHandlerText,   "txt"   },
+    { ISC_LINK_INITIAL(MEDIA_TYPE_ENTRY), mtc_image,       "svg+xml",    MTFLAG_INITIAL, MediaTypeHandlerBinary, "svg"   },
+    { ISC_LINK_INITIAL(MEDIA_TYPE_ENTRY), mtc_text,        "html",       MTFLAG_INITIAL, HttpSsiHandler,         "shtml" },
+    { ISC_LINK_INITIAL(MEDIA_TYPE_ENTRY), mtc_image,       NULL,         MTFLAG_INITIAL, MediaTypeHandlerBinary, "png"   },
+    { ISC_LINK_INITIAL(MEDIA_TYPE_ENTRY), mtc_application, NULL,         MTFLAG_INITIAL, MediaTypeHandlerBinary, "pdf"   },
+    { ISC_LINK_INITIAL(MEDIA_TYPE_ENTRY), mtc_application, "javascript", MTFLAG_INITIAL, MediaTypeHandlerText,   "js"    },
+    { ISC_LINK_INITIAL(MEDIA_TYPE_ENTRY), mtc_image,       "jpeg",       MTFLAG_INITIAL, MediaTypeHandlerBinary, "jpg"   },
+    { ISC_LINK_INITIAL(MEDIA_TYPE_ENTRY), mtc_image,       "x-icon",     MTFLAG_INITIAL, MediaTypeHandlerBinary, "ico"   },
+    { ISC_LINK_INITIAL(MEDIA_TYPE_ENTRY), mtc_text,        NULL,         MTFLAG_INITIAL, MediaTypeHandlerText,   "html"  },
+    { ISC_LINK_INITIAL(MEDIA_TYPE_ENTRY), mtc_text,        "html",       MTFLAG_INITIAL, MediaTypeHandlerText,   "htm"   },
+    { ISC_LINK_INITIAL(MEDIA_TYPE_ENTRY), mtc_image,       NULL,         MTFLAG_INITIAL, MediaTypeHandlerBinary, "gif"   },
+    { ISC_LINK_INITIAL(MEDIA_TYPE_ENTRY), mtc_text,        NULL,         MTFLAG_INITIAL, MediaTypeHandlerText,   "css"   },
+    { ISC_LINK_INITIAL(MEDIA_TYPE_ENTRY), mtc_text,        "cgi",        MTFLAG_INITIAL, MediaTypeHandlerText,   "cgi"   },
+    { ISC_LINK_INITIAL(MEDIA_TYPE_ENTRY), mtc_image,       NULL,         MTFLAG_INITIAL, MediaTypeHandlerBinary, "bmp"   },
+};
+
+#define MT_DEFAULTS     (sizeof(mt_defaults) / sizeof(MEDIA_TYPE_ENTRY))
+
+/*=======================================================================*/
+/*  Definition of all local Data                                         */
+/*=======================================================================*/
+
+static uint8_t  *pImage    = NULL;
+static uint32_t  dImageSize = 0;
+
+/*=======================================================================*/
+/*  Definition of all local Procedures                                   */
+/*=======================================================================*/
+
+/*************************************************************************/
+/*  InitDefaults                                                         */
+/*                                                                       */
+/*  Register the default media types, like InitDefaults of ipweb.c.      */
+/*                                                                       */
+/*  In    : none                                                         */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void InitDefaults (void)
+{
+   int i;
+
+   ISC_LIST_INIT(mediaTypeList);
+   for (i = 0; i < (int)MT_DEFAULTS; i++)
+   {
+      ISC_LIST_APPEND(mediaTypeList, &mt_defaults[i], media_link);
+   }
+   
+} /* InitDefaults */
+
+/*************************************************************************/
+/*  LoadImage                                                            */
+/*                                                                       */
+/*  Read the XFILE image and mount it.                                   */
+/*                                                                       */
+/*  In    : pName                                                        */
+/*  Out   : none                                                         */
+/*  Return: 0 = OK / -1 = ERROR                                          */
+/*************************************************************************/
+static int LoadImage (const char *pName)
+{
+   FILE    *fp;
+   long     lSize;
+   uint8_t *pBuffer;
+   
+   fp = fopen(pName, "rb");
+   if (NULL == fp)
+   {
+      return(-1);
+   }
+   
+   fseek(fp, 0, SEEK_END);
+   lSize = ftell(fp);
+   fseek(fp, 0, SEEK_SET);
+   
+   pImage = (lSize > 0) ? malloc((size_t)lSize) : NULL;
+   if ((NULL == pImage) || (fread(pImage, 1, (size_t)lSize, fp) != (size_t)lSize))
+   {
+      fclose(fp);
+      return(-1);
+   }
+   fclose(fp);
+   dImageSize = (uint32_t)lSize;
+   
+   if (xfile_Check(pImage, dImageSize) != 0)
+   {
+      return(-1);
+   }
+   
+   /* 
+    * A compressed image is unpacked into a new buffer. The header is
+    * still referenced by the name of the image, keep the old buffer.
+    */
+   pBuffer = xfile_Mount(pImage, dImageSize);
+   
+   return((NULL == pBuffer) ? -1 : 0);
+} /* LoadImage */
+
+/*************************************************************************/
+/*  StatLog                                                              */
+/*                                                                       */
+/*  In    : hs                                                           */
+/*  Out   : none                                                         */
+/*  Return: 0 = OK / -1 = ERROR                                          */
+/*************************************************************************/
+static int StatLog (HTTPD_SESSION *hs)
+{
+   return(web_LogSendJson(hs));
+} /* StatLog */
+
+/*=======================================================================*/
+/*  All code exported                                                    */
+/*=======================================================================*/
+
+/*************************************************************************/
+/*  web_SendCGIHeader                                                    */
+/*                                                                       */
+/*  In    : hs                                                           */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+void web_SendCGIHeader (HTTPD_SESSION *hs)
+{
+   HttpSendHeaderTop(hs, 200);
+   s_puts("Cache-Control: no-cache, must-revalidate\r\n", hs->s_stream);
+   s_puts("Expires: Sat, 26 Jul 1997 05:00:00 GMT\r\n", hs->s_stream);   
+   HttpSendHeaderBottom(hs, NULL, NULL, -1, 0);   
+   
+   s_set_flags(hs->s_stream, S_FLG_CHUNKED);
+   
+} /* web_SendCGIHeader */
+
+/*************************************************************************/
+/*  SsiLongName                                                          */
+/*                                                                       */
+/*  In    : hs                                                           */
+/*  Out   : none                                                         */
+/*  Return: 0 = OK                                                       */
+/*************************************************************************/
+static int SsiLongName (HTTPD_SESSION *hs)
+{
+   s_puts(xfile_GetName(), hs->s_stream);
+   
+   return(0);
+} /* SsiLongName */
+
+/*************************************************************************/
+/*  SsiNothing                                                           */
+/*                                                                       */
+/*  In    : hs                                                           */
+/*  Out   : none                                                         */
+/*  Return: 0 = OK                                                       */
+/*************************************************************************/
+static int SsiNothing (HTTPD_SESSION *hs)
+{
+   (void)hs;
+   
+   return(0);
+} /* SsiNothing */
+
+/*************************************************************************/
+/*  HttpSsiLookupExt                                                     */
+/*                                                                       */
+/*  The ASP variables of the target are not available, only the name    */
+/*  of the image is output. All others are replaced by nothing.          */
+/*                                                                       */
+/*  In    : name, len                                                    */
+/*  Out   : none                                                         */
+/*  Return: Handler                                                      */
+/*************************************************************************/
+HTTP_SSI_EXTHANDLER HttpSsiLookupExt (const char *name, int len)
+{
+   if ((12 == len) && (0 == strncasecmp(name, "sys_longname", 12)))
+   {
+      return(SsiLongName);
+   }
+   
+   return(SsiNothing);
+} /* HttpSsiLookupExt */
+
+/*************************************************************************/
+/*  HttpSsiParseExt                                                      */
+/*                                                                       */
+/*  In    : hs, buf, len                                                 */
+/*  Out   : none                                                         */
+/*  Return: 0 = OK                                                       */
+/*************************************************************************/
+int HttpSsiParseExt (HTTPD_SESSION *hs, const char *buf, int len)
+{
+   return(HttpSsiLookupExt(buf, len)(hs));
+} /* HttpSsiParseExt */
+
+/*************************************************************************/
+/*  main                                                                 */
+/*                                                                       */
+/*  In    : argc, argv                                                   */
+/*  Out   : none                                                         */
+/*  Return: 0 = OK / 1 = ERROR                                           */
+/*************************************************************************/
+int main (int argc, char **argv)
+{
+   const char *pPort = DEFAULT_PORT;
+   
+   if (argc < 2)
+   {
+      fprintf(stderr, "Usage: webhost Image [Port]\n");
+      return(1);
+   }
+   if (argc > 2)
+   {
+      pPort = argv[2];
+   }
+   
+   /* A client which close the connection must not stop the server */
+   signal(SIGPIPE, SIG_IGN);
+   
+   web_CacheInit();
+   HttpSsiInit();
+   FSInit();
+   xfile_Init();
+   if (LoadImage(argv[1]) != 0)
+   {
+      fprintf(stderr, "Error: %s is not a valid XFILE image\n", argv[1]);
+      return(1);
+   }
+   HttpRegisterRootPath("XFILE:"); 
+   HttpRegisterRedir("", "/index.htm", 307);
+   
+   /* Same setup as IPWebsInit */
+   StreamInit();
+   InitDefaults();
+   HttpRegisterMediaType("html", "text", "html", HttpSsiHandler);
+   HttpRegisterMediaType("htm",  "text", "html", HttpSsiHandler);
+   HttpRegisterMediaType("cgi", NULL, NULL, HttpCgiFunctionHandler);
+   HttpRegisterCgiFunction("cgi-bin/stat_log.cgi", StatLog);
+   
+   /* Same as IPWebsStart */
+   HttpRoutesFreeze();
+   
+   printf("Serve \"%s\" (%s) on port %s\n", argv[1], xfile_GetName(), pPort);
+   
+   StreamClientAccept(HttpdClientHandler, pPort);
+   
+   fprintf(stderr, "Error: port %s is not available\n", pPort);
+   
+   return(1);
+} /* main */
+
+/*** EOF ***/
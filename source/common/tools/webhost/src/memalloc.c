@@ -0,0 +1,189 @@
+/**************************************************************************
+*  Copyright (c) 2026 by Michael Fischer (www.emb4fun.de).
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*  1. Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*
+*  2. Redistributions in binary form must reproduce the above copyright
+*     notice, this list of conditions and the following disclaimer in the
+*     documentation and/or other materials provided with the distribution.
+*
+*  3. Neither the name of the author nor the names of its contributors may
+*     be used to endorse or promote products derived from this software
+*     without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+*  THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+*  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+*  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+*  SUCH DAMAGE.
+*
+***************************************************************************
+*  History:
+*
+*  17.10.2026  mifi  First Version, talmem.c for membench.
+**************************************************************************/
+/*
+ * The allocator of talmem.c for membench. The Makefile builds this file
+ * twice, with TAL_MEM_SUPPORT_TLSF 0 and 1, and MEM_PREFIX ff and tlsf.
+ * All exported functions of talmem.c get the prefix, membench uses the
+ * functions below:
+ *
+ *    ff_MemInit, ff_MemMalloc, ff_MemFree, ff_MemStat
+ *    tlsf_MemInit, tlsf_MemMalloc, tlsf_MemFree, tlsf_MemStat
+ *
+ * talmem.c uses 32 bit addresses like the target, the pool must be
+ * located in the lower 4 GB, see membench.
+ */
+#define __MEMALLOC_C__
+
+/*=======================================================================*/
+/*  Includes                                                             */
+/*=======================================================================*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/*
+ * The memory pools of talmem.c instead of the C library heap of the
+ * host talmem.h, which must not be included.
+ */
+#define __TALMEM_H__
+
+typedef enum
+{
+   XM_ID_HEAP = 0,
+   XM_ID_MAX  = 16
+} tal_mem_id;
+
+#include "tal.h"
+
+#define TAL_PRINTF   printf
+
+/* All exported functions get the prefix */
+#define MEM_CAT(_a,_b)     _a##_b
+#define MEM_XCAT(_a,_b)    MEM_CAT(_a,_b)
+#define MEM_NAME(_n)       MEM_XCAT(MEM_PREFIX, _n)
+
+#define tal_MEMInit                 MEM_NAME(_tal_MEMInit)
+#define tal_MEMAdd                  MEM_NAME(_tal_MEMAdd)
+#define tal_MEMOutputMemoryInfo     MEM_NAME(_tal_MEMOutputMemoryInfo)
+#define tal_MEMInfoGet              MEM_NAME(_tal_MEMInfoGet)
+#define tal_MEMGetUsedRawMemory     MEM_NAME(_tal_MEMGetUsedRawMemory)
+#define tal_MEMGetUsedRawMemoryMax  MEM_NAME(_tal_MEMGetUsedRawMemoryMax)
+#define tal_MEMClrUsedRawMemoryMax  MEM_NAME(_tal_MEMClrUsedRawMemoryMax)
+#define calloc                      MEM_NAME(_calloc)
+#define malloc                      MEM_NAME(_malloc)
+#define realloc                     MEM_NAME(_realloc)
+#define free                        MEM_NAME(_free)
+#define xcalloc                     MEM_NAME(_xcalloc)
+#define xmalloc                     MEM_NAME(_xmalloc)
+#define xrealloc                    MEM_NAME(_xrealloc)
+#define xfree                       MEM_NAME(_xfree)
+#define xstrdup                     MEM_NAME(_xstrdup)
+
+void    tal_MEMClrUsedRawMemoryMax (tal_mem_id ID);
+void   *xmalloc (tal_mem_id ID, size_t size);
+
+#include "../../../library/tal_ea1062/core/src/talmem.c"
+
+/*=======================================================================*/
+/*  All code exported                                                    */
+/*=======================================================================*/
+
+/*************************************************************************/
+/*  MemInit                                                              */
+/*                                                                       */
+/*  In    : pPool, dSize                                                 */
+/*  Out   : none                                                         */
+/*  Return: Size of the pool which can be used                           */
+/*************************************************************************/
+uint32_t MEM_NAME(_MemInit) (void *pPool, uint32_t dSize)
+{
+   memset(MemList, 0x00, sizeof(MemList));
+   MEMAdd(XM_ID_HEAP, pPool, dSize, dSize);
+
+   /* The first fit MEMAdd frees the pool, see tal_MEMAdd */
+   MemList[XM_ID_HEAP].UsedRawMemory    = 0;
+   MemList[XM_ID_HEAP].UsedRawMemoryMax = 0;
+
+   return(MemList[XM_ID_HEAP].dSize);
+} /* MemInit */
+
+/*************************************************************************/
+/*  MemMalloc                                                            */
+/*************************************************************************/
+void *MEM_NAME(_MemMalloc) (uint32_t dSize)
+{
+   return(MEMMalloc(XM_ID_HEAP, dSize));
+} /* MemMalloc */
+
+/*************************************************************************/
+/*  MemFree                                                              */
+/*************************************************************************/
+void MEM_NAME(_MemFree) (void *pBuffer)
+{
+   MEMFree(pBuffer);
+} /* MemFree */
+
+/*************************************************************************/
+/*  MemStat                                                              */
+/*                                                                       */
+/*  Return the peak of the used memory, the free memory and the largest  */
+/*  free block. The free list is walked, this is not O(1).               */
+/*                                                                       */
+/*  In    : pPeak, pFree, pLargest                                       */
+/*  Out   : pPeak, pFree, pLargest                                       */
+/*  Return: none                                                         */
+/*************************************************************************/
+void MEM_NAME(_MemStat) (uint32_t *pPeak, uint32_t *pFree, uint32_t *pLargest)
+{
+   uint32_t    dSize;
+#if (SUPPORT_TLSF == 0)
+   mem_hdr_t  *pMem;
+#else
+   tlsf_ctl_t *pCtl = MemList[XM_ID_HEAP].pTLSF;
+   tlsf_blk_t *pBlk;
+   uint32_t    dList;
+#endif
+
+   *pPeak    = (uint32_t)MemList[XM_ID_HEAP].UsedRawMemoryMax;
+   *pFree    = 0;
+   *pLargest = 0;
+
+#if (SUPPORT_TLSF == 0)
+   for (pMem = MemList[XM_ID_HEAP].pFreelist; pMem != NULL; pMem = pMem->pNext)
+   {
+      dSize     = GET_SIZE(pMem->dSize);
+      *pFree   += dSize;
+      *pLargest = (dSize > *pLargest) ? dSize : *pLargest;
+   }
+#else
+   for (dList = 0; dList < (pCtl->dFLCount * TLSF_SL_COUNT); dList++)
+   {
+      for (pBlk = pCtl->pFree[dList]; pBlk != NULL; pBlk = pBlk->pNextFree)
+      {
+         dSize     = BLK_SIZE(pBlk);
+         *pFree   += dSize;
+         *pLargest = (dSize > *pLargest) ? dSize : *pLargest;
+      }
+   }
+#endif
+
+} /* MemStat */
+
+/*** EOF ***/
@@ -0,0 +1,471 @@
+/**************************************************************************
+*  Copyright (c) 2026 by Michael Fischer (www.emb4fun.de).
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*  1. Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*
+*  2. Redistributions in binary form must reproduce the above copyright
+*     notice, this list of conditions and the following disclaimer in the
+*     documentation and/or other materials provided with the distribution.
+*
+*  3. Neither the name of the author nor the names of its contributors may
+*     be used to endorse or promote products derived from this software
+*     without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+*  THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+*  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+*  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+*  SUCH DAMAGE.
+*
+***************************************************************************
+*  History:
+*
+*  17.10.2026  mifi  First Version, allocator trace replay.
+**************************************************************************/
+/*
+ * Replay of an allocation trace with the first fit and the TLSF
+ * allocator of talmem.c, see memalloc.c:
+ *
+ *    membench [-i ID] [-k PoolKB] [-n Passes] Trace
+ *
+ * The trace is written by the webhost if WEBHOST_MEM_TRACE is set, see
+ * talmem.h. Only the allocations of the pool ID are replayed, default
+ * is XM_ID_WEB of the host. Both allocators get a pool of the same size
+ * like the "Web" pool of the board, 128 KB by default.
+ *
+ * For each allocator the latency of malloc and free is output, the
+ * failed allocations, the peak of the used memory, and the worst and
+ * the final fragmentation. The fragmentation is the part of the free
+ * memory which is not in the largest free block, it is sampled every
+ * FRAG_INTERVAL operations.
+ *
+ * On the host a block header has 64 bit pointers, the used memory is
+ * larger than on the target. Both allocators have the same handicap.
+ */
+#define __MEMBENCH_C__
+
+/*=======================================================================*/
+/*  Includes                                                             */
+/*=======================================================================*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/mman.h>
+
+/*=======================================================================*/
+/*  All Structures and Common Constants                                  */
+/*=======================================================================*/
+
+#define TRACE_ID_WEB    2        /* XM_ID_WEB of the host talmem.h */
+#define HASH_CNT        (1 << 20)
+#define FRAG_INTERVAL   64
+
+#define OP_ALLOC        0
+#define OP_FREE         1
+
+typedef struct _op_
+{
+   uint32_t dIndex;              /* Index of the allocation */
+   uint32_t dSize;               /* Size of an allocation */
+   uint8_t  bOp;
+} op_t;
+
+typedef struct _allocator_
+{
+   const char *pName;
+   uint32_t  (*Init) (void *pPool, uint32_t dSize);
+   void     *(*Malloc) (uint32_t dSize);
+   void      (*Free) (void *pBuffer);
+   void      (*Stat) (uint32_t *pPeak, uint32_t *pFree, uint32_t *pLargest);
+} allocator_t;
+
+/*=======================================================================*/
+/*  Prototypes of the allocators, see memalloc.c                         */
+/*=======================================================================*/
+
+uint32_t ff_MemInit (void *pPool, uint32_t dSize);
+void    *ff_MemMalloc (uint32_t dSize);
+void     ff_MemFree (void *pBuffer);
+void     ff_MemStat (uint32_t *pPeak, uint32_t *pFree, uint32_t *pLargest);
+
+uint32_t tlsf_MemInit (void *pPool, uint32_t dSize);
+void    *tlsf_MemMalloc (uint32_t dSize);
+void     tlsf_MemFree (void *pBuffer);
+void     tlsf_MemStat (uint32_t *pPeak, uint32_t *pFree, uint32_t *pLargest);
+
+/*=======================================================================*/
+/*  Definition of all local Data                                         */
+/*=======================================================================*/
+
+static const allocator_t AllocList[] =
+{
+   { "first fit", ff_MemInit,   ff_MemMalloc,   ff_MemFree,   ff_MemStat   },
+   { "tlsf",      tlsf_MemInit, tlsf_MemMalloc, tlsf_MemFree, tlsf_MemStat }
+};
+
+static op_t      *pOpList;
+static uint32_t   dOpCnt;
+static uint32_t   dAllocCnt;
+static uint32_t   dLivePeak;
+
+static void     **pPtrList;      /* [dAllocCnt] */
+static uint32_t  *pMallocTime;   /* ns */
+static uint32_t  *pFreeTime;     /* ns */
+
+/*=======================================================================*/
+/*  Definition of all local Procedures                                   */
+/*=======================================================================*/
+
+/*************************************************************************/
+/*  TimeGetNs                                                            */
+/*************************************************************************/
+static uint64_t TimeGetNs (void)
+{
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+
+   return(((uint64_t)ts.tv_sec * 1000000000) + (uint64_t)ts.tv_nsec);
+} /* TimeGetNs */
+
+/*************************************************************************/
+/*  Compare                                                              */
+/*************************************************************************/
+static int Compare (const void *a, const void *b)
+{
+   uint32_t da = *(const uint32_t*)a;
+   uint32_t db = *(const uint32_t*)b;
+
+   return((da > db) - (da < db));
+} /* Compare */
+
+/*************************************************************************/
+/*  AddOp                                                                */
+/*************************************************************************/
+static int AddOp (uint8_t bOp, uint32_t dIndex, uint32_t dSize)
+{
+   static uint32_t dOpMax = 0;
+   op_t           *pNew;
+
+   if (dOpCnt == dOpMax)
+   {
+      dOpMax = (0 == dOpMax) ? 65536 : (dOpMax * 2);
+      pNew   = realloc(pOpList, dOpMax * sizeof(op_t));
+      if (NULL == pNew)
+      {
+         return(-1);
+      }
+      pOpList = pNew;
+   }
+
+   pOpList[dOpCnt].bOp    = bOp;
+   pOpList[dOpCnt].dIndex = dIndex;
+   pOpList[dOpCnt].dSize  = dSize;
+   dOpCnt++;
+
+   return(0);
+} /* AddOp */
+
+/*************************************************************************/
+/*  Load                                                                 */
+/*                                                                       */
+/*  Read the trace. The addresses of the live allocations are kept in a  */
+/*  hash list, a free refers to the index of its allocation. A free of   */
+/*  an unknown address, e.g. of another pool, is ignored.                */
+/*                                                                       */
+/*  Return: 0 = OK / -1 = ERROR                                          */
+/*************************************************************************/
+static int Load (const char *pName, int nID)
+{
+   FILE               *hFile;
+   char                Line[128];
+   int32_t            *pHash;
+   int32_t            *pNext  = NULL;
+   unsigned long long *pAddr  = NULL;
+   uint32_t           *pSize  = NULL;
+   void               *pNew;
+   uint32_t            dMax   = 0;
+   uint32_t            dLive  = 0;
+   unsigned long long  Addr;
+   unsigned int        Size;
+   int                 nLineID;
+   int32_t             nIndex;
+   int32_t            *pLink;
+   uint32_t            dBucket;
+
+   hFile = fopen(pName, "r");
+   pHash = malloc(HASH_CNT * sizeof(int32_t));
+   if ((NULL == hFile) || (NULL == pHash))
+   {
+      return(-1);
+   }
+   memset(pHash, 0xFF, HASH_CNT * sizeof(int32_t));
+
+   while (fgets(Line, sizeof(Line), hFile) != NULL)
+   {
+      if (3 == sscanf(Line, "a %d %u %llx", &nLineID, &Size, &Addr))
+      {
+         if (nLineID != nID)
+         {
+            continue;
+         }
+
+         if (dAllocCnt == dMax)
+         {
+            dMax  = (0 == dMax) ? 65536 : (dMax * 2);
+            pNew  = realloc(pNext, dMax * sizeof(int32_t));
+            pNext = (pNew != NULL) ? pNew : pNext;
+            pNew  = (pNew != NULL) ? realloc(pAddr, dMax * sizeof(unsigned long long)) : NULL;
+            pAddr = (pNew != NULL) ? pNew : pAddr;
+            pNew  = (pNew != NULL) ? realloc(pSize, dMax * sizeof(uint32_t)) : NULL;
+            pSize = (pNew != NULL) ? pNew : pSize;
+            if (NULL == pNew)
+            {
+               fclose(hFile);
+               return(-1);
+            }
+         }
+
+         dBucket = (uint32_t)((Addr >> 4) % HASH_CNT);
+         pNext[dAllocCnt] = pHash[dBucket];
+         pAddr[dAllocCnt] = Addr;
+         pSize[dAllocCnt] = Size;
+         pHash[dBucket]   = (int32_t)dAllocCnt;
+
+         dLive += Size;
+         if (dLive > dLivePeak)
+         {
+            dLivePeak = dLive;
+         }
+
+         if (AddOp(OP_ALLOC, dAllocCnt, Size) != 0)
+         {
+            fclose(hFile);
+            return(-1);
+         }
+         dAllocCnt++;
+      }
+      else if (1 == sscanf(Line, "f %llx", &Addr))
+      {
+         /* Find and unlink the live allocation */
+         dBucket = (uint32_t)((Addr >> 4) % HASH_CNT);
+         for (pLink = &pHash[dBucket]; *pLink != -1; pLink = &pNext[*pLink])
+         {
+            if (pAddr[*pLink] == Addr)
+            {
+               break;
+            }
+         }
+
+         nIndex = *pLink;
+         if (nIndex != -1)
+         {
+            *pLink  = pNext[nIndex];
+            dLive  -= pSize[nIndex];
+
+            if (AddOp(OP_FREE, (uint32_t)nIndex, 0) != 0)
+            {
+               fclose(hFile);
+               return(-1);
+            }
+         }
+      }
+   }
+
+   fclose(hFile);
+   free(pHash);
+   free(pNext);
+   free(pAddr);
+   free(pSize);
+
+   return(0);
+} /* Load */
+
+/*************************************************************************/
+/*  Replay                                                               */
+/*************************************************************************/
+static void Replay (const allocator_t *pAlloc, uint8_t *pPool, uint32_t dPoolSize, int nPasses)
+{
+   uint64_t qStart;
+   uint32_t dMallocCnt = 0;
+   uint32_t dFreeCnt   = 0;
+   uint32_t dFailed    = 0;
+   uint32_t dOp;
+   uint32_t dIndex;
+   uint32_t dPeak;
+   uint32_t dFree;
+   uint32_t dLargest;
+   uint32_t dFrag;
+   uint32_t dFragMax   = 0;
+   uint32_t dFragEnd   = 0;
+   uint32_t dSize;
+   void    *p;
+   int      nPass;
+
+   dSize = pAlloc->Init(pPool, dPoolSize);
+
+   for (nPass = 0; nPass < nPasses; nPass++)
+   {
+      memset(pPtrList, 0x00, dAllocCnt * sizeof(void*));
+
+      for (dOp = 0; dOp < dOpCnt; dOp++)
+      {
+         dIndex = pOpList[dOp].dIndex;
+         if (OP_ALLOC == pOpList[dOp].bOp)
+         {
+            qStart = TimeGetNs();
+            p = pAlloc->Malloc(pOpList[dOp].dSize);
+            pMallocTime[dMallocCnt++] = (uint32_t)(TimeGetNs() - qStart);
+
+            pPtrList[dIndex] = p;
+            if (NULL == p)
+            {
+               dFailed++;
+            }
+         }
+         else if (pPtrList[dIndex] != NULL)
+         {
+            qStart = TimeGetNs();
+            pAlloc->Free(pPtrList[dIndex]);
+            pFreeTime[dFreeCnt++] = (uint32_t)(TimeGetNs() - qStart);
+
+            pPtrList[dIndex] = NULL;
+         }
+
+         if (0 == (dOp % FRAG_INTERVAL))
+         {
+            pAlloc->Stat(&dPeak, &dFree, &dLargest);
+            dFrag = (dFree != 0) ? (uint32_t)(((uint64_t)(dFree - dLargest) * 1000) / dFree) : 0;
+            if (dFrag > dFragMax)
+            {
+               dFragMax = dFrag;
+            }
+         }
+      }
+
+      /* The fragmentation with the memory which is still in use */
+      pAlloc->Stat(&dPeak, &dFree, &dLargest);
+      dFragEnd = (dFree != 0) ? (uint32_t)(((uint64_t)(dFree - dLargest) * 1000) / dFree) : 0;
+
+      /* Free the rest for the next pass */
+      for (dIndex = 0; dIndex < dAllocCnt; dIndex++)
+      {
+         if (pPtrList[dIndex] != NULL)
+         {
+            pAlloc->Free(pPtrList[dIndex]);
+         }
+      }
+   }
+
+   qsort(pMallocTime, dMallocCnt, sizeof(uint32_t), Compare);
+   qsort(pFreeTime, dFreeCnt, sizeof(uint32_t), Compare);
+
+   printf("%-10s pool %u, peak used %u, %u failed\n", pAlloc->pName, dSize, dPeak, dFailed);
+   if (dMallocCnt != 0)
+   {
+      printf("           malloc ns  p50 %6u  p99 %6u  p99.9 %6u  max %7u\n",
+             pMallocTime[dMallocCnt / 2], pMallocTime[(dMallocCnt * 99ULL) / 100],
+             pMallocTime[(dMallocCnt * 999ULL) / 1000], pMallocTime[dMallocCnt - 1]);
+   }
+   if (dFreeCnt != 0)
+   {
+      printf("           free ns    p50 %6u  p99 %6u  p99.9 %6u  max %7u\n",
+             pFreeTime[dFreeCnt / 2], pFreeTime[(dFreeCnt * 99ULL) / 100],
+             pFreeTime[(dFreeCnt * 999ULL) / 1000], pFreeTime[dFreeCnt - 1]);
+   }
+   printf("           fragmentation max %u.%u%%, end %u.%u%%\n",
+          dFragMax / 10, dFragMax % 10, dFragEnd / 10, dFragEnd % 10);
+
+} /* Replay */
+
+/*************************************************************************/
+/*  Usage                                                                */
+/*************************************************************************/
+static void Usage (void)
+{
+   fprintf(stderr, "Usage: membench [-i ID] [-k PoolKB] [-n Passes] Trace\n");
+} /* Usage */
+
+/*=======================================================================*/
+/*  All code exported                                                    */
+/*=======================================================================*/
+
+int main (int argc, char **argv)
+{
+   int      nID     = TRACE_ID_WEB;
+   int      nPoolKB = 128;
+   int      nPasses = 1;
+   int      nOpt;
+   size_t   Index;
+   uint8_t *pPool;
+
+   while ((nOpt = getopt(argc, argv, "i:k:n:")) != -1)
+   {
+      switch (nOpt)
+      {
+         case 'i': nID     = atoi(optarg); break;
+         case 'k': nPoolKB = atoi(optarg); break;
+         case 'n': nPasses = atoi(optarg); break;
+         default:  Usage(); return(1);
+      }
+   }
+   if ((optind != (argc - 1)) || (nPoolKB < 1) || (nPoolKB > (256 * 1024)) || (nPasses < 1))
+   {
+      Usage();
+      return(1);
+   }
+
+   if (Load(argv[optind], nID) != 0)
+   {
+      fprintf(stderr, "Can not read %s\n", argv[optind]);
+      return(1);
+   }
+
+   pPtrList    = malloc(((size_t)dAllocCnt + 1) * sizeof(void*));
+   pMallocTime = malloc(((size_t)dOpCnt * (size_t)nPasses + 1) * sizeof(uint32_t));
+   pFreeTime   = malloc(((size_t)dOpCnt * (size_t)nPasses + 1) * sizeof(uint32_t));
+
+   /* talmem.c uses 32 bit addresses, the pool must be in the lower 4 GB */
+#if defined(MAP_32BIT)
+   pPool = mmap(NULL, (size_t)nPoolKB * 1024, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_32BIT, -1, 0);
+#else
+   pPool = MAP_FAILED;
+#endif
+   if ((MAP_FAILED == pPool) || (NULL == pPtrList) || (NULL == pMallocTime) || (NULL == pFreeTime))
+   {
+      fprintf(stderr, "No pool in the lower 4 GB\n");
+      return(1);
+   }
+
+   printf("trace      %u operations, %u allocations of ID %d, peak %u bytes requested\n",
+          dOpCnt, dAllocCnt, nID, dLivePeak);
+
+   /* No page faults in the measurement */
+   memset(pPool, 0x00, (size_t)nPoolKB * 1024);
+
+   for (Index = 0; Index < (sizeof(AllocList) / sizeof(AllocList[0])); Index++)
+   {
+      Replay(&AllocList[Index], pPool, (uint32_t)nPoolKB * 1024, nPasses);
+   }
+
+   return(0);
+} /* main */
+
+/*** EOF ***/
@@ -0,0 +1,356 @@
+/**************************************************************************
+*  Copyright (c) 2026 by Michael Fischer (www.emb4fun.de).
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*  1. Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*
+*  2. Redistributions in binary form must reproduce the above copyright
+*     notice, this list of conditions and the following disclaimer in the
+*     documentation and/or other materials provided with the distribution.
+*
+*  3. Neither the name of the author nor the names of its contributors may
+*     be used to endorse or promote products derived from this software
+*     without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+*  THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+*  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+*  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+*  SUCH DAMAGE.
+*
+***************************************************************************
+*  History:
+*
+*  17.10.2026  mifi  First Version, s_printf benchmark.
+**************************************************************************/
+/*
+ * Benchmark of s_printf and s_vputs against the previous versions, which
+ * formatted into a buffer from the heap:
+ *
+ *    printbench [-n Count] [-r Rows]
+ *
+ * A table like StatStack of web_cgi.c is output Count times, each row
+ * with 10 s_printf and one s_vputs, 200 rows by default. The output is
+ * sent over a socket pair and read back after each table, this is not
+ * part of the time.
+ *
+ * Both versions must output the same table. The calls of the memory
+ * functions and the time per table are output for both.
+ */
+#define __PRINTBENCH_C__
+
+/*=======================================================================*/
+/*  Includes                                                             */
+/*=======================================================================*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/socket.h>
+
+#include "tal.h"
+#include "pro/uhttp/uhttpd.h"
+#include "pro/uhttp/streamio.h"
+
+/*=======================================================================*/
+/*  All Structures and Common Constants                                  */
+/*=======================================================================*/
+
+#define ROW_MAX         400
+#define SOCKET_BUF      (1024 * 1024)
+
+typedef int (*printf_t) (HTTP_STREAM *sp, const char *fmt, ...);
+typedef int (*vputs_t) (HTTP_STREAM *sp, ...);
+
+typedef struct _row_
+{
+   char     Name[17];
+   int      nPrio;
+   uint32_t dSize;
+   uint32_t dFree;
+   uint32_t dUsage;
+} row_t;
+
+typedef struct _variant_
+{
+   const char *pName;
+   printf_t    Printf;
+   vputs_t     Vputs;
+} variant_t;
+
+/*=======================================================================*/
+/*  Definition of all local Data                                         */
+/*=======================================================================*/
+
+static row_t    RowList[ROW_MAX];
+static int      nRowCnt = 200;
+static uint32_t dCount  = 10000;
+static int      hRead;
+
+/*=======================================================================*/
+/*  Definition of all local Procedures                                   */
+/*=======================================================================*/
+
+/*************************************************************************/
+/*  OldPrintf                                                            */
+/*                                                                       */
+/*  s_printf before the output buffer was used, only _out is replaced    */
+/*  by s_write.                                                          */
+/*************************************************************************/
+static int OldPrintf (HTTP_STREAM *sp, const char *fmt, ...)
+{
+   int rc = -1;
+   char *buf;
+   va_list ap;
+
+   buf = xmalloc(XM_ID_WEB, 1024);
+   if (buf)
+   {
+      va_start(ap, fmt);
+      rc = vsnprintf(buf, 1023, fmt, ap);
+      va_end(ap);
+
+      rc = s_write(buf, 1, rc, sp);
+
+      xfree(buf);
+   }
+   return(rc);
+} /* OldPrintf */
+
+/*************************************************************************/
+/*  OldVputs                                                             */
+/*                                                                       */
+/*  s_vputs before the output buffer was used, only _out is replaced     */
+/*  by s_write.                                                          */
+/*************************************************************************/
+static int OldVputs (HTTP_STREAM *sp, ...)
+{
+   int rc = -1;
+   int len;
+   char *cp;
+   char *buf;
+   va_list ap;
+
+   va_start(ap, sp);
+   for (len = 0; (cp = va_arg(ap, char *)) != NULL; len += strlen(cp));
+   va_end(ap);
+
+   buf = xmalloc(XM_ID_WEB, len + 1);
+   if (buf)
+   {
+      va_start(ap, sp);
+      for (*buf = '\0'; (cp = va_arg(ap, char *)) != NULL; strcat(buf, cp));
+      va_end(ap);
+
+      rc = s_write(buf, 1, strlen(buf), sp);
+
+      xfree(buf);
+   }
+   return(rc);
+} /* OldVputs */
+
+static const variant_t VariantList[] =
+{
+   { "old", OldPrintf, OldVputs },
+   { "new", s_printf,  s_vputs  }
+};
+
+/*************************************************************************/
+/*  TimeGetNs                                                            */
+/*************************************************************************/
+static uint64_t TimeGetNs (void)
+{
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return(((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec);
+} /* TimeGetNs */
+
+/*************************************************************************/
+/*  OutputTable                                                          */
+/*                                                                       */
+/*  The rows of StatStack, with a link to the task as s_vputs.           */
+/*************************************************************************/
+static void OutputTable (const variant_t *pVariant, HTTP_STREAM *sp)
+{
+   const row_t *pRow;
+   int          nIndex;
+
+   for (nIndex = 0; nIndex < nRowCnt; nIndex++)
+   {
+      pRow = &RowList[nIndex];
+
+      /* Start of row */
+      if (0 == (nIndex & 0x01))
+      {
+         pVariant->Printf(sp, "<tr>\r\n");
+      }
+      else
+      {
+         pVariant->Printf(sp, "<tr class=\"dim\">\r\n");
+      }
+
+      /* colum start */
+      pVariant->Printf(sp, "  <td>&nbsp;</td>\r\n");
+
+      /* colum task name */
+      pVariant->Printf(sp, "  <td>%s</td>\r\n", pRow->Name);
+      pVariant->Vputs(sp, "  <td><a href=\"task.htm?name=", pRow->Name, "\">info</a></td>\r\n", NULL);
+
+      /* colum prio, size, used, free and cpu load  */
+      pVariant->Printf(sp, "  <td>%d</td>\r\n",       pRow->nPrio);
+      pVariant->Printf(sp, "  <td>%d</td>\r\n",       pRow->dSize);
+      pVariant->Printf(sp, "  <td>%d</td>\r\n",       (pRow->dSize - pRow->dFree));
+      pVariant->Printf(sp, "  <td>%d</td>\r\n",       pRow->dFree);
+      pVariant->Printf(sp, "  <td>%2d.%02d</td>\r\n", pRow->dUsage / 100, pRow->dUsage % 100);
+
+      /* colum end */
+      pVariant->Printf(sp, "  <td>\r\n");
+
+      /* row end */
+      pVariant->Printf(sp, "</td>");
+   }
+
+   s_flush(sp);
+
+} /* OutputTable */
+
+/*************************************************************************/
+/*  ReadTable                                                            */
+/*                                                                       */
+/*  Read the sent table back, return the FNV-1a hash of it.              */
+/*************************************************************************/
+static uint32_t ReadTable (void)
+{
+   uint32_t dHash = 2166136261;
+   uint8_t  Buffer[4096];
+   int      nGot;
+   int      nIndex;
+
+   while ((nGot = (int)recv(hRead, Buffer, sizeof(Buffer), MSG_DONTWAIT)) > 0)
+   {
+      for (nIndex = 0; nIndex < nGot; nIndex++)
+      {
+         dHash = (dHash ^ Buffer[nIndex]) * 16777619;
+      }
+   }
+
+   return(dHash);
+} /* ReadTable */
+
+/*************************************************************************/
+/*  BenchVariant                                                         */
+/*                                                                       */
+/*  Return the hash of the table.                                        */
+/*************************************************************************/
+static uint32_t BenchVariant (const variant_t *pVariant, HTTP_STREAM *sp)
+{
+   uint64_t qTime = 0;
+   uint64_t qStart;
+   uint32_t dCalls;
+   uint32_t dHash = 0;
+   uint32_t dIndex;
+
+   dCalls = host_MemCallCount();
+   for (dIndex = 0; dIndex < dCount; dIndex++)
+   {
+      qStart = TimeGetNs();
+      OutputTable(pVariant, sp);
+      qTime += TimeGetNs() - qStart;
+
+      dHash = ReadTable();
+   }
+   dCalls = host_MemCallCount() - dCalls;
+
+   printf("%s   %d rows, %u memory calls, %u us per table\n", pVariant->pName, nRowCnt,
+          dCalls / dCount, (uint32_t)(qTime / dCount / 1000));
+
+   return(dHash);
+} /* BenchVariant */
+
+/*************************************************************************/
+/*  Usage                                                                */
+/*************************************************************************/
+static void Usage (void)
+{
+   fprintf(stderr, "Usage: printbench [-n Count] [-r Rows]\n");
+} /* Usage */
+
+/*=======================================================================*/
+/*  All code exported                                                    */
+/*=======================================================================*/
+
+int main (int argc, char **argv)
+{
+   HTTP_STREAM *sp;
+   int          Socket[2];
+   int          nSize = SOCKET_BUF;
+   int          nOpt;
+   int          nIndex;
+   uint32_t     dHashOld;
+   uint32_t     dHashNew;
+
+   while ((nOpt = getopt(argc, argv, "n:r:")) != -1)
+   {
+      switch (nOpt)
+      {
+         case 'n': dCount  = (uint32_t)atol(optarg); break;
+         case 'r': nRowCnt = atoi(optarg);           break;
+         default:  Usage(); return(1);
+      }
+   }
+   if ((optind != argc) || (0 == dCount) || (nRowCnt < 1) || (nRowCnt > ROW_MAX))
+   {
+      Usage();
+      return(1);
+   }
+
+   for (nIndex = 0; nIndex < nRowCnt; nIndex++)
+   {
+      snprintf(RowList[nIndex].Name, sizeof(RowList[nIndex].Name), "WebServer%03d", nIndex);
+      RowList[nIndex].nPrio  = 30 + (nIndex % 64);
+      RowList[nIndex].dSize  = 2048 + (uint32_t)(nIndex * 64);
+      RowList[nIndex].dFree  = 512 + (uint32_t)(nIndex * 13);
+      RowList[nIndex].dUsage = (uint32_t)(nIndex * 37) % 10000;
+   }
+
+   /* One table must fit into the socket buffer */
+   if (socketpair(AF_UNIX, SOCK_STREAM, 0, Socket) != 0)
+   {
+      perror("socketpair");
+      return(1);
+   }
+   setsockopt(Socket[0], SOL_SOCKET, SO_SNDBUF, &nSize, sizeof(nSize));
+   setsockopt(Socket[1], SOL_SOCKET, SO_RCVBUF, &nSize, sizeof(nSize));
+   hRead = Socket[1];
+
+   sp = calloc(1, sizeof(HTTP_STREAM));
+   sp->strm_csock = Socket[0];
+
+   dHashOld = BenchVariant(&VariantList[0], sp);
+   dHashNew = BenchVariant(&VariantList[1], sp);
+   if (dHashOld != dHashNew)
+   {
+      printf("Error: different output\n");
+      return(1);
+   }
+
+   return(0);
+} /* main */
+
+/*** EOF ***/
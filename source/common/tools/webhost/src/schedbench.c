@@ -0,0 +1,364 @@
+/**************************************************************************
+*  Copyright (c) 2026 by Michael Fischer (www.emb4fun.de).
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*  1. Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*
+*  2. Redistributions in binary form must reproduce the above copyright
+*     notice, this list of conditions and the following disclaimer in the
+*     documentation and/or other materials provided with the distribution.
+*
+*  3. Neither the name of the author nor the names of its contributors may
+*     be used to endorse or promote products derived from this software
+*     without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+*  THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+*  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+*  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+*  SUCH DAMAGE.
+*
+***************************************************************************
+*  History:
+*
+*  17.10.2026  mifi  First Version, TCTS scheduler benchmark.
+**************************************************************************/
+/*
+ * Benchmark of the TCTS scheduler, tcts.c runs on the host with the
+ * port tcts_host.c:
+ *
+ *    schedbench [-n Count] [-r ReadyTasks]
+ *
+ * ReadyTasks are ready to run with a lower priority than the measured
+ * tasks, like the web, TLS and service tasks of the board, default 70.
+ * They stay in the ReadyList and never run. Three values are output:
+ *
+ *    queue   GetReadyTask and AddTaskToReadyList of two tasks with the
+ *            same priority, the round robin order is checked too
+ *    wake    a task signals a semaphore, the latency until the task
+ *            with the higher priority which waits on it is running
+ *    switch  two tasks with the same priority call OS_TaskYield
+ *
+ * The latency contains the time to read the clock.
+ */
+#define __SCHEDBENCH_C__
+
+/*=======================================================================*/
+/*  Includes                                                             */
+/*=======================================================================*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <time.h>
+
+/*
+ * tcts.c with the scheduler instead of the pthread replacement of the
+ * host tal.h, which must not be included.
+ */
+#define __TAL_H__
+
+#define TAL_PRINTF      printf
+#define TAL_FAILED()    Failed(__func__, __LINE__)
+
+static void Failed (const char *pFunc, int nLine)
+{
+   fprintf(stderr, "Error: %s, line %d\n", pFunc, nLine);
+   exit(1);
+} /* Failed */
+
+static uint64_t TimeGetNs (void)
+{
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return(((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec);
+} /* TimeGetNs */
+
+static uint32_t tal_CPUStatGetHiResCnt (void)
+{
+   return((uint32_t)TimeGetNs());
+} /* tal_CPUStatGetHiResCnt */
+
+static uint32_t tal_CPUStatGetHiResPeriod (void)
+{
+   return(1);
+} /* tal_CPUStatGetHiResPeriod */
+
+static void tal_CPUSysTickStart (void)
+{
+} /* tal_CPUSysTickStart */
+
+#include "../../../library/tcts/src/tcts.c"
+
+/*=======================================================================*/
+/*  All Structures and Common Constants                                  */
+/*=======================================================================*/
+
+#define HIGH_PRIO       10
+#define LOW_PRIO        20
+#define READY_PRIO      30       /* ...READY_PRIO + READY_MAX - 1 */
+#define READY_MAX       200
+
+#define TASK_STACK      60000
+#define READY_STACK     4096
+
+/*=======================================================================*/
+/*  Definition of all local Data                                         */
+/*=======================================================================*/
+
+static uint32_t  dCount = 1000000;
+static int       nReadyCnt = 70;
+
+static OS_TCB    TCBHigh;
+static OS_TCB    TCBLow;
+static OS_TCB    TCBPeer;
+static OS_TCB   *pTCBReady;
+
+static OS_STACK(HighStack, TASK_STACK);
+static OS_STACK(LowStack,  TASK_STACK);
+static OS_STACK(PeerStack, TASK_STACK);
+static uint8_t  *pReadyStack;
+
+static OS_SEMA   WakeSema;
+static OS_SEMA   StopSema;
+
+static volatile uint64_t qSignalTime;
+static uint32_t         *pWakeTime;    /* ns */
+static uint32_t          dWakeCnt;
+static volatile int      nPeerStop;
+
+/*=======================================================================*/
+/*  Definition of all local Procedures                                   */
+/*=======================================================================*/
+
+/*************************************************************************/
+/*  Compare                                                              */
+/*************************************************************************/
+static int Compare (const void *p1, const void *p2)
+{
+   uint32_t d1 = *(const uint32_t*)p1;
+   uint32_t d2 = *(const uint32_t*)p2;
+
+   return((d1 > d2) - (d1 < d2));
+} /* Compare */
+
+/*************************************************************************/
+/*  QueueBench                                                           */
+/*                                                                       */
+/*  Take the next task from the ReadyList and add it again, before the   */
+/*  scheduler is started. Two tasks with the same priority must be taken */
+/*  in turn.                                                             */
+/*************************************************************************/
+static void QueueBench (void)
+{
+   OS_TCB   Task[2];
+   OS_TCB  *pTask;
+   uint64_t qStart;
+   uint64_t qTime;
+   uint32_t dIndex;
+   int      nIndex;
+
+   memset(Task, 0x00, sizeof(Task));
+   memset(pTCBReady, 0x00, (size_t)nReadyCnt * sizeof(OS_TCB));
+
+   for (nIndex = 0; nIndex < nReadyCnt; nIndex++)
+   {
+      pTCBReady[nIndex].nPrio = READY_PRIO + nIndex;
+      AddTaskToReadyList(&pTCBReady[nIndex]);
+   }
+   Task[0].nPrio = LOW_PRIO;
+   Task[1].nPrio = LOW_PRIO;
+   AddTaskToReadyList(&Task[0]);
+   AddTaskToReadyList(&Task[1]);
+
+   qStart = TimeGetNs();
+   for (dIndex = 0; dIndex < dCount; dIndex++)
+   {
+      pTask = GetReadyTask();
+      if (pTask != &Task[dIndex & 1])
+      {
+         fprintf(stderr, "Error: round robin order broken at %u\n", dIndex);
+         exit(1);
+      }
+      AddTaskToReadyList(pTask);
+   }
+   qTime = TimeGetNs() - qStart;
+
+   printf("queue    %d ready tasks, %" PRIu64 " ns per GetReadyTask and AddTaskToReadyList\n",
+          nReadyCnt + 2, qTime / dCount);
+
+} /* QueueBench */
+
+/*************************************************************************/
+/*  HighTask                                                             */
+/*************************************************************************/
+static void HighTask (void *pParam)
+{
+   (void)pParam;
+
+   while (1)
+   {
+      OS_SemaWait(&WakeSema, OS_WAIT_INFINITE);
+      pWakeTime[dWakeCnt++] = (uint32_t)(TimeGetNs() - qSignalTime);
+   }
+
+} /* HighTask */
+
+/*************************************************************************/
+/*  PeerTask                                                             */
+/*************************************************************************/
+static void PeerTask (void *pParam)
+{
+   (void)pParam;
+
+   while (0 == nPeerStop)
+   {
+      OS_TaskYield();
+   }
+   OS_SemaWait(&StopSema, OS_WAIT_INFINITE);
+
+} /* PeerTask */
+
+/*************************************************************************/
+/*  ReadyTask                                                            */
+/*************************************************************************/
+static void ReadyTask (void *pParam)
+{
+   (void)pParam;
+
+   /* Never reached, the measured tasks have a higher priority */
+   Failed(__func__, __LINE__);
+
+} /* ReadyTask */
+
+/*************************************************************************/
+/*  LowTask                                                              */
+/*************************************************************************/
+static void LowTask (void *pParam)
+{
+   uint64_t qStart;
+   uint64_t qWake;
+   uint64_t qSwitch;
+   uint32_t dIndex;
+
+   (void)pParam;
+
+   /* Wake up the high priority task, two context switches each */
+   qStart = TimeGetNs();
+   for (dIndex = 0; dIndex < dCount; dIndex++)
+   {
+      qSignalTime = TimeGetNs();
+      OS_SemaSignal(&WakeSema);
+   }
+   qWake = TimeGetNs() - qStart;
+
+   /* Yield to the peer task, two context switches each */
+   OS_TaskCreate(&TCBPeer, PeerTask, NULL, LOW_PRIO,
+                 PeerStack, sizeof(PeerStack), "Peer");
+
+   qStart = TimeGetNs();
+   for (dIndex = 0; dIndex < dCount; dIndex++)
+   {
+      OS_TaskYield();
+   }
+   qSwitch = TimeGetNs() - qStart;
+   nPeerStop = 1;
+
+   if (dWakeCnt != dCount)
+   {
+      fprintf(stderr, "Error: %u of %u wake-ups\n", dWakeCnt, dCount);
+      exit(1);
+   }
+   qsort(pWakeTime, dWakeCnt, sizeof(uint32_t), Compare);
+
+   printf("wake     latency ns  p50 %u  p99 %u  p99.9 %u  max %u, %" PRIu64 " ns per cycle\n",
+          pWakeTime[dWakeCnt / 2], pWakeTime[(dWakeCnt * 99ULL) / 100],
+          pWakeTime[(dWakeCnt * 999ULL) / 1000], pWakeTime[dWakeCnt - 1],
+          qWake / dCount);
+   printf("switch   %" PRIu64 " ns per OS_TaskYield\n", qSwitch / (2 * (uint64_t)dCount));
+
+   exit(0);
+
+} /* LowTask */
+
+/*************************************************************************/
+/*  Usage                                                                */
+/*************************************************************************/
+static void Usage (void)
+{
+   fprintf(stderr, "Usage: schedbench [-n Count] [-r ReadyTasks]\n");
+} /* Usage */
+
+/*=======================================================================*/
+/*  All code exported                                                    */
+/*=======================================================================*/
+
+int main (int argc, char **argv)
+{
+   int nOpt;
+   int nIndex;
+
+   while ((nOpt = getopt(argc, argv, "n:r:")) != -1)
+   {
+      switch (nOpt)
+      {
+         case 'n': dCount    = (uint32_t)atol(optarg); break;
+         case 'r': nReadyCnt = atoi(optarg);           break;
+         default:  Usage(); return(1);
+      }
+   }
+   if ((optind != argc) || (0 == dCount) || (nReadyCnt < 0) || (nReadyCnt > READY_MAX))
+   {
+      Usage();
+      return(1);
+   }
+
+   pTCBReady   = calloc((size_t)nReadyCnt + 1, sizeof(OS_TCB));
+   pReadyStack = malloc(((size_t)nReadyCnt + 1) * READY_STACK);
+   pWakeTime   = malloc((size_t)dCount * sizeof(uint32_t));
+   if ((NULL == pTCBReady) || (NULL == pReadyStack) || (NULL == pWakeTime))
+   {
+      fprintf(stderr, "Error: out of memory\n");
+      return(1);
+   }
+
+   QueueBench();
+
+   /* OS_Init clears the ReadyList of QueueBench */
+   OS_Init();
+
+   OS_SemaCreate(&WakeSema, 0, 1);
+   OS_SemaCreate(&StopSema, 0, 1);
+
+   OS_TaskCreate(&TCBHigh, HighTask, NULL, HIGH_PRIO,
+                 HighStack, sizeof(HighStack), "High");
+   OS_TaskCreate(&TCBLow, LowTask, NULL, LOW_PRIO,
+                 LowStack, sizeof(LowStack), "Low");
+
+   for (nIndex = 0; nIndex < nReadyCnt; nIndex++)
+   {
+      OS_TaskCreate(&pTCBReady[nIndex], ReadyTask, NULL, READY_PRIO + nIndex,
+                    &pReadyStack[nIndex * READY_STACK], READY_STACK, "Ready");
+   }
+
+   OS_Start();
+
+   return(1);
+} /* main */
+
+/*** EOF ***/
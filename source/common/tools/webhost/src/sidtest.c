@@ -0,0 +1,466 @@
+/**************************************************************************
+*  Copyright (c) 2026 by Michael Fischer (www.emb4fun.de).
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*  1. Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*
+*  2. Redistributions in binary form must reproduce the above copyright
+*     notice, this list of conditions and the following disclaimer in the
+*     documentation and/or other materials provided with the distribution.
+*
+*  3. Neither the name of the author nor the names of its contributors may
+*     be used to endorse or promote products derived from this software
+*     without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+*  THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+*  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+*  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+*  SUCH DAMAGE.
+*
+***************************************************************************
+*  History:
+*
+*  17.10.2026  mifi  First Version, session ID test.
+*  17.10.2026  mifi  Added the idle timeout test.
+**************************************************************************/
+/*
+ * Test of the session ID list of web_sid_non_tls.c:
+ *
+ *  - The SIDs are unique, and every hex digit is equally distributed
+ *    over all positions, because the SID is made of random data.
+ *  - A session is found by its SID and the IP address of the client.
+ *  - A full list evicts the sessions without login first, the least
+ *    recently used one first. Only if all sessions are logged in, the
+ *    least recently used login is evicted.
+ *  - A session expires after SID_TIMEOUT_SEC without access, and the
+ *    expired sessions are released before a session is evicted. The
+ *    time is moved forward by host_TimeAdvance.
+ *
+ * The Makefile builds the test with a list in the thousands, to cover
+ * the hash and LRU list with more than the default 8 entries.
+ */
+#define __SIDTEST_C__
+
+/*=======================================================================*/
+/*  Includes                                                             */
+/*=======================================================================*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "tal.h"
+#include "ipweb.h"
+#include "web_sid.h"
+#include "mbedtls/sha256.h"
+
+/*=======================================================================*/
+/*  All Structures and Common Constants                                  */
+/*=======================================================================*/
+
+#define SID_LIST_CNT    _IP_WEB_SID_LIST_CNT
+#define SID_TIMEOUT_SEC _IP_WEB_SID_TIMEOUT_SEC
+#define SID_LEN         32
+
+/* Number of SIDs for the random test, at least one for each entry */
+#if (SID_LIST_CNT > 4096)
+#define SID_CNT         SID_LIST_CNT
+#else
+#define SID_CNT         4096
+#endif
+
+#define CLIENT_IP       0x0100A8C0     /* 192.168.0.1 in network order */
+#define OTHER_IP        0x0200A8C0     /* 192.168.0.2 in network order */
+
+/* sha256("tiny:adminadmin"), the password hash of the default admin */
+#define ADMIN_HASH      "91dedb441a62499e0a09fb36827d10b1154944b5e4bd76dc15ad0e28e5e8aafd"
+
+/*=======================================================================*/
+/*  Definition of all local Data                                         */
+/*=======================================================================*/
+
+static HTTP_STREAM   Stream;
+static HTTPD_SESSION Session;
+static int           nFailed;
+
+static char          SIDBuffer[SID_CNT][SID_LEN + 1];
+
+/*=======================================================================*/
+/*  Definition of all local Procedures                                   */
+/*=======================================================================*/
+
+/*************************************************************************/
+/*  Check                                                                */
+/*************************************************************************/
+static void Check (int nOk, const char *pText)
+{
+   if (!nOk)
+   {
+      printf("FAIL %s\n", pText);
+      nFailed++;
+   }
+} /* Check */
+
+/*************************************************************************/
+/*  CreateSession                                                        */
+/*                                                                       */
+/*  Return the SID of a new session in pSID.                             */
+/*************************************************************************/
+static int CreateSession (char *pSID)
+{
+   char *pCookie;
+   char *pSessionID;
+   
+   pCookie = WebSidCreateCookie(&Session);
+   if (NULL == pCookie)
+   {
+      return(-1);
+   }
+   pSessionID = WebSidParseCookie(pCookie);
+   free(pCookie);
+   if (NULL == pSessionID)
+   {
+      return(-1);
+   }
+   memcpy(pSID, pSessionID, SID_LEN + 1);
+   free(pSessionID);
+   
+   return(0);
+} /* CreateSession */
+
+/*************************************************************************/
+/*  Find                                                                 */
+/*                                                                       */
+/*  Return: -1 == not found / nSIDEntry                                  */
+/*************************************************************************/
+static int Find (char *pSID)
+{
+   return(WebSidCheck(&Session, pSID, WEB_SID_HTTP));
+} /* Find */
+
+/*************************************************************************/
+/*  Login                                                                */
+/*                                                                       */
+/*  Login as admin like the web page, the password is:                   */
+/*                                                                       */
+/*     sha256(NONCE + sha256(pass))                                      */
+/*                                                                       */
+/*  Return: 1 == logged in                                               */
+/*************************************************************************/
+static int Login (char *pSID)
+{
+   mbedtls_sha256_context HashCtx;
+   uint8_t                Hash[32];
+   char                   Pass[65];
+   char                   Nonce[WEB_SID_NONCE_SIZE];
+   int                    nIndex;
+   
+   Session.s_req.req_sid = pSID;
+   if (WebSidCreateNonce(&Session, Nonce, sizeof(Nonce)) != 0)
+   {
+      return(0);
+   }
+   
+   mbedtls_sha256_init(&HashCtx);
+   mbedtls_sha256_starts_ret(&HashCtx, 0);
+   mbedtls_sha256_update_ret(&HashCtx, (uint8_t*)Nonce, strlen(Nonce));
+   mbedtls_sha256_update_ret(&HashCtx, (uint8_t*)ADMIN_HASH, strlen(ADMIN_HASH));
+   mbedtls_sha256_finish_ret(&HashCtx, Hash);
+   mbedtls_sha256_free(&HashCtx);
+   
+   for (nIndex = 0; nIndex < 32; nIndex++)
+   {
+      sprintf(&Pass[nIndex * 2], "%02x", Hash[nIndex]);
+   }
+   
+   return(WebSidCheckUserPass(&Session, "admin", Pass));
+} /* Login */
+
+/*************************************************************************/
+/*  Compare                                                              */
+/*************************************************************************/
+static int Compare (const void *pA, const void *pB)
+{
+   return(strcmp((const char*)pA, (const char*)pB));
+} /* Compare */
+
+/*************************************************************************/
+/*  TestRandom                                                           */
+/*                                                                       */
+/*  All SIDs must be unique. Each hex digit is expected SID_CNT/16 times */
+/*  at each position, with random data far away from the limits.        */
+/*************************************************************************/
+static void TestRandom (void)
+{
+   static int DigitCnt[SID_LEN][16];
+   int        nIndex;
+   int        nPos;
+   int        nDigit;
+   int        nMin = SID_CNT;
+   int        nMax = 0;
+   int        nDuplicates = 0;
+   
+   for (nIndex = 0; nIndex < SID_CNT; nIndex++)
+   {
+      if (CreateSession(SIDBuffer[nIndex]) != 0)
+      {
+         Check(0, "random, create session");
+         return;
+      }
+      for (nPos = 0; nPos < SID_LEN; nPos++)
+      {
+         nDigit = SIDBuffer[nIndex][nPos];
+         nDigit = (nDigit <= '9') ? (nDigit - '0') : (nDigit - 'A' + 10);
+         if ((nDigit < 0) || (nDigit > 15))
+         {
+            Check(0, "random, SID is not hex");
+            return;
+         }
+         DigitCnt[nPos][nDigit]++;
+      }
+   }
+   
+   qsort(SIDBuffer, SID_CNT, SID_LEN + 1, Compare);
+   for (nIndex = 1; nIndex < SID_CNT; nIndex++)
+   {
+      if (0 == strcmp(SIDBuffer[nIndex - 1], SIDBuffer[nIndex]))
+      {
+         nDuplicates++;
+      }
+   }
+   
+   for (nPos = 0; nPos < SID_LEN; nPos++)
+   {
+      for (nDigit = 0; nDigit < 16; nDigit++)
+      {
+         if (DigitCnt[nPos][nDigit] < nMin) nMin = DigitCnt[nPos][nDigit];
+         if (DigitCnt[nPos][nDigit] > nMax) nMax = DigitCnt[nPos][nDigit];
+      }
+   }
+   
+   printf("random:   %d SIDs, %d duplicates, digit count %d..%d (expected %d)\n",
+          SID_CNT, nDuplicates, nMin, nMax, SID_CNT / 16);
+   Check(0 == nDuplicates, "random, duplicate SID");
+   Check((nMin > ((SID_CNT / 16) / 2)) && (nMax < ((SID_CNT / 16) * 3 / 2)), "random, digit distribution");
+} /* TestRandom */
+
+/*************************************************************************/
+/*  TestLookup                                                           */
+/*************************************************************************/
+static void TestLookup (void)
+{
+   static char Unknown[SID_LEN + 1];
+   int         nIndex;
+   int         nFound = 0;
+   int         nOther = 0;
+   
+   WebSidInit();
+   for (nIndex = 0; nIndex < SID_LIST_CNT; nIndex++)
+   {
+      CreateSession(SIDBuffer[nIndex]);
+   }
+   
+   for (nIndex = 0; nIndex < SID_LIST_CNT; nIndex++)
+   {
+      if (Find(SIDBuffer[nIndex]) != -1)
+      {
+         nFound++;
+      }
+   }
+   
+   /* The session is bound to the IP address of the client */
+   Stream.strm_caddr.sin_addr.s_addr = OTHER_IP;
+   for (nIndex = 0; nIndex < SID_LIST_CNT; nIndex++)
+   {
+      if (Find(SIDBuffer[nIndex]) != -1)
+      {
+         nOther++;
+      }
+   }
+   Stream.strm_caddr.sin_addr.s_addr = CLIENT_IP;
+   
+   memset(Unknown, '0', SID_LEN);
+   
+   printf("lookup:   %d/%d found, %d found from other IP\n", nFound, SID_LIST_CNT, nOther);
+   Check(SID_LIST_CNT == nFound, "lookup, session not found");
+   Check((0 == nOther) || (0 == _IP_WEB_SID_BIND_IP), "lookup, session found from other IP");
+   Check(-1 == Find(Unknown), "lookup, unknown SID found");
+   Check(-1 == Find(NULL), "lookup, no SID found");
+} /* TestLookup */
+
+/*************************************************************************/
+/*  TestEviction                                                         */
+/*************************************************************************/
+static void TestEviction (void)
+{
+   static char New[SID_LEN + 1];
+   int         nIndex;
+   int         nLogins = SID_LIST_CNT / 2;
+   int         nGranted = 0;
+   int         nGuests = 0;
+   int         nLost;
+   
+   WebSidInit();
+   for (nIndex = 0; nIndex < SID_LIST_CNT; nIndex++)
+   {
+      CreateSession(SIDBuffer[nIndex]);
+   }
+   
+   /* Login the first half, then use the others. So the logins are the least recently used ones. */
+   for (nIndex = 0; nIndex < nLogins; nIndex++)
+   {
+      Check(1 == Login(SIDBuffer[nIndex]), "eviction, login");
+   }
+   for (nIndex = nLogins; nIndex < SID_LIST_CNT; nIndex++)
+   {
+      Find(SIDBuffer[nIndex]);
+   }
+   
+   /* A flood of new clients */
+   for (nIndex = 0; nIndex < (SID_LIST_CNT * 4); nIndex++)
+   {
+      CreateSession(New);
+   }
+   
+   for (nIndex = 0; nIndex < SID_LIST_CNT; nIndex++)
+   {
+      if (nIndex < nLogins)
+      {
+         nGranted += WebSidCheckAccessGranted(&Session, SIDBuffer[nIndex], WEB_SID_HTTP);
+      }
+      else if (Find(SIDBuffer[nIndex]) != -1)
+      {
+         nGuests++;
+      }
+   }
+   
+   printf("eviction: %d/%d logins kept, %d/%d guests kept\n",
+          nGranted, nLogins, nGuests, SID_LIST_CNT - nLogins);
+   Check(nLogins == nGranted, "eviction, login evicted");
+   Check(0 == nGuests, "eviction, guest kept");
+   
+   /* All sessions are logged in, the least recently used one is evicted */
+   WebSidInit();
+   for (nIndex = 0; nIndex < SID_LIST_CNT; nIndex++)
+   {
+      CreateSession(SIDBuffer[nIndex]);
+      Login(SIDBuffer[nIndex]);
+   }
+   CreateSession(New);
+   
+   nLost = -1;
+   nGranted = 0;
+   for (nIndex = 0; nIndex < SID_LIST_CNT; nIndex++)
+   {
+      if (WebSidCheckAccessGranted(&Session, SIDBuffer[nIndex], WEB_SID_HTTP))
+      {
+         nGranted++;
+      }
+      else
+      {
+         nLost = nIndex;
+      }
+   }
+   
+   printf("eviction: all logged in, %d/%d kept, session %d evicted\n",
+          nGranted, SID_LIST_CNT, nLost);
+   Check(((SID_LIST_CNT - 1) == nGranted) && (0 == nLost), "eviction, not the least recently used login");
+} /* TestEviction */
+
+/*************************************************************************/
+/*  TestExpiry                                                           */
+/*************************************************************************/
+static void TestExpiry (void)
+{
+   static char User[SID_LEN + 1];
+   static char Guest[SID_LEN + 1];
+   int         nIndex;
+   int         nKept = 0;
+   
+   WebSidInit();
+   CreateSession(User);
+   Check(1 == Login(User), "expiry, login");
+   CreateSession(Guest);
+   
+   /* Just before the timeout, the access retriggers the login only */
+   host_TimeAdvance((SID_TIMEOUT_SEC - 1) * 1000);
+   Check(Find(User) != -1, "expiry, session expired too early");
+   Check(1 == WebSidCheckAccessGranted(&Session, User, WEB_SID_HTTP), "expiry, login expired too early");
+   
+   /* The guest is idle longer than the timeout now, the login is not */
+   host_TimeAdvance((SID_TIMEOUT_SEC - 1) * 1000);
+   Check(-1 == Find(Guest), "expiry, idle guest not expired");
+   Check(Find(User) != -1, "expiry, used session expired");
+   
+   host_TimeAdvance(SID_TIMEOUT_SEC * 1000);
+   Check(0 == WebSidCheckAccessGranted(&Session, User, WEB_SID_HTTP), "expiry, idle login still granted");
+   Check(-1 == Find(User), "expiry, idle login not expired");
+   
+   /*
+    * A full list of expired logins. Without the release of the idle
+    * sessions, the new guests would evict each other, see SIDVictim.
+    */
+   WebSidInit();
+   for (nIndex = 0; nIndex < SID_LIST_CNT; nIndex++)
+   {
+      CreateSession(SIDBuffer[nIndex]);
+      Login(SIDBuffer[nIndex]);
+   }
+   host_TimeAdvance(SID_TIMEOUT_SEC * 1000);
+   
+   for (nIndex = 0; nIndex < SID_LIST_CNT; nIndex++)
+   {
+      CreateSession(SIDBuffer[nIndex]);
+   }
+   for (nIndex = 0; nIndex < SID_LIST_CNT; nIndex++)
+   {
+      if (Find(SIDBuffer[nIndex]) != -1)
+      {
+         nKept++;
+      }
+   }
+   
+   printf("expiry:   timeout %d s, %d/%d new sessions kept after the logins expired\n",
+          SID_TIMEOUT_SEC, nKept, SID_LIST_CNT);
+   Check(SID_LIST_CNT == nKept, "expiry, idle sessions not released");
+} /* TestExpiry */
+
+/*=======================================================================*/
+/*  All code exported                                                    */
+/*=======================================================================*/
+
+int main (void)
+{
+   Stream.strm_caddr.sin_addr.s_addr = CLIENT_IP;
+   Session.s_stream = &Stream;
+   
+   WebSidInit();
+   
+   TestRandom();
+   TestLookup();
+   TestEviction();
+   TestExpiry();
+   
+   if (nFailed != 0)
+   {
+      printf("%d failures\n", nFailed);
+      return(2);
+   }
+   
+   return(0);
+} /* main */
+
+/*** EOF ***/
@@ -0,0 +1,434 @@
+/**************************************************************************
+*  Copyright (c) 2026 by Michael Fischer (www.emb4fun.de).
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*  1. Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*
+*  2. Redistributions in binary form must reproduce the above copyright
+*     notice, this list of conditions and the following disclaimer in the
+*     documentation and/or other materials provided with the distribution.
+*
+*  3. Neither the name of the author nor the names of its contributors may
+*     be used to endorse or promote products derived from this software
+*     without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+*  THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+*  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+*  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+*  SUCH DAMAGE.
+*
+***************************************************************************
+*  History:
+*
+*  17.10.2026  mifi  First Version, StreamReadUntilChars benchmark.
+**************************************************************************/
+/*
+ * Benchmark of StreamReadUntilChars against the previous version, which
+ * tested every byte with strchr(). The payloads are read like uhttpd.c
+ * does it from the receive buffer of the stream:
+ *
+ *    streambench [-n Count] [File...]
+ *
+ * A header is read line by line with the delimiters of the request
+ * line, header names and values, a form with "&" like the arguments of
+ * a POST. The files are headers, e.g. the corpus of test/header, the
+ * built-in payloads are a browser request and three forms.
+ *
+ * Both versions must return the same lengths and strings, otherwise
+ * the benchmark fails. The time per payload is output for both.
+ */
+#define __STREAMBENCH_C__
+
+/*=======================================================================*/
+/*  Includes                                                             */
+/*=======================================================================*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "pro/uhttp/uhttpd.h"
+#include "pro/uhttp/streamio.h"
+
+/*=======================================================================*/
+/*  All Structures and Common Constants                                  */
+/*=======================================================================*/
+
+#define LINE_SIZE       512
+#define PAYLOAD_SIZE    1460     /* One _recv of StreamReadUntilChars */
+#define FORM_FIELDS     48
+
+typedef int (*read_until_t) (HTTP_STREAM *sp, const char *delim, const char *ignore, char *buf, int siz);
+
+typedef struct _payload_
+{
+   const char *pName;
+   int         nForm;
+   char       *pData;
+   int         nSize;
+} payload_t;
+
+/*=======================================================================*/
+/*  Definition of all local Data                                         */
+/*=======================================================================*/
+
+static const char Browser[] =
+   "GET /cgi-bin/stat_json.cgi?reset=0 HTTP/1.1\r\n"
+   "Host: 192.168.1.200\r\n"
+   "Connection: keep-alive\r\n"
+   "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/126.0.0.0 Safari/537.36\r\n"
+   "Accept: application/json, text/javascript, */*; q=0.01\r\n"
+   "X-Requested-With: XMLHttpRequest\r\n"
+   "Referer: http://192.168.1.200/system.htm\r\n"
+   "Accept-Encoding: gzip, deflate\r\n"
+   "Accept-Language: de-DE,de;q=0.9,en-US;q=0.8,en;q=0.7\r\n"
+   "Cookie: SID=6f1e0c2a9b7d4e3f8a5c1d2e3f4a5b6c\r\n"
+   "\r\n";
+
+static const char Login[] =
+   "username=admin&password=Secret%2B123&nonce=8f3a9c2e1b7d4e6f";
+
+static const char Network[] =
+   "dhcp=0&ip=192.168.1.200&mask=255.255.255.0&gw=192.168.1.1"
+   "&dns1=192.168.1.1&dns2=8.8.8.8&name=EA1062&ntp=pool.ntp.org"
+   "&tz=CET-1CEST%2CM3.5.0%2CM10.5.0%2F3&http=80&https=443&redirect=1";
+
+static payload_t PayloadList[64];
+static int       nPayloadCnt;
+static uint32_t  dCount = 100000;
+
+/*=======================================================================*/
+/*  Definition of all local Procedures                                   */
+/*=======================================================================*/
+
+/*************************************************************************/
+/*  OldReadUntilChars                                                    */
+/*                                                                       */
+/*  StreamReadUntilChars before the character sets, only the refill      */
+/*  calls recv() directly instead of _recv().                            */
+/*************************************************************************/
+static int OldReadUntilChars (HTTP_STREAM *sp, const char *delim, const char *ignore, char *buf, int siz)
+{
+   int  rc = 0;
+   int  skip = 0;
+   char ch;
+
+   /* Do not read more characters than requested. */
+   while (rc < siz)
+   {
+      /* Check the current stream buffer. */
+      if (sp->strm_ipos == sp->strm_ilen)
+      {
+         /* No more buffered data, re-fill the buffer. */
+         int got = (int)recv(sp->strm_csock, sp->strm_ibuf, 1460, 0);
+         if (got <= 0)
+         {
+            /* Broken connection or timeout. */
+            if (got < 0)
+            {
+               rc = -1;
+               skip = 0;
+            }
+            break;
+         }
+
+         sp->strm_ilen = got;
+         sp->strm_ipos = 0;
+      }
+
+      ch = sp->strm_ibuf[sp->strm_ipos];
+      sp->strm_ipos++;
+
+      if (rc == 0 && ch == ' ')
+      {
+         /* Skip leading spaces. */
+         skip++;
+      }
+      else
+      {
+         rc++;
+
+         if (delim && strchr(delim, ch))
+         {
+            /* Delimiter found. */
+            break;
+         }
+
+         if (buf && (ignore == NULL || strchr(ignore, ch) == NULL))
+         {
+            /* Add valid character to application buffer. */
+            *buf++ = ch;
+         }
+      }
+   }
+
+   if (buf)
+   {
+      *buf = '\0';
+   }
+
+   return(rc + skip);
+} /* OldReadUntilChars */
+
+/*************************************************************************/
+/*  TimeGetNs                                                            */
+/*************************************************************************/
+static uint64_t TimeGetNs (void)
+{
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return(((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec);
+} /* TimeGetNs */
+
+/*************************************************************************/
+/*  Hash                                                                 */
+/*                                                                       */
+/*  FNV-1a of the length and the string of each read.                    */
+/*************************************************************************/
+static uint32_t Hash (uint32_t dHash, int nGot, const char *pBuf)
+{
+   dHash = (dHash ^ (uint32_t)nGot) * 16777619;
+   while (*pBuf != 0)
+   {
+      dHash = (dHash ^ (uint8_t)*pBuf++) * 16777619;
+   }
+
+   return(dHash);
+} /* Hash */
+
+/*************************************************************************/
+/*  ReadPayload                                                          */
+/*                                                                       */
+/*  Read the buffered payload with the delimiters of uhttpd.c. Return    */
+/*  the hash of all reads.                                               */
+/*************************************************************************/
+static uint32_t ReadPayload (read_until_t Read, HTTP_STREAM *sp, const payload_t *pPayload)
+{
+   uint32_t dHash = 2166136261;
+   char     Line[LINE_SIZE];
+   int      nGot;
+
+   sp->strm_ipos = 0;
+   sp->strm_ilen = pPayload->nSize;
+
+   if (pPayload->nForm)
+   {
+      while (sp->strm_ipos < sp->strm_ilen)
+      {
+         nGot  = Read(sp, "&", NULL, Line, sizeof(Line) - 1);
+         dHash = Hash(dHash, nGot, Line);
+      }
+   }
+   else
+   {
+      /* Request line */
+      nGot  = Read(sp, "\n", "\r", Line, sizeof(Line) - 1);
+      dHash = Hash(dHash, nGot, Line);
+
+      /* Header name and value */
+      while (sp->strm_ipos < sp->strm_ilen)
+      {
+         nGot  = Read(sp, ":\n", "\r", Line, sizeof(Line) - 1);
+         dHash = Hash(dHash, nGot, Line);
+
+         if ((nGot > 0) && (':' == sp->strm_ibuf[sp->strm_ipos - 1]) && (sp->strm_ipos < sp->strm_ilen))
+         {
+            nGot  = Read(sp, "\n", "\r", Line, sizeof(Line) - 1);
+            dHash = Hash(dHash, nGot, Line);
+         }
+      }
+   }
+
+   return(dHash);
+} /* ReadPayload */
+
+/*************************************************************************/
+/*  BenchPayload                                                         */
+/*                                                                       */
+/*  Return 0 if both versions read the same, otherwise -1.               */
+/*************************************************************************/
+static int BenchPayload (HTTP_STREAM *sp, const payload_t *pPayload, uint64_t *pOld, uint64_t *pNew)
+{
+   uint64_t qStart;
+   uint64_t qOld;
+   uint64_t qNew;
+   uint32_t dIndex;
+   uint32_t dHash;
+   uint32_t dCheck;
+
+   memcpy(sp->strm_ibuf, pPayload->pData, (size_t)pPayload->nSize);
+
+   dHash = ReadPayload(OldReadUntilChars, sp, pPayload);
+   if (ReadPayload(StreamReadUntilChars, sp, pPayload) != dHash)
+   {
+      printf("%-16s different result\n", pPayload->pName);
+      return(-1);
+   }
+
+   /* The hash of the loops is checked, they can not be optimized away */
+   dCheck = dHash;
+   qStart = TimeGetNs();
+   for (dIndex = 0; dIndex < dCount; dIndex++)
+   {
+      dHash += ReadPayload(OldReadUntilChars, sp, pPayload);
+   }
+   qOld = TimeGetNs() - qStart;
+
+   qStart = TimeGetNs();
+   for (dIndex = 0; dIndex < dCount; dIndex++)
+   {
+      dHash -= ReadPayload(StreamReadUntilChars, sp, pPayload);
+   }
+   qNew = TimeGetNs() - qStart;
+
+   printf("%-16s %5d bytes  old %6u ns  new %6u ns  %u.%02ux\n",
+          pPayload->pName, pPayload->nSize,
+          (uint32_t)(qOld / dCount), (uint32_t)(qNew / dCount),
+          (uint32_t)(qOld / qNew), (uint32_t)(((qOld * 100) / qNew) % 100));
+
+   *pOld += qOld;
+   *pNew += qNew;
+
+   return((dHash != dCheck) ? -1 : 0);
+} /* BenchPayload */
+
+/*************************************************************************/
+/*  AddPayload                                                           */
+/*************************************************************************/
+static void AddPayload (const char *pName, int nForm, const char *pData, int nSize)
+{
+   payload_t *pPayload;
+
+   if ((nPayloadCnt < (int)(sizeof(PayloadList) / sizeof(PayloadList[0]))) &&
+       (nSize > 0) && (nSize <= PAYLOAD_SIZE))
+   {
+      pPayload = &PayloadList[nPayloadCnt++];
+      pPayload->pName = pName;
+      pPayload->nForm = nForm;
+      pPayload->pData = malloc((size_t)nSize);
+      pPayload->nSize = nSize;
+      memcpy(pPayload->pData, pData, (size_t)nSize);
+   }
+   else
+   {
+      fprintf(stderr, "Skip %s\n", pName);
+   }
+
+} /* AddPayload */
+
+/*************************************************************************/
+/*  AddFile                                                              */
+/*************************************************************************/
+static int AddFile (const char *pName)
+{
+   FILE *hFile;
+   char  Data[PAYLOAD_SIZE + 1];
+   int   nSize;
+
+   hFile = fopen(pName, "rb");
+   if (NULL == hFile)
+   {
+      return(-1);
+   }
+   nSize = (int)fread(Data, 1, sizeof(Data), hFile);
+   fclose(hFile);
+
+   AddPayload((strrchr(pName, '/') != NULL) ? strrchr(pName, '/') + 1 : pName, 0, Data, nSize);
+
+   return(0);
+} /* AddFile */
+
+/*************************************************************************/
+/*  Usage                                                                */
+/*************************************************************************/
+static void Usage (void)
+{
+   fprintf(stderr, "Usage: streambench [-n Count] [File...]\n");
+} /* Usage */
+
+/*=======================================================================*/
+/*  All code exported                                                    */
+/*=======================================================================*/
+
+int main (int argc, char **argv)
+{
+   HTTP_STREAM *sp;
+   char         Form[PAYLOAD_SIZE];
+   int          nSize = 0;
+   int          nOpt;
+   int          nIndex;
+   int          rc = 0;
+   uint64_t     qOld = 0;
+   uint64_t     qNew = 0;
+
+   while ((nOpt = getopt(argc, argv, "n:")) != -1)
+   {
+      switch (nOpt)
+      {
+         case 'n': dCount = (uint32_t)atol(optarg); break;
+         default:  Usage(); return(1);
+      }
+   }
+   if (0 == dCount)
+   {
+      Usage();
+      return(1);
+   }
+
+   for (nIndex = optind; nIndex < argc; nIndex++)
+   {
+      if (AddFile(argv[nIndex]) != 0)
+      {
+         fprintf(stderr, "Can not read %s\n", argv[nIndex]);
+         return(1);
+      }
+   }
+
+   AddPayload("browser", 0, Browser, (int)strlen(Browser));
+   AddPayload("form login", 1, Login, (int)strlen(Login));
+   AddPayload("form network", 1, Network, (int)strlen(Network));
+
+   /* A large form like a configuration page */
+   for (nIndex = 0; nIndex < FORM_FIELDS; nIndex++)
+   {
+      nSize += snprintf(&Form[nSize], sizeof(Form) - (size_t)nSize, "%sfield%02d=value+%d%%2C+%d",
+                        (nIndex != 0) ? "&" : "", nIndex, nIndex * 17, nIndex * 31);
+   }
+   AddPayload("form config", 1, Form, nSize);
+
+   /* No refill, a read of an empty buffer fails */
+   sp = calloc(1, sizeof(HTTP_STREAM));
+   sp->strm_csock = -1;
+
+   for (nIndex = 0; nIndex < nPayloadCnt; nIndex++)
+   {
+      rc |= BenchPayload(sp, &PayloadList[nIndex], &qOld, &qNew);
+   }
+
+   if (qNew != 0)
+   {
+      printf("%-16s              old %6u ms  new %6u ms  %u.%02ux\n", "total",
+             (uint32_t)(qOld / 1000000), (uint32_t)(qNew / 1000000),
+             (uint32_t)(qOld / qNew), (uint32_t)(((qOld * 100) / qNew) % 100));
+   }
+
+   return((rc != 0) ? 1 : 0);
+} /* main */
+
+/*** EOF ***/
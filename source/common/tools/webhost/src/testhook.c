@@ -0,0 +1,87 @@
+/**************************************************************************
+*  Copyright (c) 2026 by Michael Fischer (www.emb4fun.de).
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*  1. Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*
+*  2. Redistributions in binary form must reproduce the above copyright
+*     notice, this list of conditions and the following disclaimer in the
+*     documentation and/or other materials provided with the distribution.
+*
+*  3. Neither the name of the author nor the names of its contributors may
+*     be used to endorse or promote products derived from this software
+*     without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+*  THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+*  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+*  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+*  SUCH DAMAGE.
+*
+***************************************************************************
+*  History:
+*
+*  17.10.2026  mifi  First Version, application hooks for the tests.
+**************************************************************************/
+/*
+ * The server library needs some hooks of the application, see main.c.
+ * The tests do not send responses, here they do nothing.
+ */
+#define __TESTHOOK_C__
+
+/*=======================================================================*/
+/*  Includes                                                             */
+/*=======================================================================*/
+#include <stddef.h>
+
+#include "pro/uhttp/uhttpd.h"
+#include "pro/uhttp/modules/mod_ssi.h"
+
+/*=======================================================================*/
+/*  All code exported                                                    */
+/*=======================================================================*/
+
+/*************************************************************************/
+/*  web_SendCGIHeader                                                    */
+/*************************************************************************/
+void web_SendCGIHeader (HTTPD_SESSION *hs)
+{
+   (void)hs;
+} /* web_SendCGIHeader */
+
+/*************************************************************************/
+/*  HttpSsiLookupExt                                                     */
+/*************************************************************************/
+HTTP_SSI_EXTHANDLER HttpSsiLookupExt (const char *name, int len)
+{
+   (void)name;
+   (void)len;
+   
+   return(NULL);
+} /* HttpSsiLookupExt */
+
+/*************************************************************************/
+/*  HttpSsiParseExt                                                      */
+/*************************************************************************/
+int HttpSsiParseExt (HTTPD_SESSION *hs, const char *buf, int len)
+{
+   (void)hs;
+   (void)buf;
+   (void)len;
+   
+   return(0);
+} /* HttpSsiParseExt */
+
+/*** EOF ***/
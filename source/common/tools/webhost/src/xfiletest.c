@@ -0,0 +1,325 @@
+/**************************************************************************
+*  Copyright (c) 2026 by Michael Fischer (www.emb4fun.de).
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*  1. Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*
+*  2. Redistributions in binary form must reproduce the above copyright
+*     notice, this list of conditions and the following disclaimer in the
+*     documentation and/or other materials provided with the distribution.
+*
+*  3. Neither the name of the author nor the names of its contributors may
+*     be used to endorse or promote products derived from this software
+*     without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+*  THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+*  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+*  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+*  SUCH DAMAGE.
+*
+***************************************************************************
+*  History:
+*
+*  17.10.2026  mifi  First Version, XFILE image test.
+**************************************************************************/
+/*
+ * Round trip test of tools/xfile and fs_xfile.c:
+ *
+ *    xfiletest Folder V4Image V3Image
+ *
+ * Both images must be created by xfile from Folder, the version 3
+ * image with -3. Every file of the image is looked up and compared
+ * with the file of the folder, and the image must contain all files
+ * of the folder.
+ *
+ *  - The version 4 image has a hash table, every lookup compares one
+ *    name only.
+ *  - The version 3 image has none, the lookup falls back to the linear
+ *    scan and compares the names of all entries before it.
+ *  - Open files take the FCB from the pool, only the files above the
+ *    pool size use the heap.
+ *
+ * fs_xfile.c is included here, to count the name compares of FindEntry.
+ */
+#define __XFILETEST_C__
+
+/*=======================================================================*/
+/*  Includes                                                             */
+/*=======================================================================*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <dirent.h>
+
+static int CountStrcmp (const char *s1, const char *s2);
+
+/* The name compares of fs_xfile.c are counted */
+#define strcmp CountStrcmp
+#include "../../../library/fsapi/src/fs_xfile.c"
+#undef strcmp
+
+/*=======================================================================*/
+/*  All Structures and Common Constants                                  */
+/*=======================================================================*/
+
+#define PATH_SIZE       1024
+
+/*=======================================================================*/
+/*  Definition of all local Data                                         */
+/*=======================================================================*/
+
+static const char *pFolder;
+static int         nFolderCnt;
+static uint32_t    dStrcmpCnt;
+static int         nFailed;
+
+/*=======================================================================*/
+/*  Definition of all local Procedures                                   */
+/*=======================================================================*/
+
+/*************************************************************************/
+/*  CountStrcmp                                                          */
+/*************************************************************************/
+static int CountStrcmp (const char *s1, const char *s2)
+{
+   dStrcmpCnt++;
+   return(strcmp(s1, s2));
+} /* CountStrcmp */
+
+/*************************************************************************/
+/*  Check                                                                */
+/*************************************************************************/
+static void Check (int nOk, const char *pText, const char *pName)
+{
+   if (!nOk)
+   {
+      printf("FAIL %s %s\n", pText, pName);
+      nFailed++;
+   }
+} /* Check */
+
+/*************************************************************************/
+/*  CountFiles                                                           */
+/*                                                                       */
+/*  Return the number of files of the folder and its subfolders.         */
+/*************************************************************************/
+static int CountFiles (const char *pPath)
+{
+   DIR           *pDirectory;
+   struct dirent *pEntry;
+   char           Path[PATH_SIZE];
+   int            nCount = 0;
+
+   pDirectory = opendir(pPath);
+   if (NULL == pDirectory)
+   {
+      return(-1);
+   }
+
+   while ((pEntry = readdir(pDirectory)) != NULL)
+   {
+      if (DT_REG == pEntry->d_type)
+      {
+         nCount++;
+      }
+      else if ((DT_DIR == pEntry->d_type) && (strcmp(pEntry->d_name, ".") != 0) &&
+               (strcmp(pEntry->d_name, "..") != 0))
+      {
+         snprintf(Path, sizeof(Path), "%s/%s", pPath, pEntry->d_name);
+         nCount += CountFiles(Path);
+      }
+   }
+   closedir(pDirectory);
+
+   return(nCount);
+} /* CountFiles */
+
+/*************************************************************************/
+/*  ReadFile                                                             */
+/*                                                                       */
+/*  Return the content of the file in a new buffer.                      */
+/*************************************************************************/
+static uint8_t *ReadFile (const char *pName, uint32_t *pSize)
+{
+   FILE    *fp;
+   long     lSize;
+   uint8_t *pData;
+
+   fp = fopen(pName, "rb");
+   if (NULL == fp)
+   {
+      return(NULL);
+   }
+
+   fseek(fp, 0, SEEK_END);
+   lSize = ftell(fp);
+   fseek(fp, 0, SEEK_SET);
+
+   pData = malloc((size_t)lSize + 1);
+   if ((pData != NULL) && (fread(pData, 1, (size_t)lSize, fp) != (size_t)lSize))
+   {
+      free(pData);
+      pData = NULL;
+   }
+   fclose(fp);
+
+   *pSize = (uint32_t)lSize;
+
+   return(pData);
+} /* ReadFile */
+
+/*************************************************************************/
+/*  TestImage                                                            */
+/*                                                                       */
+/*  Look up all files of the image and compare them with the folder.     */
+/*************************************************************************/
+static void TestImage (const char *pImageName, int nVersion)
+{
+   uint8_t  *pImage;
+   uint8_t  *pFile;
+   uint8_t  *pRead;
+   uint32_t  dImageSize;
+   uint32_t  dFileSize;
+   uint32_t  dCmpMax = 0;
+   uint32_t  dCmpSum = 0;
+   uint32_t  dCalls;
+   intptr_t  Handle[_FCB_POOL_CNT + 1];
+   char      Path[PATH_SIZE];
+   char     *pName;
+   int       nCount = 0;
+   int       nIndex;
+
+   pImage = ReadFile(pImageName, &dImageSize);
+   if ((NULL == pImage) || (xfile_Check(pImage, dImageSize) != 0) || (NULL == xfile_Mount(pImage, dImageSize)))
+   {
+      Check(0, "mount", pImageName);
+      free(pImage);
+      return;
+   }
+   Check((4 == nVersion) == (pHash != NULL), "hash table of version", pImageName);
+
+   for (nIndex = 0; pDir[nIndex].dFilename != 0; nIndex++)
+   {
+      pName = (char*)(pImageBuffer + pDir[nIndex].dFilename);
+
+      /* Lookup */
+      dStrcmpCnt = 0;
+      Check(FindEntry(pName) == nIndex, "lookup", pName);
+      if (4 == nVersion)
+      {
+         Check(1 == dStrcmpCnt, "more than one compare", pName);
+      }
+      else
+      {
+         Check(dStrcmpCnt == (uint32_t)(nIndex + 1), "no linear scan", pName);
+      }
+      dCmpSum += dStrcmpCnt;
+      dCmpMax  = (dStrcmpCnt > dCmpMax) ? dStrcmpCnt : dCmpMax;
+
+      /* Content */
+      snprintf(Path, sizeof(Path), "%s/%s", pFolder, pName);
+      pFile = ReadFile(Path, &dFileSize);
+      Check((pFile != NULL) && (dFileSize == pDir[nIndex].dFilelength), "size", pName);
+      if ((pFile != NULL) && (dFileSize == pDir[nIndex].dFilelength))
+      {
+         pRead = malloc((size_t)dFileSize + 1);
+         Handle[0] = xfile_open(pName, 0);
+         Check((Handle[0] != -1) && (xfile_read(Handle[0], pRead, dFileSize + 1) == (int)dFileSize) &&
+               (0 == memcmp(pRead, pFile, dFileSize)), "content", pName);
+         if (Handle[0] != -1)
+         {
+            xfile_close(Handle[0]);
+         }
+         free(pRead);
+      }
+      free(pFile);
+
+      nCount++;
+   }
+   Check(nCount == nFolderCnt, "file count of the folder", pFolder);
+
+   dStrcmpCnt = 0;
+   Check(-1 == FindEntry("no/such/file.htm"), "missing file found", pImageName);
+   Check(-1 == xfile_open("no/such/file.htm", 0), "missing file opened", pImageName);
+
+   /* The pool is used first, only the last FCB comes from the heap */
+   dCalls = host_MemCallCount();
+   for (nIndex = 0; nIndex < (_FCB_POOL_CNT + 1); nIndex++)
+   {
+      Handle[nIndex] = xfile_open((char*)(pImageBuffer + pDir[0].dFilename), 0);
+      if (_FCB_POOL_CNT - 1 == nIndex)
+      {
+         Check(host_MemCallCount() == dCalls, "heap used by the pool", pImageName);
+      }
+   }
+   Check(host_MemCallCount() == (dCalls + 1), "heap not used after the pool", pImageName);
+   for (nIndex = 0; nIndex < (_FCB_POOL_CNT + 1); nIndex++)
+   {
+      Check(Handle[nIndex] != -1, "open", pImageName);
+      if (Handle[nIndex] != -1)
+      {
+         xfile_close(Handle[nIndex]);
+      }
+   }
+
+   printf("v%d:       %d files, compares per lookup %.1f average, %u max\n",
+          nVersion, nCount, (nCount > 0) ? ((double)dCmpSum / nCount) : 0.0, dCmpMax);
+
+   if (pImageBuffer != (pImage + sizeof(XFILE_HEADER)))
+   {
+      xfree(pImageBuffer);
+   }
+   xfile_UnMount();
+   free(pImage);
+
+} /* TestImage */
+
+/*=======================================================================*/
+/*  All code exported                                                    */
+/*=======================================================================*/
+
+int main (int argc, char **argv)
+{
+   if (argc != 4)
+   {
+      fprintf(stderr, "Usage: xfiletest Folder V4Image V3Image\n");
+      return(1);
+   }
+   pFolder = argv[1];
+
+   nFolderCnt = CountFiles(pFolder);
+   if (nFolderCnt < 0)
+   {
+      fprintf(stderr, "Error: Folder \"%s\" not available\n", pFolder);
+      return(1);
+   }
+
+   xfile_Init();
+
+   TestImage(argv[2], 4);
+   TestImage(argv[3], 3);
+
+   if (nFailed != 0)
+   {
+      printf("%d failures\n", nFailed);
+      return(2);
+   }
+
+   return(0);
+} /* main */
+
+/*** EOF ***/
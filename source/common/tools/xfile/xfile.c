@@ -0,0 +1,582 @@
+/**************************************************************************
+*  Copyright (c) 2026 by Michael Fischer (www.emb4fun.de).
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*  1. Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*
+*  2. Redistributions in binary form must reproduce the above copyright
+*     notice, this list of conditions and the following disclaimer in the
+*     documentation and/or other materials provided with the distribution.
+*
+*  3. Neither the name of the author nor the names of its contributors may
+*     be used to endorse or promote products derived from this software
+*     without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+*  THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+*  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+*  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+*  THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+*  SUCH DAMAGE.
+*
+***************************************************************************
+*  History:
+*
+*  16.10.2026  mifi  First Version, portable replacement of xfile.exe.
+*  17.10.2026  mifi  Check the length of all paths.
+**************************************************************************/
+/*
+ * Host tool to create a XFILE image from a folder. The command line
+ * is compatible to the Windows xfile.exe:
+ *
+ *    xfile -i:InFolder [-p:ProductID] [-c:Config] [-z] [-o:Output] [-3]
+ *
+ * The config file is relative to the input folder, the name and the
+ * version of the image are taken from the [SYSTEM] and [VERSION]
+ * section. By default a version 4 image with a hashed directory index
+ * is created, -3 creates a version 3 image without the index.
+ * If SOURCE_DATE_EPOCH is set, it is used as creation time.
+ *
+ * Build with: cc -O2 -o xfile xfile.c -lz, or with make xfile in
+ * tools/webhost, where make test checks the images.
+ */
+#define __XFILE_C__
+
+/*=======================================================================*/
+/*  Includes                                                             */
+/*=======================================================================*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <zlib.h>
+
+#include "../../library/fsapi/inc/xfile.h"
+
+/*=======================================================================*/
+/*  All Structures and Common Constants                                  */
+/*=======================================================================*/
+
+#define XFILE_TOOL_VERSION    "4.00"
+
+#define MAX_FILES             4096
+#define MAX_PATH_LEN          256
+#define MAX_IMAGE_SIZE        (32 * 1024 * 1024)
+
+#define ALIGN4(_x)            (((_x) + 3) & ~3u)
+
+typedef struct _file_entry_
+{
+   char     Name[MAX_PATH_LEN];   /* Name relative to the input folder */
+   uint32_t dSize;
+} FILE_ENTRY;
+
+/*=======================================================================*/
+/*  Definition of all local Data                                         */
+/*=======================================================================*/
+
+static FILE_ENTRY  FileList[MAX_FILES];
+static int         FileCount = 0;
+
+static char       *pInFolder  = NULL;
+static char       *pConfig    = NULL;
+static char       *pOutFile   = "xfile.bin";
+static uint32_t    dProductID = 0;
+static int         bCompress  = 0;
+static int         bVersion3  = 0;
+
+/*=======================================================================*/
+/*  Definition of all local Procedures                                   */
+/*=======================================================================*/
+
+/*************************************************************************/
+/*  Usage                                                                */
+/*                                                                       */
+/*  In    : none                                                         */
+/*  Out   : none                                                         */
+/*  Return: none                                                         */
+/*************************************************************************/
+static void Usage (void)
+{
+   printf("xfile v%s compiled %s %s\n", XFILE_TOOL_VERSION, __DATE__, __TIME__);
+   printf("Usage: xfile -i:InFolder [-p:ProductID] [-c:Config] [-z] [-o:Output] [-3]\n");
+   printf("  -i   Input folder, e.g. -i:html\n");
+   printf("  -p   Product ID (hex), e.g. -p:0x80000001\n");
+   printf("  -c   Config file, e.g. -c:etc/config.txt\n");
+   printf("  -z   Compress the data with ZLIB\n");
+   printf("  -o   Output file, default xfile.bin\n");
+   printf("  -3   Create a version 3 image without hash table\n");
+} /* Usage */
+
+/*************************************************************************/
+/*  MakePath                                                             */
+/*                                                                       */
+/*  Create the path "First/Second" in pPath.                             */
+/*                                                                       */
+/*  In    : pPath, Size, pFirst, pSecond                                 */
+/*  Out   : pPath                                                        */
+/*  Return: 0 = OK / -1 = ERROR, path too long                           */
+/*************************************************************************/
+static int MakePath (char *pPath, size_t Size, const char *pFirst, const char *pSecond)
+{
+   int nLen;
+
+   if ('\0' == pFirst[0])
+   {
+      nLen = snprintf(pPath, Size, "%s", pSecond);
+   }
+   else
+   {
+      nLen = snprintf(pPath, Size, "%s/%s", pFirst, pSecond);
+   }
+   if ((nLen < 0) || ((size_t)nLen >= Size))
+   {
+      printf("Error: Path len > %d, \"%s/%s\"\n", (int)Size - 1, pFirst, pSecond);
+      return(-1);
+   }
+
+   return(0);
+} /* MakePath */
+
+/*************************************************************************/
+/*  CompareEntry                                                         */
+/*                                                                       */
+/*  In    : a, b                                                         */
+/*  Out   : none                                                         */
+/*  Return: strcmp result of the names                                   */
+/*************************************************************************/
+static int CompareEntry (const void *a, const void *b)
+{
+   return(strcmp(((const FILE_ENTRY*)a)->Name, ((const FILE_ENTRY*)b)->Name));
+} /* CompareEntry */
+
+/*************************************************************************/
+/*  ScanFolder                                                           */
+/*                                                                       */
+/*  Collect all files of the folder and its subfolders.                  */
+/*                                                                       */
+/*  In    : pRelative, folder relative to the input folder, "" = root    */
+/*  Out   : none                                                         */
+/*  Return: 0 = OK / -1 = ERROR                                          */
+/*************************************************************************/
+static int ScanFolder (const char *pRelative)
+{
+   int             rc = 0;
+   DIR           *pDirectory;
+   struct dirent *pEntry;
+   struct stat     Stat;
+   char            Path[MAX_PATH_LEN * 2];
+   char            Name[MAX_PATH_LEN * 2];
+
+   if (MakePath(Path, sizeof(Path), pInFolder, pRelative) != 0)
+   {
+      return(-1);
+   }
+   pDirectory = opendir(Path);
+   if (NULL == pDirectory)
+   {
+      printf("Error: Input folder \"%s\" not available\n", Path);
+      return(-1);
+   }
+
+   while ((0 == rc) && ((pEntry = readdir(pDirectory)) != NULL))
+   {
+      if (('.' == pEntry->d_name[0]) &&
+          (('\0' == pEntry->d_name[1]) || (('.' == pEntry->d_name[1]) && ('\0' == pEntry->d_name[2]))))
+      {
+         continue;
+      }
+
+      if ((MakePath(Name, sizeof(Name), pRelative, pEntry->d_name) != 0) ||
+          (MakePath(Path, sizeof(Path), pInFolder, Name) != 0))
+      {
+         rc = -1;
+      }
+      else if (stat(Path, &Stat) != 0)
+      {
+         printf("Error: Could not stat \"%s\"\n", Path);
+         rc = -1;
+      }
+      else if (S_ISDIR(Stat.st_mode))
+      {
+         rc = ScanFolder(Name);
+      }
+      else if (S_ISREG(Stat.st_mode))
+      {
+         if (strlen(Name) >= MAX_PATH_LEN)
+         {
+            printf("Error: Filename len > %d, \"%s\"\n", MAX_PATH_LEN - 1, Name);
+            rc = -1;
+         }
+         else if (FileCount >= MAX_FILES)
+         {
+            printf("Error: To many files > %d\n", MAX_FILES);
+            rc = -1;
+         }
+         else
+         {
+            strcpy(FileList[FileCount].Name, Name);
+            FileList[FileCount].dSize = (uint32_t)Stat.st_size;
+            FileCount++;
+         }
+      }
+   }
+
+   closedir(pDirectory);
+
+   return(rc);
+} /* ScanFolder */
+
+/*************************************************************************/
+/*  ReadConfig                                                           */
+/*                                                                       */
+/*  Read the name and the version from the config file.                  */
+/*                                                                       */
+/*  In    : pHeader                                                      */
+/*  Out   : pHeader                                                      */
+/*  Return: 0 = OK / -1 = ERROR                                          */
+/*************************************************************************/
+static int ReadConfig (XFILE_HEADER *pHeader)
+{
+   FILE     *hFile;
+   char      Path[MAX_PATH_LEN * 2];
+   char      Line[256];
+   char      Section[32] = "";
+   char    *pKey;
+   char    *pValue;
+   char    *pEnd;
+   uint32_t  Digit[3] = { 0, 0, 0 };
+
+   if (MakePath(Path, sizeof(Path), pInFolder, pConfig) != 0)
+   {
+      return(-1);
+   }
+   hFile = fopen(Path, "r");
+   if (NULL == hFile)
+   {
+      printf("Error: Config file \"%s\" not available\n", Path);
+      return(-1);
+   }
+
+   while (fgets(Line, sizeof(Line), hFile) != NULL)
+   {
+      pKey = Line;
+      while (isspace((unsigned char)*pKey)) pKey++;
+
+      if ('[' == *pKey)
+      {
+         pEnd = strchr(pKey, ']');
+         if (pEnd != NULL)
+         {
+            *pEnd = '\0';
+            snprintf(Section, sizeof(Section), "%s", pKey + 1);
+         }
+         continue;
+      }
+
+      pValue = strchr(pKey, '=');
+      if (NULL == pValue)
+      {
+         continue;
+      }
+
+      /* Split key and value, remove white space */
+      pEnd = pValue;
+      while ((pEnd > pKey) && isspace((unsigned char)pEnd[-1])) pEnd--;
+      *pEnd = '\0';
+      pValue++;
+      while (isspace((unsigned char)*pValue)) pValue++;
+      pEnd = pValue + strlen(pValue);
+      while ((pEnd > pValue) && isspace((unsigned char)pEnd[-1])) pEnd--;
+      *pEnd = '\0';
+
+      if ((0 == strcmp(Section, "SYSTEM")) && (0 == strcmp(pKey, "Name")))
+      {
+         if ('"' == *pValue)
+         {
+            pValue++;
+            pEnd = strchr(pValue, '"');
+            if (pEnd != NULL) *pEnd = '\0';
+         }
+         if (strlen(pValue) >= XFILE_HEADER_NAME_SIZE)
+         {
+            printf("Error: Name len > %d\n", XFILE_HEADER_NAME_SIZE - 1);
+            fclose(hFile);
+            return(-1);
+         }
+         strcpy((char*)pHeader->DataName, pValue);
+      }
+      else if ((0 == strcmp(Section, "VERSION")) && (0 == strncmp(pKey, "Digit", 5)) &&
+               (pKey[5] >= '1') && (pKey[5] <= '3') && ('\0' == pKey[6]))
+      {
+         Digit[pKey[5] - '1'] = (uint32_t)strtoul(pValue, NULL, 10);
+      }
+   }
+
+   fclose(hFile);
+
+   pHeader->dDataVersion = (Digit[0] * 100) + (Digit[1] * 10) + Digit[2];
+
+   return(0);
+} /* ReadConfig */
+
+/*************************************************************************/
+/*  HashName                                                             */
+/*                                                                       */
+/*  Calculate the FNV-1a hash of a filename, see fs_xfile.c.             */
+/*                                                                       */
+/*  In    : name                                                         */
+/*  Out   : none                                                         */
+/*  Return: Hash value                                                   */
+/*************************************************************************/
+static uint32_t HashName (const char *name)
+{
+   uint32_t dHash = XFILE_HASH_FNV_OFFSET;
+
+   while (*name != 0)
+   {
+      dHash ^= (uint8_t)*name++;
+      dHash *= XFILE_HASH_FNV_PRIME;
+   }
+
+   return(dHash);
+} /* HashName */
+
+/*************************************************************************/
+/*  BuildData                                                            */
+/*                                                                       */
+/*  Create the data area: directory, names, hash table and file data.    */
+/*                                                                       */
+/*  In    : pHeader, pSize                                               */
+/*  Out   : pHeader, pSize                                               */
+/*  Return: Data buffer / NULL = ERROR                                   */
+/*************************************************************************/
+static uint8_t *BuildData (XFILE_HEADER *pHeader, uint32_t *pSize)
+{
+   uint8_t           *pData;
+   XFILE_FAT_ENTRY  *pFat;
+   XFILE_HASH_ENTRY *pHash;
+   FILE              *hFile;
+   char               Path[MAX_PATH_LEN * 2];
+   uint32_t           dOffset;
+   uint32_t           dHashOffset = 0;
+   uint32_t           dHashSize   = 0;
+   uint32_t           dSlot;
+   uint64_t           dTotal;
+   int                i;
+
+   /* Calculate the size of the data area */
+   dTotal = (uint64_t)(FileCount + 1) * sizeof(XFILE_FAT_ENTRY);
+   for (i = 0; i < FileCount; i++)
+   {
+      dTotal += ALIGN4(strlen(FileList[i].Name) + 1);
+   }
+   if (!bVersion3)
+   {
+      /* At least 50% free slots, keeps the probe sequences short */
+      dHashSize = 4;
+      while (dHashSize < (uint32_t)(FileCount * 2))
+      {
+         dHashSize <<= 1;
+      }
+      dHashOffset = (uint32_t)dTotal;
+      dTotal     += dHashSize * sizeof(XFILE_HASH_ENTRY);
+   }
+   for (i = 0; i < FileCount; i++)
+   {
+      dTotal += ALIGN4((uint64_t)FileList[i].dSize);
+   }
+   if (dTotal > MAX_IMAGE_SIZE)
+   {
+      printf("Error: xfile size > %d\n", MAX_IMAGE_SIZE);
+      return(NULL);
+   }
+
+   pData = (uint8_t*)calloc(1, (size_t)dTotal);
+   if (NULL == pData)
+   {
+      printf("Error: Out of memory\n");
+      return(NULL);
+   }
+   pFat  = (XFILE_FAT_ENTRY*)pData;
+   pHash = (XFILE_HASH_ENTRY*)(pData + dHashOffset);
+
+   /* Names follow the directory, the terminating entry stays zero */
+   dOffset = (uint32_t)(FileCount + 1) * sizeof(XFILE_FAT_ENTRY);
+   for (i = 0; i < FileCount; i++)
+   {
+      pFat[i].dFilename   = dOffset;
+      pFat[i].dFilelength = FileList[i].dSize;
+      strcpy((char*)&pData[dOffset], FileList[i].Name);
+      dOffset += ALIGN4(strlen(FileList[i].Name) + 1);
+   }
+
+   /* Hash table with linear probing */
+   if (!bVersion3)
+   {
+      for (i = 0; i < FileCount; i++)
+      {
+         dSlot = HashName(FileList[i].Name) & (dHashSize - 1);
+         while (pHash[dSlot].dIndex != 0)
+         {
+            dSlot = (dSlot + 1) & (dHashSize - 1);
+         }
+         pHash[dSlot].dHash  = HashName(FileList[i].Name);
+         pHash[dSlot].dIndex = (uint32_t)i + 1;
+      }
+      dOffset += dHashSize * sizeof(XFILE_HASH_ENTRY);
+
+      pHeader->dHashTable = dHashOffset;
+      pHeader->dHashSize  = dHashSize;
+   }
+
+   /* File data */
+   for (i = 0; i < FileCount; i++)
+   {
+      hFile = NULL;
+      if ((MakePath(Path, sizeof(Path), pInFolder, FileList[i].Name) != 0) ||
+          (NULL == (hFile = fopen(Path, "rb"))) || (fread(&pData[dOffset], 1, FileList[i].dSize, hFile) != FileList[i].dSize))
+      {
+         printf("Error: Could not read \"%s/%s\"\n", pInFolder, FileList[i].Name);
+         if (hFile != NULL) fclose(hFile);
+         free(pData);
+         return(NULL);
+      }
+      fclose(hFile);
+
+      pFat[i].dData = dOffset;
+      dOffset += ALIGN4(FileList[i].dSize);
+   }
+
+   *pSize = dOffset;
+
+   return(pData);
+} /* BuildData */
+
+/*=======================================================================*/
+/*  All code exported                                                    */
+/*=======================================================================*/
+
+int main (int argc, char **argv)
+{
+   XFILE_HEADER  Header;
+   uint8_t      *pData;
+   uint8_t      *pComp  = NULL;
+   uLongf         dCompSize;
+   uint32_t      dSize;
+   FILE          *hFile;
+   char          *pEpoch;
+   int            i;
+
+   for (i = 1; i < argc; i++)
+   {
+      if      (0 == strncmp(argv[i], "-i:", 3)) pInFolder  = &argv[i][3];
+      else if (0 == strncmp(argv[i], "-c:", 3)) pConfig    = &argv[i][3];
+      else if (0 == strncmp(argv[i], "-o:", 3)) pOutFile   = &argv[i][3];
+      else if (0 == strncmp(argv[i], "-p:", 3)) dProductID = (uint32_t)strtoul(&argv[i][3], NULL, 16);
+      else if (0 == strcmp(argv[i], "-z"))      bCompress  = 1;
+      else if (0 == strcmp(argv[i], "-3"))      bVersion3  = 1;
+      else
+      {
+         Usage();
+         return(-1);
+      }
+   }
+
+   if (NULL == pInFolder)
+   {
+      Usage();
+      printf("Error: No input folder specified\n");
+      return(-1);
+   }
+   printf("Input folder: %s\n", pInFolder);
+
+   memset(&Header, 0x00, sizeof(Header));
+   Header.dMagic1      = XFILE_HEADER_MAGIC_1;
+   Header.dMagic2      = XFILE_HEADER_MAGIC_2;
+   Header.dSizeVersion = (bVersion3) ? XFILE_HEADER_SIZEVER_V3 : XFILE_HEADER_SIZEVER_V4;
+   Header.dProductID   = dProductID;
+
+   pEpoch = getenv("SOURCE_DATE_EPOCH");
+   Header.dDataCreationTime = (pEpoch != NULL) ? (uint32_t)strtoul(pEpoch, NULL, 10) : (uint32_t)time(NULL);
+
+   if ((pConfig != NULL) && (ReadConfig(&Header) != 0))
+   {
+      return(-1);
+   }
+
+   if (ScanFolder("") != 0)
+   {
+      return(-1);
+   }
+   qsort(FileList, (size_t)FileCount, sizeof(FILE_ENTRY), CompareEntry);
+
+   pData = BuildData(&Header, &dSize);
+   if (NULL == pData)
+   {
+      return(-1);
+   }
+   Header.dDataTotalSize = dSize;
+   Header.dDataCRC32     = (uint32_t)adler32(adler32(0, NULL, 0), pData, dSize);
+
+   if (bCompress)
+   {
+      dCompSize = compressBound(dSize);
+      pComp     = (uint8_t*)malloc(dCompSize);
+      if ((NULL == pComp) || (compress2(pComp, &dCompSize, pData, dSize, Z_BEST_COMPRESSION) != Z_OK))
+      {
+         printf("Error: ZLIB error\n");
+         free(pComp);
+         free(pData);
+         return(-1);
+      }
+      Header.dDataCompSize  = (uint32_t)dCompSize;
+      Header.dDataCompCRC32 = (uint32_t)adler32(adler32(0, NULL, 0), pComp, (uInt)dCompSize);
+   }
+
+   Header.dHeaderCRC32 = (uint32_t)adler32(adler32(0, NULL, 0), (uint8_t*)&Header, sizeof(Header) - XFILE_SIZE_OF_CRC32);
+
+   hFile = fopen(pOutFile, "wb");
+   if (NULL == hFile)
+   {
+      printf("Error: Could not create \"%s\"\n", pOutFile);
+      free(pComp);
+      free(pData);
+      return(-1);
+   }
+
+   if ((fwrite(&Header, 1, sizeof(Header), hFile) != sizeof(Header)) ||
+       ((pComp != NULL) && (fwrite(pComp, 1, Header.dDataCompSize, hFile) != Header.dDataCompSize)) ||
+       ((NULL == pComp) && (fwrite(pData, 1, dSize, hFile) != dSize)))
+   {
+      printf("Error: Write error\n");
+      fclose(hFile);
+      free(pComp);
+      free(pData);
+      return(-1);
+   }
+
+   printf("Output file \"%s\" was successful created, %ld bytes\n", pOutFile, ftell(hFile));
+   fclose(hFile);
+
+   free(pComp);
+   free(pData);
+
+   return(0);
+} /* main */
+
+/*** EOF ***/
@@ -53,6 +53,65 @@
 #define IP_WEB_CGI_EXT_CST          1
 
 #define IP_WEB_SID_SUPPORT          1
+#define IP_WEB_SID_LIST_CNT         32
+#define IP_WEB_SID_TIMEOUT_SEC      (1*60)
+#define IP_WEB_SID_BIND_IP          1
+
+/*
+ * Connection multiplexer, a small number of worker tasks serve
+ * all HTTP connections. The number of connections is limited by
+ * IP_WEB_MUX_MAX_CONN and MEMP_NUM_NETCONN.
+ */
+#define IP_WEB_MUX_SUPPORT          0
+#define IP_WEB_MUX_WORKERS          4
+#define IP_WEB_MUX_MAX_CONN         MEMP_NUM_NETCONN
+
+/*
+ * Admission control, a connection which finds no free client task
+ * waits in the accept queue. If the queue is full, or the connection
+ * waited too long, it is answered with "503 Service Unavailable".
+ */
+#define IP_WEB_ACCEPT_QUEUE_SIZE        8
+#define IP_WEB_ACCEPT_QUEUE_TIMEOUT_MS  2000
+#define IP_WEB_RETRY_AFTER_SEC          1
+
+/*
+ * Connection timeouts: waiting for the request header, inactivity
+ * while the request is processed, keep-alive idle time.
+ */
+#define IP_WEB_HEADER_TIMEOUT_MS        10000
+#define IP_WEB_BODY_TIMEOUT_MS          30000
+#define IP_WEB_IDLE_TIMEOUT_MS          15000
+
+/*
+ * Status event stream, one sample per interval is shared by all
+ * subscribers. Each subscriber occupies a HTTP task. A row of the
+ * task list needs about 115 bytes, the frame holds about 30 tasks.
+ */
+#define IP_WEB_SSE_MAX_CLIENTS          2
+#define IP_WEB_SSE_INTERVAL_MS          2000
+#define IP_WEB_SSE_FRAME_SIZE           4096
+
+/*
+ * Static buffer of the JSON telemetry snapshot, stat_json.cgi
+ */
+#define IP_WEB_STAT_JSON_SIZE           5120
+
+/*
+ * Access log ring, size must be a power of 2. The records can be
+ * drained to syslog, IP_WEB_LOG_SYSLOG_BATCH records together.
+ */
+#define IP_WEB_LOG_RING_SIZE            64
+#define IP_WEB_LOG_SYSLOG               0
+#define IP_WEB_LOG_SYSLOG_BATCH         16
+
+/*
+ * RAM cache of the static files, 0 = not used. Files larger
+ * than IP_WEB_CACHE_FILE_MAX bytes are sent from the file system.
+ */
+#define IP_WEB_CACHE_SIZE               65536
+#define IP_WEB_CACHE_ENTRIES            16
+#define IP_WEB_CACHE_FILE_MAX           16384
 
 /**************************************************************************
 *  Macro Definitions
@@ -46,6 +46,12 @@
 *  Global Definitions
 **************************************************************************/
 
+/*
+ * Set to 1 to use the TLSF allocator for xmalloc/xfree instead
+ * of the "First Fit" free list.
+ */
+#define TAL_MEM_SUPPORT_TLSF  0
+
 /**************************************************************************
 *  Macro Definitions
 **************************************************************************/
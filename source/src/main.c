@@ -48,6 +48,8 @@
 #include "nvm.h"
 #include "ipstack.h"
 #include "ipweb.h"
+#include "web_sse.h"
+#include "web_cache.h"
 #include "cert.h"
 #include "xmempool.h"
 #include "mbedtls/version.h"
@@ -694,6 +696,31 @@ void term_RxCallback (uint8_t bData)
          term_printf("\r\n");
          term_printf("Threads Max HTTP : %d\r\n", nNumThreadsMax);
          term_printf("Threads Max HTTPs: %d\r\n", nNumThreadsMaxTLS);
+         {
+            ipweb_accept_stats_t Stats;
+            
+            IPWebsGetAcceptStats(&Stats);
+            term_printf("HTTP accepted    : %d\r\n", Stats.dAccepted);
+            term_printf("HTTP queued      : %d (max %d)\r\n", Stats.dQueued, Stats.dQueueMax);
+            term_printf("HTTP shed (503)  : %d\r\n", Stats.dShed);
+            term_printf("HTTP timed out   : %d\r\n", Stats.dTimedOut);
+         }
+         {
+            web_sse_stats_t Stats;
+            
+            web_SSEGetStats(&Stats);
+            term_printf("SSE subscribers  : %d (rejected %d)\r\n", Stats.dSubscribers, Stats.dRejected);
+            term_printf("SSE samples      : %d (skipped %d, truncated %d)\r\n", Stats.dSamples, Stats.dSkipped, Stats.dTruncated);
+            term_printf("SSE frames sent  : %d (dropped %d)\r\n", Stats.dSent, Stats.dDropped);
+         }
+         {
+            web_cache_stats_t Stats;
+            
+            web_CacheGetStats(&Stats);
+            term_printf("Cache entries    : %d (%d bytes)\r\n", Stats.dEntries, Stats.dBytes);
+            term_printf("Cache hits       : %d (misses %d)\r\n", Stats.dHits, Stats.dMisses);
+            term_printf("Cache inserts    : %d (evicts %d, flushes %d)\r\n", Stats.dInserts, Stats.dEvicts, Stats.dFlushes);
+         }
          nNumThreadsMax    = 0;
          nNumThreadsMaxTLS = 0;
          break;
@@ -36,6 +36,7 @@
 *  16.03.2019  mifi  First version.
 *  04.07.2019  mifi  Changed from LPC to STM. 
 *  14.07.2019  mifi  First version for the BeagleBone Black.
+*  17.10.2026  mifi  Use HttpFormRead for the arguments.
 **************************************************************************/
 #define __WEB_CGI_EXT_CST_C__
 
@@ -89,7 +90,7 @@ int nUser2Value = 2;
 /*************************************************************************/
 int User1Set (HTTPD_SESSION *hs)
 {
-   long      Avail;
+   HTTP_FORM Form;
    char    *pArg;
    char    *pVal;
    char    *pRedir = NULL;
@@ -99,27 +100,22 @@ int User1Set (HTTPD_SESSION *hs)
    /* For this CGI the permission of user1 is needed */
    dPermission = hs->s_req.req_sid_perm & PERMISSION_USER1;
    
-   Avail = hs->s_req.req_length;
-   while (Avail) 
+   HttpFormRead(hs, &Form);
+   while ((pArg = HttpFormNext(&Form, &pVal)) != NULL)
    {
-      pArg = HttpArgReadNext(hs, &Avail);
-      if (pArg != NULL)
+      if (pVal)
       {
-         pVal = HttpArgValue(&hs->s_req);
-         if (pVal)
+//         term_printf("%s: %s\r\n", pArg, pVal);
+      
+         if      (strcmp(pArg, "value") == 0)
          {
-//            term_printf("%s: %s\r\n", pArg, pVal);
-         
-            if      (strcmp(pArg, "value") == 0)
-            {
-               nValue = atoi(pVal);
-            }
-            else if (strcmp(pArg, "redir") == 0)
-            {
-               pRedir = strdup(pVal);
-            }
-         }            
-      }
+            nValue = atoi(pVal);
+         }
+         else if (strcmp(pArg, "redir") == 0)
+         {
+            pRedir = pVal;
+         }
+      }            
    }   
 
    /* Check if all required parameters are available */
@@ -136,7 +132,8 @@ int User1Set (HTTPD_SESSION *hs)
       }   
    }   
    
-   free(pRedir);
+   /* pRedir points into the form, release it last */
+   HttpFormRelease(&Form);
 
    return(0);
 } /* User1Set */
@@ -150,7 +147,7 @@ int User1Set (HTTPD_SESSION *hs)
 /*************************************************************************/
 int User2Set (HTTPD_SESSION *hs)
 {
-   long      Avail;
+   HTTP_FORM Form;
    char    *pArg;
    char    *pVal;
    char    *pRedir = NULL;
@@ -160,27 +157,22 @@ int User2Set (HTTPD_SESSION *hs)
    /* For this CGI the permission of user2 is needed */
    dPermission = hs->s_req.req_sid_perm & PERMISSION_USER2;
    
-   Avail = hs->s_req.req_length;
-   while (Avail) 
+   HttpFormRead(hs, &Form);
+   while ((pArg = HttpFormNext(&Form, &pVal)) != NULL)
    {
-      pArg = HttpArgReadNext(hs, &Avail);
-      if (pArg != NULL)
+      if (pVal)
       {
-         pVal = HttpArgValue(&hs->s_req);
-         if (pVal)
+//         term_printf("%s: %s\r\n", pArg, pVal);
+      
+         if      (strcmp(pArg, "value") == 0)
          {
-//            term_printf("%s: %s\r\n", pArg, pVal);
-         
-            if      (strcmp(pArg, "value") == 0)
-            {
-               nValue = atoi(pVal);
-            }
-            else if (strcmp(pArg, "redir") == 0)
-            {
-               pRedir = strdup(pVal);
-            }
-         }            
-      }
+            nValue = atoi(pVal);
+         }
+         else if (strcmp(pArg, "redir") == 0)
+         {
+            pRedir = pVal;
+         }
+      }            
    }   
 
    /* Check if all required parameters are available */
@@ -197,7 +189,8 @@ int User2Set (HTTPD_SESSION *hs)
       }   
    }   
    
-   free(pRedir);
+   /* pRedir points into the form, release it last */
+   HttpFormRelease(&Form);
 
    return(0);
 } /* User2Set */